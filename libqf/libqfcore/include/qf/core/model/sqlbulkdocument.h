@@ -0,0 +1 @@
+#include "../../../../src/model/sqlbulkdocument.h"
@@ -0,0 +1 @@
+#include "../../../../src/sql/queryexecutor.h"
@@ -61,6 +61,19 @@ int Collator::compare(const QStringRef &s1, const QStringRef &s2) const
 	return ret;
 }
 
+QString Collator::sortKey(const QString &s) const
+{
+	return sortKey(QStringRef(&s));
+}
+
+QString Collator::sortKey(const QStringRef &s) const
+{
+	QString ret(s.length(), Qt::Uninitialized);
+	for(int i=0; i<s.length(); i++)
+		ret[i] = QChar(sortIndex(s.at(i)));
+	return ret;
+}
+
 int Collator::sortIndex(QChar c) const
 {
 	QChar co = c;
@@ -44,6 +44,10 @@ public:
 
 	int compare(const QString &s1, const QString &s2) const;
 	int compare(const QStringRef &s1, const QStringRef &s2) const;
+	/// sort keys compare by QString::compare() as source strings compare by compare(),
+	/// key has the same length as source string, so key prefix is key of string prefix
+	QString sortKey(const QString &s) const;
+	QString sortKey(const QStringRef &s) const;
 
 	static QByteArray toAscii7(QLocale::Language lang, const QString &s, bool to_lower);
 	static QChar removePunctuation(QLocale::Language language, QChar c);
@@ -3,6 +3,7 @@ HEADERS += \
     $$PWD/logtablemodel.h \
     $$PWD/datadocument.h \
     $$PWD/sqldatadocument.h \
+    $$PWD/sqlbulkdocument.h \
     $$PWD/sqltablemodel.h
 
 SOURCES += \
@@ -10,5 +11,6 @@ SOURCES += \
     $$PWD/logtablemodel.cpp \
     $$PWD/datadocument.cpp \
     $$PWD/sqldatadocument.cpp \
+    $$PWD/sqlbulkdocument.cpp \
     $$PWD/sqltablemodel.cpp
 
@@ -0,0 +1,411 @@
+#include "sqlbulkdocument.h"
+
+#include "../core/assert.h"
+#include "../core/exception.h"
+#include "../core/log.h"
+#include "../sql/connection.h"
+#include "../sql/query.h"
+
+using namespace qf::core::model;
+
+SqlBulkDocument::SqlBulkDocument(const QString &table_name, const QString &connection_name)
+	: m_tableName(table_name)
+	, m_connectionName(connection_name)
+{
+}
+
+SqlBulkDocument::~SqlBulkDocument()
+{
+}
+
+const QSqlRecord &SqlBulkDocument::sqlRecord() const
+{
+	if(m_sqlRecord.isEmpty()) {
+		qf::core::sql::Connection conn = qf::core::sql::Connection::forName(m_connectionName);
+		m_sqlRecord = conn.record(m_tableName);
+		if(m_sqlRecord.isEmpty())
+			QF_EXCEPTION("Cannot get record of table: " + m_tableName);
+	}
+	return m_sqlRecord;
+}
+
+int SqlBulkDocument::fieldIndex(const QString &field_name) const
+{
+	auto it = m_fieldIndexes.constFind(field_name);
+	if(it != m_fieldIndexes.constEnd())
+		return it.value();
+	QString fn = field_name.section('.', -1);
+	int ret = -1;
+	const QSqlRecord &rec = sqlRecord();
+	for (int i = 0; i < rec.count(); ++i) {
+		if(rec.fieldName(i).compare(fn, Qt::CaseInsensitive) == 0) {
+			ret = i;
+			break;
+		}
+	}
+	m_fieldIndexes[field_name] = ret;
+	return ret;
+}
+
+void SqlBulkDocument::load(const QList<int> &ids)
+{
+	QStringList id_list;
+	for (int i = 0; i < ids.count(); ++i) {
+		id_list << QString::number(ids[i]);
+		if(id_list.count() == 500 || i == ids.count() - 1) {
+			loadRecords(m_idFieldName + " IN (" + id_list.join(',') + ")");
+			id_list.clear();
+		}
+	}
+}
+
+void SqlBulkDocument::loadWhere(const QString &where_condition)
+{
+	loadRecords(where_condition);
+}
+
+void SqlBulkDocument::loadRecords(const QString &where_condition)
+{
+	qfLogFuncFrame() << m_tableName << where_condition;
+	const QSqlRecord &rec = sqlRecord();
+	int id_ix = fieldIndex(m_idFieldName);
+	if(id_ix < 0)
+		QF_EXCEPTION("Table: " + m_tableName + " has not id field: " + m_idFieldName);
+	QStringList fields;
+	for (int i = 0; i < rec.count(); ++i)
+		fields << rec.fieldName(i);
+	qf::core::sql::Query q(m_connectionName);
+	QString qs = "SELECT " + fields.join(", ") + " FROM " + m_tableName;
+	if(!where_condition.isEmpty())
+		qs += " WHERE " + where_condition;
+	q.exec(qs, qf::core::Exception::Throw);
+	while(q.next()) {
+		Record r;
+		r.mode = DataDocument::ModeEdit;
+		r.values.resize(fields.count());
+		for (int i = 0; i < fields.count(); ++i)
+			r.values[i] = q.value(i);
+		r.origValues = r.values;
+		r.dirty.fill(false, fields.count());
+		int id = r.values[id_ix].toInt();
+		int ix = m_idIndexes.value(id, -1);
+		if(ix < 0) {
+			m_idIndexes[id] = m_records.count();
+			m_records << r;
+		}
+		else {
+			m_records[ix] = r;
+		}
+	}
+}
+
+void SqlBulkDocument::clear()
+{
+	m_records.clear();
+	m_idIndexes.clear();
+}
+
+int SqlBulkDocument::appendRecord()
+{
+	int n = sqlRecord().count();
+	Record r;
+	r.mode = DataDocument::ModeInsert;
+	r.values.resize(n);
+	r.origValues.resize(n);
+	r.dirty.fill(false, n);
+	m_records << r;
+	return m_records.count() - 1;
+}
+
+SqlBulkDocument::RecordEditMode SqlBulkDocument::mode(int ix) const
+{
+	QF_ASSERT(isValidIndex(ix), "Invalid record index:" + QString::number(ix), return DataDocument::ModeView);
+	return m_records[ix].mode;
+}
+
+void SqlBulkDocument::setMode(int ix, SqlBulkDocument::RecordEditMode mode)
+{
+	QF_ASSERT(isValidIndex(ix), "Invalid record index:" + QString::number(ix), return);
+	m_records[ix].mode = mode;
+}
+
+QVariant SqlBulkDocument::dataId(int ix) const
+{
+	return value(ix, m_idFieldName);
+}
+
+QVariant SqlBulkDocument::value(int ix, const QString &field_name) const
+{
+	QF_ASSERT(isValidIndex(ix), "Invalid record index:" + QString::number(ix), return QVariant());
+	int fi = fieldIndex(field_name);
+	if(fi < 0) {
+		qfWarning() << "Invalid field name:" << field_name << "table:" << m_tableName;
+		return QVariant();
+	}
+	return m_records[ix].values.value(fi);
+}
+
+QVariant SqlBulkDocument::origValue(int ix, const QString &field_name) const
+{
+	QF_ASSERT(isValidIndex(ix), "Invalid record index:" + QString::number(ix), return QVariant());
+	int fi = fieldIndex(field_name);
+	if(fi < 0) {
+		qfWarning() << "Invalid field name:" << field_name << "table:" << m_tableName;
+		return QVariant();
+	}
+	return m_records[ix].origValues.value(fi);
+}
+
+void SqlBulkDocument::setValue(int ix, const QString &field_name, const QVariant &val)
+{
+	QF_ASSERT(isValidIndex(ix), "Invalid record index:" + QString::number(ix), return);
+	int fi = fieldIndex(field_name);
+	if(fi < 0) {
+		qfWarning() << "Invalid field name:" << field_name << "table:" << m_tableName;
+		return;
+	}
+	Record &r = m_records[ix];
+	r.values[fi] = val;
+	if(r.mode == DataDocument::ModeInsert) {
+		r.dirty[fi] = true;
+	}
+	else {
+		const QVariant &orig = r.origValues[fi];
+		r.dirty[fi] = (orig.isNull() != val.isNull()) || (orig != val);
+	}
+}
+
+bool SqlBulkDocument::isDirty(int ix) const
+{
+	QF_ASSERT(isValidIndex(ix), "Invalid record index:" + QString::number(ix), return false);
+	return m_records[ix].dirty.contains(true);
+}
+
+bool SqlBulkDocument::isDirty(int ix, const QString &field_name) const
+{
+	QF_ASSERT(isValidIndex(ix), "Invalid record index:" + QString::number(ix), return false);
+	int fi = fieldIndex(field_name);
+	if(fi < 0)
+		return false;
+	return m_records[ix].dirty[fi];
+}
+
+QList<int> SqlBulkDocument::dirtyFieldIndexes(const SqlBulkDocument::Record &rec) const
+{
+	QList<int> ret;
+	for (int i = 0; i < rec.dirty.count(); ++i) {
+		if(rec.dirty[i])
+			ret << i;
+	}
+	return ret;
+}
+
+QMap<QString, QList<int>> SqlBulkDocument::dirtyFieldSets(const QList<int> &ixs) const
+{
+	/// one prepared statement is used for each combination of dirty fields
+	QMap<QString, QList<int>> ret;
+	for(int ix : ixs) {
+		QStringList key;
+		for(int fi : dirtyFieldIndexes(m_records[ix]))
+			key << QString::number(fi);
+		ret[key.join(',')] << ix;
+	}
+	return ret;
+}
+
+QStringList SqlBulkDocument::idLists(const QList<int> &ixs, int chunk_size) const
+{
+	QStringList ret;
+	QStringList ids;
+	for (int i = 0; i < ixs.count(); ++i) {
+		ids << QString::number(dataId(ixs[i]).toInt());
+		if(ids.count() == chunk_size || i == ixs.count() - 1) {
+			ret << ids.join(',');
+			ids.clear();
+		}
+	}
+	return ret;
+}
+
+void SqlBulkDocument::save()
+{
+	qfLogFuncFrame() << m_tableName;
+	QList<int> dropped, updated, inserted;
+	for (int i = 0; i < m_records.count(); ++i) {
+		const Record &r = m_records[i];
+		if(r.mode == DataDocument::ModeDelete)
+			dropped << i;
+		else if(r.mode == DataDocument::ModeEdit && isDirty(i))
+			updated << i;
+		else if(r.mode == DataDocument::ModeInsert)
+			inserted << i;
+	}
+	qfDebug() << "drops:" << dropped.count() << "updates:" << updated.count() << "inserts:" << inserted.count();
+	if(!dropped.isEmpty())
+		dropRecords(dropped);
+	if(!updated.isEmpty())
+		updateRecords(updated);
+	if(!inserted.isEmpty())
+		insertRecords(inserted);
+	for(int ix : dropped) {
+		m_idIndexes.remove(dataId(ix).toInt());
+		m_records[ix].mode = DataDocument::ModeView;
+	}
+	int id_ix = fieldIndex(m_idFieldName);
+	for(int ix : updated + inserted) {
+		Record &r = m_records[ix];
+		r.mode = DataDocument::ModeEdit;
+		r.origValues = r.values;
+		r.dirty.fill(false);
+		if(id_ix >= 0)
+			m_idIndexes[r.values[id_ix].toInt()] = ix;
+	}
+}
+
+void SqlBulkDocument::dropRecords(const QList<int> &ixs)
+{
+	qf::core::sql::Query q(m_connectionName);
+	for(const QString &ids : idLists(ixs))
+		q.exec("DELETE FROM " + m_tableName + " WHERE " + m_idFieldName + " IN (" + ids + ")", qf::core::Exception::Throw);
+}
+
+void SqlBulkDocument::updateRows(const QString &table, const QString &key_field, const QStringList &fields, const QList<int> &keys, const QList<QVariantList> &values) const
+{
+	if(keys.isEmpty() || fields.isEmpty())
+		return;
+	/// keys are written as literals, bound values are kept under SQLite limit of 999 variables
+	const int chunk_size = qMin(500, qMax(1, 900 / fields.count()));
+	qf::core::sql::Query q(m_connectionName);
+	for (int i = 0; i < keys.count(); i += chunk_size) {
+		const int n = qMin(chunk_size, keys.count() - i);
+		QStringList key_list;
+		for (int j = i; j < i + n; ++j)
+			key_list << QString::number(keys[j]);
+		QStringList set_list;
+		for(const QString &field : fields) {
+			/// ELSE branch lets PostgreSQL infer type of bound values from field
+			QString set = field + "=CASE " + key_field;
+			for(const QString &key : key_list)
+				set += " WHEN " + key + " THEN ?";
+			set += " ELSE " + field + " END";
+			set_list << set;
+		}
+		q.prepare("UPDATE " + table + " SET " + set_list.join(", ") + " WHERE " + key_field + " IN (" + key_list.join(',') + ")", qf::core::Exception::Throw);
+		int bind_ix = 0;
+		for (int k = 0; k < fields.count(); ++k) {
+			for (int j = i; j < i + n; ++j)
+				q.bindValue(bind_ix++, values[j].value(k));
+		}
+		q.exec(qf::core::Exception::Throw);
+	}
+}
+
+void SqlBulkDocument::updateRecords(const QList<int> &ixs)
+{
+	const QSqlRecord &rec = sqlRecord();
+	int id_ix = fieldIndex(m_idFieldName);
+	QMap<QString, QList<int>> field_sets = dirtyFieldSets(ixs);
+	for(auto it = field_sets.constBegin(); it != field_sets.constEnd(); ++it) {
+		QList<int> fields = dirtyFieldIndexes(m_records[it.value().first()]);
+		QStringList names;
+		for(int fi : fields)
+			names << rec.fieldName(fi);
+		QList<int> keys;
+		QList<QVariantList> values;
+		for(int ix : it.value()) {
+			const Record &r = m_records[ix];
+			keys << r.origValues[id_ix].toInt();
+			QVariantList row;
+			for(int fi : fields)
+				row << r.values[fi];
+			values << row;
+		}
+		updateRows(m_tableName, m_idFieldName, names, keys, values);
+	}
+}
+
+void SqlBulkDocument::insertRecords(const QList<int> &ixs)
+{
+	const QSqlRecord &rec = sqlRecord();
+	int id_ix = fieldIndex(m_idFieldName);
+	qf::core::sql::Connection conn = qf::core::sql::Connection::forName(m_connectionName);
+	const bool is_psql = conn.driverName().endsWith(QLatin1String("PSQL"), Qt::CaseInsensitive);
+	const bool is_sqlite = conn.driverName().endsWith(QLatin1String("SQLITE"), Qt::CaseInsensitive);
+	QMap<QString, QList<int>> field_sets = dirtyFieldSets(ixs);
+	for(auto it = field_sets.constBegin(); it != field_sets.constEnd(); ++it) {
+		const QList<int> &set_ixs = it.value();
+		QList<int> fields = dirtyFieldIndexes(m_records[set_ixs.first()]);
+		if(fields.isEmpty() || !(is_psql || is_sqlite)) {
+			insertRecordsByRow(set_ixs, fields);
+			continue;
+		}
+		const bool fetch_id = id_ix >= 0 && !fields.contains(id_ix);
+		QStringList names, placeholders;
+		for(int fi : fields) {
+			names << rec.fieldName(fi);
+			placeholders << QStringLiteral("?");
+		}
+		const QString row_placeholders = '(' + placeholders.join(", ") + ')';
+		/// keep number of bound variables under SQLite limit 999
+		const int chunk_size = qMin(500, qMax(1, 900 / fields.count()));
+		qf::core::sql::Query q(conn);
+		for (int i = 0; i < set_ixs.count(); i += chunk_size) {
+			const int n = qMin(chunk_size, set_ixs.count() - i);
+			QStringList values;
+			for (int j = 0; j < n; ++j)
+				values << row_placeholders;
+			QString qs = "INSERT INTO " + m_tableName + " (" + names.join(", ") + ") VALUES " + values.join(", ");
+			if(fetch_id && is_psql)
+				qs += " RETURNING " + m_idFieldName;
+			q.prepare(qs, qf::core::Exception::Throw);
+			int bind_ix = 0;
+			for (int j = i; j < i + n; ++j) {
+				const Record &r = m_records[set_ixs[j]];
+				for(int fi : fields)
+					q.bindValue(bind_ix++, r.values[fi]);
+			}
+			q.exec(qf::core::Exception::Throw);
+			if(!fetch_id)
+				continue;
+			if(is_psql) {
+				/// RETURNING rows are in order of VALUES rows
+				for (int j = i; j < i + n && q.next(); ++j)
+					m_records[set_ixs[j]].values[id_ix] = q.value(0);
+			}
+			else {
+				/// SQLite assigns consecutive rowids to rows inserted by one statement
+				qlonglong first_id = q.lastInsertId().toLongLong() - n + 1;
+				for (int j = 0; j < n; ++j)
+					m_records[set_ixs[i + j]].values[id_ix] = first_id + j;
+			}
+		}
+	}
+}
+
+void SqlBulkDocument::insertRecordsByRow(const QList<int> &ixs, const QList<int> &fields)
+{
+	const QSqlRecord &rec = sqlRecord();
+	int id_ix = fieldIndex(m_idFieldName);
+	QString qs = "INSERT INTO " + m_tableName;
+	if(fields.isEmpty()) {
+		qs += " DEFAULT VALUES";
+	}
+	else {
+		QStringList names, placeholders;
+		for(int fi : fields) {
+			names << rec.fieldName(fi);
+			placeholders << QStringLiteral("?");
+		}
+		qs += " (" + names.join(", ") + ") VALUES (" + placeholders.join(", ") + ")";
+	}
+	qf::core::sql::Query q(m_connectionName);
+	q.prepare(qs, qf::core::Exception::Throw);
+	for(int ix : ixs) {
+		Record &r = m_records[ix];
+		for (int i = 0; i < fields.count(); ++i)
+			q.bindValue(i, r.values[fields[i]]);
+		q.exec(qf::core::Exception::Throw);
+		if(id_ix >= 0 && !r.dirty[id_ix])
+			r.values[id_ix] = q.lastInsertId();
+	}
+}
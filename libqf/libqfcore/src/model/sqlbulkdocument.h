@@ -0,0 +1,103 @@
+#ifndef QF_CORE_MODEL_SQLBULKDOCUMENT_H
+#define QF_CORE_MODEL_SQLBULKDOCUMENT_H
+
+#include "../core/coreglobal.h"
+#include "datadocument.h"
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSqlRecord>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+namespace qf {
+namespace core {
+namespace model {
+
+/// Edits many rows of one SQL table at once.
+/// Records are loaded by one query, changes are diffed in memory and written by save()
+/// in chunks of rows sharing the same set of changed fields, updates by CASE expressions,
+/// inserts by multi-row VALUES, deletes are grouped to IN (...) lists.
+/// save() does not start transaction, caller is supposed to call it in one.
+class QFCORE_DECL_EXPORT SqlBulkDocument
+{
+public:
+	typedef DataDocument::RecordEditMode RecordEditMode;
+public:
+	SqlBulkDocument(const QString &table_name, const QString &connection_name = QString());
+	virtual ~SqlBulkDocument();
+
+	const QString& tableName() const {return m_tableName;}
+	const QString& connectionName() const {return m_connectionName;}
+	const QString& idFieldName() const {return m_idFieldName;}
+	void setIdFieldName(const QString &id_field_name) {m_idFieldName = id_field_name;}
+
+	/// load records in ModeEdit, already loaded records are reloaded
+	void load(const QList<int> &ids);
+	/// load all records matching SQL condition in ModeEdit
+	void loadWhere(const QString &where_condition);
+	void clear();
+
+	int recordCount() const {return m_records.count();}
+	/// @return index of loaded record or -1
+	int indexOf(int id) const {return m_idIndexes.value(id, -1);}
+	/// @return index of new record in ModeInsert
+	int appendRecord();
+	RecordEditMode mode(int ix) const;
+	/// ModeDelete marks record to be dropped, ModeView excludes record from save
+	void setMode(int ix, RecordEditMode mode);
+	QVariant dataId(int ix) const;
+
+	/// field name can be prefixed by table name
+	int fieldIndex(const QString &field_name) const;
+	QVariant value(int ix, const QString &field_name) const;
+	QVariant origValue(int ix, const QString &field_name) const;
+	void setValue(int ix, const QString &field_name, const QVariant &val);
+	bool isDirty(int ix) const;
+	bool isDirty(int ix, const QString &field_name) const;
+
+	/// drops, updates and inserts records in this order, throws qf::core::Exception on SQL error
+	/// inserted and updated records are clean in ModeEdit after save, dropped ones are in ModeView
+	virtual void save();
+protected:
+	/// called by save() before saved records are marked clean, so overrides can check dirty fields
+	virtual void dropRecords(const QList<int> &ixs);
+	virtual void updateRecords(const QList<int> &ixs);
+	virtual void insertRecords(const QList<int> &ixs);
+
+	/// comma separated ids of records, at most chunk_size ids in one string
+	QStringList idLists(const QList<int> &ixs, int chunk_size = 500) const;
+	/// UPDATE table SET field=CASE key_field WHEN key THEN ? ... ELSE field END WHERE key_field IN (keys)
+	/// executed for chunks of rows, values[i] are values of fields for keys[i]
+	void updateRows(const QString &table, const QString &key_field, const QStringList &fields, const QList<int> &keys, const QList<QVariantList> &values) const;
+	const QSqlRecord& sqlRecord() const;
+private:
+	struct Record
+	{
+		RecordEditMode mode = DataDocument::ModeView;
+		QVector<QVariant> values;
+		QVector<QVariant> origValues;
+		QVector<bool> dirty;
+	};
+	bool isValidIndex(int ix) const {return ix >= 0 && ix < m_records.count();}
+	void loadRecords(const QString &where_condition);
+	QList<int> dirtyFieldIndexes(const Record &rec) const;
+	/// one prepared statement executed per record, used when driver cannot return ids of multi-row insert
+	void insertRecordsByRow(const QList<int> &ixs, const QList<int> &fields);
+	/// dirty fields key -> records indexes
+	QMap<QString, QList<int>> dirtyFieldSets(const QList<int> &ixs) const;
+private:
+	QString m_tableName;
+	QString m_connectionName;
+	QString m_idFieldName = QStringLiteral("id");
+	mutable QSqlRecord m_sqlRecord;
+	mutable QHash<QString, int> m_fieldIndexes;
+	QVector<Record> m_records;
+	QHash<int, int> m_idIndexes; //< id -> index to m_records
+};
+
+}}}
+
+#endif // QF_CORE_MODEL_SQLBULKDOCUMENT_H
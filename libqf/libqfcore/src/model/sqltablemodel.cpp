@@ -740,13 +740,17 @@ void SqlTableModel::setSqlFlags(qf::core::utils::Table::FieldList &table_fields,
 			}
 		}
 	}
+	/// metadata are looked up once per table, they come from connection's catalog cache
+	qfs::Connection sql_conn = sqlConnection();
 	QMap<QString, QString> serial_field_names;
+	QMap<QString, QStringList> prikey_field_names;
 	QSet<QString> updateable_table_ids;
 	Q_FOREACH(QString table_id, field_ids.keys()) {
-		QString serial_field_name = sqlConnection().serialFieldName(table_id);
+		QString serial_field_name = sql_conn.serialFieldName(table_id);
 		//qfInfo() << "serial field for table id:" << table_id << "is:" << serial_field_name;
 		serial_field_names[table_id] = serial_field_name;
-		const QStringList prikey_fields = sqlConnection().primaryIndexFieldNames(table_id);
+		const QStringList prikey_fields = sql_conn.primaryIndexFieldNames(table_id);
+		prikey_field_names[table_id] = prikey_fields;
 		bool ok = true;
 		QSet<QString> flds = field_ids.value(table_id);
 		Q_FOREACH(auto pk_f, prikey_fields) {
@@ -765,8 +769,10 @@ void SqlTableModel::setSqlFlags(qf::core::utils::Table::FieldList &table_fields,
 		QString table_id = fld.tableId();
 		if(!table_id.isEmpty()) {
 			fld.setCanUpdate(updateable_table_ids.contains(table_id));
-			QStringList prikey_fields = sqlConnection().primaryIndexFieldNames(table_id);
-			fld.setPriKey(prikey_fields.contains(fld.shortName()));
+			auto prikey_it = prikey_field_names.constFind(table_id);
+			if(prikey_it == prikey_field_names.constEnd())
+				prikey_it = prikey_field_names.insert(table_id, sql_conn.primaryIndexFieldNames(table_id));
+			fld.setPriKey(prikey_it.value().contains(fld.shortName()));
 			//qfDebug() << "table_id;" << table_id << "fldname:" << fld.shortName() << "serial_field_names.value(table_id):" << serial_field_names.value(table_id);
 			fld.setSerial(serial_field_names.value(table_id) == fld.shortName());
 			//qfDebug() << fld.name() << "is serial:" << fld.isSerial();
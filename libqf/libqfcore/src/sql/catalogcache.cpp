@@ -0,0 +1,96 @@
+#include "catalogcache.h"
+
+#include "../core/log.h"
+
+#include <QHash>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QWriteLocker>
+
+using namespace qf::core::sql;
+
+namespace {
+
+struct Catalog
+{
+	QHash<QString, CatalogCache::TableInfo> tables;
+};
+
+QReadWriteLock s_lock;
+/// connection name -> catalog key
+QHash<QString, QString> s_connectionCatalogs;
+/// catalog key -> catalog
+QHash<QString, Catalog> s_catalogs;
+
+QString s_tableKey(const QString &table_id)
+{
+	return table_id.toLower();
+}
+
+}
+
+QString CatalogCache::catalogKey(const QString &connection_signature, const QString &schema)
+{
+	return connection_signature + '/' + schema;
+}
+
+void CatalogCache::setConnectionCatalog(const QString &connection_name, const QString &catalog_key)
+{
+	qfLogFuncFrame() << connection_name << "->" << catalog_key;
+	QWriteLocker locker(&s_lock);
+	s_connectionCatalogs[connection_name] = catalog_key;
+}
+
+QString CatalogCache::connectionCatalog(const QString &connection_name)
+{
+	QReadLocker locker(&s_lock);
+	return s_connectionCatalogs.value(connection_name);
+}
+
+void CatalogCache::removeConnection(const QString &connection_name)
+{
+	QWriteLocker locker(&s_lock);
+	s_connectionCatalogs.remove(connection_name);
+}
+
+bool CatalogCache::tableInfo(const QString &connection_name, const QString &table_id, CatalogCache::TableInfo &info)
+{
+	QReadLocker locker(&s_lock);
+	auto cat_it = s_catalogs.constFind(s_connectionCatalogs.value(connection_name));
+	if(cat_it == s_catalogs.constEnd())
+		return false;
+	const Catalog &cat = cat_it.value();
+	auto it = cat.tables.constFind(s_tableKey(table_id));
+	if(it == cat.tables.constEnd())
+		return false;
+	info = it.value();
+	return true;
+}
+
+void CatalogCache::setTableInfo(const QString &connection_name, const QString &table_id, const CatalogCache::TableInfo &info)
+{
+	QWriteLocker locker(&s_lock);
+	QString key = s_connectionCatalogs.value(connection_name);
+	if(key.isEmpty()) {
+		qfWarning() << "Connection:" << connection_name << "is not bound to any catalog, table info of:" << table_id << "will not be cached.";
+		return;
+	}
+	s_catalogs[key].tables[s_tableKey(table_id)] = info;
+}
+
+void CatalogCache::invalidate(const QString &connection_name)
+{
+	QWriteLocker locker(&s_lock);
+	QString key = s_connectionCatalogs.value(connection_name);
+	qfLogFuncFrame() << connection_name << "catalog:" << key;
+	s_catalogs.remove(key);
+}
+
+int CatalogCache::tableCount(const QString &connection_name)
+{
+	QReadLocker locker(&s_lock);
+	auto it = s_catalogs.constFind(s_connectionCatalogs.value(connection_name));
+	if(it == s_catalogs.constEnd())
+		return 0;
+	return it.value().tables.count();
+}
@@ -0,0 +1,47 @@
+#ifndef QF_CORE_SQL_CATALOGCACHE_H
+#define QF_CORE_SQL_CATALOGCACHE_H
+
+#include "../core/coreglobal.h"
+
+#include <QSqlRecord>
+#include <QString>
+#include <QStringList>
+
+namespace qf {
+namespace core {
+namespace sql {
+
+/// Table metadata cache used by Connection::record(), primaryIndexFieldNames() and serialFieldName().
+/// Catalogs are keyed by connection signature and schema, so connections to the same database
+/// and schema (GUI and worker thread clones) share one catalog.
+/// Access is guarded by read-write lock, lookups of cached tables do not block each other.
+class QFCORE_DECL_EXPORT CatalogCache
+{
+public:
+	struct TableInfo
+	{
+		QSqlRecord record;
+		QStringList primaryIndexFieldNames;
+		QString serialFieldName;
+	};
+public:
+	static QString catalogKey(const QString &connection_signature, const QString &schema);
+
+	/// bind connection to catalog, called when connection is opened or its current schema is changed
+	static void setConnectionCatalog(const QString &connection_name, const QString &catalog_key);
+	/// @return empty string if connection is not bound to catalog yet
+	static QString connectionCatalog(const QString &connection_name);
+	static void removeConnection(const QString &connection_name);
+
+	static bool tableInfo(const QString &connection_name, const QString &table_id, TableInfo &info);
+	static void setTableInfo(const QString &connection_name, const QString &table_id, const TableInfo &info);
+	/// drop catalog connection is bound to, all connections sharing it are affected
+	static void invalidate(const QString &connection_name);
+
+	/// number of cached tables in catalog of connection
+	static int tableCount(const QString &connection_name);
+};
+
+}}}
+
+#endif // QF_CORE_SQL_CATALOGCACHE_H
@@ -1,6 +1,8 @@
 #include "connection.h"
 
 #include "catalog.h"
+#include "catalogcache.h"
+#include "preparedquerycache.h"
 
 #include "../core/log.h"
 #include "../core/utils.h"
@@ -25,37 +27,122 @@ using namespace qf::core::sql;
 //=========================================
 namespace {
 
-QMap<QString, QStringList> s_primaryIndexCache;
-QMap<QString, QString> s_serialFieldNamesCache;
-QMap<QString, QSqlRecord> s_tableRecordCache;
+bool s_isSerialField(const QSqlField &fld)
+{
+	if(fld.isAutoValue())
+		return true;
+	/// PSQL serial default value is in form: nextval('events_id_seq'::regclass)
+	return fld.defaultValue().toString().startsWith(QLatin1String("nextval('"), Qt::CaseInsensitive);
+}
 
-void s_clearCache(const QString &connection_name)
+CatalogCache::TableInfo s_tableInfo(const Connection &conn, const QString &table_id)
 {
-	QString prefix = connection_name + '.';
+	CatalogCache::TableInfo ret;
+	QString conn_name = conn.connectionName();
+	if(CatalogCache::tableInfo(conn_name, table_id, ret))
+		return ret;
+	if(CatalogCache::connectionCatalog(conn_name).isEmpty()) {
+		/// connection was not opened by Connection::open()
+		CatalogCache::setConnectionCatalog(conn_name, CatalogCache::catalogKey(conn.signature(), conn.currentSchema()));
+	}
+	qfDebug() << "loading catalog info for table:" << table_id;
 	{
-		QMutableMapIterator<QString, QStringList> it(s_primaryIndexCache);
-		while(it.hasNext()) {
-			it.next();
-			if(it.key().startsWith(prefix, Qt::CaseInsensitive))
-				it.remove();
+		QString s = conn.fullTableNameToQtDriverTableName(table_id);
+		if(conn.driverName().endsWith(QLatin1String("SQLITE"))) {
+			/// SQLITE neumi schema.tablename v prikazu PRAGMA table_info(...)
+			int ix = s.lastIndexOf('.');
+			if(ix >= 0)
+				s = s.mid(ix + 1);
 		}
+		ret.record = conn.QSqlDatabase::record(s);
 	}
 	{
-		QMutableMapIterator<QString, QString> it(s_serialFieldNamesCache);
-		while(it.hasNext()) {
-			it.next();
-			if(it.key().startsWith(prefix, Qt::CaseInsensitive))
-				it.remove();
+		QSqlIndex sql_ix = conn.primaryIndex(table_id);
+		for(int i=0; i<sql_ix.count(); i++) {
+			QString fld_name = sql_ix.fieldName(i);
+			qf::core::Utils::parseFieldName(fld_name, &fld_name);
+			ret.primaryIndexFieldNames << fld_name;
 		}
 	}
-	{
-		QMutableMapIterator<QString, QSqlRecord> it(s_tableRecordCache);
-		while(it.hasNext()) {
-			it.next();
-			if(it.key().startsWith(prefix, Qt::CaseInsensitive))
-				it.remove();
+	for(int i=0; i<ret.record.count(); i++) {
+		QSqlField fld = ret.record.field(i);
+		if(s_isSerialField(fld)) {
+			QString fld_name = fld.name();
+			qf::core::Utils::parseFieldName(fld_name, &fld_name);
+			ret.serialFieldName = fld_name;
+			break;
 		}
 	}
+	CatalogCache::setTableInfo(conn_name, table_id, ret);
+	return ret;
+}
+
+QVariant::Type s_psqlFieldType(const QString &data_type)
+{
+	/// the same mapping as QPSQL driver does for type OIDs
+	if(data_type == QLatin1String("smallint") || data_type == QLatin1String("integer"))
+		return QVariant::Int;
+	if(data_type == QLatin1String("bigint"))
+		return QVariant::LongLong;
+	if(data_type == QLatin1String("boolean"))
+		return QVariant::Bool;
+	if(data_type == QLatin1String("real") || data_type == QLatin1String("double precision") || data_type == QLatin1String("numeric"))
+		return QVariant::Double;
+	if(data_type == QLatin1String("date"))
+		return QVariant::Date;
+	if(data_type.startsWith(QLatin1String("time ")))
+		return QVariant::Time;
+	if(data_type.startsWith(QLatin1String("timestamp")))
+		return QVariant::DateTime;
+	if(data_type == QLatin1String("bytea"))
+		return QVariant::ByteArray;
+	return QVariant::String;
+}
+
+/// load columns and primary keys of all tables and views of schema by two information_schema queries
+void s_warmCatalogCache_psql(const Connection &conn, const QString &schema)
+{
+	QMap<QString, CatalogCache::TableInfo> tables;
+	QSqlQuery q(conn);
+	q.setForwardOnly(true);
+	QString qs = "SELECT table_name, column_name, data_type, is_nullable, column_default"
+				 ", character_maximum_length, numeric_precision, numeric_scale"
+				 " FROM information_schema.columns"
+				 " WHERE table_schema='%1'"
+				 " ORDER BY table_name, ordinal_position";
+	if(!q.exec(qs.arg(schema))) {
+		qfError() << "Error loading catalog of schema:" << schema << q.lastError().text();
+		return;
+	}
+	while(q.next()) {
+		CatalogCache::TableInfo &ti = tables[q.value(0).toString()];
+		QSqlField fld(q.value(1).toString(), s_psqlFieldType(q.value(2).toString()));
+		fld.setRequiredStatus(q.value(3).toString() == QLatin1String("NO")? QSqlField::Required: QSqlField::Optional);
+		fld.setDefaultValue(q.value(4));
+		int len = q.value(5).isNull()? q.value(6).toInt(): q.value(5).toInt();
+		fld.setLength(len > 0? len: -1);
+		fld.setPrecision(q.value(7).isNull()? -1: q.value(7).toInt());
+		ti.record.append(fld);
+		if(ti.serialFieldName.isEmpty() && s_isSerialField(fld))
+			ti.serialFieldName = fld.name();
+	}
+	qs = "SELECT kcu.table_name, kcu.column_name"
+		 " FROM information_schema.table_constraints tc"
+		 " JOIN information_schema.key_column_usage kcu"
+		 " ON kcu.constraint_schema=tc.constraint_schema AND kcu.constraint_name=tc.constraint_name AND kcu.table_name=tc.table_name"
+		 " WHERE tc.table_schema='%1' AND tc.constraint_type='PRIMARY KEY'"
+		 " ORDER BY kcu.table_name, kcu.ordinal_position";
+	if(!q.exec(qs.arg(schema))) {
+		qfError() << "Error loading primary keys of schema:" << schema << q.lastError().text();
+		return;
+	}
+	while(q.next()) {
+		auto it = tables.find(q.value(0).toString());
+		if(it != tables.end())
+			it.value().primaryIndexFieldNames << q.value(1).toString();
+	}
+	for(auto it = tables.constBegin(); it != tables.constEnd(); ++it)
+		CatalogCache::setTableInfo(conn.connectionName(), it.key(), it.value());
 }
 
 }
@@ -78,15 +165,44 @@ Connection &Connection::operator=(const QSqlDatabase &o)
 
 bool Connection::open()
 {
-	s_clearCache(connectionName());
-	return Super::open();
+	PreparedQueryCache::clear(connectionName());
+	bool ret = Super::open();
+	if(ret)
+		CatalogCache::setConnectionCatalog(connectionName(), CatalogCache::catalogKey(signature(), currentSchema()));
+	return ret;
 }
 
 void Connection::close()
 {
+	PreparedQueryCache::clear(connectionName());
+	CatalogCache::removeConnection(connectionName());
 	Super::close();
 }
 
+void Connection::warmCatalogCache()
+{
+	qfLogFuncFrame() << connectionName();
+	QString schema = currentSchema();
+	CatalogCache::setConnectionCatalog(connectionName(), CatalogCache::catalogKey(signature(), schema));
+	CatalogCache::invalidate(connectionName());
+	if(driverName().endsWith(QLatin1String("PSQL"))) {
+		s_warmCatalogCache_psql(*this, schema);
+	}
+	else {
+		/// SQLite catalog is local file, PRAGMA per table does not cost network round trip
+		const QStringList table_names = tables(schema);
+		for(const QString &table_name : table_names)
+			s_tableInfo(*this, table_name);
+	}
+	qfInfo() << "catalog cache of connection:" << connectionName() << "warmed up, tables:" << CatalogCache::tableCount(connectionName());
+}
+
+void Connection::invalidateCatalogCache()
+{
+	CatalogCache::invalidate(connectionName());
+	PreparedQueryCache::invalidateAll();
+}
+
 Connection Connection::forName(const QString &connection_name)
 {
 	QString cn = connection_name;
@@ -334,23 +450,7 @@ bool Connection::tableExists(const QString &_table_name)
 QSqlRecord Connection::record(const QString & tablename) const
 {
 	qfLogFuncFrame() << "tblname:" << tablename;
-	QString pk_key = connectionName() + '.' + tablename;
-	QSqlRecord ret;
-	if(!s_tableRecordCache.contains(pk_key)) {
-		QString s = fullTableNameToQtDriverTableName(tablename);
-		if(driverName().endsWith(QLatin1String("SQLITE"))) {
-			/// SQLITE neumi schema.tablename v prikazu PRAGMA table_info(...)
-			int ix = s.lastIndexOf('.');
-			if(ix >= 0)
-				s = s.mid(ix + 1);
-		}
-		ret = QSqlDatabase::record(s);
-		s_tableRecordCache[pk_key] = ret;
-	}
-	else {
-		ret = s_tableRecordCache.value(pk_key);
-	}
-	return ret;
+	return s_tableInfo(*this, tablename).record;
 }
 
 QStringList Connection::fields(const QString& tbl_name) const
@@ -775,21 +875,7 @@ QStringList Connection::primaryIndexFieldNames(const QString &table_id)
 	QF_ASSERT(isValid(),
 			  QString("Connection '%1' is not valid!").arg(connectionName()),
 			  return QStringList());
-	QString pk_key = connectionName() + '.' + table_id;
-	QStringList ret;
-	if(!s_primaryIndexCache.contains(pk_key)) {
-		QSqlIndex sql_ix = primaryIndex(table_id);
-		for(int i=0; i<sql_ix.count(); i++) {
-			QString fld_name = sql_ix.fieldName(i);
-			qf::core::Utils::parseFieldName(fld_name, &fld_name);
-			ret << fld_name;
-		}
-		s_primaryIndexCache[pk_key] = ret;
-	}
-	else {
-		ret = s_primaryIndexCache.value(pk_key);
-	}
-	return ret;
+	return s_tableInfo(*this, table_id).primaryIndexFieldNames;
 }
 
 QString Connection::serialFieldName(const QString &table_id)
@@ -798,28 +884,7 @@ QString Connection::serialFieldName(const QString &table_id)
 	QF_ASSERT(isValid(),
 			  QString("Connection '%1' is not valid!").arg(connectionName()),
 			  return QString());
-	QString pk_key = connectionName() + '.' + table_id;
-	QString ret;
-	if(!s_serialFieldNamesCache.contains(pk_key)) {
-		qf::core::sql::FieldInfoList fldlst;
-		fldlst.load(*this, table_id);
-		QMapIterator<QString, qf::core::sql::FieldInfo> it(fldlst);
-		while(it.hasNext()) {
-			it.next();
-			qf::core::sql::FieldInfo fi = it.value();
-			qfDebug() << "checking:" << it.key() << "name:" << fi.name();
-			if(fi.isAutoIncrement()) {
-				qfDebug() << "\t found auto increment field:" << fi.name();
-				ret = it.key();
-				break;
-			}
-		}
-		s_serialFieldNamesCache[pk_key] = ret;
-	}
-	else {
-		ret = s_serialFieldNamesCache.value(pk_key);
-	}
-	return ret;
+	return s_tableInfo(*this, table_id).serialFieldName;
 }
 
 QString Connection::normalizeFieldName(const QString &n) const
@@ -909,7 +974,8 @@ bool Connection::setCurrentSchema(const QString &schema_name)
 {
 	qfLogFuncFrame() << schema_name;
 	bool ret = true;
-	s_clearCache(connectionName());
+	/// statements are planned against previous schema
+	PreparedQueryCache::clear(connectionName());
 	if(driverName().endsWith(QLatin1String("MYSQL"))) {
 		QSqlQuery q(*this);
 		if(!q.exec("USE " + schema_name)) {
@@ -926,6 +992,8 @@ bool Connection::setCurrentSchema(const QString &schema_name)
 	}
 	if(ret)
 		ret = (currentSchema() == schema_name);
+	if(ret)
+		CatalogCache::setConnectionCatalog(connectionName(), CatalogCache::catalogKey(signature(), schema_name));
 	return ret;
 }
 
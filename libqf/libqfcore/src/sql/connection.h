@@ -69,6 +69,10 @@ public:
 	QSqlIndex primaryIndex(const QString& table_id) const;
 	QStringList primaryIndexFieldNames(const QString &table_id);
 	QString serialFieldName(const QString &table_id);
+	/// load metadata of all tables to catalog cache at once, so models do not query catalog on reload
+	void warmCatalogCache();
+	/// call after schema of current database is changed
+	void invalidateCatalogCache();
 
 	QSqlRecord record(const QString & table_id) const;
 
@@ -0,0 +1,163 @@
+#include "connectionpool.h"
+
+#include "../core/log.h"
+
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QThread>
+
+using namespace qf::core::sql;
+
+namespace {
+
+typedef QMap<QString, ConnectionPool::ConnectionParams> OpenedConnections;
+
+QMutex s_mutex;
+/// thread -> connection name -> params the connection was opened with
+QMap<QThread*, OpenedConnections> s_threadConnections;
+
+bool s_openedParams(const QString &connection_name, ConnectionPool::ConnectionParams &params)
+{
+	QMutexLocker locker(&s_mutex);
+	const OpenedConnections &opened = s_threadConnections.value(QThread::currentThread());
+	auto it = opened.constFind(connection_name);
+	if(it == opened.constEnd())
+		return false;
+	params = it.value();
+	return true;
+}
+
+void s_setOpenedParams(const QString &connection_name, const ConnectionPool::ConnectionParams &params)
+{
+	QMutexLocker locker(&s_mutex);
+	s_threadConnections[QThread::currentThread()][connection_name] = params;
+}
+
+}
+
+//=========================================
+//        ConnectionPool::ConnectionParams
+//=========================================
+ConnectionPool::ConnectionParams ConnectionPool::ConnectionParams::fromConnection(const Connection &conn)
+{
+	ConnectionParams ret;
+	ret.connectionName = conn.connectionName();
+	ret.driverName = conn.driverName();
+	ret.hostName = conn.hostName();
+	ret.port = conn.port();
+	ret.userName = conn.userName();
+	ret.password = conn.password();
+	ret.databaseName = conn.databaseName();
+	ret.connectOptions = conn.connectOptions();
+	if(conn.isOpen())
+		ret.schema = conn.currentSchema();
+	return ret;
+}
+
+bool ConnectionPool::ConnectionParams::isClonable() const
+{
+	if(driverName.isEmpty())
+		return false;
+	if(driverName.endsWith(QLatin1String("SQLITE"))) {
+		if(databaseName.isEmpty() || databaseName == QLatin1String(":memory:"))
+			return false;
+	}
+	return true;
+}
+
+bool ConnectionPool::ConnectionParams::isSameDatabase(const ConnectionPool::ConnectionParams &o) const
+{
+	return driverName == o.driverName
+			&& hostName == o.hostName
+			&& port == o.port
+			&& userName == o.userName
+			&& password == o.password
+			&& databaseName == o.databaseName
+			&& connectOptions == o.connectOptions;
+}
+
+//=========================================
+//        ConnectionPool
+//=========================================
+QString ConnectionPool::threadConnectionName(const QString &source_connection_name)
+{
+	QString cn = source_connection_name;
+	if(cn.isEmpty())
+		cn = QSqlDatabase::defaultConnection;
+	return cn + QStringLiteral("_thread_") + QString::number((quintptr)QThread::currentThreadId(), 16);
+}
+
+Connection ConnectionPool::threadConnection(const ConnectionPool::ConnectionParams &params)
+{
+	qfLogFuncFrame() << params.connectionName << params.databaseName << params.schema;
+	if(!params.isClonable()) {
+		qfError() << "Connection:" << params.connectionName << "driver:" << params.driverName << "database:" << params.databaseName << "cannot be cloned to other thread.";
+		return Connection();
+	}
+	QString conn_name = threadConnectionName(params.connectionName);
+	ConnectionParams opened_params;
+	if(QSqlDatabase::contains(conn_name) && s_openedParams(conn_name, opened_params)) {
+		Connection conn(QSqlDatabase::database(conn_name, false));
+		if(conn.isOpen() && opened_params.isSameDatabase(params)) {
+			if(!params.schema.isEmpty() && opened_params.schema != params.schema) {
+				if(!conn.setCurrentSchema(params.schema)) {
+					qfError() << "Cannot switch thread connection:" << conn_name << "to schema:" << params.schema;
+					return Connection();
+				}
+				opened_params.schema = params.schema;
+				s_setOpenedParams(conn_name, opened_params);
+			}
+			return conn;
+		}
+		conn.close();
+		if(conn.driverName() != params.driverName) {
+			conn = Connection();
+			QSqlDatabase::removeDatabase(conn_name);
+		}
+	}
+	Connection conn;
+	if(QSqlDatabase::contains(conn_name))
+		conn = Connection(QSqlDatabase::database(conn_name, false));
+	else
+		conn = Connection(QSqlDatabase::addDatabase(params.driverName, conn_name));
+	conn.setHostName(params.hostName);
+	conn.setPort(params.port);
+	conn.setUserName(params.userName);
+	conn.setPassword(params.password);
+	conn.setDatabaseName(params.databaseName);
+	conn.setConnectOptions(params.connectOptions);
+	qfInfo() << "Opening thread connection:" << conn_name << "database:" << params.databaseName;
+	if(!conn.open()) {
+		qfError() << "Cannot open thread connection:" << conn_name << conn.lastError().text();
+		return Connection();
+	}
+	if(!params.schema.isEmpty() && conn.currentSchema() != params.schema) {
+		if(!conn.setCurrentSchema(params.schema)) {
+			qfError() << "Cannot switch thread connection:" << conn_name << "to schema:" << params.schema;
+			conn.close();
+			return Connection();
+		}
+	}
+	s_setOpenedParams(conn_name, params);
+	return conn;
+}
+
+void ConnectionPool::releaseThreadConnections()
+{
+	qfLogFuncFrame();
+	OpenedConnections opened;
+	{
+		QMutexLocker locker(&s_mutex);
+		opened = s_threadConnections.take(QThread::currentThread());
+	}
+	for(const QString &conn_name : opened.keys()) {
+		{
+			Connection conn(QSqlDatabase::database(conn_name, false));
+			if(conn.isOpen())
+				conn.close();
+		}
+		QSqlDatabase::removeDatabase(conn_name);
+	}
+}
@@ -0,0 +1,52 @@
+#ifndef QF_CORE_SQL_CONNECTIONPOOL_H
+#define QF_CORE_SQL_CONNECTIONPOOL_H
+
+#include "../core/coreglobal.h"
+#include "connection.h"
+
+#include <QString>
+
+namespace qf {
+namespace core {
+namespace sql {
+
+/// Per thread clones of a connection.
+/// QSqlDatabase can be used only in the thread which created it, so worker threads
+/// get their own connection opened with parameters of the source connection.
+class QFCORE_DECL_EXPORT ConnectionPool
+{
+public:
+	/// Source connection parameters, must be taken in the thread owning the source connection.
+	struct QFCORE_DECL_EXPORT ConnectionParams
+	{
+		QString connectionName;
+		QString driverName;
+		QString hostName;
+		int port = -1;
+		QString userName;
+		QString password;
+		QString databaseName;
+		QString connectOptions;
+		QString schema;
+
+		static ConnectionParams fromConnection(const Connection &conn);
+		/// in memory SQLite database cannot be shared with other connection
+		bool isClonable() const;
+		/// true if params point to the same database, schema may differ
+		bool isSameDatabase(const ConnectionParams &o) const;
+	};
+public:
+	/// @return opened connection of current thread cloned from \a params
+	/// Connection is reopened when \a params database changes and schema is switched when \a params schema changes.
+	/// Invalid connection is returned when clone cannot be opened.
+	static Connection threadConnection(const ConnectionParams &params);
+	/// close and remove all connections created by current thread,
+	/// must be called before the worker thread finishes
+	static void releaseThreadConnections();
+
+	static QString threadConnectionName(const QString &source_connection_name);
+};
+
+}}}
+
+#endif // QF_CORE_SQL_CONNECTIONPOOL_H
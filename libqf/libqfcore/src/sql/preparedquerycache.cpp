@@ -0,0 +1,144 @@
+#include "preparedquerycache.h"
+
+#include "../core/log.h"
+
+#include <QCache>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlQuery>
+#include <QStringList>
+
+using namespace qf::core::sql;
+
+namespace {
+
+struct ConnectionCache
+{
+	QCache<QString, QSqlQuery> statements;
+	const QSqlDriver *driver = nullptr;
+	int schemaVersion = 0;
+	qint64 hits = 0;
+	qint64 misses = 0;
+};
+
+QMutex s_mutex;
+QMap<QString, ConnectionCache*> s_caches;
+int s_capacity = PreparedQueryCache::DEFAULT_CAPACITY;
+/// incremented when database schema is changed
+int s_schemaVersion = 0;
+
+ConnectionCache* s_connectionCache(const QSqlDatabase &db)
+{
+	ConnectionCache *ret = s_caches.value(db.connectionName());
+	if(!ret) {
+		ret = new ConnectionCache();
+		ret->statements.setMaxCost(s_capacity);
+		ret->schemaVersion = s_schemaVersion;
+		s_caches[db.connectionName()] = ret;
+	}
+	if(ret->driver != db.driver()) {
+		/// connection was removed and added again, old statements belong to dead driver
+		ret->statements.clear();
+		ret->driver = db.driver();
+	}
+	if(ret->schemaVersion != s_schemaVersion) {
+		/// statements are deleted here, in thread of their connection
+		ret->statements.clear();
+		ret->schemaVersion = s_schemaVersion;
+	}
+	return ret;
+}
+
+}
+
+const int PreparedQueryCache::DEFAULT_CAPACITY = 64;
+
+bool PreparedQueryCache::take(const QSqlDatabase &db, const QString &query, QSqlQuery &prepared_query)
+{
+	QMutexLocker locker(&s_mutex);
+	ConnectionCache *cache = s_connectionCache(db);
+	QSqlQuery *q = cache->statements.take(query);
+	if(q) {
+		cache->hits++;
+		prepared_query = *q;
+		delete q;
+		return true;
+	}
+	cache->misses++;
+	return false;
+}
+
+void PreparedQueryCache::put(const QSqlDatabase &db, const QString &query, const QSqlQuery &prepared_query)
+{
+	if(!db.isOpen())
+		return;
+	QMutexLocker locker(&s_mutex);
+	ConnectionCache *cache = s_connectionCache(db);
+	cache->statements.insert(query, new QSqlQuery(prepared_query));
+}
+
+void PreparedQueryCache::clear(const QString &connection_name)
+{
+	qfLogFuncFrame() << connection_name;
+	QMutexLocker locker(&s_mutex);
+	ConnectionCache *cache = s_caches.value(connection_name);
+	if(cache)
+		cache->statements.clear();
+}
+
+void PreparedQueryCache::invalidateAll()
+{
+	qfLogFuncFrame();
+	QMutexLocker locker(&s_mutex);
+	s_schemaVersion++;
+}
+
+int PreparedQueryCache::capacity()
+{
+	QMutexLocker locker(&s_mutex);
+	return s_capacity;
+}
+
+void PreparedQueryCache::setCapacity(int n)
+{
+	QMutexLocker locker(&s_mutex);
+	s_capacity = n;
+	for(ConnectionCache *cache : s_caches)
+		cache->statements.setMaxCost(n);
+}
+
+PreparedQueryCache::Statistics PreparedQueryCache::statistics(const QString &connection_name)
+{
+	QMutexLocker locker(&s_mutex);
+	Statistics ret;
+	ret.capacity = s_capacity;
+	ConnectionCache *cache = s_caches.value(connection_name);
+	if(cache) {
+		ret.hits = cache->hits;
+		ret.misses = cache->misses;
+		ret.count = cache->statements.count();
+	}
+	return ret;
+}
+
+QString PreparedQueryCache::statisticsReport()
+{
+	QStringList connection_names;
+	{
+		QMutexLocker locker(&s_mutex);
+		connection_names = s_caches.keys();
+	}
+	QStringList lines;
+	for(const QString &connection_name : connection_names) {
+		Statistics st = statistics(connection_name);
+		lines << QStringLiteral("%1: statements: %2/%3, hits: %4, misses: %5, hit rate: %6%")
+				 .arg(connection_name)
+				 .arg(st.count).arg(st.capacity)
+				 .arg(st.hits).arg(st.misses)
+				 .arg(st.hitRate(), 0, 'f', 1);
+	}
+	return lines.join('\n');
+}
@@ -0,0 +1,52 @@
+#ifndef QF_CORE_SQL_PREPAREDQUERYCACHE_H
+#define QF_CORE_SQL_PREPAREDQUERYCACHE_H
+
+#include "../core/coreglobal.h"
+
+#include <QString>
+
+class QSqlDatabase;
+class QSqlQuery;
+
+namespace qf {
+namespace core {
+namespace sql {
+
+/// Per connection LRU cache of prepared statements keyed by SQL text.
+/// Statement is taken out of cache while in use, so nested queries with the same SQL
+/// get own statement, and it is put back when the query is finished.
+class QFCORE_DECL_EXPORT PreparedQueryCache
+{
+public:
+	struct Statistics
+	{
+		qint64 hits = 0;
+		qint64 misses = 0;
+		int count = 0;
+		int capacity = 0;
+
+		double hitRate() const {return (hits + misses)? (100. * hits / (hits + misses)): 0;}
+	};
+public:
+	static const int DEFAULT_CAPACITY;
+
+	/// @return true and prepared statement for \a query if it is in cache
+	static bool take(const QSqlDatabase &db, const QString &query, QSqlQuery &prepared_query);
+	static void put(const QSqlDatabase &db, const QString &query, const QSqlQuery &prepared_query);
+	/// drop all statements of connection, called when connection is reopened or schema is changed
+	static void clear(const QString &connection_name);
+	/// drop statements of all connections after database schema is changed,
+	/// caches of other threads are cleared by their threads on next access
+	static void invalidateAll();
+
+	static int capacity();
+	static void setCapacity(int n);
+
+	static Statistics statistics(const QString &connection_name);
+	/// human readable statistics of all connections
+	static QString statisticsReport();
+};
+
+}}}
+
+#endif // QF_CORE_SQL_PREPAREDQUERYCACHE_H
@@ -1,6 +1,8 @@
 #include "query.h"
 #include "connection.h"
 #include "querybuilder.h"
+#include "preparedquerycache.h"
+#include "catalogcache.h"
 
 #include "../core/log.h"
 
@@ -12,17 +14,49 @@ using namespace qf::core::sql;
 
 Query::Query(const QSqlDatabase &db)
 	: Super(db)
+	, m_connectionName(db.connectionName())
 {
 }
 
 Query::Query(const QString &connection_name)
-	: Super(Connection::forName(connection_name))
+	: Query(Connection::forName(connection_name))
 {
 }
 
+class Query::PreparedQueryLease
+{
+public:
+	PreparedQueryLease(const QString &connection_name, const QString &query, const QSqlQuery &prepared_query)
+		: m_connectionName(connection_name), m_query(query), m_preparedQuery(prepared_query) {}
+	~PreparedQueryLease()
+	{
+		if(!m_isValid)
+			return;
+		m_preparedQuery.finish();
+		PreparedQueryCache::put(Connection::forName(m_connectionName), m_query, m_preparedQuery);
+	}
+	/// do not return statement in unknown state to cache
+	void invalidate() {m_isValid = false;}
+private:
+	QString m_connectionName;
+	QString m_query;
+	QSqlQuery m_preparedQuery;
+	bool m_isValid = true;
+};
+
+void Query::releasePreparedQuery()
+{
+	if(m_preparedQueryLease.isNull())
+		return;
+	m_preparedQueryLease.clear();
+	/// detach from cached statement
+	Super::operator=(QSqlQuery(Connection::forName(m_connectionName)));
+}
+
 bool Query::prepare(const QString &query, bool throw_exc)
 {
 	qfLogFuncFrame() << query;
+	releasePreparedQuery();
 	bool ret = Super::prepare(query);
 	if(!ret) {
 		if(throw_exc)
@@ -36,6 +70,7 @@ bool Query::exec(const QString &query, bool throw_exc)
 {
 	qfLogFuncFrame() << query;
 	//qfWarning() << query;
+	releasePreparedQuery();
 	bool ret = Super::exec(query);
 	if(!ret) {
 		if(throw_exc)
@@ -44,12 +79,57 @@ bool Query::exec(const QString &query, bool throw_exc)
 	}
 	if(isSelect())
 		m_demangledRecord = QSqlRecord();
+	else if(ret && isSchemaChangingCommand(query)) {
+		CatalogCache::invalidate(m_connectionName);
+		PreparedQueryCache::invalidateAll();
+	}
 	return ret;
 }
 
+bool Query::isSchemaChangingCommand(const QString &query)
+{
+	QStringRef cmd = query.leftRef(16).trimmed();
+	return cmd.startsWith(QLatin1String("CREATE"), Qt::CaseInsensitive)
+			|| cmd.startsWith(QLatin1String("ALTER"), Qt::CaseInsensitive)
+			|| cmd.startsWith(QLatin1String("DROP"), Qt::CaseInsensitive);
+}
+
 bool Query::exec(const QueryBuilder &query_builder, bool throw_exc)
 {
-	return exec(query_builder.toString(), throw_exc);
+	QVariantMap bound_values = query_builder.boundValues();
+	if(bound_values.isEmpty())
+		return exec(query_builder.toString(), throw_exc);
+	return execPrepared(query_builder.toString(), bound_values, throw_exc);
+}
+
+bool Query::execPrepared(const QString &query, const QVariantMap &bound_values, bool throw_exc)
+{
+	qfLogFuncFrame() << query;
+	releasePreparedQuery();
+	QString qs = query.trimmed();
+	QSqlDatabase db = Connection::forName(m_connectionName);
+	QSqlQuery cached_query;
+	if(PreparedQueryCache::take(db, qs, cached_query)) {
+		Super::operator=(cached_query);
+	}
+	else {
+		if(!prepare(qs, throw_exc))
+			return false;
+	}
+	m_preparedQueryLease = QSharedPointer<PreparedQueryLease>(new PreparedQueryLease(m_connectionName, qs, *this));
+	for(auto it = bound_values.constBegin(); it != bound_values.constEnd(); ++it)
+		bindValue(it.key(), it.value());
+	bool ret = Super::exec();
+	if(!ret) {
+		QString err = qs + '\n' + lastError().text();
+		m_preparedQueryLease->invalidate();
+		if(throw_exc)
+			QF_EXCEPTION(err);
+		qfError() << err;
+	}
+	if(isSelect())
+		m_demangledRecord = QSqlRecord();
+	return ret;
 }
 
 bool Query::exec(bool throw_exc)
@@ -7,6 +7,7 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QVariantMap>
+#include <QSharedPointer>
 
 class QSqlDatabase;
 
@@ -34,6 +35,8 @@ public:
 	/// necessary for proper overloading, const char* is treated as bool without this function
 	bool exec(const char *query, bool throw_exc = false) {return exec(QString::fromUtf8(query), throw_exc);}
 	bool exec(bool throw_exc = false);
+	/// Executes \a query with named placeholders, prepared statement is reused from connection's PreparedQueryCache.
+	bool execPrepared(const QString &query, const QVariantMap &bound_values, bool throw_exc = false);
 	bool execCommands(const QStringList &commands, const QMap<QString, QString> &replacements = QMap<QString, QString>());
 	void execCommandsThrow(const QStringList &commands, const QMap<QString, QString> &replacements = QMap<QString, QString>());
 	QSqlRecord record() const;
@@ -42,8 +45,17 @@ public:
 	QVariant value(const QString& field_name) const;
 	QVariantMap values() const;
 	QString lastErrorText() const;
+	/// CREATE, ALTER or DROP command, catalog cache of connection is invalidated after it is executed
+	static bool isSchemaChangingCommand(const QString &query);
 private:
+	/// detach from statement used by execPrepared(), it returns to cache when the last copy of query releases it
+	void releasePreparedQuery();
+private:
+	class PreparedQueryLease;
 	mutable QSqlRecord m_demangledRecord;
+	QString m_connectionName;
+	/// shared by copies of query, so statement is not returned to cache while some copy still uses it
+	QSharedPointer<PreparedQueryLease> m_preparedQueryLease;
 };
 
 }}}
@@ -310,6 +310,31 @@ QueryBuilder& QueryBuilder::as(const QString &alias_name)
 	return *this;
 }
 
+QueryBuilder& QueryBuilder::bindValue(const QString &placeholder, const QVariant &value)
+{
+	if(placeholder.startsWith(':'))
+		m_boundValues[placeholder] = value;
+	else
+		m_boundValues[':' + placeholder] = value;
+	return *this;
+}
+
+QVariantMap QueryBuilder::boundValues() const
+{
+	QVariantMap ret;
+	const JoinDefinitionList lst = m_queryMap.value(FromKey).value<JoinDefinitionList>();
+	for(const JoinDefinition &join_def : lst) {
+		if(join_def.joinRelation.userType() == qMetaTypeId<QueryBuilder>()) {
+			QVariantMap m = join_def.joinRelation.value<QueryBuilder>().boundValues();
+			for(auto it = m.constBegin(); it != m.constEnd(); ++it)
+				ret[it.key()] = it.value();
+		}
+	}
+	for(auto it = m_boundValues.constBegin(); it != m_boundValues.constEnd(); ++it)
+		ret[it.key()] = it.value();
+	return ret;
+}
+
 QVariant QueryBuilder::takeWhere()
 {
 	QVariant v = take(WhereKey);
@@ -357,6 +382,7 @@ QVariant QueryBuilder::take(QueryMapKey key)
 void QueryBuilder::clear()
 {
 	m_queryMap.clear();
+	m_boundValues.clear();
 }
 
 
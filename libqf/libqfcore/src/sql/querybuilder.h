@@ -111,6 +111,15 @@ public:
 	QueryBuilder& limit(int n);
 	QueryBuilder& offset(int n);
 	QueryBuilder& as(const QString &alias_name);
+	/**
+	* Binds value to named placeholder used in query, bound values of nested queries are included.
+	* Query::exec(const QueryBuilder&) executes such a query as prepared statement.
+	\code
+		qb.select2("runs", "stageId").from("runs").where("runs.id=:runId").bindValue(":runId", run_id);
+	\endcode
+	*/
+	QueryBuilder& bindValue(const QString &placeholder, const QVariant &value);
+	QVariantMap boundValues() const;
 
 	QVariant takeWhere();
 	QVariant takeOrderBy();
@@ -188,6 +197,7 @@ private:
 	QString buildString(QueryMapKey key) const;
 private:
 	QueryMap m_queryMap;
+	QVariantMap m_boundValues;
 };
 
 }}}
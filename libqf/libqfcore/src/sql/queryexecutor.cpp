@@ -0,0 +1,180 @@
+#include "queryexecutor.h"
+
+#include "../core/log.h"
+#include "../core/exception.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+namespace qf {
+namespace core {
+namespace sql {
+
+//=========================================
+//        QueryExecutorThread
+//=========================================
+class QueryExecutorThread : public QThread
+{
+public:
+	struct Job
+	{
+		int taskId = 0;
+		ConnectionPool::ConnectionParams params;
+		QueryExecutor::Task task;
+	};
+public:
+	QueryExecutorThread(QueryExecutor *executor) : QThread(executor), m_executor(executor) {}
+
+	void enqueue(const Job &job)
+	{
+		QMutexLocker locker(&m_mutex);
+		m_jobs.enqueue(job);
+		m_jobAdded.wakeOne();
+	}
+	void stop()
+	{
+		{
+			QMutexLocker locker(&m_mutex);
+			m_stop = true;
+			m_jobs.clear();
+			m_jobAdded.wakeOne();
+		}
+		wait();
+	}
+protected:
+	void run() Q_DECL_OVERRIDE
+	{
+		while(true) {
+			Job job;
+			{
+				QMutexLocker locker(&m_mutex);
+				while(m_jobs.isEmpty() && !m_stop)
+					m_jobAdded.wait(&m_mutex);
+				if(m_stop)
+					break;
+				job = m_jobs.dequeue();
+			}
+			QVariant result;
+			QString error;
+			try {
+				Connection conn = ConnectionPool::threadConnection(job.params);
+				if(!conn.isOpen())
+					QF_EXCEPTION(QString("Cannot open worker connection for: %1").arg(job.params.connectionName));
+				result = job.task(conn);
+			}
+			catch(qf::core::Exception &e) {
+				error = e.message();
+			}
+			catch(std::exception &e) {
+				error = QString::fromUtf8(e.what());
+			}
+			QMetaObject::invokeMethod(m_executor, "onTaskFinished", Qt::QueuedConnection
+									  , Q_ARG(int, job.taskId)
+									  , Q_ARG(QVariant, result)
+									  , Q_ARG(QString, error));
+		}
+		ConnectionPool::releaseThreadConnections();
+	}
+private:
+	QueryExecutor *m_executor;
+	QMutex m_mutex;
+	QWaitCondition m_jobAdded;
+	QQueue<Job> m_jobs;
+	bool m_stop = false;
+};
+
+//=========================================
+//        QueryExecutor
+//=========================================
+QueryExecutor::QueryExecutor(const QString &connection_name, QObject *parent)
+	: Super(parent)
+	, m_connectionName(connection_name)
+{
+}
+
+QueryExecutor::~QueryExecutor()
+{
+	if(m_workerThread)
+		m_workerThread->stop();
+}
+
+QueryExecutor *QueryExecutor::instance()
+{
+	static QueryExecutor *s_instance = nullptr;
+	if(!s_instance)
+		s_instance = new QueryExecutor(QString(), QCoreApplication::instance());
+	return s_instance;
+}
+
+int QueryExecutor::execute(const QueryExecutor::Task &task, const QueryExecutor::Callback &callback)
+{
+	int task_id = ++m_lastTaskId;
+	qfLogFuncFrame() << "task id:" << task_id;
+	m_callbacks[task_id] = callback;
+	Connection conn = Connection::forName(m_connectionName);
+	ConnectionPool::ConnectionParams params = ConnectionPool::ConnectionParams::fromConnection(conn);
+	if(!params.isClonable()) {
+		/// in memory database, the only way is to run the task here
+		QVariant result;
+		QString error;
+		try {
+			result = task(conn);
+		}
+		catch(qf::core::Exception &e) {
+			error = e.message();
+		}
+		catch(std::exception &e) {
+			error = QString::fromUtf8(e.what());
+		}
+		QMetaObject::invokeMethod(this, "onTaskFinished", Qt::QueuedConnection
+								  , Q_ARG(int, task_id)
+								  , Q_ARG(QVariant, result)
+								  , Q_ARG(QString, error));
+		return task_id;
+	}
+	if(!m_workerThread) {
+		m_workerThread = new QueryExecutorThread(this);
+		m_workerThread->start();
+	}
+	QueryExecutorThread::Job job;
+	job.taskId = task_id;
+	job.params = params;
+	job.task = task;
+	m_workerThread->enqueue(job);
+	return task_id;
+}
+
+QVariant QueryExecutor::executeAndWait(const QueryExecutor::Task &task, QString *error)
+{
+	QVariant ret;
+	bool finished = false;
+	QEventLoop loop;
+	execute(task, [&ret, &finished, &loop, error](const QVariant &result, const QString &err) {
+		ret = result;
+		if(error)
+			*error = err;
+		else if(!err.isEmpty())
+			qfError() << "SQL task error:" << err;
+		finished = true;
+		loop.quit();
+	});
+	if(!finished)
+		loop.exec(QEventLoop::ExcludeUserInputEvents);
+	return ret;
+}
+
+void QueryExecutor::onTaskFinished(int task_id, const QVariant &result, const QString &error)
+{
+	qfLogFuncFrame() << "task id:" << task_id << "error:" << error;
+	Callback callback = m_callbacks.take(task_id);
+	if(callback)
+		callback(result, error);
+	emit taskFinished(task_id, result, error);
+}
+
+}}}
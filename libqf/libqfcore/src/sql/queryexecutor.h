@@ -0,0 +1,65 @@
+#ifndef QF_CORE_SQL_QUERYEXECUTOR_H
+#define QF_CORE_SQL_QUERYEXECUTOR_H
+
+#include "../core/coreglobal.h"
+#include "connectionpool.h"
+
+#include <QObject>
+#include <QMap>
+#include <QVariant>
+
+#include <functional>
+
+namespace qf {
+namespace core {
+namespace sql {
+
+class QueryExecutorThread;
+
+/// Runs SQL tasks in worker thread on a clone of source connection.
+/// Tasks are executed one by one in order they were submitted, results are delivered
+/// by callback in the thread which owns executor, so long queries do not block GUI event loop.
+/// Task must not touch GUI objects, use QMetaObject::invokeMethod() with Qt::QueuedConnection to report progress.
+class QFCORE_DECL_EXPORT QueryExecutor : public QObject
+{
+	Q_OBJECT
+private:
+	typedef QObject Super;
+public:
+	/// throw qf::core::Exception to report error
+	typedef std::function<QVariant (Connection &conn)> Task;
+	/// error is empty if task succeeded
+	typedef std::function<void (const QVariant &result, const QString &error)> Callback;
+public:
+	explicit QueryExecutor(const QString &connection_name = QString(), QObject *parent = nullptr);
+	~QueryExecutor() Q_DECL_OVERRIDE;
+
+	/// executor for default connection, living in application main thread
+	static QueryExecutor* instance();
+
+	QString connectionName() const {return m_connectionName;}
+
+	/// @return task id
+	/// Connection parameters including current schema are taken now, so task is executed
+	/// against the same event even if current schema is changed before the task starts.
+	int execute(const Task &task, const Callback &callback = Callback());
+	/// Executes task in worker thread and waits for its result processing events,
+	/// so the SI reader and db notifications are still served while waiting.
+	/// User input events are excluded.
+	QVariant executeAndWait(const Task &task, QString *error = nullptr);
+
+	int pendingTaskCount() const {return m_callbacks.count();}
+
+	Q_SIGNAL void taskFinished(int task_id, const QVariant &result, const QString &error);
+private:
+	Q_SLOT void onTaskFinished(int task_id, const QVariant &result, const QString &error);
+private:
+	QString m_connectionName;
+	QueryExecutorThread *m_workerThread = nullptr;
+	int m_lastTaskId = 0;
+	QMap<int, Callback> m_callbacks;
+};
+
+}}}
+
+#endif // QF_CORE_SQL_QUERYEXECUTOR_H
@@ -2,7 +2,11 @@ HEADERS += \
     $$PWD/querybuilder.h \
     $$PWD/connection.h \
 	$$PWD/catalog.h \
+    $$PWD/catalogcache.h \
     $$PWD/query.h \
+    $$PWD/preparedquerycache.h \
+    $$PWD/connectionpool.h \
+    $$PWD/queryexecutor.h \
     $$PWD/dbenum.h \
     $$PWD/dbenumcache.h \
     $$PWD/dbfsdriver.h \
@@ -14,7 +18,11 @@ SOURCES += \
     $$PWD/querybuilder.cpp \
     $$PWD/connection.cpp \
 	$$PWD/catalog.cpp \
+    $$PWD/catalogcache.cpp \
     $$PWD/query.cpp \
+    $$PWD/preparedquerycache.cpp \
+    $$PWD/connectionpool.cpp \
+    $$PWD/queryexecutor.cpp \
     $$PWD/dbenum.cpp \
     $$PWD/dbenumcache.cpp \
     $$PWD/dbfsdriver.cpp \
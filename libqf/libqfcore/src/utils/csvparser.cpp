@@ -0,0 +1,269 @@
+#include "csvparser.h"
+#include "../core/log.h"
+
+#include <QFile>
+
+#include <climits>
+#include <cstring>
+
+using namespace qf::core::utils;
+
+CSVParser::CSVParser(char separator, char quote)
+	: m_separator(separator), m_quote(quote)
+{
+}
+
+CSVParser::~CSVParser()
+{
+	close();
+}
+
+bool CSVParser::openFile(const QString &file_name)
+{
+	close();
+	m_file = new QFile(file_name);
+	if(!m_file->open(QFile::ReadOnly)) {
+		qfWarning() << "Cannot open file:" << file_name << "for reading";
+		close();
+		return false;
+	}
+	if(m_file->size() == 0)
+		return true;
+	const char *data = reinterpret_cast<const char*>(m_file->map(0, m_file->size()));
+	if(data) {
+		m_pos = data;
+		m_end = data + m_file->size();
+	}
+	else {
+		/// some file systems cannot be mapped
+		qfWarning() << "Cannot map file:" << file_name << "to memory, reading whole content";
+		m_data = m_file->readAll();
+		m_pos = m_data.constData();
+		m_end = m_pos + m_data.size();
+	}
+	/// skip UTF-8 BOM
+	if(m_end - m_pos >= 3 && m_pos[0] == '\xEF' && m_pos[1] == '\xBB' && m_pos[2] == '\xBF')
+		m_pos += 3;
+	return true;
+}
+
+void CSVParser::setData(const QByteArray &data)
+{
+	close();
+	m_data = data;
+	m_pos = m_data.constData();
+	m_end = m_pos + m_data.size();
+	if(m_data.startsWith("\xEF\xBB\xBF"))
+		m_pos += 3;
+}
+
+void CSVParser::close()
+{
+	delete m_file;
+	m_file = nullptr;
+	m_data.clear();
+	m_pos = m_end = nullptr;
+	m_lineNumber = 1;
+	m_recordLineNumber = 0;
+	m_fields.clear();
+	m_unescaped.clear();
+}
+
+void CSVParser::skipLine()
+{
+	const char *nl = static_cast<const char*>(memchr(m_pos, '\n', m_end - m_pos));
+	m_pos = nl? nl + 1: m_end;
+	m_lineNumber++;
+}
+
+bool CSVParser::readRecord()
+{
+	m_fields.resize(0);
+	m_unescaped.resize(0);
+	while(m_pos < m_end) {
+		char c = *m_pos;
+		if(c == '\n') {
+			m_pos++;
+			m_lineNumber++;
+			continue;
+		}
+		if(c == '\r') {
+			m_pos++;
+			continue;
+		}
+		if(m_lineComment && c == m_lineComment) {
+			skipLine();
+			continue;
+		}
+		m_recordLineNumber = m_lineNumber;
+		parseRecord();
+		return true;
+	}
+	return false;
+}
+
+void CSVParser::parseRecord()
+{
+	enum State {FieldStart, Unquoted, Quoted, QuoteInQuoted, AfterQuoted};
+	const char *p = m_pos;
+	const char *field_start = p;
+	bool escaped = false;
+	State state = FieldStart;
+	auto add_field = [this, &escaped](const char *b, const char *e, bool trim) {
+		if(trim) {
+			while(b < e && (*b == ' ' || *b == '\t'))
+				b++;
+			while(e > b && (e[-1] == ' ' || e[-1] == '\t'))
+				e--;
+		}
+		FieldRef f;
+		if(escaped) {
+			/// unescape doubled quotes
+			f.offset = m_unescaped.size();
+			for(const char *s = b; s < e; s++) {
+				m_unescaped.append(*s);
+				if(*s == m_quote && s + 1 < e && s[1] == m_quote)
+					s++;
+			}
+			f.length = m_unescaped.size() - f.offset;
+		}
+		else {
+			f.data = b;
+			f.length = e - b;
+		}
+		m_fields << f;
+		escaped = false;
+	};
+	const char *quoted_end = nullptr;
+	bool record_end = false;
+	while(!record_end) {
+		char c = (p < m_end)? *p: '\n';
+		bool eol = (p >= m_end || c == '\n' || c == '\r');
+		switch(state) {
+		case FieldStart:
+			if(c == m_quote) {
+				state = Quoted;
+				field_start = p + 1;
+			}
+			else if((c == ' ' || c == '\t') && c != m_separator) {
+				/// spaces before opening quote are ignored
+			}
+			else {
+				state = Unquoted;
+				if(m_trimFields)
+					field_start = p;
+				p--;
+			}
+			break;
+		case Unquoted:
+			if(c == m_separator || eol) {
+				add_field(field_start, p, m_trimFields);
+				if(eol)
+					record_end = true;
+				else
+					state = FieldStart;
+				field_start = p + 1;
+			}
+			break;
+		case Quoted:
+			if(p >= m_end) {
+				/// unterminated quoted field takes rest of data
+				add_field(field_start, p, false);
+				record_end = true;
+			}
+			else if(c == m_quote) {
+				state = QuoteInQuoted;
+			}
+			else if(c == '\n') {
+				m_lineNumber++;
+			}
+			break;
+		case QuoteInQuoted:
+			if(c == m_quote) {
+				escaped = true;
+				state = Quoted;
+			}
+			else {
+				quoted_end = p - 1;
+				state = AfterQuoted;
+				p--;
+			}
+			break;
+		case AfterQuoted:
+			/// garbage between closing quote and separator is ignored
+			if(c == m_separator || eol) {
+				add_field(field_start, quoted_end, false);
+				if(eol)
+					record_end = true;
+				else
+					state = FieldStart;
+				field_start = p + 1;
+			}
+			break;
+		}
+		if(!record_end)
+			p++;
+	}
+	if(p < m_end && *p == '\r')
+		p++;
+	if(p < m_end && *p == '\n') {
+		p++;
+		m_lineNumber++;
+	}
+	m_pos = p;
+}
+
+QByteArray CSVParser::fieldData(int ix) const
+{
+	if(ix < 0 || ix >= m_fields.count())
+		return QByteArray();
+	const FieldRef &f = m_fields[ix];
+	const char *data = f.data? f.data: m_unescaped.constData() + f.offset;
+	return QByteArray::fromRawData(data, f.length);
+}
+
+int CSVParser::fieldInt(int ix, bool *ok) const
+{
+	QByteArray ba = fieldData(ix);
+	const char *p = ba.constData();
+	const char *e = p + ba.size();
+	while(p < e && *p == ' ')
+		p++;
+	bool neg = false;
+	if(p < e && (*p == '-' || *p == '+'))
+		neg = (*p++ == '-');
+	qint64 ret = 0;
+	bool is_ok = (p < e);
+	for(; p < e; p++) {
+		if(*p < '0' || *p > '9') {
+			is_ok = false;
+			break;
+		}
+		ret = ret * 10 + (*p - '0');
+		if(ret > INT_MAX) {
+			is_ok = false;
+			break;
+		}
+	}
+	if(ok)
+		*ok = is_ok;
+	if(!is_ok)
+		return 0;
+	return static_cast<int>(neg? -ret: ret);
+}
+
+double CSVParser::fieldDouble(int ix, bool *ok) const
+{
+	/// QByteArray::toDouble() needs zero terminated data, copy is unavoidable here
+	QByteArray ba = fieldData(ix);
+	return QByteArray(ba.constData(), ba.size()).toDouble(ok);
+}
+
+QStringList CSVParser::recordStrings() const
+{
+	QStringList ret;
+	ret.reserve(m_fields.count());
+	for (int i = 0; i < m_fields.count(); ++i)
+		ret << fieldString(i);
+	return ret;
+}
@@ -0,0 +1,80 @@
+#ifndef QF_CORE_UTILS_CSVPARSER_H
+#define QF_CORE_UTILS_CSVPARSER_H
+
+#include "../core/coreglobal.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QFile;
+
+namespace qf {
+namespace core {
+namespace utils {
+
+/// State machine CSV parser over UTF-8 buffer, file input is memory mapped.
+/// Fields are returned as views to the buffer, only quoted fields containing doubled quotes
+/// are unescaped to record buffer. Views are valid until next readRecord() call.
+class QFCORE_DECL_EXPORT CSVParser
+{
+public:
+	CSVParser(char separator = ',', char quote = '"');
+	~CSVParser();
+
+	void setSeparator(char c) {m_separator = c;}
+	void setQuote(char c) {m_quote = c;}
+	/// lines starting with comment char are skipped
+	void setLineComment(char c) {m_lineComment = c;}
+	/// trim spaces around not quoted fields, default true
+	void setTrimFields(bool b) {m_trimFields = b;}
+
+	/// map UTF-8 file to memory
+	bool openFile(const QString &file_name);
+	/// parse buffer in memory, data are shared not copied
+	void setData(const QByteArray &data);
+	void close();
+
+	bool atEnd() const {return m_pos >= m_end;}
+	/// parse next not empty record
+	/// @return false if there are no more records
+	bool readRecord();
+	/// line number of last record start, first line is 1
+	int lineNumber() const {return m_recordLineNumber;}
+
+	int fieldCount() const {return m_fields.count();}
+	/// zero copy view to field bytes, null if ix is out of range
+	QByteArray fieldData(int ix) const;
+	QString fieldString(int ix) const {return QString::fromUtf8(fieldData(ix));}
+	/// parse integer without copy, leading sign is allowed
+	int fieldInt(int ix, bool *ok = nullptr) const;
+	double fieldDouble(int ix, bool *ok = nullptr) const;
+	QStringList recordStrings() const;
+private:
+	struct FieldRef
+	{
+		const char *data = nullptr; //< nullptr if field is in m_unescaped buffer
+		int offset = 0;
+		int length = 0;
+	};
+	void parseRecord();
+	void skipLine();
+private:
+	char m_separator;
+	char m_quote;
+	char m_lineComment = '\0';
+	bool m_trimFields = true;
+	QFile *m_file = nullptr;
+	QByteArray m_data;
+	const char *m_pos = nullptr;
+	const char *m_end = nullptr;
+	int m_lineNumber = 1;
+	int m_recordLineNumber = 0;
+	QVector<FieldRef> m_fields;
+	QByteArray m_unescaped;
+};
+
+}}}
+
+#endif // QF_CORE_UTILS_CSVPARSER_H
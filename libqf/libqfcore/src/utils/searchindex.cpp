@@ -0,0 +1,103 @@
+#include "searchindex.h"
+
+#include "../core/collator.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace qf::core::utils;
+
+SearchIndex::SearchIndex()
+{
+}
+
+QByteArray SearchIndex::normalizedKey(const QString &s)
+{
+	return qf::core::Collator::toAscii7(QLocale::Czech, s, true);
+}
+
+int SearchIndex::addItem(const QString &search_text)
+{
+	int id = m_keys.count();
+	QByteArray key = normalizedKey(search_text);
+	for (int i = 0; i + 3 <= key.length(); ++i) {
+		QVector<int> &items = m_trigramItems[trigram(key.constData() + i)];
+		/// ids are increasing, so item lists stay sorted and unique
+		if(items.isEmpty() || items.last() != id)
+			items << id;
+	}
+	m_keys << key;
+	return id;
+}
+
+void SearchIndex::clear()
+{
+	m_keys.clear();
+	m_trigramItems.clear();
+}
+
+QVector<int> SearchIndex::search(const QString &text, int max_count) const
+{
+	QList<QByteArray> words;
+	for(const QByteArray &w : normalizedKey(text).split(' ')) {
+		if(!w.isEmpty())
+			words << w;
+	}
+	if(words.isEmpty() || max_count == 0)
+		return QVector<int>();
+
+	QVector<const QVector<int>*> item_lists;
+	for(const QByteArray &w : words) {
+		for (int i = 0; i + 3 <= w.length(); ++i) {
+			auto it = m_trigramItems.constFind(trigram(w.constData() + i));
+			if(it == m_trigramItems.constEnd())
+				return QVector<int>();
+			item_lists << &it.value();
+		}
+	}
+	QVector<int> candidates;
+	bool all_items = item_lists.isEmpty();
+	if(!all_items) {
+		std::sort(item_lists.begin(), item_lists.end(), [](const QVector<int> *a, const QVector<int> *b) {
+			return a->count() < b->count();
+		});
+		candidates = *item_lists.first();
+		QVector<int> tmp;
+		for (int i = 1; i < item_lists.count() && !candidates.isEmpty(); ++i) {
+			tmp.clear();
+			std::set_intersection(candidates.constBegin(), candidates.constEnd()
+								  , item_lists[i]->constBegin(), item_lists[i]->constEnd()
+								  , std::back_inserter(tmp));
+			candidates.swap(tmp);
+		}
+	}
+
+	/// 0 - key starts with first word, 1 - some key word starts with it, 2 - contains it
+	QVector<int> ranked[3];
+	int n = all_items? m_keys.count(): candidates.count();
+	for (int i = 0; i < n; ++i) {
+		int id = all_items? i: candidates[i];
+		const QByteArray &key = m_keys[id];
+		int rank = 3;
+		for (int j = 0; j < words.count(); ++j) {
+			int pos = key.indexOf(words[j]);
+			if(pos < 0) {
+				rank = 3;
+				break;
+			}
+			if(j == 0)
+				rank = (pos == 0)? 0: (key[pos - 1] == ' ')? 1: 2;
+		}
+		if(rank > 2)
+			continue;
+		ranked[rank] << id;
+		/// items are visited in id order, best ranked ones cannot be overtaken any more
+		if(max_count > 0 && ranked[0].count() >= max_count)
+			break;
+	}
+	QVector<int> ret = ranked[0];
+	ret << ranked[1] << ranked[2];
+	if(max_count > 0 && ret.count() > max_count)
+		ret.resize(max_count);
+	return ret;
+}
@@ -0,0 +1,42 @@
+#ifndef QF_CORE_UTILS_SEARCHINDEX_H
+#define QF_CORE_UTILS_SEARCHINDEX_H
+
+#include "../core/coreglobal.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+namespace qf {
+namespace core {
+namespace utils {
+
+/// Incremental search over prebuilt lower case ascii7 keys.
+/// Every search text word must be contained in the item key, candidates are found by trigram index,
+/// results are ranked: key starting with first word, then word starting with it, then other matches.
+class QFCORE_DECL_EXPORT SearchIndex
+{
+public:
+	SearchIndex();
+
+	static QByteArray normalizedKey(const QString &s);
+
+	/// @return item id, ids are assigned in sequence 0, 1, 2, ...
+	int addItem(const QString &search_text);
+	int count() const {return m_keys.count();}
+	bool isEmpty() const {return m_keys.isEmpty();}
+	void clear();
+
+	/// @return ids of matching items, at most max_count if max_count >= 0
+	QVector<int> search(const QString &text, int max_count = -1) const;
+private:
+	static quint32 trigram(const char *s) {return ((quint32)(uchar)s[0] << 16) | ((quint32)(uchar)s[1] << 8) | (uchar)s[2];}
+private:
+	QVector<QByteArray> m_keys;
+	QHash<quint32, QVector<int>> m_trigramItems;
+};
+
+}}}
+
+#endif // QF_CORE_UTILS_SEARCHINDEX_H
@@ -1,5 +1,6 @@
 #include "table.h"
 #include "csvreader.h"
+#include "csvparser.h"
 #include "svalue.h"
 #include "treetable.h"
 
@@ -894,53 +895,93 @@ const QString Table::CVSTableEndTag = "#CVS_TABLE_END";
 void Table::importCSV(QTextStream &ts, TextImportOptions opts)
 {
 	qfLogFuncFrame();
-	QString s;
-	QStringList sl;
-	//emit progressValue(0, tr("Importuji CSV"));
+	CSVParser parser;
+	parser.setData(ts.readAll().toUtf8());
+	importCSV(parser, opts);
+}
+
+void Table::importCSV(CSVParser &parser, TextImportOptions opts)
+{
+	qfLogFuncFrame();
 	qfDebug() << "\t opts fieldSeparator:" << opts.fieldSeparator();
 	qfDebug() << "\t opts ignoreFirstLinesCount:" << opts.ignoreFirstLinesCount();
 	qfDebug() << "\t opts isImportColumnNames:" << opts.isImportColumnNames();
-	CSVReader reader(&ts, String(opts.fieldSeparator()).value(0).toLatin1(), String(opts.fieldQuotes()).value(0).toLatin1());
-	if(!opts.isImportAppend()) clear();
-	for(int i=0; i<opts.ignoreFirstLinesCount(); i++)
-		reader.readCSVLine();
-	if(opts.isImportColumnNames()) {
-		sl = reader.readCSVLineSplitted();
-		foreach(s, sl) {
-			//qfDebug() << "\tfield:" << s;
-			Field fld(s, QVariant::String);
-			fieldsRef().append(fld);
+	parser.setSeparator(String(opts.fieldSeparator()).value(0).toLatin1());
+	parser.setQuote(String(opts.fieldQuotes()).value(0).toLatin1());
+	parser.setTrimFields(opts.isTrimValues());
+	if(!opts.isImportAppend())
+		clear();
+	/// ignored lines are physical lines, blank ones included, parser skips blank lines so records are compared by line number
+	const int ignore_lines_count = opts.ignoreFirstLinesCount();
+	bool import_column_names = opts.isImportColumnNames();
+	/// fields defined before import are filled with values of their types
+	QVector<int> field_types;
+	const QByteArray end_tag = CVSTableEndTag.toUtf8();
+	while(parser.readRecord()) {
+		if(parser.lineNumber() <= ignore_lines_count)
+			continue;
+		if(import_column_names) {
+			import_column_names = false;
+			for (int i = 0; i < parser.fieldCount(); ++i) {
+				Field fld(parser.fieldString(i), QVariant::String);
+				fieldsRef().append(fld);
+			}
+			continue;
 		}
-	}
-	//int n = 0, cnt = 100, steps = 100, progress_step = cnt / steps;
-	bool trim_values = opts.isTrimValues();
-	while(!ts.atEnd()) {
-		//if(((n++)%steps) % progress_step) emit progressValue(1.*n / cnt, tr("Probiha import"));
-		sl = reader.readCSVLineSplitted();
-		if(!sl.isEmpty()) {
-			if(sl[0] == CVSTableEndTag) break;
-			s = sl[0];
-			if(s[0] == '#') continue; /// CVS comment (my CVS extension)
-			if(fields().isEmpty()) {
-				/// pokud nejsou vytvoreny fieldy, treba protoze se neimpoortovaly nazvy sloupcu, udelej je z tohoto radku
-				int colno = 0;
-				foreach(s, sl) {
-					Field fld(QString("col%1").arg(++colno), QVariant::String);
-					fieldsRef().append(fld);
-				}
+		QByteArray first = parser.fieldData(0);
+		if(first == end_tag)
+			break;
+		if(first.startsWith('#'))
+			continue; /// CVS comment (my CVS extension)
+		if(fields().isEmpty()) {
+			/// pokud nejsou vytvoreny fieldy, treba protoze se neimpoortovaly nazvy sloupcu, udelej je z tohoto radku
+			for (int i = 0; i < parser.fieldCount(); ++i) {
+				Field fld(QString("col%1").arg(i + 1), QVariant::String);
+				fieldsRef().append(fld);
+			}
+		}
+		if(field_types.isEmpty()) {
+			for (int i = 0; i < fields().count(); ++i)
+				field_types << fields().at(i).type();
+		}
+		TableRow r(tableProperties());
+		for(int i=0; i<field_types.count() && i<parser.fieldCount(); i++) {
+			switch(field_types[i]) {
+			case QVariant::Int: {
+				bool ok;
+				int n = parser.fieldInt(i, &ok);
+				r.setValue(i, ok? QVariant(n): QVariant(QVariant::Int));
+				break;
+			}
+			case QVariant::Double: {
+				bool ok;
+				double d = parser.fieldDouble(i, &ok);
+				r.setValue(i, ok? QVariant(d): QVariant(QVariant::Double));
+				break;
+			}
+			case QVariant::Bool: {
+				/// QVariant conversion, "0" and "false" are false, other text like "true", "T" or "1" is true
+				QString s = parser.fieldString(i);
+				r.setValue(i, s.isEmpty()? QVariant(QVariant::Bool): QVariant(QVariant(s).toBool()));
+				break;
+			}
+			case QVariant::String:
+			case QMetaType::UnknownType:
+				r.setValue(i, parser.fieldString(i));
+				break;
+			default: {
+				QVariant v = parser.fieldString(i);
+				v.convert(field_types[i]);
+				r.setValue(i, v);
+				break;
 			}
-			TableRow r(tableProperties());
-			for(int i=0; i<fields().count() && i<sl.count(); i++) {
-				QString s = sl[i];
-				if(trim_values) s = s.trimmed();
-				r.setValue(i, s);
 			}
-			r.clearOrigValues();
-			d->rows.append(r);
 		}
+		r.clearOrigValues();
+		d->rows.append(r);
 	}
-	//reload();
 }
+
 #ifdef TXT_EXPORT_IMPORT
 static QList<int> parse_field_structure(Table &table, const QString & file_structure_definition, QVariantMap & parsed_props)
 {
@@ -21,6 +21,7 @@ namespace core {
 namespace utils {
 
 class TableRow;
+class CSVParser;
 typedef QList<TableRow> RowList;
 
 class QFCORE_DECL_EXPORT Table
@@ -304,6 +305,9 @@ public:
 	static QString quoteCSV(const QVariant &val, const TextExportOptions &opts);
 	void exportCSV(QTextStream &ts, const QString col_names = "*", TextExportOptions opts = TextExportOptions()) const;
 	void importCSV(QTextStream &ts, TextImportOptions opts = TextImportOptions());
+	/// columns defined before import get values converted to column type, empty Int, Double and Bool fields are null
+	/// ignoreFirstLinesCount() counts physical lines of input, blank lines included
+	void importCSV(CSVParser &parser, TextImportOptions opts = TextImportOptions());
 #ifdef TXT_EXPORT_IMPORT
 	void importTXT(QTextStream &ts, const QString &file_structure_definition);
 #endif
@@ -404,4 +408,6 @@ public:
 
 }}}
 
+Q_DECLARE_METATYPE(qf::core::utils::Table)
+
 #endif
@@ -4,11 +4,13 @@ HEADERS += \
     $$PWD/treetable.h \
     $$PWD/table.h \
     $$PWD/csvreader.h \
+    $$PWD/csvparser.h \
 	$$PWD/fileutils.h \
 	$$PWD/treeitembase.h \
 	$$PWD/clioptions.h \
     $$PWD/settings.h \
     $$PWD/timescope.h \
+    $$PWD/searchindex.h \
     $$PWD/htmlutils.h
 
 SOURCES += \
@@ -17,10 +19,12 @@ SOURCES += \
     $$PWD/treetable.cpp \
     $$PWD/table.cpp \
     $$PWD/csvreader.cpp \
+    $$PWD/csvparser.cpp \
 	$$PWD/fileutils.cpp \
 	$$PWD/treeitembase.cpp \
 	$$PWD/clioptions.cpp \
     $$PWD/settings.cpp \
     $$PWD/timescope.cpp \
+    $$PWD/searchindex.cpp \
     $$PWD/htmlutils.cpp
 
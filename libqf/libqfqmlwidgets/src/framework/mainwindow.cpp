@@ -308,13 +308,25 @@ Plugin *MainWindow::plugin(const QString &feature_id, bool throw_exc)
 	return ret;
 }
 
+Plugin *MainWindow::pluginForMetaObject(const QMetaObject *meta_object, bool throw_exc)
+{
+	Plugin *ret = nullptr;
+	if(m_pluginLoader) {
+		ret = m_pluginLoader->typedPlugins().value(meta_object);
+	}
+	if(!ret) {
+		qfWarning() << "Plugin of type:" << meta_object->className() << "is not installed!";
+		if(throw_exc)
+			QF_EXCEPTION(tr("Plugin of type: '%1' is not installed!").arg(meta_object->className()));
+	}
+	return ret;
+}
+
 Plugin *MainWindow::pluginForObject(QObject *qml_object)
 {
-	qfLogFuncFrame();
 	Plugin *ret = nullptr;
 	for(QObject *o = qml_object; o!=nullptr; o=o->parent()) {
 		PartWidget *pw = qobject_cast<PartWidget*>(o);
-		qfDebug() << o << "->" << pw;
 		if(pw) {
 			QString id = pw->featureId();
 			ret = plugin(id);
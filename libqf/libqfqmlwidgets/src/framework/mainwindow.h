@@ -69,6 +69,24 @@ public:
 	Q_INVOKABLE void addPartWidget(qf::qmlwidgets::framework::PartWidget *widget, const QString &feature_id = QString());
 
 	Q_INVOKABLE qf::qmlwidgets::framework::Plugin* plugin(const QString &feature_id, bool throw_exc = false);
+	/// Typed plugin lookup without feature id string and qobject_cast,
+	/// plugin is registered by loader for each C++ class of its hierarchy when installed.
+	template<class T>
+	T* plugin(bool throw_exc = false)
+	{
+		return static_cast<T*>(pluginForMetaObject(&T::staticMetaObject, throw_exc));
+	}
+	/// Typed plugin pointer cached on first successful lookup,
+	/// installed plugins live as long as the framework does, so it is safe to use on hot paths.
+	template<class T>
+	static T* cachedPlugin()
+	{
+		static T *s_plugin = nullptr;
+		if(!s_plugin)
+			s_plugin = frameWork()->plugin<T>(true);
+		return s_plugin;
+	}
+	Plugin* pluginForMetaObject(const QMetaObject *meta_object, bool throw_exc = false);
 	Q_INVOKABLE qf::qmlwidgets::framework::Plugin* pluginForObject(QObject *qml_object);
 
 	Q_INVOKABLE qf::qmlwidgets::dialogs::QmlDialog* createQmlDialog(QWidget *parent = nullptr);
@@ -130,6 +130,17 @@ bool PartWidget::isAddToPartSwitchFromBottom()
 	return add_from_bottom;
 }
 
+void PartWidget::ensureLazyInit()
+{
+	if(m_lazyInitDone)
+		return;
+	m_lazyInitDone = true;
+	qfLogFuncFrame() << featureId();
+	lazyInit();
+	/// widgets created in lazyInit() missed persistent settings loading in MainWindow::addPartWidget()
+	loadPersistentSettingsRecursively();
+}
+
 QIcon PartWidget::createIcon()
 {
 	QIcon ico;
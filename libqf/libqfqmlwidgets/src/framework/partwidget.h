@@ -73,7 +73,14 @@ public:
 	Q_INVOKABLE qf::qmlwidgets::ToolBar* toolBar(const QString &name, bool create_if_not_exists = false);
 
 	bool isAddToPartSwitchFromBottom();
+
+	/// calls lazyInit() if it was not called yet
+	void ensureLazyInit();
 protected:
+	/// Called once before part is activated first time.
+	/// Reimplement to create part content on demand and save application startup time.
+	virtual void lazyInit() {}
+
 	QQmlListProperty<QWidget> widgets();
 	QQmlListProperty<QObject> attachedObjects();
 	Frame* centralFrame();
@@ -91,6 +98,7 @@ private:
 	QString m_iconSource;
 	QString m_featureId;
 	QList<QObject*> m_attachedObjects;
+	bool m_lazyInitDone = false;
 };
 
 }}}
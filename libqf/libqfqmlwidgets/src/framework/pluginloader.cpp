@@ -14,10 +14,29 @@
 #include <QQmlProperty>
 #include <QDirIterator>
 #include <QTranslator>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonArray>
 
 using namespace qf::qmlwidgets::framework;
 
 static const QLatin1String CoreFeatureId("Core");
+static const QLatin1String KEY_VERSION("version");
+static const QLatin1String KEY_MANIFESTS("manifests");
+static const QLatin1String KEY_LAST_MODIFIED("lastModified");
+static const QLatin1String KEY_SIZE("size");
+static const QLatin1String KEY_FEATURE_ID("featureId");
+static const QLatin1String KEY_DISABLED("disabled");
+static const QLatin1String KEY_DEPENDS_ON("dependsOnFeatureIds");
+static const QLatin1String KEY_ADD_FROM_BOTTOM("addFromBottom");
+
+static QString manifestIndexFileName()
+{
+	QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+	if(dir.isEmpty())
+		return QString();
+	return dir + "/pluginmanifestindex.json";
+}
 
 PluginLoader::PluginLoader(MainWindow *parent) :
 	QObject(parent)
@@ -27,154 +46,331 @@ PluginLoader::PluginLoader(MainWindow *parent) :
 PluginLoader::ManifestMap PluginLoader::findPlugins()
 {
 	ManifestMap ret;
-	QQmlEngine *qe = Application::instance()->qmlEngine();
-
+	loadManifestIndex();
 	Q_FOREACH(auto path, Application::instance()->qmlPluginImportPaths()) {
 		qfInfo() << "Finding plugin manifests on:" << path;
 		QDirIterator it(path, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::FollowSymlinks);
 		while(it.hasNext()) {
 			it.next();
 			QFileInfo fi = it.fileInfo();
-			if(QFile::exists(fi.absoluteFilePath() + "/Manifest.qml")) {
-				qfDebug() << "Trying to load plugin manifest on path:" << (fi.absoluteFilePath() + "/Manifest.qml");
-				QQmlComponent c(qe, QUrl::fromLocalFile(fi.absoluteFilePath() + "/Manifest.qml"));
-				if(!c.isReady()) {
-					qfError() << c.errorString();
+			QString manifest_path = fi.absoluteFilePath() + "/Manifest.qml";
+			if(QFile::exists(manifest_path)) {
+				PluginManifest *manifest = manifestFromIndex(manifest_path);
+				if(!manifest)
+					manifest = loadManifest(manifest_path);
+				if(!manifest)
+					continue;
+				QString feature_id = manifest->featureId();
+				if(feature_id.isEmpty()) {
+					feature_id = fi.baseName();
+					//qfInfo() << "FeatureId is empty, setting from plugin name to:" << feature_id;
+					/// not sure if QML properties can be set this way, I rathe think that QQmlProperty should be used here
+					manifest->setFeatureId(feature_id);
+				}
+				//QString plugin_loader = "main.qml";
+				QStringList depends_on_feature_ids = manifest->dependsOnFeatureIds();
+				if(feature_id != CoreFeatureId) {
+					/// each not Core feature implicitly depends on Core
+					depends_on_feature_ids << CoreFeatureId;
+					manifest->setDependsOnFeatureIds(depends_on_feature_ids);
+				}
+
+				QString plugin_path = fi.absoluteFilePath();
+				manifest->setHomeDir(plugin_path);
+				qfInfo() << "Found Manifest.qml for featureId:" << feature_id << "from plugin:" << fi.baseName();
+				if(ret.contains(feature_id)) {
+					qfError() << "Feature id:" << feature_id << "already loaded";
+					delete manifest;
 				}
 				else {
-					QObject *root = c.create();
-					if(!root) {
-						qfError() << "Error creating plugin manifest:" << c.url().toString();
-						qfError() << c.errorString();
+					if(manifest->isDisabled()) {
+						qfInfo() << "Plugin featureId:" << feature_id << "DISABLED in manifest";
+						delete manifest;
 					}
 					else {
-						PluginManifest *manifest = qobject_cast<PluginManifest*>(root);
-						if(!manifest) {
-							qfError() << "Loaded component is not a kind of PluginManifest:" << root << c.url().toString();
-							continue;
-						}
-						QString feature_id = manifest->featureId();
-						if(feature_id.isEmpty()) {
-							feature_id = fi.baseName();
-							//qfInfo() << "FeatureId is empty, setting from plugin name to:" << feature_id;
-							/// not sure if QML properties can be set this way, I rathe think that QQmlProperty should be used here
-							manifest->setFeatureId(feature_id);
-						}
-						//QString plugin_loader = "main.qml";
-						QStringList depends_on_feature_ids = manifest->dependsOnFeatureIds();
-						if(feature_id != CoreFeatureId) {
-							/// each not Core feature implicitly depends on Core
-							depends_on_feature_ids << CoreFeatureId;
-							manifest->setDependsOnFeatureIds(depends_on_feature_ids);
-						}
-
-						QString plugin_path = fi.absoluteFilePath();
-						manifest->setHomeDir(plugin_path);
-						qfInfo() << "Found Manifest.qml for featureId:" << feature_id << "from plugin:" << fi.baseName();
-						if(ret.contains(feature_id)) {
-							qfError() << "Feature id:" << feature_id << "already loaded";
-							delete root;
-						}
-						else {
-							bool is_disabled = root->property("disabled").toBool();
-							if(is_disabled) {
-								qfInfo() << "Plugin featureId:" << feature_id << "DISABLED in manifest";
-								delete root;
-							}
-							else {
-								root->setParent(this);
-								ret[feature_id] = manifest;
-							}
-						}
+						manifest->setParent(this);
+						ret[feature_id] = manifest;
 					}
 				}
 			}
 		}
 	}
+	saveManifestIndex();
 	return ret;
 }
 
+PluginManifest *PluginLoader::loadManifest(const QString &manifest_path)
+{
+	qfDebug() << "Trying to load plugin manifest on path:" << manifest_path;
+	QQmlEngine *qe = Application::instance()->qmlEngine();
+	QQmlComponent c(qe, QUrl::fromLocalFile(manifest_path));
+	if(!c.isReady()) {
+		qfError() << c.errorString();
+		return nullptr;
+	}
+	QObject *root = c.create();
+	if(!root) {
+		qfError() << "Error creating plugin manifest:" << c.url().toString();
+		qfError() << c.errorString();
+		return nullptr;
+	}
+	PluginManifest *manifest = qobject_cast<PluginManifest*>(root);
+	if(!manifest) {
+		qfError() << "Loaded component is not a kind of PluginManifest:" << root << c.url().toString();
+		delete root;
+		return nullptr;
+	}
+	/// manifests declaring own properties cannot be restored from index
+	bool is_plain = manifest->metaObject()->propertyCount() == PluginManifest::staticMetaObject.propertyCount();
+	updateManifestIndex(manifest_path, manifest, is_plain);
+	return manifest;
+}
+
+PluginManifest *PluginLoader::manifestFromIndex(const QString &manifest_path)
+{
+	QJsonObject entry = m_manifestIndex.value(manifest_path).toObject();
+	if(entry.isEmpty())
+		return nullptr;
+	QFileInfo fi(manifest_path);
+	if(entry.value(KEY_LAST_MODIFIED).toDouble() != (double)fi.lastModified().toMSecsSinceEpoch()
+			|| entry.value(KEY_SIZE).toDouble() != (double)fi.size()) {
+		qfDebug() << "Manifest index entry is out of date:" << manifest_path;
+		return nullptr;
+	}
+	qfDebug() << "Plugin manifest restored from index:" << manifest_path;
+	PluginManifest *manifest = new PluginManifest(this);
+	manifest->setFeatureId(entry.value(KEY_FEATURE_ID).toString());
+	manifest->setDisabled(entry.value(KEY_DISABLED).toBool());
+	manifest->setAddFromBottom(entry.value(KEY_ADD_FROM_BOTTOM).toBool());
+	QStringList depends_on;
+	for(auto v : entry.value(KEY_DEPENDS_ON).toArray())
+		depends_on << v.toString();
+	manifest->setDependsOnFeatureIds(depends_on);
+	return manifest;
+}
+
+void PluginLoader::updateManifestIndex(const QString &manifest_path, PluginManifest *manifest, bool is_plain)
+{
+	m_manifestIndexDirty = true;
+	if(!is_plain) {
+		m_manifestIndex.remove(manifest_path);
+		return;
+	}
+	QFileInfo fi(manifest_path);
+	QJsonObject entry;
+	entry[KEY_LAST_MODIFIED] = (double)fi.lastModified().toMSecsSinceEpoch();
+	entry[KEY_SIZE] = (double)fi.size();
+	entry[KEY_FEATURE_ID] = manifest->featureId();
+	entry[KEY_DISABLED] = manifest->isDisabled();
+	entry[KEY_ADD_FROM_BOTTOM] = manifest->isAddFromBottom();
+	entry[KEY_DEPENDS_ON] = QJsonArray::fromStringList(manifest->dependsOnFeatureIds());
+	m_manifestIndex[manifest_path] = entry;
+}
+
+void PluginLoader::loadManifestIndex()
+{
+	m_manifestIndex = QJsonObject();
+	m_manifestIndexDirty = false;
+	QFile f(manifestIndexFileName());
+	if(f.fileName().isEmpty() || !f.open(QFile::ReadOnly))
+		return;
+	QJsonObject root = QJsonDocument::fromJson(f.readAll()).object();
+	if(root.value(KEY_VERSION).toString() != QCoreApplication::applicationVersion()) {
+		qfInfo() << "Plugin manifest index was created by different application version, it will be rebuilt.";
+		m_manifestIndexDirty = true;
+		return;
+	}
+	m_manifestIndex = root.value(KEY_MANIFESTS).toObject();
+}
+
+void PluginLoader::saveManifestIndex()
+{
+	if(!m_manifestIndexDirty)
+		return;
+	QString fn = manifestIndexFileName();
+	if(fn.isEmpty())
+		return;
+	QDir().mkpath(QFileInfo(fn).absolutePath());
+	QFile f(fn);
+	if(!f.open(QFile::WriteOnly)) {
+		qfWarning() << "Cannot write plugin manifest index:" << fn;
+		return;
+	}
+	QJsonObject root;
+	root[KEY_VERSION] = QCoreApplication::applicationVersion();
+	root[KEY_MANIFESTS] = m_manifestIndex;
+	f.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+	m_manifestIndexDirty = false;
+}
+
 void PluginLoader::loadPlugins(const QStringList &feature_ids)
 {
 	qfLogFuncFrame();
+	m_startupTimer.start();
+	m_loadingFinished = false;
+	m_startupTimeline.clear();
 	m_manifestsToLoad = findPlugins();
+	qfInfo() << "Plugin manifests found in" << m_startupTimer.elapsed() << "msec";
 	QStringList fids = feature_ids;
 	if(fids.isEmpty())
 		Q_FOREACH(auto m, m_manifestsToLoad)
 			fids << m->featureId();
-	Q_FOREACH(auto feature_id, fids)
-		loadPlugin(feature_id);
-	emit loadingFinished();
+	QStringList load_order;
+	Q_FOREACH(auto feature_id, fids) {
+		QStringList resolving;
+		resolveDependencies(feature_id, load_order, resolving);
+	}
+	m_featuresToInstall = load_order;
+	Q_FOREACH(auto feature_id, load_order) {
+		installTranslator(feature_id);
+		startComponentLoading(feature_id);
+	}
+	/// components ready immediately do not need to emit statusChanged()
+	QMetaObject::invokeMethod(this, "continueLoading", Qt::QueuedConnection);
 }
 
-bool PluginLoader::loadPlugin(const QString feature_id)
+bool PluginLoader::resolveDependencies(const QString &feature_id, QStringList &load_order, QStringList &resolving)
 {
-	if(m_loadedPlugins.contains(feature_id)) {
-		// feature installed already
+	if(m_loadedPlugins.contains(feature_id) || load_order.contains(feature_id)) {
+		// feature installed or scheduled already
 		return true;
 	}
-
-	PluginManifest *manifest = m_manifestsToLoad.take(feature_id);
+	PluginManifest *manifest = m_manifestsToLoad.value(feature_id);
 	if(manifest == nullptr) {
 		qfError() << QString("Feature id: '%1' - Invalid manifest!").arg(feature_id);
 		return false;
 	}
-
-	QQmlEngine *qe = Application::instance()->qmlEngine();
-	QF_ASSERT(qe != nullptr, "Qml engine is NULL", return false);
-
+	if(resolving.contains(feature_id)) {
+		qfError() << "Cyclic dependency:" << (resolving.join(" -> ") + " -> " + feature_id);
+		return false;
+	}
+	resolving << feature_id;
 	bool ok = true;
 	QStringList depends_on = manifest->dependsOnFeatureIds();
 	Q_FOREACH(auto required_feature_id, depends_on) {
-		if(!m_loadedPlugins.contains(required_feature_id)) {
-			qfInfo() << feature_id << "solving dependency on" << required_feature_id;
-			ok = loadPlugin(required_feature_id);
-			if(!ok) {
+		qfDebug() << feature_id << "solving dependency on" << required_feature_id;
+		ok = resolveDependencies(required_feature_id, load_order, resolving);
+		if(!ok) {
+			qfError() << "Cannot load feature:" << feature_id << "due to unsatisfied dependecies!";
+			qfError() << "\t!!!" << feature_id << "depends on:" << depends_on.join(", ");
+			break;
+		}
+	}
+	resolving.removeLast();
+	if(ok) {
+		load_order << feature_id;
+	}
+	else {
+		delete m_manifestsToLoad.take(feature_id);
+		qfError() << "ERROR load feature:" << feature_id;
+	}
+	return ok;
+}
+
+void PluginLoader::installTranslator(const QString &feature_id)
+{
+	QString lc_name = mainWindow()->uiLanguageName();
+	if(lc_name.isEmpty())
+		return;
+	QString tr_name = feature_id + '.' + lc_name;
+	QString app_translations_path = QCoreApplication::applicationDirPath() + "/translations";
+	QTranslator *trans = new QTranslator(mainWindow());
+	bool ok = trans->load(tr_name, app_translations_path);
+	if(ok) {
+		qfInfo() << "Found translation file for:" << tr_name;
+		QCoreApplication::instance()->installTranslator(trans);
+	}
+	else {
+		qfInfo() << "Cannot load translation file for:" << tr_name << "in:" << app_translations_path;
+		delete trans;
+	}
+}
+
+void PluginLoader::startComponentLoading(const QString &feature_id)
+{
+	QQmlEngine *qe = Application::instance()->qmlEngine();
+	QF_ASSERT(qe != nullptr, "Qml engine is NULL", return);
+	PluginManifest *manifest = m_manifestsToLoad.value(feature_id);
+	QUrl plugin_loader_url = QUrl::fromLocalFile(manifest->homeDir() + "/main.qml");
+	qfInfo() << "Loading feature:" << feature_id << "from:" << plugin_loader_url.toString();
+	QQmlComponent *c = new QQmlComponent(qe, this);
+	m_pluginComponents[feature_id] = c;
+	connect(c, &QQmlComponent::statusChanged, this, [this, feature_id](QQmlComponent::Status status) {
+		if(status != QQmlComponent::Loading && !m_componentReadyMsec.contains(feature_id))
+			m_componentReadyMsec[feature_id] = m_startupTimer.elapsed();
+		continueLoading();
+	});
+	c->loadUrl(plugin_loader_url, QQmlComponent::Asynchronous);
+}
+
+void PluginLoader::continueLoading()
+{
+	/// plugin installation can process events, pending components are checked in loop below anyway
+	if(m_installing)
+		return;
+	m_installing = true;
+	while(!m_featuresToInstall.isEmpty()) {
+		QString feature_id = m_featuresToInstall.first();
+		QQmlComponent *c = m_pluginComponents.value(feature_id);
+		QF_ASSERT(c != nullptr, "Plugin component is NULL", break);
+		if(c->isLoading())
+			break;
+		m_featuresToInstall.removeFirst();
+		m_pluginComponents.remove(feature_id);
+		PluginManifest *manifest = m_manifestsToLoad.take(feature_id);
+
+		LoadTime load_time;
+		load_time.featureId = feature_id;
+		load_time.readyMsec = m_componentReadyMsec.value(feature_id, m_startupTimer.elapsed());
+		QElapsedTimer install_timer;
+		install_timer.start();
+
+		bool ok = true;
+		Q_FOREACH(auto required_feature_id, manifest->dependsOnFeatureIds()) {
+			if(!m_loadedPlugins.contains(required_feature_id)) {
 				qfError() << "Cannot load feature:" << feature_id << "due to unsatisfied dependecies!";
-				qfError() << "\t!!!" << feature_id << "depends on:" << depends_on.join(", ");
+				qfError() << "\t!!!" << feature_id << "depends on:" << required_feature_id << "which failed to install";
+				ok = false;
 				break;
 			}
 		}
-		else {
-			qfInfo() << feature_id << "dependency on" << required_feature_id << "satisfied";
-		}
-	}
-	if(ok) {
-		QUrl plugin_loader_url = QUrl::fromLocalFile(manifest->homeDir() + "/main.qml");
-		qfInfo() << "Installing feature:" << feature_id << "from:" << plugin_loader_url.toString();
-		QString lc_name = mainWindow()->uiLanguageName();
-		if(!lc_name.isEmpty()) {
-			QString tr_name = feature_id + '.' + lc_name;
-			QString app_translations_path = QCoreApplication::applicationDirPath() + "/translations";
-			QTranslator *trans = new QTranslator(mainWindow());
-			bool ok = trans->load(tr_name, app_translations_path);
-			if(ok) {
-				qfInfo() << "Found translation file for:" << tr_name;
-				QCoreApplication::instance()->installTranslator(trans);
+		if(ok) {
+			if(!c->isReady()) {
+				qfError() << "Component is not ready!" << c->errorString();
+				ok = false;
 			}
 			else {
-				qfInfo() << "Cannot load translation file for:" << tr_name << "in:" << app_translations_path;
-				delete trans;
+				qfInfo() << "Installing feature:" << feature_id << "from:" << c->url().toString();
+				ok = loadPluginComponent(c, manifest);
 			}
 		}
-		QQmlComponent *c = new QQmlComponent(qe, plugin_loader_url, QQmlComponent::PreferSynchronous);
-		if(c->isLoading()) {
-			qfError() << "Asynchronous plugin loading is not supported!";
-			ok = false;
-			//QObject::connect(m_currentlyLoadedComponent, &QQmlComponent::statusChanged, this, &PluginLoader::continueLoading);
-		}
-		else if(!c->isReady()) {
-			qfError() << "Component is not ready!" << c->errorString();
-		}
-		else {
-			ok = loadPluginComponent(c, manifest);
+		if(!ok) {
+			QF_SAFE_DELETE(manifest);
+			qfError() << "ERROR load feature:" << feature_id;
 		}
+		c->deleteLater();
+		load_time.installMsec = install_timer.elapsed();
+		load_time.ok = ok;
+		m_startupTimeline << load_time;
 	}
-	if(!ok) {
-		QF_SAFE_DELETE(manifest);
-		qfError() << "ERROR load feature:" << feature_id;
+	m_installing = false;
+	if(m_featuresToInstall.isEmpty())
+		finishLoading();
+}
+
+void PluginLoader::finishLoading()
+{
+	if(m_loadingFinished)
+		return;
+	m_loadingFinished = true;
+	qfInfo() << "Plugins loaded in" << m_startupTimer.elapsed() << "msec";
+	for(const LoadTime &lt : m_startupTimeline) {
+		qfInfo() << "\t" << lt.featureId
+				 << "component ready at:" << lt.readyMsec << "msec,"
+				 << "installed in:" << lt.installMsec << "msec"
+				 << (lt.ok? "": "ERROR");
 	}
-	return ok;
+	emit loadingFinished();
 }
 
 bool PluginLoader::loadPluginComponent(QQmlComponent *plugin_component, PluginManifest *manifest)
@@ -203,6 +399,7 @@ bool PluginLoader::loadPluginComponent(QQmlComponent *plugin_component, PluginMa
 	else {
 		plugin->setParent(mainWindow());
 		m_loadedPlugins[manifest->featureId()] = plugin;
+		registerTypedPlugin(plugin);
 	}
 
 	if(!ret) {
@@ -215,6 +412,19 @@ bool PluginLoader::loadPluginComponent(QQmlComponent *plugin_component, PluginMa
 	return ret;
 }
 
+void PluginLoader::registerTypedPlugin(Plugin *plugin)
+{
+	/// QML plugin root can have dynamic meta object, register all C++ classes up to Plugin
+	for(const QMetaObject *mo = plugin->metaObject(); mo && mo != &Plugin::staticMetaObject; mo = mo->superClass()) {
+		if(m_typedPlugins.contains(mo)) {
+			if(m_typedPlugins.value(mo) != plugin)
+				qfWarning() << "Plugin type:" << mo->className() << "already registered by:" << m_typedPlugins.value(mo)->objectName();
+			continue;
+		}
+		m_typedPlugins[mo] = plugin;
+	}
+}
+
 MainWindow *PluginLoader::mainWindow()
 {
 	MainWindow *ret = qobject_cast<MainWindow*>(this->parent());
@@ -4,6 +4,9 @@
 #include "mainwindow.h"
 
 #include <QObject>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QHash>
 
 class QQmlComponent;
 
@@ -14,33 +17,67 @@ namespace framework {
 class MainWindow;
 class PluginManifest;
 
+/// Plugins are loaded asynchronously, plugin main.qml files are compiled
+/// in background by QML type loader, while plugins are installed
+/// in dependency order in GUI thread as soon as their components are ready.
 class PluginLoader : public QObject
 {
 	Q_OBJECT
 public:
 	typedef QMap<QString, qf::qmlwidgets::framework::Plugin*> PluginMap;
 	typedef QMap<QString, qf::qmlwidgets::framework::PluginManifest*> ManifestMap;
+	typedef QHash<const QMetaObject*, qf::qmlwidgets::framework::Plugin*> TypedPluginMap;
+	struct LoadTime
+	{
+		QString featureId;
+		/// msec from start of loading to component ready
+		qint64 readyMsec = 0;
+		/// msec spent in plugin creation and installation
+		qint64 installMsec = 0;
+		bool ok = false;
+	};
 public:
 	explicit PluginLoader(MainWindow *parent = 0);
 
 	void loadPlugins(const QStringList &feature_ids = QStringList());
 	const PluginMap& loadedPlugins() {return m_loadedPlugins;}
+	/// installed plugins by C++ class, see MainWindow::plugin<T>()
+	const TypedPluginMap& typedPlugins() {return m_typedPlugins;}
+	/// per plugin load times in order of installation, complete after loadingFinished()
+	const QList<LoadTime>& startupTimeline() const {return m_startupTimeline;}
 
 	Q_SIGNAL void loadingFinished();
 private:
 	MainWindow *mainWindow();
 
 	ManifestMap findPlugins();
-	bool loadPlugin(const QString feature_id);
+	PluginManifest* loadManifest(const QString &manifest_path);
+	PluginManifest* manifestFromIndex(const QString &manifest_path);
+	void updateManifestIndex(const QString &manifest_path, PluginManifest *manifest, bool is_plain);
+	void loadManifestIndex();
+	void saveManifestIndex();
+
+	bool resolveDependencies(const QString &feature_id, QStringList &load_order, QStringList &resolving);
+	void installTranslator(const QString &feature_id);
+	void startComponentLoading(const QString &feature_id);
 	bool loadPluginComponent(QQmlComponent *plugin_component, PluginManifest *manifest);
+	void registerTypedPlugin(Plugin *plugin);
 
-	//Q_SLOT void loadNextPlugin();
-	//Q_SLOT void continueLoading();
+	Q_SLOT void continueLoading();
+	void finishLoading();
 private:
 	PluginMap m_loadedPlugins;
+	TypedPluginMap m_typedPlugins;
 	ManifestMap m_manifestsToLoad;
-	//QString m_currentlyLoadedFeatureId;
-	//QQmlComponent *m_currentlyLoadedComponent;
+	QStringList m_featuresToInstall;
+	QMap<QString, QQmlComponent*> m_pluginComponents;
+	QElapsedTimer m_startupTimer;
+	QMap<QString, qint64> m_componentReadyMsec;
+	QList<LoadTime> m_startupTimeline;
+	QJsonObject m_manifestIndex;
+	bool m_manifestIndexDirty = false;
+	bool m_installing = false;
+	bool m_loadingFinished = false;
 };
 
 }}}
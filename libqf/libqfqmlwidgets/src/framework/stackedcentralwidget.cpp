@@ -51,6 +51,8 @@ bool StackedCentralWidget::setActivePart(int part_index, bool set_active)
 	PartWidget *pw = partWidget(part_index);
 	if(pw) {
 		qfDebug() << "featureId:" << pw->featureId();
+		if(set_active)
+			pw->ensureLazyInit();
 		QVariant ret_val(true);
 		int ix = pw->metaObject()->indexOfMethod("canActivate(QVariant)");
 		if(ix >= 0) {
@@ -35,8 +35,12 @@ QVariant BandDataModel::table(int row_no, const QString &table_name)
 BandDataModel* BandDataModel::createFromData(const QVariant &data, QObject *parent)
 {
 	BandDataModel *ret = nullptr;
-	// only tree table is supported currently
-	// so every data is tree table itself or treetable data for now
+	if(data.userType() == qMetaTypeId<qfu::Table>()) {
+		TableBandDataModel *m = new TableBandDataModel(parent);
+		m->setDataTable(data.value<qfu::Table>());
+		return m;
+	}
+	// every other data is tree table itself or treetable data
 	qfu::TreeTable tt;
 	if(data.userType() == qMetaTypeId<qfu::TreeTable>()) {
 		tt = data.value<qfu::TreeTable>();
@@ -61,13 +65,12 @@ TreeTableBandDataModel::TreeTableBandDataModel(QObject *parent)
 
 int TreeTableBandDataModel::rowCount()
 {
-	QF_TIME_SCOPE("TreeTableBandDataModel::rowCount");
-	return treeTable().rowCount();
+	return m_rowCount;
 }
 
 int TreeTableBandDataModel::columnCount()
 {
-	return treeTable().columnCount();
+	return m_columnCount;
 }
 
 QVariant TreeTableBandDataModel::tableData(const QString &key, BandDataModel::DataRole role)
@@ -99,26 +102,44 @@ QVariant TreeTableBandDataModel::headerData(int col_no, BandDataModel::DataRole
 
 QVariant TreeTableBandDataModel::dataByIndex(int row_no, int col_no, BandDataModel::DataRole role)
 {
-	QVariant ret;
-	qfu::TreeTableRow ttr = treeTable().row(row_no);
-	if(!ttr.isNull()) {
-		if(role == Qt::DisplayRole) {
-			ret = ttr.value(col_no);
-		}
+	if(row_no < 0 || row_no >= m_rowCount || role != Qt::DisplayRole)
+		return QVariant();
+	if(col_no < 0 || col_no >= m_columnCount) {
+		qfError() << QString("index %1 not found, column count: %2").arg(col_no).arg(m_columnCount);
+		return QVariant();
 	}
-	return ret;
+	return m_cells[row_no * m_columnCount + col_no];
 }
 
 QVariant TreeTableBandDataModel::dataByName(int row_no, const QString &col_name, BandDataModel::DataRole role)
 {
-	QVariant ret;
-	qfu::TreeTableRow ttr = treeTable().row(row_no);
-	if(!ttr.isNull()) {
-		if(role == Qt::DisplayRole) {
-			ret = ttr.value(col_name);
-		}
-	}
-	return ret;
+	if(row_no < 0 || row_no >= m_rowCount || role != Qt::DisplayRole)
+		return QVariant();
+	int col_no = columnIndex(col_name);
+	if(col_no >= 0)
+		return m_cells[row_no * m_columnCount + col_no];
+	/// row keyvals are rare, take them from tree
+	return treeTable().row(row_no).value(col_name);
+}
+
+int TreeTableBandDataModel::columnIndex(const QString &col_name)
+{
+	auto it = m_columnIndexes.constFind(col_name);
+	if(it != m_columnIndexes.constEnd())
+		return it.value();
+	int ix = treeTable().columns().indexOf(col_name);
+	m_columnIndexes[col_name] = ix;
+	return ix;
+}
+
+bool TreeTableBandDataModel::hasColumnOrKey(const QString &name)
+{
+	if(columnIndex(name) >= 0)
+		return true;
+	/// keyvals of first row are supposed to be the same as in other rows
+	if(m_rowCount == 0)
+		return false;
+	return treeTable().row(0).keyvals().hasProperty(name);
 }
 
 QVariant TreeTableBandDataModel::table(int row_no, const QString &table_name)
@@ -128,6 +149,14 @@ QVariant TreeTableBandDataModel::table(int row_no, const QString &table_name)
 	if(!ttr.isNull()) {
 		for(int i=0; i<ttr.tablesCount(); i++) {
 			qfu::TreeTable tt = ttr.table(i);
+			if(tt.value().userType() == qMetaTypeId<qfu::Table>()) {
+				/// nested Table has no name
+				if(table_name.isEmpty()) {
+					ret = tt.value();
+					break;
+				}
+				continue;
+			}
 			if(table_name.isEmpty() || tt.name() == table_name) {
 				ret = QVariant::fromValue(tt);
 				break;
@@ -149,6 +178,107 @@ const qf::core::utils::TreeTable& TreeTableBandDataModel::treeTable() const
 void TreeTableBandDataModel::setTreeTable(const qf::core::utils::TreeTable &tree_table)
 {
 	m_treeTable = tree_table;
+	loadCells();
 	setDataValid(true);
 }
 
+void TreeTableBandDataModel::loadCells()
+{
+	QF_TIME_SCOPE("TreeTableBandDataModel::loadCells");
+	m_columnIndexes.clear();
+	qfu::TreeTableColumns cols = m_treeTable.columns();
+	m_columnCount = cols.count();
+	QVector<int> col_types(m_columnCount);
+	for (int i = 0; i < m_columnCount; ++i) {
+		QString type_name = cols.column(i).property(qfu::TreeTable::KEY_TYPE).toString();
+		col_types[i] = QMetaType::type(type_name.toLatin1().constData());
+	}
+	QVariantList rows = qfu::SValue(m_treeTable.property(qfu::TreeTable::KEY_ROWS)).value().toList();
+	m_rowCount = rows.count();
+	m_cells = QVector<QVariant>(m_rowCount * m_columnCount);
+	QVariant *cell = m_cells.data();
+	for (int i = 0; i < m_rowCount; ++i) {
+		qfu::SValue row(rows[i]);
+		QVariantList row_values;
+		if(row.isList())
+			row_values = row.value().toList();
+		else if(row.isMap())
+			row_values = qfu::SValue(row.property(qfu::TreeTable::KEY_ROW)).value().toList();
+		for (int j = 0; j < m_columnCount; ++j, ++cell) {
+			if(j >= row_values.count())
+				continue;
+			const QVariant &v = row_values[j];
+			/// same as TreeTableRow::value(), SValue cells are not retyped
+			if(v.isValid() && v.userType() != qMetaTypeId<qfu::SValue>())
+				*cell = qfc::Utils::retypeVariant(v, col_types[j]);
+			else
+				*cell = v;
+		}
+	}
+}
+
+//=======================================================
+//                   TableBandDataModel
+//=======================================================
+TableBandDataModel::TableBandDataModel(QObject *parent)
+	: Super(parent)
+{
+}
+
+int TableBandDataModel::rowCount()
+{
+	return m_table.rowCount();
+}
+
+int TableBandDataModel::columnCount()
+{
+	return m_table.fields().count();
+}
+
+QVariant TableBandDataModel::headerData(int col_no, BandDataModel::DataRole role)
+{
+	QVariant ret;
+	if(role == Qt::DisplayRole && m_table.fields().isValidFieldIndex(col_no))
+		ret = m_table.fields().at(col_no).shortName();
+	return ret;
+}
+
+QVariant TableBandDataModel::dataByIndex(int row_no, int col_no, BandDataModel::DataRole role)
+{
+	if(row_no < 0 || row_no >= m_table.rowCount() || role != Qt::DisplayRole)
+		return QVariant();
+	return m_table.row(row_no).value(col_no);
+}
+
+QVariant TableBandDataModel::dataByName(int row_no, const QString &col_name, BandDataModel::DataRole role)
+{
+	int col_no = columnIndex(col_name);
+	if(col_no < 0) {
+		qfError() << "column" << col_name << "not found in band data table";
+		return QVariant();
+	}
+	return dataByIndex(row_no, col_no, role);
+}
+
+QString TableBandDataModel::dump() const
+{
+	return m_table.toString();
+}
+
+void TableBandDataModel::setDataTable(const qf::core::utils::Table &table)
+{
+	m_table = table;
+	m_columnIndexes.clear();
+	setDataValid(true);
+}
+
+int TableBandDataModel::columnIndex(const QString &col_name)
+{
+	auto it = m_columnIndexes.constFind(col_name);
+	if(it != m_columnIndexes.constEnd())
+		return it.value();
+	int ix = m_table.fields().fieldIndex(col_name);
+	m_columnIndexes[col_name] = ix;
+	return ix;
+}
+
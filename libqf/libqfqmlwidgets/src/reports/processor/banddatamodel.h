@@ -10,9 +10,12 @@
 #include "../../qmlwidgetsglobal.h"
 
 #include <qf/core/utils.h>
+#include <qf/core/utils/table.h>
 #include <qf/core/utils/treetable.h>
 
 #include <QObject>
+#include <QHash>
+#include <QVector>
 
 namespace qf {
 namespace qmlwidgets {
@@ -41,6 +44,10 @@ public:
 	Q_INVOKABLE virtual QVariant dataByName(int row_no, const QString &col_name, DataRole role = Qt::DisplayRole) {Q_UNUSED(row_no) Q_UNUSED(col_name) Q_UNUSED(role) return QVariant();}
 	virtual QVariant table(int row_no, const QString &table_name);
 	Q_INVOKABLE virtual QString dump() const {return QString();}
+	/// column names are resolved once per model, -1 if column does not exist
+	virtual int columnIndex(const QString &col_name) {Q_UNUSED(col_name) return -1;}
+	/// check if \a name can be read by dataByName(), used to report bad bindings before data rows are printed
+	virtual bool hasColumnOrKey(const QString &name) {return columnIndex(name) >= 0;}
 
 	Q_SLOT void invalidateData() {setDataValid(false);}
 public:
@@ -64,10 +71,45 @@ public:
 	QVariant table(int row_no, const QString &table_name) Q_DECL_OVERRIDE;
 	QString dump() const Q_DECL_OVERRIDE;
 
+	/// -1 for keyvals
+	int columnIndex(const QString &col_name) Q_DECL_OVERRIDE;
+	bool hasColumnOrKey(const QString &name) Q_DECL_OVERRIDE;
+
 	const qf::core::utils::TreeTable& treeTable() const;
 	void setTreeTable(const qf::core::utils::TreeTable &tree_table);
+private:
+	/// copy cells to m_cells, so they can be read without walking SValue tree
+	void loadCells();
 private:
 	qf::core::utils::TreeTable m_treeTable;
+	int m_rowCount = 0;
+	int m_columnCount = 0;
+	QVector<QVariant> m_cells; //< row major, values are retyped to column type
+	QHash<QString, int> m_columnIndexes; //< column name -> index, -1 for keyvals
+};
+
+/// band data read directly from Table rows, Table has neither keyvals nor nested tables
+class TableBandDataModel : public BandDataModel
+{
+	Q_OBJECT
+private:
+	typedef BandDataModel Super;
+public:
+	explicit TableBandDataModel(QObject *parent = 0);
+public:
+	int rowCount() Q_DECL_OVERRIDE;
+	int columnCount() Q_DECL_OVERRIDE;
+	QVariant headerData(int col_no, DataRole role = Qt::DisplayRole) Q_DECL_OVERRIDE;
+	QVariant dataByIndex(int row_no, int col_no, DataRole role = Qt::DisplayRole) Q_DECL_OVERRIDE;
+	QVariant dataByName(int row_no, const QString &col_name, DataRole role = Qt::DisplayRole) Q_DECL_OVERRIDE;
+	QString dump() const Q_DECL_OVERRIDE;
+	int columnIndex(const QString &col_name) Q_DECL_OVERRIDE;
+
+	const qf::core::utils::Table& dataTable() const {return m_table;}
+	void setDataTable(const qf::core::utils::Table &table);
+private:
+	qf::core::utils::Table m_table;
+	QHash<QString, int> m_columnIndexes;
 };
 
 }}}
@@ -149,9 +149,8 @@ ReportItem::PrintResult ReportItemPara::printHtml(HTMLElement & out)
 	QDomElement el_div = out.ownerDocument().createElement("div");
 	QDomElement el_p = out.ownerDocument().createElement("p");
 	QString text = paraText();
-	QRegExp rx = ReportItemMetaPaint::checkReportSubstitutionRegExp;
-	if(rx.exactMatch(text)) {
-		bool check_on = rx.capturedTexts().value(1) == "1";
+	bool check_on;
+	if(ReportItemMetaPaint::isCheckReportSubstitution(text, &check_on)) {
 		text = (check_on)? "X": QString();
 	}
 	setElementText(el_p, text);
@@ -1,6 +1,7 @@
 #include "reportitemframe.h"
 
 #include "reportitemband.h"
+#include "reportitemdetail.h"
 #include "reportpainter.h"
 #include "reportprocessor.h"
 
@@ -553,6 +554,16 @@ ReportItem::PrintResult ReportItemFrame::printMetaPaint(ReportItemMetaPaint *out
 		qfDebug() << "\t<<<< FRAME NOT FIT HEIGHT";
 		return checkPrintResult(PrintResult::createPrintAgain());
 	}
+	QString measured_height_key;
+	if(!canBreak() && m_indexToPrint == 0) {
+		/// frame is printed from beginning, check if the same data row did not fit already
+		measured_height_key = measuredHeightKey(bounding_rect);
+		if(isKnownNotFit(measured_height_key, bounding_rect)) {
+			qfDebug() << "\t<<<< FRAME KNOWN NOT FIT";
+			discardNotBreakablePrint(out, false);
+			return checkPrintResult(PrintResult::createPrintAgain());
+		}
+	}
 	frame_content_br.adjust(hinset(), vinset(), -hinset(), -vinset());
 
 	QList<double> column_sizes;
@@ -586,37 +597,9 @@ ReportItem::PrintResult ReportItemFrame::printMetaPaint(ReportItemMetaPaint *out
 			if(!canBreak()) {
 				// always delete current metapaint item when it cannot be broken
 				// when keepWithPrev is true, delete also metapaint item for all metapaint items in it's keepWithPrev chain
-				ReportItemFrame *parent_frame = this->parentFrame();
-				if(!parent_frame) {
-					qfWarning() << "Parent frame shall not be NULL!";
-				}
-				else {
-					QF_CHECK(parent_frame->itemToPrintAt(parent_frame->m_indexToPrint) == this, "Internal error!");
-					while(true) {
-						ReportItem *it = parent_frame->itemToPrintAt(parent_frame->m_indexToPrint);
-						QF_ASSERT(it != nullptr, "Internal error!", break);
-						//qfWarning() << "reseting index of:" << it;
-						it->resetIndexToPrintRecursively(ReportItem::IncludingParaTexts);
-						ReportItemMetaPaint *mpit = out->lastChild();
-						QF_ASSERT(mpit != nullptr, "Cannot delete NULL metapaint item!", break);
-						QF_SAFE_DELETE(mpit);
-						if(it->isKeepWithPrev()) {
-							if(parent_frame->m_indexToPrint > 0) {
-								parent_frame->m_indexToPrint--;
-								//qfWarning() << "new m_indexToPrint:" << parent_frame->m_indexToPrint;
-								continue;
-							}
-							else {
-								qfWarning() << "Index to print == 0: Internal error!";
-							}
-						}
-						break;
-					}
-				}
-				/*
-				resetIndexToPrintRecursively(ReportItem::IncludingParaTexts);
-				QF_SAFE_DELETE(mp);
-				*/
+				if(!measured_height_key.isEmpty() && !res.isPageBreak() && !res.isColumnBreak())
+					setMeasuredHeight(measured_height_key, bounding_rect.height(), false);
+				discardNotBreakablePrint(out, true);
 				return checkPrintResult(res);
 			}
 		}
@@ -671,6 +654,10 @@ ReportItem::PrintResult ReportItemFrame::printMetaPaint(ReportItemMetaPaint *out
 	}
 	qfDebug() << "\trenderedRect:" << metapaint_frame->renderedRect.toString();
 	res = checkPrintResult(res);
+	/// height of frame expanded to available space is not its measured height
+	if(!measured_height_key.isEmpty() && res.isPrintFinished()
+			&& !isExpandVerticalSprings() && designedRect.verticalUnit == Rect::UnitMM)
+		setMeasuredHeight(measured_height_key, metapaint_frame->renderedRect.height(), true);
 	setRenderedWidth(metapaint_frame->renderedRect.width());
 	setRenderedHeight(metapaint_frame->renderedRect.height());
 	//qfDebug().color(QFLog::Cyan) << "\t<<<< FRAME return:" << res.toString() << element.tagName() << "id:" << element.attribute("id");
@@ -693,4 +680,77 @@ void ReportItemFrame::resetIndexToPrintRecursively(bool including_para_texts)
 	*/
 }
 
+void ReportItemFrame::discardNotBreakablePrint(ReportItemMetaPaint *out, bool metapaint_created)
+{
+	ReportItemFrame *parent_frame = this->parentFrame();
+	if(!parent_frame) {
+		qfWarning() << "Parent frame shall not be NULL!";
+		return;
+	}
+	QF_CHECK(parent_frame->itemToPrintAt(parent_frame->m_indexToPrint) == this, "Internal error!");
+	bool delete_metapaint = metapaint_created;
+	while(true) {
+		ReportItem *it = parent_frame->itemToPrintAt(parent_frame->m_indexToPrint);
+		QF_ASSERT(it != nullptr, "Internal error!", break);
+		//qfWarning() << "reseting index of:" << it;
+		it->resetIndexToPrintRecursively(ReportItem::IncludingParaTexts);
+		if(delete_metapaint) {
+			ReportItemMetaPaint *mpit = out->lastChild();
+			QF_ASSERT(mpit != nullptr, "Cannot delete NULL metapaint item!", break);
+			QF_SAFE_DELETE(mpit);
+		}
+		/// items in keepWithPrev chain are always printed already
+		delete_metapaint = true;
+		if(it->isKeepWithPrev()) {
+			if(parent_frame->m_indexToPrint > 0) {
+				parent_frame->m_indexToPrint--;
+				//qfWarning() << "new m_indexToPrint:" << parent_frame->m_indexToPrint;
+				continue;
+			}
+			else {
+				qfWarning() << "Index to print == 0: Internal error!";
+			}
+		}
+		break;
+	}
+}
 
+QString ReportItemFrame::measuredHeightKey(const ReportItem::Rect &bounding_rect)
+{
+	/// width in hundredths of mm
+	QString ret = QString::number(qRound(bounding_rect.width() * 100));
+	for(QObject *o = this; o; o = o->parent()) {
+		ReportItemDetail *det = qobject_cast<ReportItemDetail*>(o);
+		if(det)
+			ret += '/' + QString::number(det->currentIndex());
+	}
+	return ret;
+}
+
+bool ReportItemFrame::isKnownNotFit(const QString &key, const ReportItem::Rect &bounding_rect)
+{
+	ReportProcessor *proc = processor(!qf::core::Exception::Throw);
+	int process_id = proc? proc->processId(): 0;
+	if(process_id != m_measuredHeightsProcessId) {
+		/// data could change since last processing
+		m_measuredHeights.clear();
+		m_measuredHeightsProcessId = process_id;
+		return false;
+	}
+	auto it = m_measuredHeights.constFind(key);
+	if(it == m_measuredHeights.constEnd())
+		return false;
+	const MeasuredHeight &mh = it.value();
+	if(mh.fits)
+		return mh.height > bounding_rect.height() + Epsilon;
+	return mh.height + Epsilon >= bounding_rect.height();
+}
+
+void ReportItemFrame::setMeasuredHeight(const QString &key, qreal height, bool fits)
+{
+	MeasuredHeight &mh = m_measuredHeights[key];
+	if(!fits && (mh.fits || mh.height > height))
+		return;
+	mh.height = height;
+	mh.fits = fits;
+}
@@ -10,6 +10,8 @@
 #include "reportitem.h"
 #include "../../qmlwidgetsglobal.h"
 
+#include <QHash>
+
 namespace qf {
 namespace qmlwidgets {
 namespace reports {
@@ -197,11 +199,27 @@ private:
 	QQmlListProperty<ReportItem> items();
 	int itemCount() const;
 	ReportItem* itemAt(int index);
+
+	/// Height of frame which cannot break measured by previous print attempt of the same data row.
+	struct MeasuredHeight
+	{
+		qreal height = 0;
+		bool fits = false; ///< false means that frame does not fit into \a height
+	};
+	/// key of data row printed by frame, it consists of current indexes of all the parent details and available width
+	QString measuredHeightKey(const Rect &bounding_rect);
+	/// @return true if it is known from previous print attempt, that frame cannot be printed into \a bounding_rect
+	bool isKnownNotFit(const QString &key, const Rect &bounding_rect);
+	void setMeasuredHeight(const QString &key, qreal height, bool fits);
+	/// remove metapaint items of frame and of its keepWithPrev chain, frame will be printed again on next page
+	void discardNotBreakablePrint(ReportItemMetaPaint *out, bool metapaint_created);
 protected:
 	//! children, kterym se ma zacit pri tisku
 	int m_indexToPrint;
 private:
 	QList<ReportItem*> m_items;
+	QHash<QString, MeasuredHeight> m_measuredHeights;
+	int m_measuredHeightsProcessId = 0;
 };
 
 }}}
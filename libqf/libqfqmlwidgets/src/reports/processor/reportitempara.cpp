@@ -2,6 +2,9 @@
 
 #include "reportprocessor.h"
 #include "reportpainter.h"
+#include "reportitemband.h"
+#include "reportitemdetail.h"
+#include "banddatamodel.h"
 
 #include <qf/core/log.h>
 #include <qf/core/assert.h>
@@ -76,9 +79,8 @@ ReportItem::PrintResult ReportItemPara::printMetaPaintChildren(ReportItemMetaPai
 		device_bounding_rect = qmlwidgets::graphics::mm2device(bounding_rect, processor()->paintDevice());
 
 		bool render_check_mark = false;
-		QRegExp rx = ReportItemMetaPaint::checkReportSubstitutionRegExp;
-		if(rx.exactMatch(text_to_layout)) {
-			//bool check_on = rx.capturedTexts().value(1) == "1";
+		ReportItemMetaPaintText::ShapedText shaped_text;
+		if(ReportItemMetaPaint::isCheckReportSubstitution(text_to_layout)) {
 			device_bounding_rect = font_metrics.boundingRect('X');
 			render_check_mark = true;
 			m_indexToPrint += text_to_layout.length();
@@ -93,8 +95,14 @@ ReportItem::PrintResult ReportItemPara::printMetaPaintChildren(ReportItemMetaPai
 				qreal leading = font_metrics.leading();
 				qreal height = 0;
 				qreal width = 0;
-				textLayout.setFont(style.font());
-				textLayout.setTextOption(text_option);
+				int laid_out_lines = 0;
+				/// lines are shaped left aligned, so glyph runs can be reused by ReportItemMetaPaintText::paint()
+				bool store_shaped_text = ReportItemMetaPaintText::isShapedTextAlignment(text_option.alignment());
+				QTextOption layout_option = text_option;
+				if(store_shaped_text)
+					layout_option.setAlignment(Qt::AlignLeft | Qt::AlignAbsolute);
+				textLayout.setFont(QFont(style.font(), processor()->paintDevice()));
+				textLayout.setTextOption(layout_option);
 				textLayout.setText(text_to_layout);
 				textLayout.beginLayout();
 				bool finished = false;
@@ -128,6 +136,7 @@ ReportItem::PrintResult ReportItemPara::printMetaPaintChildren(ReportItemMetaPai
 							line.setPosition(QPointF(0., height));
 							height += line.height();
 							width = qMax(width, line.naturalTextWidth());
+							laid_out_lines++;
 						}
 					}
 					if(finished) {
@@ -135,6 +144,13 @@ ReportItem::PrintResult ReportItemPara::printMetaPaintChildren(ReportItemMetaPai
 					}
 				}
 				textLayout.endLayout();
+				if(store_shaped_text) {
+					QPaintDevice *device = processor()->paintDevice();
+					shaped_text.dpiX = device->logicalDpiX();
+					shaped_text.dpiY = device->logicalDpiY();
+					for (int i = 0; i < laid_out_lines; ++i)
+						shaped_text.lines << ReportItemMetaPaintText::shapedLine(textLayout.lineAt(i));
+				}
 				device_bounding_rect.setWidth(width);
 				device_bounding_rect.setHeight(height);
 			}
@@ -159,6 +175,10 @@ ReportItem::PrintResult ReportItemPara::printMetaPaintChildren(ReportItemMetaPai
 			mt->textOption = text_option;
 			mt->renderedRect = device_bounding_rect;
 			mt->renderedRect.flags = designedRect.flags;
+			if(shaped_text.isValid()) {
+				shaped_text.text = mt->text;
+				mt->addShapedText(shaped_text);
+			}
 		}
 		//qfDebug().color(QFLog::Green, QFLog::Red) << "\tleading:" << processor()->fontMetrics(style.font).leading() << "\theight:" << processor()->fontMetrics(style.font).height();
 		qfDebug() << "\tchild rendered rect:" << device_bounding_rect.toString();
@@ -194,7 +214,7 @@ QString ReportItemPara::paraText()
 		ret = m_getTextCppFn();
 	}
 	else {
-		ret = text();
+		ret = boundText();
 	}
 	{
 		static QString new_line;
@@ -211,3 +231,62 @@ QString ReportItemPara::paraText()
 	return ret;
 }
 
+void ReportItemPara::compileTextBinding()
+{
+	m_textBinding = TextBinding();
+	const QString txt = text();
+	m_textBinding.text = txt;
+	static const QString open_tag = QStringLiteral("{{");
+	static const QString close_tag = QStringLiteral("}}");
+	int pos = 0;
+	while(true) {
+		int ix1 = txt.indexOf(open_tag, pos);
+		int ix2 = (ix1 < 0)? -1: txt.indexOf(close_tag, ix1 + open_tag.length());
+		if(ix2 < 0) {
+			m_textBinding.literals << txt.mid(pos);
+			break;
+		}
+		m_textBinding.literals << txt.mid(pos, ix1 - pos);
+		m_textBinding.fields << txt.mid(ix1 + open_tag.length(), ix2 - ix1 - open_tag.length()).trimmed();
+		pos = ix2 + close_tag.length();
+	}
+}
+
+void ReportItemPara::resolveTextBinding(BandDataModel *model)
+{
+	qfLogFuncFrame() << m_textBinding.fields;
+	m_textBinding.model = model;
+	m_textBinding.columns.clear();
+	for(const QString &field : m_textBinding.fields) {
+		int ix = model->columnIndex(field);
+		if(ix < 0 && !model->hasColumnOrKey(field))
+			qfError() << this << "text field:" << field << "not found in band data, text:" << m_textBinding.text;
+		m_textBinding.columns << ix;
+	}
+}
+
+QString ReportItemPara::boundText()
+{
+	if(m_textBinding.text != text() || m_textBinding.literals.isEmpty())
+		compileTextBinding();
+	if(m_textBinding.fields.isEmpty())
+		return m_textBinding.text;
+	ReportItemDetail *detail = qf::core::Utils::findParent<ReportItemDetail*>(this, false);
+	ReportItemBand *band = detail? qobject_cast<ReportItemBand*>(detail->parent()): nullptr;
+	BandDataModel *model = band? band->model(): nullptr;
+	if(!model) {
+		qfError() << this << "text fields can be used in Detail of Band with data only, text:" << m_textBinding.text;
+		return m_textBinding.text;
+	}
+	if(m_textBinding.model != model)
+		resolveTextBinding(model);
+	int row_no = detail->currentIndex();
+	QString ret = m_textBinding.literals.value(0);
+	for (int i = 0; i < m_textBinding.fields.count(); ++i) {
+		int col_no = m_textBinding.columns[i];
+		QVariant v = (col_no >= 0)? model->dataByIndex(row_no, col_no): model->dataByName(row_no, m_textBinding.fields[i]);
+		ret += v.toString();
+		ret += m_textBinding.literals.value(i + 1);
+	}
+	return ret;
+}
@@ -11,6 +11,9 @@
 #include "../../qmlwidgetsglobal.h"
 
 #include <QJSValue>
+#include <QPointer>
+#include <QStringList>
+#include <QVector>
 
 #include <functional>
 
@@ -18,6 +21,10 @@ namespace qf {
 namespace qmlwidgets {
 namespace reports {
 
+class BandDataModel;
+
+/// Para text can contain {{field}} placeholders, they are replaced by field values of parent detail current row.
+/// Placeholders are compiled to column indexes once per band data, so simple data cells do not need textFn.
 class QFQMLWIDGETS_DECL_EXPORT ReportItemPara : public ReportItemFrame
 {
 	Q_OBJECT
@@ -59,9 +66,23 @@ public:
 	virtual void resetIndexToPrintRecursively(bool including_para_texts);
 	virtual PrintResult printMetaPaint(ReportItemMetaPaint *out, const Rect &bounding_rect);
 	virtual PrintResult printHtml(HTMLElement &out);
+private:
+	struct TextBinding
+	{
+		QString text; ///< text binding was compiled from
+		QStringList literals; ///< text between placeholders, there is one literal more than fields
+		QStringList fields;
+		QPointer<BandDataModel> model; ///< model fields are resolved in
+		QVector<int> columns; ///< -1 for fields read by name, like keyvals
+	};
+	/// text() with placeholders replaced by detail row data
+	QString boundText();
+	void compileTextBinding();
+	void resolveTextBinding(BandDataModel *model);
 private:
 	GetTextFunction m_getTextCppFn = nullptr;
 	QJSValue m_getTextJsFn;
+	TextBinding m_textBinding;
 };
 
 }}}
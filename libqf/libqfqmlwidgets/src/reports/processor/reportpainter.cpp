@@ -14,6 +14,7 @@
 #include <qf/core/assert.h>
 
 #include <QJsonDocument>
+#include <QHash>
 
 #include <typeinfo>
 
@@ -28,6 +29,19 @@ const QString ReportItemMetaPaint::pageCountReportSubstitution = "@{n}";
 const QString ReportItemMetaPaint::checkReportSubstitution = "@{check:${STATE}}";
 const QRegExp ReportItemMetaPaint::checkReportSubstitutionRegExp = QRegExp("@\\{check:(\\d)\\}");
 
+bool ReportItemMetaPaint::isCheckReportSubstitution(const QString &text, bool *check_on)
+{
+	static const QString check_prefix = QStringLiteral("@{check:");
+	if(!text.startsWith(check_prefix))
+		return false;
+	QRegExp rx = checkReportSubstitutionRegExp;
+	if(!rx.exactMatch(text))
+		return false;
+	if(check_on)
+		*check_on = rx.capturedTexts().value(1) == "1";
+	return true;
+}
+
 ReportItemMetaPaint::ReportItemMetaPaint()
 	: Super(NULL)
 {
@@ -72,7 +86,8 @@ void ReportItemMetaPaint::paint(ReportPainter *painter, unsigned mode)
 {
 	foreach(Super *_it, children()) {
 		ReportItemMetaPaint *it = static_cast<ReportItemMetaPaint*>(_it);
-		it->paint(painter, mode);
+		if(painter->isItemToPaint(it))
+			it->paint(painter, mode);
 	}
 }
 
@@ -556,7 +571,6 @@ void ReportItemMetaPaintText::paint(ReportPainter *painter, unsigned mode)
 		}
 	}
 
-	QFontMetricsF font_metrics = QFontMetricsF(painter->font(), painter->device());
 	//ReportItemMetaPaintFrame::paint(painter);
 	//qfDebug() << "\trenderedRect:" << renderedRect.toString();
 	//painter->setBrush(brush);
@@ -588,6 +602,21 @@ void ReportItemMetaPaintText::paint(ReportPainter *painter, unsigned mode)
 	painter->drawText(br, flags, s);
 #else
 	/// to samy jako v #if 0, jen se to tiskne stejnym zpusobem, jako se to kompilovalo, coz muze ukazat, proc to vypada jinak, nez cekam
+	if(isShapedTextAlignment(textOption.alignment())) {
+		/// replay glyph runs shaped by processor or by previous paint
+		const ShapedText &shaped_text = shapedText(painter, s, br.width());
+		for(const ShapedText::Line &line : shaped_text.lines) {
+			QPointF pos = br.topLeft();
+			if(textOption.alignment() & Qt::AlignRight)
+				pos.rx() += br.width() - line.naturalWidth;
+			else if(textOption.alignment() & Qt::AlignHCenter)
+				pos.rx() += (br.width() - line.naturalWidth) / 2;
+			for(const QGlyphRun &glyph_run : line.glyphRuns)
+				painter->drawGlyphRun(pos, glyph_run);
+		}
+		return;
+	}
+	QFontMetricsF font_metrics = ReportPainter::fontMetrics(painter->font(), painter->device());
 	qreal leading = font_metrics.leading();
 	qreal height = 0;
 	//qreal width = 0;
@@ -616,6 +645,82 @@ void ReportItemMetaPaintText::paint(ReportPainter *painter, unsigned mode)
 #endif
 }
 
+int ReportItemMetaPaintText::shapedTextIndex(int dpi_x, int dpi_y) const
+{
+	for (int i = 0; i < m_shapedTexts.count(); ++i) {
+		const ShapedText &st = m_shapedTexts[i];
+		if(st.dpiX == dpi_x && st.dpiY == dpi_y)
+			return i;
+	}
+	return -1;
+}
+
+void ReportItemMetaPaintText::addShapedText(const ReportItemMetaPaintText::ShapedText &shaped_text)
+{
+	int ix = shapedTextIndex(shaped_text.dpiX, shaped_text.dpiY);
+	if(ix < 0)
+		m_shapedTexts << shaped_text;
+	else
+		m_shapedTexts[ix] = shaped_text;
+}
+
+ReportItemMetaPaintText::ShapedText::Line ReportItemMetaPaintText::shapedLine(const QTextLine &line)
+{
+	ShapedText::Line ret;
+	ret.glyphRuns = line.glyphRuns();
+	ret.naturalWidth = line.naturalTextWidth();
+	return ret;
+}
+
+ReportItemMetaPaintText::ShapedText ReportItemMetaPaintText::shapeText(const QString &s, const QFont &font, QPaintDevice *device, qreal line_width)
+{
+	ShapedText ret;
+	ret.text = s;
+	ret.dpiX = device->logicalDpiX();
+	ret.dpiY = device->logicalDpiY();
+	QFont device_font(font, device);
+	qreal leading = ReportPainter::fontMetrics(device_font, device).leading();
+	qreal height = 0;
+	QTextLayout text_layout;
+	QTextOption opt;
+	opt.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+	opt.setAlignment(Qt::AlignLeft | Qt::AlignAbsolute);
+	text_layout.setTextOption(opt);
+	text_layout.setFont(device_font);
+	text_layout.setText(s);
+	text_layout.beginLayout();
+	while (1) {
+		QTextLine line = text_layout.createLine();
+		if(!line.isValid()) {
+			break;
+		}
+		line.setLineWidth(line_width);
+		if(height > 0)
+			height += leading;
+		line.setPosition(QPointF(0., height));
+		height += line.height();
+	}
+	text_layout.endLayout();
+	for (int i = 0; i < text_layout.lineCount(); ++i)
+		ret.lines << shapedLine(text_layout.lineAt(i));
+	return ret;
+}
+
+const ReportItemMetaPaintText::ShapedText &ReportItemMetaPaintText::shapedText(QPainter *painter, const QString &s, qreal line_width)
+{
+	QPaintDevice *device = painter->device();
+	int ix = shapedTextIndex(device->logicalDpiX(), device->logicalDpiY());
+	if(ix < 0) {
+		ix = m_shapedTexts.count();
+		m_shapedTexts << shapeText(s, font, device, line_width);
+	}
+	else if(m_shapedTexts[ix].text != s) {
+		/// text with page count substitution is shaped again when page count changes
+		m_shapedTexts[ix] = shapeText(s, font, device, line_width);
+	}
+	return m_shapedTexts[ix];
+}
+
 QString ReportItemMetaPaintText::dump(int indent)
 {
 	QString indent_str;
@@ -640,12 +745,11 @@ void ReportItemMetaPaintCheck::paint(ReportPainter * painter, unsigned mode)
 	if(mode != PaintFill)
 		return;
 
-	QFontMetricsF font_metrics = QFontMetricsF(painter->font(), painter->device());
+	QFontMetricsF font_metrics = ReportPainter::fontMetrics(painter->font(), painter->device());
 
 	//qfInfo() << "paint" << text;
-	QRegExp rx = ReportItemMetaPaint::checkReportSubstitutionRegExp;
-	if(rx.exactMatch(text)) {
-		bool check_on = rx.capturedTexts().value(1) == "1";
+	bool check_on;
+	if(isCheckReportSubstitution(text, &check_on)) {
 		/// V tabulkach by jako check OFF slo netisknout vubec nic,
 		/// ale na ostatnich mistech repotu je to zavadejici .
 
@@ -769,6 +873,20 @@ ReportPainter::ReportPainter(QPaintDevice *device)
 	setMarkEditableSqlText(false);
 }
 
+QFontMetricsF ReportPainter::fontMetrics(const QFont &font, QPaintDevice *device)
+{
+	if(!device)
+		return QFontMetricsF(font);
+	static QHash<QString, QFontMetricsF> s_fontMetrics;
+	QString key = font.key() + '/' + QString::number(device->logicalDpiX()) + 'x' + QString::number(device->logicalDpiY());
+	auto it = s_fontMetrics.constFind(key);
+	if(it != s_fontMetrics.constEnd())
+		return it.value();
+	QFontMetricsF ret(font, device);
+	s_fontMetrics.insert(key, ret);
+	return ret;
+}
+
 void ReportPainter::drawMetaPaint(ReportItemMetaPaint *item)
 {
 	if(item) {
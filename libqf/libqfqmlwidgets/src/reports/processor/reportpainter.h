@@ -19,6 +19,10 @@
 #include <QObject>
 #include <QPainter>
 #include <QPrinter>
+#include <QSet>
+#include <QGlyphRun>
+#include <QTextOption>
+#include <QTextLayout>
 
 namespace qf {
 namespace qmlwidgets {
@@ -42,6 +46,8 @@ public:
 	static const QString pageCountReportSubstitution;
 	static const QRegExp checkReportSubstitutionRegExp;
 	static const QString checkReportSubstitution;
+	/// test \a text against checkReportSubstitutionRegExp, regexp is not copied for texts which cannot match
+	static bool isCheckReportSubstitution(const QString &text, bool *check_on = nullptr);
 	//static const QString checkOffReportSubstitution;
 	typedef qf::qmlwidgets::graphics::Rect Rect;
 	typedef qf::qmlwidgets::graphics::Size Size;
@@ -183,6 +189,29 @@ public:
 	QTextOption textOption;
 	QString editGrants;
 public:
+	/// Text shaped for one device resolution.
+	/// Lines are shaped left aligned, horizontal alignment is applied when painted.
+	struct ShapedText
+	{
+		struct Line
+		{
+			QList<QGlyphRun> glyphRuns; ///< glyph positions are relative to text top left corner
+			qreal naturalWidth = 0;
+		};
+		QString text;
+		int dpiX = 0;
+		int dpiY = 0;
+		QList<Line> lines;
+
+		bool isValid() const {return dpiX > 0;}
+	};
+	/// store text shaped by processor, so painting on device with the same resolution does not shape it again
+	void addShapedText(const ShapedText &shaped_text);
+	/// text alignments which can be painted from ShapedText, justified text is layouted on every paint
+	static bool isShapedTextAlignment(Qt::Alignment alignment) {return !(alignment & Qt::AlignJustify);}
+	/// glyph runs of layouted lines
+	static ShapedText::Line shapedLine(const QTextLine &line);
+
 	void paint(ReportPainter *painter, unsigned mode = PaintAll) Q_DECL_OVERRIDE;
 	bool isPointInside(const QPointF &p) Q_DECL_OVERRIDE {Q_UNUSED(p); return false;}
 
@@ -193,6 +222,17 @@ public:
 	ReportItemMetaPaintText(ReportItemMetaPaint *parent, ReportItem *report_item)
 	: ReportItemMetaPaint(parent, report_item) {}
 	~ReportItemMetaPaintText() Q_DECL_OVERRIDE {}
+protected:
+	/// layout \a s the same way as processor does
+	static ShapedText shapeText(const QString &s, const QFont &font, QPaintDevice *device, qreal line_width);
+	/// shaped \a s for painter device resolution, text is shaped and cached if it is not done yet
+	const ShapedText& shapedText(QPainter *painter, const QString &s, qreal line_width);
+private:
+	/// @return -1 if text is not shaped for device resolution
+	int shapedTextIndex(int dpi_x, int dpi_y) const;
+private:
+	/// usually one for screen and one for printer
+	QList<ShapedText> m_shapedTexts;
 };
 
 
@@ -241,12 +281,18 @@ public:
 	//virtual void paintPage();
 	bool isMarkEditableSqlText() const {return m_markEditableSqlText;}
 	void setMarkEditableSqlText(bool b) {m_markEditableSqlText = b;}
+	/// font metrics are cached per font and device resolution, use only in GUI thread
+	static QFontMetricsF fontMetrics(const QFont &font, QPaintDevice *device);
+	/// paint only \a items, their parents have to be in set too, empty set paints everything
+	void setItemsToPaint(const QSet<ReportItemMetaPaint*> &items) {m_itemsToPaint = items;}
+	bool isItemToPaint(ReportItemMetaPaint *it) const {return m_itemsToPaint.isEmpty() || m_itemsToPaint.contains(it);}
 public:
 	/// field umoznujici zobrazit pocet stranek reportu, jinak to asi nejde, behem kompilace nevim, kolik jich nakonec bude.
 	int pageCount;
 protected:
 	ReportItemMetaPaint *f_selectedItem;
 	bool m_markEditableSqlText;
+	QSet<ReportItemMetaPaint*> m_itemsToPaint;
 };
 
 }}}
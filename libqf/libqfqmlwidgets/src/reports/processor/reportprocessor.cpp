@@ -83,6 +83,10 @@ QUrl ReportProcessor::reportUrl() const
 
 void ReportProcessor::setTableData(const QString &key, const QVariant &table_data)
 {
+	if(table_data.userType() == qMetaTypeId<qfu::TreeTable>() || table_data.userType() == qMetaTypeId<qfu::Table>()) {
+		setData(key, table_data);
+		return;
+	}
 	qfu::TreeTable tt;
 	tt.setVariant(table_data);
 	setTableData(key, tt);
@@ -94,6 +98,11 @@ void ReportProcessor::setTableData(const QString &key, const qf::core::utils::Tr
 	setData(key, v);
 }
 
+void ReportProcessor::setTableData(const QString &key, const qf::core::utils::Table &table_data)
+{
+	setData(key, QVariant::fromValue(table_data));
+}
+
 void ReportProcessor::setData(const QString &key, const QVariant &data)
 {
 	//qfInfo() << "ReportProcessor _data:" << _data.toString().mid(0, 100);
@@ -150,6 +159,7 @@ void ReportProcessor::process(ReportProcessor::ProcessorMode mode)
 	QF_TIME_SCOPE("ReportProcessor::process");
 	if(mode == FirstPage || mode == AllPages) {
 		setProcessedPageNo(0);
+		m_processId++;
 		QF_SAFE_DELETE(m_processorOutput);
 		if(documentInstanceRoot()) {
 			m_processorOutput = new ReportItemMetaPaintReport(documentInstanceRoot());
@@ -206,7 +216,7 @@ ReportItem::PrintResult ReportProcessor::processPage(ReportItemMetaPaint *out)
 
 QFontMetricsF ReportProcessor::fontMetrics(const QFont &font)
 {
-	return QFontMetricsF(font, paintDevice());
+	return ReportPainter::fontMetrics(font, paintDevice());
 }
 
 void ReportProcessor::processHtml(QDomElement & el_body, const HtmlExportOptions &opts)
@@ -13,6 +13,7 @@
 #include "reportdocument.h"
 //#include "reportprocessorcontext.h"
 
+#include <qf/core/utils/table.h>
 #include <qf/core/utils/treetable.h>
 //#include <qf/core/utils/searchdirs.h>
 #include <qf/core/assert.h>
@@ -67,6 +68,8 @@ public:
 	//--ReportDocument& reportRef() {return fReport;}
 	void setTableData(const QString &key, const QVariant &table_data);
 	void setTableData(const QString &key, const qf::core::utils::TreeTable &table_data);
+	/// flat table is read by band directly, without conversion to tree table
+	void setTableData(const QString &key, const qf::core::utils::Table &table_data);
 	void setData(const QString &key, const QVariant& data);
 	QVariant data(const QString &key) const {return m_data.value(key);}
 
@@ -95,6 +98,8 @@ public:
 	int pageCount();
 
 	ReportItemMetaPaintReport* processorOutput() {return m_processorOutput;}
+	/// changes with every processing from the first page, print attempts cached by items are valid for one processing only
+	int processId() const {return m_processId;}
 	ReportItemReport* documentInstanceRoot();
 public:
 	/// vlozi do el_body report ve formatu HTML
@@ -131,6 +136,7 @@ private:
 	ReportItemReport *m_documentInstanceRoot = nullptr;
 	//! Root of ReportItemMetaPaint objects tree generated by \a printMetaPaint() method.
 	ReportItemMetaPaintReport *m_processorOutput = nullptr;
+	int m_processId = 0;
 
 	ReportItem::PrintResult m_singlePageProcessResult;
 
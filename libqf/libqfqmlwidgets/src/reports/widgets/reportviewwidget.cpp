@@ -38,9 +38,13 @@
 #include <QDomDocument>
 #include <QDir>
 #include <QApplication>
+#include <QPaintEvent>
+#include <QImage>
+#include <QtMath>
 //#include <QStyle>
 
 #include <typeinfo>
+#include <cmath>
 
 namespace qfu = qf::core::utils;
 using namespace qf::qmlwidgets::reports;
@@ -224,6 +228,110 @@ void ReportViewWidget::ScrollArea::verticalScrollBarValueChanged(int value)
 	old_val = value;
 }
 
+//====================================================
+//        ReportViewWidget::PageIndex
+//====================================================
+void ReportViewWidget::PageIndex::build(ReportItemMetaPaintFrame *page)
+{
+	m_page = page;
+	m_entries.clear();
+	m_cells.clear();
+	m_columnCount = m_rowCount = 0;
+	if(!page)
+		return;
+	m_pageRect = page->renderedRect;
+	m_columnCount = qCeil(m_pageRect.width() / CellSize) + 1;
+	m_rowCount = qCeil(m_pageRect.height() / CellSize) + 1;
+	m_cells.resize(m_columnCount * m_rowCount);
+	addItem(page);
+}
+
+void ReportViewWidget::PageIndex::addItem(ReportItemMetaPaint *item)
+{
+	Entry e;
+	e.item = item;
+	e.rect = item->renderedRect;
+	/// text is aligned in its parent rect during painting
+	ReportItemMetaPaint *parent = item->parent();
+	if(parent && dynamic_cast<ReportItemMetaPaintText*>(item))
+		e.rect = e.rect.united(parent->renderedRect);
+	int ix = m_entries.count();
+	m_entries << e;
+	QRect cells = cellRange(e.rect);
+	for(int row=cells.top(); row<=cells.bottom(); row++)
+		for(int col=cells.left(); col<=cells.right(); col++)
+			m_cells[row * m_columnCount + col] << ix;
+	for(int i=0; i<item->childrenCount(); i++)
+		addItem(item->child(i));
+}
+
+QRect ReportViewWidget::PageIndex::cellRange(const QRectF &mm_rect) const
+{
+	/// pens can paint little bit outside of item rect
+	QRectF r = mm_rect.adjusted(-1, -1, 1, 1).translated(-m_pageRect.topLeft());
+	int col1 = qBound(0, (int)std::floor(r.left() / CellSize), m_columnCount - 1);
+	int col2 = qBound(0, (int)std::floor(r.right() / CellSize), m_columnCount - 1);
+	int row1 = qBound(0, (int)std::floor(r.top() / CellSize), m_rowCount - 1);
+	int row2 = qBound(0, (int)std::floor(r.bottom() / CellSize), m_rowCount - 1);
+	return QRect(QPoint(col1, row1), QPoint(col2, row2));
+}
+
+QSet<ReportItemMetaPaint*> ReportViewWidget::PageIndex::itemsToPaint(const QRectF &mm_rect) const
+{
+	QSet<ReportItemMetaPaint*> ret;
+	if(!m_page)
+		return ret;
+	QRectF r = mm_rect.adjusted(-1, -1, 1, 1);
+	QRect cells = cellRange(mm_rect);
+	for(int row=cells.top(); row<=cells.bottom(); row++) {
+		for(int col=cells.left(); col<=cells.right(); col++) {
+			for(int ix : m_cells[row * m_columnCount + col]) {
+				const Entry &e = m_entries[ix];
+				if(ret.contains(e.item) || !e.rect.intersects(r))
+					continue;
+				for(ReportItemMetaPaint *it = e.item; it && !ret.contains(it); it = it->parent())
+					ret << it;
+			}
+		}
+	}
+	/// never return empty set, it would paint whole page
+	ret << m_page;
+	return ret;
+}
+
+ReportItemMetaPaint* ReportViewWidget::PageIndex::itemAt(const QPointF &mm_point) const
+{
+	ReportItemMetaPaint *ret = nullptr;
+	if(!m_page || !m_page->isPointInside(mm_point))
+		return ret;
+	int ret_ix = -1;
+	QRect cells = cellRange(QRectF(mm_point, QSizeF()));
+	QSet<int> visited;
+	for(int row=cells.top(); row<=cells.bottom(); row++) {
+		for(int col=cells.left(); col<=cells.right(); col++) {
+			for(int ix : m_cells[row * m_columnCount + col]) {
+				if(visited.contains(ix))
+					continue;
+				visited << ix;
+				ReportItemMetaPaint *it = m_entries[ix].item;
+				bool inside = true;
+				for(ReportItemMetaPaint *it1 = it; it1 && inside; it1 = it1->parent())
+					inside = it1->isPointInside(mm_point);
+				if(!inside)
+					continue;
+				/// if more items are under cursor, then select one with smaller area,
+				/// the later one in paint order in case of the same area to select top level item in stacked layout
+				if(!ret || it->renderedRect.area() < ret->renderedRect.area()
+						|| (it->renderedRect.area() == ret->renderedRect.area() && ix > ret_ix)) {
+					ret = it;
+					ret_ix = ix;
+				}
+			}
+		}
+	}
+	return ret;
+}
+
 //====================================================
 //        ReportViewWidget::PainterWidget
 //====================================================
@@ -244,27 +352,82 @@ void ReportViewWidget::PainterWidget::paintEvent(QPaintEvent *ev)
 {
 	//qfDebug() << QF_FUNC_NAME;
 	QWidget::paintEvent(ev);
-	ReportPainter painter(this);
+	ReportViewWidget *w = reportViewWidget();
+	if(m_tilesPage != w->currentPage() || m_tilesScale != w->scale()) {
+		invalidateTiles();
+		m_tilesPage = w->currentPage();
+		m_tilesScale = w->scale();
+	}
+	/// page is painted by tiles, only tiles which are not rendered yet are painted by report painter
+	QPainter painter(this);
+	QRect r = ev->rect();
+	int col1 = r.left() / TileSize;
+	int col2 = r.right() / TileSize;
+	int row1 = r.top() / TileSize;
+	int row2 = r.bottom() / TileSize;
+	for(int row=row1; row<=row2; row++) {
+		for(int col=col1; col<=col2; col++) {
+			quint64 key = (((quint64)col) << 32) | (quint32)row;
+			auto it = m_tiles.constFind(key);
+			if(it == m_tiles.constEnd())
+				it = m_tiles.insert(key, renderTile(col, row));
+			painter.drawPixmap(col * TileSize, row * TileSize, it.value());
+		}
+	}
+	//painter.setPen(p);
+	//QRect r(0, 0, 210, 297);
+	//painter.drawText(r, Qt::AlignCenter | Qt::TextWordWrap, "<qt>Qt <b>kjutyn</b> <br>indian</qt>");
+}
+
+QPixmap ReportViewWidget::PainterWidget::renderTile(int col, int row)
+{
+	QRect tile_rect(col * TileSize, row * TileSize, TileSize, TileSize);
+	int dpr = devicePixelRatio();
+	/// report is laid out in mm, tile must have the same resolution as widget
+	QImage img(tile_rect.size() * dpr, QImage::Format_ARGB32_Premultiplied);
+	img.setDevicePixelRatio(dpr);
+	img.setDotsPerMeterX(qRound(logicalDpiX() / 0.0254));
+	img.setDotsPerMeterY(qRound(logicalDpiY() / 0.0254));
+	ReportPainter painter(&img);
 	painter.setMarkEditableSqlText(true);
+	painter.translate(-tile_rect.topLeft());
 
 	/// nakresli ramecek a stranku
-	//painter.setBrush(Qt::yellow);
-	QRect r1 = rect();
-	painter.fillRect(r1, QBrush(QColor("#CCFF99")));
-
-	reportViewWidget()->setupPainter(&painter);
-	ReportItemMetaPaintFrame *frm = reportViewWidget()->currentPage();
-	if(!frm) return;
+	painter.fillRect(tile_rect, QBrush(QColor("#CCFF99")));
+
+	ReportViewWidget *w = reportViewWidget();
+	w->setupPainter(&painter);
+	ReportItemMetaPaintFrame *frm = w->currentPage();
+	if(!frm) {
+		painter.end();
+		return QPixmap::fromImage(img);
+	}
 	graphics::Rect r = graphics::mm2device(frm->renderedRect, painter.device());
 	painter.fillRect(r, QColor("white"));
 	painter.setPen(QColor("teal"));
 	painter.setBrush(QBrush());
 	painter.drawRect(r);
 
-	painter.drawMetaPaint(reportViewWidget()->currentPage());
-	//painter.setPen(p);
-	//QRect r(0, 0, 210, 297);
-	//painter.drawText(r, Qt::AlignCenter | Qt::TextWordWrap, "<qt>Qt <b>kjutyn</b> <br>indian</qt>");
+	QRectF mm_rect = graphics::device2mm(w->m_painterInverseMatrix.mapRect(QRectF(tile_rect)), this);
+	painter.setItemsToPaint(pageIndex().itemsToPaint(mm_rect));
+	painter.drawMetaPaint(frm);
+	painter.end();
+	return QPixmap::fromImage(img);
+}
+
+const ReportViewWidget::PageIndex &ReportViewWidget::PainterWidget::pageIndex()
+{
+	ReportItemMetaPaintFrame *frm = reportViewWidget()->currentPage();
+	if(m_pageIndex.page() != frm)
+		m_pageIndex.build(frm);
+	return m_pageIndex;
+}
+
+void ReportViewWidget::PainterWidget::invalidatePage()
+{
+	m_pageIndex.clear();
+	m_tilesPage = nullptr;
+	invalidateTiles();
 }
 
 void ReportViewWidget::PainterWidget::mousePressEvent(QMouseEvent *e)
@@ -317,6 +480,7 @@ void ReportViewWidget::PainterWidget::mousePressEvent(QMouseEvent *e)
 							it->text.replace('\n', QChar::LineSeparator);
 							/// roztahni text na ohranicujici ramecek, aby se tam delsi text vesel
 							it->setRenderedRectRect(selected_item->renderedRect);
+							invalidatePage();
 							update();
 							QString sql_id = it->sqlId;
 							if(!sql_id.isEmpty()) {
@@ -713,9 +877,12 @@ void ReportViewWidget::setupPainter(ReportPainter *p)
 	//p->currentPage = currentPageNo();
 	p->pageCount = pageCount();
 	p->setSelectedItem(m_selectedItem);
-	p->scale(scale(), scale());
-	p->translate(qmlwidgets::graphics::mm2device(qmlwidgets::graphics::Point(PageBorder, PageBorder), p->device()));
-	m_painterInverseMatrix = p->matrix().inverted();
+	/// painter can be already translated to tile, keep inverse matrix in widget coordinates
+	QMatrix m;
+	m.scale(scale(), scale());
+	m.translate(qmlwidgets::graphics::mm2device(qmlwidgets::graphics::Point(PageBorder, PageBorder), p->device()));
+	p->setMatrix(m, true);
+	m_painterInverseMatrix = m.inverted();
 }
 
 void ReportViewWidget::setReport(const QString &file_name, const QVariantMap &report_init_properties)
@@ -739,6 +906,8 @@ void ReportViewWidget::onPageProcessed()
 		if(pageCount() == 1)
 			setCurrentPageNo(0);
 	}
+	/// page count is painted on pages
+	m_painterWidget->invalidateTiles();
 	refreshWidget();
 	//setCurrentPageNo(0);
 	QTimer::singleShot(10, reportProcessor(), &ReportProcessor::processSinglePage); /// 10 je kompromis mezi rychlosti prekladu a sviznosti GUI
@@ -778,6 +947,8 @@ void ReportViewWidget::setCurrentPageNo(int pg_no)
 	if(pg_no >= pageCount() || pg_no < 0)
 		pg_no = 0;
 	m_currentPageNo = pg_no;
+	/// page can be reprocessed at the same address
+	m_painterWidget->invalidatePage();
 	setupPainterWidgetSize();
 	m_painterWidget->update();
 	refreshWidget();
@@ -861,45 +1032,15 @@ static QString is_fake_element(const QFDomElement &_el)
 	return fake_path;
 }
 --*/
-ReportItemMetaPaint* ReportViewWidget::selectItem_helper(ReportItemMetaPaint *it, const QPointF &p)
-{
-	ReportItemMetaPaint *ret = nullptr;
-	if(it && it->isPointInside(p)) {
-		//qfLogFuncFrame() << "point inside:" << it->reportItem() << it->renderedRect.toString();
-		ret = it;
-		//qfInfo() << it->dump();
-		/// traverse items in reverse order to select top level items in stacked layout
-		auto chlst = it->children();
-		for(int i=chlst.count()-1; i>=0; i--) {
-			ReportItemMetaPaint *it1 = static_cast<ReportItemMetaPaint*>(chlst[i]);
-			ReportItemMetaPaint *child_sel_it = selectItem_helper(it1, p);
-			if(child_sel_it) {
-				if(ret == it)
-					ret = child_sel_it;
-				else {
-					// if more children have item under cursor,
-					// then select one with smaller area
-					ReportItem::Rect r1 = ret->renderedRect;
-					ReportItem::Rect r2 = child_sel_it->renderedRect;
-					if(r1.area() > r2.area()) {
-						ret = child_sel_it;
-					}
-				}
-			}
-		}
-	}
-	return ret;
-}
-
 void ReportViewWidget::selectItem(const QPointF &p)
 {
 	qfLogFuncFrame();
-	ReportItemMetaPaintFrame *frm = currentPage();
 	ReportItemMetaPaint *old_selected_item = m_selectedItem;
 	//QFDomElement old_el = fSelectedElement;
-	m_selectedItem = selectItem_helper(frm, p);
+	m_selectedItem = m_painterWidget->pageIndex().itemAt(p);
 	if(m_selectedItem != old_selected_item) {
 		/// odznac puvodni selekci
+		m_painterWidget->invalidateTiles();
 		m_painterWidget->update();
 	}
 }
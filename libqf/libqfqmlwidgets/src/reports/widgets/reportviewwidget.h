@@ -16,6 +16,10 @@
 #include <QScrollArea>
 #include <QFrame>
 #include <QMatrix>
+#include <QHash>
+#include <QSet>
+#include <QPixmap>
+#include <QVector>
 
 class QLineEdit;
 class QSpinBox;
@@ -70,6 +74,7 @@ public:
 
 protected:
 	class ScrollArea;
+	class PageIndex;
 	class PainterWidget;
 
 	PainterWidget *m_painterWidget;
@@ -92,7 +97,6 @@ protected:
 	qf::qmlwidgets::StatusBar *m_statusBar;
 private:
 	void selectItem(const QPointF &p);
-	ReportItemMetaPaint* selectItem_helper(ReportItemMetaPaint *it, const QPointF &p);
 protected:
 	qf::qmlwidgets::StatusBar* statusBar();
 	QSpinBox *zoomStatusSpinBox;
@@ -180,9 +184,41 @@ private:
 	QLineEdit *m_edCurrentPage = nullptr;
 };
 
+/// Grid of page metapaint items bounding rects in mm, used to paint and hit test only items in some area of page.
+class ReportViewWidget::PageIndex
+{
+public:
+	static const int CellSize = 10; ///< mm
+public:
+	ReportItemMetaPaintFrame* page() const {return m_page;}
+	void build(ReportItemMetaPaintFrame *page);
+	void clear() {build(nullptr);}
+	/// items which can paint into \a mm_rect including all their parents
+	QSet<ReportItemMetaPaint*> itemsToPaint(const QRectF &mm_rect) const;
+	/// the same item as selected by walking the page tree, the smallest one in case of more children under point
+	ReportItemMetaPaint* itemAt(const QPointF &mm_point) const;
+private:
+	struct Entry
+	{
+		ReportItemMetaPaint *item;
+		QRectF rect; ///< area item can paint into
+	};
+	void addItem(ReportItemMetaPaint *item);
+	QRect cellRange(const QRectF &mm_rect) const;
+private:
+	ReportItemMetaPaintFrame *m_page = nullptr;
+	QRectF m_pageRect;
+	int m_columnCount = 0;
+	int m_rowCount = 0;
+	QVector<Entry> m_entries; ///< in paint order
+	QVector<QVector<int>> m_cells; ///< row major, entry indexes of items intersecting cell
+};
+
 class ReportViewWidget::PainterWidget : public QWidget
 {
 	Q_OBJECT
+public:
+	static const int TileSize = 256;
 protected:
 	void mousePressEvent(QMouseEvent *e) Q_DECL_OVERRIDE;
 	//virtual void wheelEvent(QWheelEvent *event);
@@ -194,6 +230,22 @@ signals:
 public:
 	PainterWidget(QWidget *parent);
 	virtual ~PainterWidget() {}
+
+	/// index of current page
+	const PageIndex& pageIndex();
+	/// drop rendered tiles, call when selection changes
+	void invalidateTiles() {m_tiles.clear();}
+	/// drop tiles and page index, call when current page or its metapaint items are changed
+	/// pages are not QObjects, so deleted page cannot be detected by pointer
+	void invalidatePage();
+private:
+	QPixmap renderTile(int col, int row);
+private:
+	PageIndex m_pageIndex;
+	/// tiles of current page and zoom, key is (column << 32) | row
+	QHash<quint64, QPixmap> m_tiles;
+	ReportItemMetaPaintFrame *m_tilesPage = nullptr;
+	qreal m_tilesScale = 0;
 };
 
 class ReportViewWidget::ScrollArea : public QScrollArea
@@ -42,6 +42,8 @@
 #include <QPainter>
 #include <QToolButton>
 
+#include <algorithm>
+
 #define QF_TIMESCOPE_ENABLED
 #include <qf/core/utils/timescope.h>
 
@@ -93,6 +95,13 @@ TableView::TableView(QWidget *parent) :
 	connect(m_proxyModel, &TableViewProxyModel::modelReset, this, &TableView::refreshActions);
 	m_proxyModel->setDynamicSortFilter(false);
 	Super::setModel(m_proxyModel);
+	/// seek keys contain view row numbers
+	connect(m_proxyModel, &TableViewProxyModel::modelReset, this, &TableView::invalidateSeekKeys);
+	connect(m_proxyModel, &TableViewProxyModel::layoutChanged, this, &TableView::invalidateSeekKeys);
+	connect(m_proxyModel, &TableViewProxyModel::rowsInserted, this, &TableView::invalidateSeekKeys);
+	connect(m_proxyModel, &TableViewProxyModel::rowsRemoved, this, &TableView::invalidateSeekKeys);
+	connect(m_proxyModel, &TableViewProxyModel::rowsMoved, this, &TableView::invalidateSeekKeys);
+	connect(m_proxyModel, &TableViewProxyModel::dataChanged, this, &TableView::invalidateSeekKeys);
 	/*
 	connect(this, &TableView::readOnlyChanged, [this] (bool b) {
 		setEditRowsEnabled(!b);
@@ -1202,24 +1211,58 @@ void TableView::seek(const QString &prefix_str)
 		sort_collator.setCaseSensitivity(Qt::CaseInsensitive);
 		sort_collator.setIgnorePunctuation(true);
 		//qfWarning() << sort_collator.compare(QString::fromUtf8("s"), QString::fromUtf8("š")) << QString::fromUtf8("š").toUpper();
-		//qfWarning() << "collator CS:" << (sort_collator.caseSensitivity() == Qt::CaseSensitive);
-		for(int i=0; i<model()->rowCount(); i++) {
-			QModelIndex ix = model()->index(i, col, QModelIndex());
-			QString data_str = model()->data(ix, Qt::DisplayRole).toString();//.mid(0, prefix_str.length()).toLower();
-			/// QTBUG-37689 QCollator allways sorts case sensitive
-			/// workarounded by own implementation of qf::core::Collator
-			QStringRef ps(&prefix_str);
-			QStringRef ds(&data_str, 0, qMin(prefix_str.length(), data_str.length()));
-			//QString ps = prefix_str.toLower();
-			//QString ds = data_str.mid(0, ps.length()).toLower();
-			int cmp = sort_collator.compare(ps, ds);
-			//qfInfo() << ps << "cmp" << ds << "->" << cmp;
-			if(cmp <= 0) {
-				setCurrentIndex(ix);
-				break;
-			}
+		/// QTBUG-37689 QCollator allways sorts case sensitive
+		/// workarounded by own implementation of qf::core::Collator
+		int row = seekRow(sort_collator, col, prefix_str);
+		if(row >= 0)
+			setCurrentIndex(model()->index(row, col, QModelIndex()));
+	}
+}
+
+int TableView::seekRow(const qf::core::Collator &sort_collator, int col, const QString &prefix_str)
+{
+	const QString prefix_key = sort_collator.sortKey(prefix_str);
+	int n = prefix_key.length();
+	int row_cnt = model()->rowCount();
+	/// rows of string column sorted ascending by proxy model are searched by the proxy's own comparator on the data it sorts by,
+	/// other types are not sorted by their display text
+	bool view_in_sort_key_order = m_proxyModel->sortColumn() == col
+			&& m_proxyModel->sortOrder() == Qt::AscendingOrder
+			&& tableModel()->columnType(col) == QVariant::String;
+	if(view_in_sort_key_order) {
+		const QByteArray prefix_sort_key = TableViewProxyModel::sortKey(prefix_str);
+		const int sort_key_len = prefix_sort_key.size();
+		int lo = 0;
+		int hi = row_cnt;
+		while(lo < hi) {
+			int mid = (lo + hi) / 2;
+			/// NULL and non string values are sorted first by proxy, empty key sorts first too
+			QVariant v = model()->data(model()->index(mid, col, QModelIndex()), Qt::EditRole);
+			QByteArray key = (v.userType() == qMetaTypeId<QString>())? TableViewProxyModel::sortKey(v.toString()): QByteArray();
+			if(TableViewProxyModel::compareSortKeys(key, prefix_sort_key, sort_key_len) < 0)
+				lo = mid + 1;
+			else
+				hi = mid;
 		}
+		return (lo < row_cnt)? lo: -1;
+	}
+	if(m_seekKeysColumn != col) {
+		qfDebug() << "building seek keys for column:" << col;
+		m_seekKeys.resize(row_cnt);
+		for(int i=0; i<row_cnt; i++) {
+			SeekKey &sk = m_seekKeys[i];
+			sk.key = sort_collator.sortKey(model()->data(model()->index(i, col, QModelIndex()), Qt::DisplayRole).toString());
+			sk.row = i;
+		}
+		std::stable_sort(m_seekKeys.begin(), m_seekKeys.end(), [](const SeekKey &k1, const SeekKey &k2) {
+			return k1.key < k2.key;
+		});
+		m_seekKeysColumn = col;
 	}
+	auto it = std::lower_bound(m_seekKeys.constBegin(), m_seekKeys.constEnd(), prefix_key, [n](const SeekKey &k, const QString &key) {
+		return k.key.leftRef(n).compare(key) < 0;
+	});
+	return (it == m_seekKeys.constEnd())? -1: it->row;
 }
 
 void TableView::cancelSeek()
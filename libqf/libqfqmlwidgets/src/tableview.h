@@ -9,6 +9,7 @@
 #include <qf/core/model/datadocument.h>
 
 #include <QTableView>
+#include <QVector>
 
 class QAbstractProxyModel;
 class QSortFilterProxyModel;
@@ -166,6 +167,10 @@ private:
 	int seekColumn() const;
 	void seek(const QString &prefix_str);
 	void cancelSeek();
+	/// @return first view row which prefix of seek column is not less than \a prefix_str or -1
+	/// rows sorted by proxy are compared by proxy's sort keys, other columns by collation keys
+	int seekRow(const qf::core::Collator &sort_collator, int col, const QString &prefix_str);
+	void invalidateSeekKeys() {m_seekKeys.clear(); m_seekKeysColumn = -1;}
 
 	qf::core::utils::TreeTable toTreeTable(const QString& table_name = QString(), const QVariantList& exported_columns = QVariantList(), const qf::core::model::TableModel::TreeTableExportOptions &opts = qf::core::model::TableModel::TreeTableExportOptions()) const;
 	void exportReport_helper(const QVariant& _options);
@@ -219,6 +224,14 @@ protected:
 	QAbstractButton *m_leftTopCornerButton = nullptr;
 private:
 	bool m_isReadOnly = false;
+	struct SeekKey
+	{
+		QString key;
+		int row;
+	};
+	/// view rows ordered by collation key of m_seekKeysColumn, built lazily if view rows are not sorted by proxy sort keys
+	QVector<SeekKey> m_seekKeys;
+	int m_seekKeysColumn = -1;
 };
 
 }}
@@ -82,26 +82,38 @@ bool TableViewProxyModel::filterAcceptsRow(int source_row, const QModelIndex &so
 	return false;
 }
 
-int TableViewProxyModel::variantLessThan(const QVariant &left, const QVariant &right) const
+QByteArray TableViewProxyModel::sortKey(const QString &s)
 {
-	if(left.userType() == qMetaTypeId<QString>() && right.userType() == qMetaTypeId<QString>()) {
-		const QByteArray lb = qf::core::Collator::toAscii7(QLocale::Czech, left.toString(), true);
-		const QByteArray rb = qf::core::Collator::toAscii7(QLocale::Czech, right.toString(), true);
-		int lsz = lb.size();
-		int rsz = rb.size();
-		for(int i=0; ; i++) {
-			char lc = (i<lsz)? lb.at(i): 0;
-			char rc = (i<rsz)? rb.at(i): 0;
-			if(lc == rc) {
-				if(lc == 0) {
-					/// same
-					return false;
-				}
-			}
-			else {
-				return (lc < rc);
+	return qf::core::Collator::toAscii7(QLocale::Czech, s, true);
+}
+
+int TableViewProxyModel::compareSortKeys(const QByteArray &k1, const QByteArray &k2, int n)
+{
+	int sz1 = k1.size();
+	int sz2 = k2.size();
+	if(n >= 0) {
+		sz1 = qMin(sz1, n);
+		sz2 = qMin(sz2, n);
+	}
+	for(int i=0; ; i++) {
+		char c1 = (i<sz1)? k1.at(i): 0;
+		char c2 = (i<sz2)? k2.at(i): 0;
+		if(c1 == c2) {
+			if(c1 == 0) {
+				/// same
+				return 0;
 			}
 		}
+		else {
+			return (c1 < c2)? -1: 1;
+		}
+	}
+}
+
+int TableViewProxyModel::variantLessThan(const QVariant &left, const QVariant &right) const
+{
+	if(left.userType() == qMetaTypeId<QString>() && right.userType() == qMetaTypeId<QString>()) {
+		return compareSortKeys(sortKey(left.toString()), sortKey(right.toString())) < 0;
 	}
 	if(!left.isValid()) {
 		return right.isValid();
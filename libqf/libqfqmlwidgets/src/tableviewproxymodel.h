@@ -20,6 +20,11 @@ public:
 	bool isIdle() const;
 
 	void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) Q_DECL_OVERRIDE;
+
+	/// strings are sorted by order of their keys compared by compareSortKeys()
+	static QByteArray sortKey(const QString &s);
+	/// compares at most n leading bytes of keys when n >= 0
+	static int compareSortKeys(const QByteArray &k1, const QByteArray &k2, int n = -1);
 protected:
 	QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const Q_DECL_OVERRIDE;
 	QVariant headerData(int section, Qt::Orientation orientation, int role) const Q_DECL_OVERRIDE;
@@ -25,10 +25,7 @@ namespace CardReader {
 
 static Event::EventPlugin* eventPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Event::EventPlugin*>(fwk->plugin("Event"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad Event plugin!");
-	return plugin;
+	return qf::qmlwidgets::framework::MainWindow::cachedPlugin<Event::EventPlugin>();
 }
 
 CardChecker::CardChecker(QObject *parent)
@@ -66,9 +63,7 @@ int CardChecker::stageIdForRun(int run_id)
 
 int CardChecker::stageStartSec(int stage_id)
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto event_plugin = qobject_cast<Event::EventPlugin *>(fwk->plugin("Event"));
-	QF_ASSERT(event_plugin != nullptr, "Bad plugin", return 0);
+	auto *event_plugin = qf::qmlwidgets::framework::MainWindow::cachedPlugin<Event::EventPlugin>();
 	if(stage_id == 0)
 		stage_id = event_plugin->currentStageId();
 	int ret = event_plugin->stageStartMsec(stage_id);
@@ -81,9 +76,10 @@ int CardChecker::startTimeSec(int run_id)
 	qfs::QueryBuilder qb;
 	qb.select2("runs", "startTimeMs")
 			.from("runs")
-			.where("runs.id=" QF_IARG(run_id));
+			.where("runs.id=:runId")
+			.bindValue(":runId", run_id);
 	qfs::Query q;
-	q.exec(qb.toString(), qf::core::Exception::Throw);
+	q.exec(qb, qf::core::Exception::Throw);
 	if(q.next())
 		ret = q.value(0).toInt() / 1000;
 	else
@@ -98,9 +94,7 @@ QVariantMap CardChecker::courseCodesForRunId(int run_id)
 		qfError() << "Run ID == 0";
 		return ret;
 	}
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto runs_plugin = qobject_cast<Runs::RunsPlugin *>(fwk->plugin("Runs"));
-	QF_ASSERT(runs_plugin != nullptr, "Bad plugin", return QVariantMap());
+	auto *runs_plugin = qf::qmlwidgets::framework::MainWindow::cachedPlugin<Runs::RunsPlugin>();
 
 	int course_id = runs_plugin->courseForRun(run_id);
 	if(course_id <= 0) {
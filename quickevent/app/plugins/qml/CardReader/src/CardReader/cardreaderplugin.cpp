@@ -5,6 +5,7 @@
 #include "../cardreaderpartwidget.h"
 
 #include <Event/eventplugin.h>
+#include <Event/competitortotals.h>
 
 #include <quickevent/og/timems.h>
 #include <quickevent/si/punchrecord.h>
@@ -33,10 +34,7 @@ namespace CardReader {
 
 static Event::EventPlugin* eventPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Event::EventPlugin*>(fwk->plugin("Event"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad Event plugin!");
-	return plugin;
+	return qff::MainWindow::cachedPlugin<Event::EventPlugin>();
 }
 
 const QLatin1String CardReaderPlugin::SETTINGS_PREFIX("plugins/CardReader");
@@ -77,9 +75,7 @@ CardChecker *CardReaderPlugin::currentCardChecker()
 
 int CardReaderPlugin::currentStageId()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto event_plugin = qobject_cast<Event::EventPlugin *>(fwk->plugin("Event"));
-	QF_ASSERT(event_plugin != nullptr, "Bad plugin", return 0);
+	auto *event_plugin = qff::MainWindow::cachedPlugin<Event::EventPlugin>();
 	int ret = event_plugin->currentStageId();
 	return ret;
 }
@@ -277,7 +273,7 @@ int CardReaderPlugin::savePunchRecordToSql(const quickevent::si::PunchRecord &pu
 	qf::core::sql::Query q;
 	int run_id = punch.runid();
 	if(run_id > 0) {
-		q.exec("SELECT startTimeMs FROM runs WHERE id=" QF_IARG(run_id), qf::core::Exception::Throw);
+		q.execPrepared(QStringLiteral("SELECT startTimeMs FROM runs WHERE id=:runId"), QVariantMap{{QStringLiteral(":runId"), run_id}}, qf::core::Exception::Throw);
 		if(q.next()) {
 			QVariant v = q.value(0);
 			if(!v.isNull()) {
@@ -288,20 +284,20 @@ int CardReaderPlugin::savePunchRecordToSql(const quickevent::si::PunchRecord &pu
 
 	int code = resolveAltCode(punch.code(), punch.stageid());
 
-	q.prepare(QStringLiteral("INSERT INTO punches (siId, code, time, msec, runId, stageId, timeMs, runTimeMs, marking)"
-							 " VALUES (:siId, :code, :time, :msec, :runId, :stageId, :timeMs, :runTimeMs, :marking)")
-							, qf::core::Exception::Throw);
-	q.bindValue(QStringLiteral(":siId"), punch.siid());
-	q.bindValue(QStringLiteral(":code"), code);
-	q.bindValue(QStringLiteral(":time"), punch.time());
-	q.bindValue(QStringLiteral(":msec"), punch.msec());
-	q.bindValue(QStringLiteral(":runId"), punch.runid());
-	q.bindValue(QStringLiteral(":stageId"), punch.stageid());
-	q.bindValue(QStringLiteral(":marking"), punch.marking());
-	q.bindValue(QStringLiteral(":timeMs"), punch.timems());
-	q.bindValue(QStringLiteral(":runTimeMs"), punch.runtimems_isset()? punch.runtimems(): QVariant());
+	QVariantMap bound_values;
+	bound_values[QStringLiteral(":siId")] = punch.siid();
+	bound_values[QStringLiteral(":code")] = code;
+	bound_values[QStringLiteral(":time")] = punch.time();
+	bound_values[QStringLiteral(":msec")] = punch.msec();
+	bound_values[QStringLiteral(":runId")] = punch.runid();
+	bound_values[QStringLiteral(":stageId")] = punch.stageid();
+	bound_values[QStringLiteral(":marking")] = punch.marking();
+	bound_values[QStringLiteral(":timeMs")] = punch.timems();
+	bound_values[QStringLiteral(":runTimeMs")] = punch.runtimems_isset()? punch.runtimems(): QVariant();
 	/// it is not possible to save punch time as date-time to be independent on start00 since it depends on start00 due to 12H time format
-	if(q.exec()) {
+	if(q.execPrepared(QStringLiteral("INSERT INTO punches (siId, code, time, msec, runId, stageId, timeMs, runTimeMs, marking)"
+									 " VALUES (:siId, :code, :time, :msec, :runId, :stageId, :timeMs, :runTimeMs, :marking)")
+					  , bound_values)) {
 		ret = q.lastInsertId().toInt();
 	}
 	else {
@@ -334,9 +330,8 @@ void CardReaderPlugin::updateCheckedCardValuesSql(const CardReader::CheckedCard
 	qf::core::sql::Query q(cc);
 	{
 		QF_TIME_SCOPE("DELETE FROM runlaps");
-		q.exec("DELETE FROM runlaps WHERE runId=" + QString::number(run_id), qf::core::Exception::Throw);
+		q.execPrepared(QStringLiteral("DELETE FROM runlaps WHERE runId=:runId"), QVariantMap{{QStringLiteral(":runId"), run_id}}, qf::core::Exception::Throw);
 	}
-	q.prepare(QStringLiteral("INSERT INTO runlaps (runId, position, code, stpTimeMs, lapTimeMs) VALUES (:runId, :position, :code, :stpTimeMs, :lapTimeMs)"), qf::core::Exception::Throw);
 	auto punch_list = checked_card.punches();
 	if(punch_list.count()) {
 		int position = 0;
@@ -345,23 +340,34 @@ void CardReaderPlugin::updateCheckedCardValuesSql(const CardReader::CheckedCard
 			CardReader::CheckedPunch cp(v.toMap());
 			//qfInfo() << run_id << position << cp;
 			if(cp.stpTimeMs() > 0 && cp.lapTimeMs() > 0) {
-				q.bindValue(QStringLiteral(":runId"), run_id);
-				q.bindValue(QStringLiteral(":code"), cp.code());
-				q.bindValue(QStringLiteral(":position"), position);
-				q.bindValue(QStringLiteral(":stpTimeMs"), cp.stpTimeMs());
-				q.bindValue(QStringLiteral(":lapTimeMs"), cp.lapTimeMs());
-				q.exec(qf::core::Exception::Throw);
+				QVariantMap bound_values;
+				bound_values[QStringLiteral(":runId")] = run_id;
+				bound_values[QStringLiteral(":code")] = cp.code();
+				bound_values[QStringLiteral(":position")] = position;
+				bound_values[QStringLiteral(":stpTimeMs")] = cp.stpTimeMs();
+				bound_values[QStringLiteral(":lapTimeMs")] = cp.lapTimeMs();
+				q.execPrepared(QStringLiteral("INSERT INTO runlaps (runId, position, code, stpTimeMs, lapTimeMs) VALUES (:runId, :position, :code, :stpTimeMs, :lapTimeMs)")
+							   , bound_values, qf::core::Exception::Throw);
 			}
 		}
 	}
-	q.prepare("UPDATE runs SET timeMs=:timeMs, finishTimeMs=:finishTimeMs, misPunch=:misPunch, disqualified=:disqualified WHERE id=" + QString::number(run_id), qf::core::Exception::Throw);
-	q.bindValue(QStringLiteral(":timeMs"), checked_card.timeMs());
-	q.bindValue(QStringLiteral(":finishTimeMs"), checked_card.finishTimeMs());
-	q.bindValue(QStringLiteral(":misPunch"), checked_card.isMisPunch());
-	q.bindValue(QStringLiteral(":disqualified"), !checked_card.isOk());
-	q.exec(qf::core::Exception::Throw);
+	{
+		QVariantMap bound_values;
+		bound_values[QStringLiteral(":timeMs")] = checked_card.timeMs();
+		bound_values[QStringLiteral(":finishTimeMs")] = checked_card.finishTimeMs();
+		bound_values[QStringLiteral(":misPunch")] = checked_card.isMisPunch();
+		bound_values[QStringLiteral(":disqualified")] = !checked_card.isOk();
+		bound_values[QStringLiteral(":runId")] = run_id;
+		q.execPrepared(QStringLiteral("UPDATE runs SET timeMs=:timeMs, finishTimeMs=:finishTimeMs, misPunch=:misPunch, disqualified=:disqualified WHERE id=:runId")
+					   , bound_values, qf::core::Exception::Throw);
+	}
 	if(q.numRowsAffected() != 1)
 		QF_EXCEPTION("Update runs error!");
+	{
+		/// totals are written in the same transaction as run times
+		Event::CompetitorTotals totals(cc, eventPlugin()->stageCount());
+		totals.updateRuns(QList<int>() << run_id);
+	}
 	bool is_relays = eventPlugin()->eventConfig()->isRelays();
 	if(is_relays) {
 		/// set start time for next leg
@@ -8,6 +8,7 @@
 #include "CardReader/checkedcard.h"
 
 #include <Event/eventplugin.h>
+#include <Event/dbeventbus.h>
 #include <Runs/findrunnerwidget.h>
 
 #include <quickevent/og/timems.h>
@@ -47,6 +48,7 @@
 #include <QComboBox>
 #include <QLabel>
 #include <QCheckBox>
+#include <QElapsedTimer>
 
 namespace qfm = qf::core::model;
 namespace qfs = qf::core::sql;
@@ -56,10 +58,7 @@ namespace qfd = qf::qmlwidgets::dialogs;
 
 static Event::EventPlugin* eventPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Event::EventPlugin*>(fwk->plugin("Event"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad Event plugin!");
-	return plugin;
+	return qff::MainWindow::cachedPlugin<Event::EventPlugin>();
 }
 
 namespace {
@@ -259,6 +258,20 @@ void CardReaderWidget::settleDownInPartWidget(CardReaderPartWidget *part_widget)
 			connect(a, &qf::qmlwidgets::Action::triggered, this, &CardReaderWidget::operatorAudioNotify);
 			a_tools->addActionInto(a);
 		}
+		{
+			qfw::Action *a = new qfw::Action("Test audio mixer without device");
+			connect(a, &qf::qmlwidgets::Action::triggered, [this]() {
+				QString report = quickevent::audio::Player::nullSinkTest();
+				qfInfo() << report;
+				qf::qmlwidgets::dialogs::MessageBox::showInfo(this, report);
+			});
+			a_tools->addActionInto(a);
+		}
+		{
+			qfw::Action *a = new qfw::Action("Benchmark card processing");
+			connect(a, &qf::qmlwidgets::Action::triggered, this, &CardReaderWidget::benchmarkCardProcessing);
+			a_tools->addActionInto(a);
+		}
 	}
 	qfw::ToolBar *main_tb = part_widget->toolBar("main", true);
 	main_tb->addAction(m_actCommOpen);
@@ -289,7 +302,9 @@ void CardReaderWidget::settleDownInPartWidget(CardReaderPartWidget *part_widget)
 		m_cbxPunchMarking->addItem(tr("Entries"), quickevent::si::PunchRecord::MARKING_ENTRIES);
 		main_tb->addWidget(m_cbxPunchMarking);
 	}
-	connect(eventPlugin(), &Event::EventPlugin::dbEventNotify, this, &CardReaderWidget::onDbEventNotify, Qt::QueuedConnection);
+	eventPlugin()->dbEventBus()->subscribe(Event::EventPlugin::DBEVENT_CARD_READ, this, [this](const QVariantList &card_ids) {
+		onCardsRead(card_ids);
+	});
 }
 
 void CardReaderWidget::reset()
@@ -331,15 +346,13 @@ void CardReaderWidget::reload()
 	m_cardsModel->reload();
 }
 
-void CardReaderWidget::onDbEventNotify(const QString &domain, int connection_id, const QVariant &data)
+void CardReaderWidget::onCardsRead(const QVariantList &card_ids)
 {
-	Q_UNUSED(connection_id)
-	int card_id = data.toInt();
-	if(domain == QLatin1String(Event::EventPlugin::DBEVENT_CARD_READ)) {
-		// TODO: only if widget is visible (plugin window active)
-		if(m_cbxAutoRefresh->isChecked())
-			updateTableView(card_id);
-	}
+	// TODO: only if widget is visible (plugin window active)
+	if(!m_cbxAutoRefresh->isChecked())
+		return;
+	for(const QVariant &card_id : card_ids)
+		updateTableView(card_id.toInt());
 }
 
 void CardReaderWidget::createActions()
@@ -578,10 +591,7 @@ void CardReaderWidget::updateTableView(int card_id)
 
 CardReader::CardReaderPlugin *CardReaderWidget::thisPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto cardreader_plugin = qobject_cast<CardReader::CardReaderPlugin *>(fwk->plugin("CardReader"));
-	QF_ASSERT_EX(cardreader_plugin != nullptr, "Bad plugin");
-	return cardreader_plugin;
+	return qff::MainWindow::cachedPlugin<CardReader::CardReaderPlugin>();
 }
 
 qf::qmlwidgets::framework::Plugin *CardReaderWidget::receiptsPlugin()
@@ -646,8 +656,10 @@ void CardReaderWidget::assignRunnerToSelectedCard()
 
 quickevent::audio::Player *CardReaderWidget::audioPlayer()
 {
-	if(!m_audioPlayer)
+	if(!m_audioPlayer) {
 		m_audioPlayer = new quickevent::audio::Player(this);
+		m_audioPlayer->preload();
+	}
 	return m_audioPlayer;
 }
 
@@ -814,5 +826,75 @@ void CardReaderWidget::importCards_lapsOnlyCsv()
 	}
 }
 
+void CardReaderWidget::benchmarkCardProcessing()
+{
+	qfLogFuncFrame();
+	if(!eventPlugin()->isEventOpen())
+		return;
+	QStringList report;
+	{
+		/// plugin lookup done by eventPlugin() helpers several times per card
+		const int lookup_count = 100000;
+		qff::MainWindow *fwk = qff::MainWindow::frameWork();
+		QElapsedTimer elapsed;
+		Event::EventPlugin *p = nullptr;
+		elapsed.start();
+		for (int i = 0; i < lookup_count; ++i)
+			p = qobject_cast<Event::EventPlugin*>(fwk->plugin("Event"));
+		qint64 by_name_nsec = elapsed.nsecsElapsed();
+		elapsed.restart();
+		for (int i = 0; i < lookup_count; ++i)
+			p = fwk->plugin<Event::EventPlugin>();
+		qint64 by_type_nsec = elapsed.nsecsElapsed();
+		elapsed.restart();
+		for (int i = 0; i < lookup_count; ++i)
+			p = qff::MainWindow::cachedPlugin<Event::EventPlugin>();
+		qint64 cached_nsec = elapsed.nsecsElapsed();
+		Q_UNUSED(p)
+		report << tr("Plugin lookup nsec, by feature id: %1, by type: %2, cached: %3")
+				  .arg(by_name_nsec / lookup_count).arg(by_type_nsec / lookup_count).arg(cached_nsec / lookup_count);
+	}
+	try {
+		QList<int> card_ids;
+		qf::core::sql::Query q;
+		q.exec("SELECT id FROM cards WHERE stageId=" QF_IARG(thisPlugin()->currentStageId()) " ORDER BY id DESC LIMIT 200", qf::core::Exception::Throw);
+		while(q.next())
+			card_ids << q.value(0).toInt();
+		int processed_count = 0;
+		QElapsedTimer elapsed;
+		{
+			/// the same steps as processSICard() without db events, nothing is written
+			qf::core::sql::Transaction transaction;
+			elapsed.start();
+			for(int card_id : card_ids) {
+				CardReader::ReadCard read_card = thisPlugin()->readCard(card_id);
+				if(read_card.isEmpty())
+					continue;
+				int run_id = thisPlugin()->findRunId(read_card.cardNumber(), read_card.finishTime());
+				if(run_id == 0)
+					continue;
+				thisPlugin()->isCardLent(read_card.cardNumber(), read_card.finishTime(), run_id);
+				read_card.setRunId(run_id);
+				int new_card_id = thisPlugin()->saveCardToSql(read_card);
+				thisPlugin()->saveCardAssignedRunnerIdSql(new_card_id, run_id);
+				CardReader::CheckedCard checked_card = thisPlugin()->checkCard(read_card);
+				thisPlugin()->updateCheckedCardValuesSql(checked_card);
+				processed_count++;
+			}
+		}
+		qint64 msec = elapsed.elapsed();
+		if(processed_count > 0)
+			report << tr("Processed %1 cards in %2 msec, %3 msec per card").arg(processed_count).arg(msec).arg(double(msec) / processed_count, 0, 'f', 2);
+		else
+			report << tr("No card with assigned run found in current stage.");
+	}
+	catch (const qf::core::Exception &e) {
+		qf::qmlwidgets::dialogs::MessageBox::showException(this, e);
+		return;
+	}
+	qfInfo() << report.join('\n');
+	qf::qmlwidgets::dialogs::MessageBox::showInfo(this, report.join('\n'));
+}
+
 #include "cardreaderwidget.moc"
 
@@ -62,7 +62,8 @@ public:
 	Q_SLOT void reset();
 	Q_SLOT void reload();
 
-	void onDbEventNotify(const QString &domain, int connection_id, const QVariant &data);
+	/// card ids merged by DbEventBus
+	void onCardsRead(const QVariantList &card_ids);
 private slots:
 	void appendLog(qf::core::Log::Level level, const QString &msg);
 	void processDriverInfo(qf::core::Log::Level level, const QString &msg);
@@ -96,6 +97,9 @@ private:
 	quickevent::audio::Player* audioPlayer();
 	void operatorAudioWakeUp();
 	void operatorAudioNotify();
+
+	/// time plugin lookups and processing of stored cards in transaction which is rolled back
+	void benchmarkCardProcessing();
 private:
 	Ui::CardReaderWidget *ui;
 	qf::qmlwidgets::Action *m_actCommOpen = nullptr;
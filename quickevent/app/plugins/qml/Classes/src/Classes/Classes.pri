@@ -3,7 +3,9 @@ message(including $$PWD)
 HEADERS += \
     $$PWD/classesplugin.h \
     $$PWD/classdocument.h \
+    $$PWD/coursesimporter.h \
 
 SOURCES += \
     $$PWD/classesplugin.cpp \
     $$PWD/classdocument.cpp \
+    $$PWD/coursesimporter.cpp \
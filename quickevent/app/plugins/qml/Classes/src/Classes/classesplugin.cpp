@@ -1,6 +1,7 @@
 #include "classesplugin.h"
 #include "../thispartwidget.h"
 #include "classdocument.h"
+#include "coursesimporter.h"
 
 #include "../coursedef.h"
 
@@ -77,18 +78,16 @@ void ClassesPlugin::dropClass(int class_id) throw(qf::core::Exception)
 	doc.drop();
 }
 
-void ClassesPlugin::createCourses(int stage_id, const QVariantList &courses)
+void ClassesPlugin::createCourses(int stage_id, const QVariantList &courses, bool diff_mode)
 {
 	qfLogFuncFrame() << courses;
 	try {
 		bool is_relays = eventPlugin()->eventConfig()->isRelays();
 		qf::core::sql::Transaction transaction(qf::core::sql::Connection::forName());
 		qf::core::sql::Query q;
-		deleteCourses(stage_id);
+		if(!diff_mode)
+			deleteCourses(stage_id);
 
-		QSet<int> all_codes;
-		QMap<QString, int> course_ids;
-		QMap<int, QList<int> > course_codes;
 		{
 			// if classes are not imported from Oris, import also classes
 			q.exec("SELECT COUNT(*) FROM classes", qf::core::Exception::Throw);
@@ -108,85 +107,11 @@ void ClassesPlugin::createCourses(int stage_id, const QVariantList &courses)
 				}
 			}
 		}
-		QMap<QString, int> class_ids;
-		{
-			q.exec("SELECT id, name FROM classes");
-			while(q.next()) {
-				class_ids[q.value("name").toString()] = q.value("id").toInt();
-			}
-		}
-		for(auto v : courses) {
-			CourseDef cd(v.toMap());
-			int course_id = 0;
-			{
-				qfInfo() << "inserting course" << cd.name();
-				QString qs = "INSERT INTO courses (name, length, climb, note) VALUES (:name, :length, :climb, :note)";
-				q.prepare(qs, qf::core::Exception::Throw);
-				q.bindValue(":name", cd.name());
-				q.bindValue(":length", cd.lenght());
-				q.bindValue(":climb", cd.climb());
-				q.bindValue(":note", QString("E%1 ").arg(stage_id) + cd.classes().join(','));
-				q.exec(qf::core::Exception::Throw);
-				course_id = q.lastInsertId().toInt();
-			}
-			if(!is_relays) {
-				QString qs = "UPDATE classdefs SET courseId=:courseId WHERE classId=:classId AND stageId=:stageId";
-				q.prepare(qs, qf::core::Exception::Throw);
-				for(auto class_name : cd.classes()) {
-					int class_id = class_ids.value(class_name);
-					if(class_id > 0) {
-						qfInfo() << "\t" << "updating classdefs for" << class_name << "stage:" << stage_id;
-						q.bindValue(":classId", class_id);
-						q.bindValue(":courseId", course_id);
-						q.bindValue(":stageId", stage_id);
-						q.exec(qf::core::Exception::Throw);
-					}
-					else {
-						qfError() << class_name << "not found in defined classes";
-					}
-				}
-			}
-			course_ids[cd.name()] = course_id;
-			for(auto v : cd.codes()) {
-				int code = v.toInt();
-				all_codes << code;
-				course_codes[course_id] << code;
-			}
-		}
-		QMap<int, int> code_to_id;
-		{
-			QString qs = "INSERT INTO codes (code, note) VALUES (:code, :note)";
-			q.prepare(qs, qf::core::Exception::Throw);
-			for(auto code : all_codes) {
-				qfDebug() << "inserting code" << code;
-				q.bindValue(":code", code);
-				q.bindValue(":note", QString("E%1").arg(stage_id));
-				q.exec(qf::core::Exception::Throw);
-				code_to_id[code] = q.lastInsertId().toInt();
-			}
-		}
-		{
-			QString qs = "INSERT INTO coursecodes (courseId, position, codeId) VALUES (:courseId, :position, :codeId)";
-			q.prepare(qs, qf::core::Exception::Throw);
-			QMapIterator<int, QList<int> > it(course_codes);
-			while(it.hasNext()) {
-				it.next();
-				int pos = 0;
-				for(auto code : it.value()) {
-					int code_id = code_to_id.value(code);
-					if(code_id > 0) {
-						qfDebug() << "courseId" << it.key() << "-> code:" << code << "codeId:" << code_id;
-						q.bindValue(":courseId", it.key());
-						q.bindValue(":position", ++pos);
-						q.bindValue(":codeId", code_id);
-						q.exec(qf::core::Exception::Throw);
-					}
-					else {
-						QF_EXCEPTION(tr("Cannot find id for code: %1").arg(code));
-					}
-				}
-			}
-		}
+		QList<CourseDef> course_defs;
+		for(auto v : courses)
+			course_defs << CourseDef(v.toMap());
+		CoursesImporter importer(stage_id, is_relays);
+		importer.importCourses(course_defs);
 		transaction.commit();
 	}
 	catch (const qf::core::Exception &e) {
@@ -32,7 +32,8 @@ public:
 	Q_INVOKABLE QObject* createClassDocument(QObject *parent);
 	Q_INVOKABLE void createClass(const QString &class_name) throw(qf::core::Exception);
 	Q_INVOKABLE void dropClass(int class_id) throw(qf::core::Exception);
-	Q_INVOKABLE void createCourses(int stage_id, const QVariantList &courses);
+	/// diff_mode keeps existing courses of stage and writes only changed ones, otherwise all stage courses are deleted first
+	Q_INVOKABLE void createCourses(int stage_id, const QVariantList &courses, bool diff_mode = false);
 	Q_INVOKABLE void deleteCourses(int stage_id);
 	Q_INVOKABLE void gcCourses();
 
@@ -0,0 +1,315 @@
+#include "coursesimporter.h"
+
+#include "../coursedef.h"
+
+#include <qf/core/log.h>
+#include <qf/core/sql/connection.h>
+#include <qf/core/sql/query.h>
+
+#include <QSet>
+
+namespace qfs = qf::core::sql;
+
+using namespace Classes;
+
+CoursesImporter::CoursesImporter(int stage_id, bool is_relays)
+	: m_stageId(stage_id)
+	, m_isRelays(is_relays)
+{
+}
+
+void CoursesImporter::importCourses(const QList<CourseDef> &course_defs) throw(qf::core::Exception)
+{
+	qfLogFuncFrame() << "stage:" << m_stageId << "courses:" << course_defs.count();
+	loadStoredCourses();
+	QMap<int, int> code_ids = loadCodeIds();
+	QMap<QString, int> class_ids;
+	{
+		qfs::Query q;
+		q.exec("SELECT id, name FROM classes", qf::core::Exception::Throw);
+		while(q.next())
+			class_ids[q.value(1).toString()] = q.value(0).toInt();
+	}
+
+	const QString note_prefix = QString("E%1 ").arg(m_stageId);
+	QList<QVariantList> new_courses;
+	QList<QVariantList> changed_courses;
+	QMap<QString, QList<int>> course_codes; //< course name -> codes to be written to coursecodes
+	QList<int> recoded_course_ids;
+	QSet<int> new_codes;
+	QMap<QString, QString> class_course_names; //< class name -> course name
+	QSet<QString> imported_names;
+	for(const CourseDef &cd : course_defs) {
+		const QString name = cd.name();
+		if(imported_names.contains(name)) {
+			qfWarning() << "duplicate course name:" << name << "skipped";
+			continue;
+		}
+		imported_names << name;
+		QList<int> codes;
+		for(const QVariant &v : cd.codes()) {
+			int code = v.toInt();
+			codes << code;
+			if(!code_ids.contains(code))
+				new_codes << code;
+		}
+		const QString note = note_prefix + cd.classes().join(',');
+		for(const QString &class_name : cd.classes())
+			class_course_names[class_name] = name;
+		auto it = m_storedCourses.find(name);
+		if(it == m_storedCourses.end()) {
+			new_courses << QVariantList{name, cd.lenght(), cd.climb(), note};
+			course_codes[name] = codes;
+			m_insertedCount++;
+			continue;
+		}
+		StoredCourse &sc = it.value();
+		sc.used = true;
+		bool changed = false;
+		if(sc.length != cd.lenght() || sc.climb != cd.climb() || sc.note != note) {
+			changed_courses << QVariantList{cd.lenght(), cd.climb(), note, sc.id};
+			changed = true;
+		}
+		if(sc.codes != codes) {
+			recoded_course_ids << sc.id;
+			course_codes[name] = codes;
+			changed = true;
+		}
+		if(changed)
+			m_updatedCount++;
+		else
+			m_unchangedCount++;
+	}
+	qfInfo() << "stage:" << m_stageId << "new courses:" << m_insertedCount << "changed:" << m_updatedCount << "unchanged:" << m_unchangedCount;
+
+	{
+		QList<QVariantList> rows;
+		for(int code : new_codes)
+			rows << QVariantList{code, QString("E%1").arg(m_stageId)};
+		QMap<QString, int> ids = insertRows(QStringLiteral("codes"), QStringList{"code", "note"}, rows, QStringLiteral("code"));
+		for(auto it = ids.constBegin(); it != ids.constEnd(); ++it)
+			code_ids[it.key().toInt()] = it.value();
+	}
+	QMap<QString, int> course_ids;
+	for(auto it = m_storedCourses.constBegin(); it != m_storedCourses.constEnd(); ++it) {
+		if(it.value().used)
+			course_ids[it.key()] = it.value().id;
+	}
+	{
+		QMap<QString, int> ids = insertRows(QStringLiteral("courses"), QStringList{"name", "length", "climb", "note"}, new_courses, QStringLiteral("name"));
+		for(auto it = ids.constBegin(); it != ids.constEnd(); ++it)
+			course_ids[it.key()] = it.value();
+	}
+	qfs::Query q;
+	if(!changed_courses.isEmpty()) {
+		q.prepare("UPDATE courses SET length=?, climb=?, note=? WHERE id=?", qf::core::Exception::Throw);
+		for(const QVariantList &row : changed_courses) {
+			for (int i = 0; i < row.count(); ++i)
+				q.bindValue(i, row[i]);
+			q.exec(qf::core::Exception::Throw);
+		}
+	}
+	for(const QString &ids : idLists(recoded_course_ids))
+		q.exec("DELETE FROM coursecodes WHERE courseId IN (" + ids + ")", qf::core::Exception::Throw);
+	{
+		QList<QVariantList> rows;
+		for(auto it = course_codes.constBegin(); it != course_codes.constEnd(); ++it) {
+			int course_id = course_ids.value(it.key());
+			int pos = 0;
+			for(int code : it.value()) {
+				int code_id = code_ids.value(code);
+				if(code_id == 0)
+					QF_EXCEPTION(QString("Cannot find id for code: %1").arg(code));
+				rows << QVariantList{course_id, ++pos, code_id};
+			}
+		}
+		insertRows(QStringLiteral("coursecodes"), QStringList{"courseId", "position", "codeId"}, rows);
+	}
+	if(!m_isRelays) {
+		QMap<int, int> class_course_ids;
+		for(auto it = class_course_names.constBegin(); it != class_course_names.constEnd(); ++it) {
+			int class_id = class_ids.value(it.key());
+			if(class_id > 0)
+				class_course_ids[class_id] = course_ids.value(it.value());
+			else
+				qfError() << it.key() << "not found in defined classes";
+		}
+		assignClassdefs(class_course_ids);
+	}
+	QList<int> obsolete_course_ids = m_duplicateCourseIds;
+	for(const StoredCourse &sc : m_storedCourses) {
+		if(!sc.used)
+			obsolete_course_ids << sc.id;
+	}
+	dropCourses(obsolete_course_ids);
+}
+
+void CoursesImporter::loadStoredCourses()
+{
+	m_storedCourses.clear();
+	m_duplicateCourseIds.clear();
+	qfs::Query q;
+	q.exec("SELECT id, name, length, climb, note FROM courses"
+		   " WHERE id IN (SELECT courseId FROM classdefs WHERE stageId=" QF_IARG(m_stageId) ")"
+		   " OR note LIKE 'E" + QString::number(m_stageId) + " %'"
+		   " ORDER BY id", qf::core::Exception::Throw);
+	QMap<int, QString> course_names;
+	while(q.next()) {
+		StoredCourse sc;
+		sc.id = q.value("id").toInt();
+		sc.length = q.value("length").toInt();
+		sc.climb = q.value("climb").toInt();
+		sc.note = q.value("note").toString();
+		QString name = q.value("name").toString();
+		if(m_storedCourses.contains(name)) {
+			m_duplicateCourseIds << sc.id;
+			continue;
+		}
+		m_storedCourses[name] = sc;
+		course_names[sc.id] = name;
+	}
+	for(const QString &ids : idLists(course_names.keys())) {
+		q.exec("SELECT coursecodes.courseId, codes.code FROM coursecodes"
+			   " JOIN codes ON coursecodes.codeId=codes.id"
+			   " WHERE coursecodes.courseId IN (" + ids + ")"
+			   " ORDER BY coursecodes.courseId, coursecodes.position", qf::core::Exception::Throw);
+		while(q.next())
+			m_storedCourses[course_names.value(q.value(0).toInt())].codes << q.value(1).toInt();
+	}
+}
+
+QMap<int, int> CoursesImporter::loadCodeIds()
+{
+	QMap<int, int> ret;
+	qfs::Query q;
+	const QString stage_note = 'E' + QString::number(m_stageId);
+	q.exec("SELECT id, code FROM codes"
+		   " WHERE note='" + stage_note + "' OR note LIKE '" + stage_note + " %'"
+		   " ORDER BY id", qf::core::Exception::Throw);
+	while(q.next()) {
+		int code = q.value(1).toInt();
+		if(!ret.contains(code))
+			ret[code] = q.value(0).toInt();
+	}
+	/// codes assigned to stage courses by hand can have different note
+	QList<int> course_ids;
+	for(const StoredCourse &sc : m_storedCourses)
+		course_ids << sc.id;
+	for(const QString &ids : idLists(course_ids)) {
+		q.exec("SELECT codes.id, codes.code FROM codes"
+			   " JOIN coursecodes ON coursecodes.codeId=codes.id"
+			   " WHERE coursecodes.courseId IN (" + ids + ")"
+			   " ORDER BY codes.id", qf::core::Exception::Throw);
+		while(q.next()) {
+			int code = q.value(1).toInt();
+			if(!ret.contains(code))
+				ret[code] = q.value(0).toInt();
+		}
+	}
+	return ret;
+}
+
+void CoursesImporter::assignClassdefs(const QMap<int, int> &class_course_ids)
+{
+	QList<QPair<int, int>> changes; //< classId, courseId
+	qfs::Query q;
+	q.exec("SELECT classId, courseId FROM classdefs WHERE stageId=" QF_IARG(m_stageId), qf::core::Exception::Throw);
+	while(q.next()) {
+		int class_id = q.value(0).toInt();
+		if(!m_clearUnassignedClasses && !class_course_ids.contains(class_id))
+			continue;
+		int course_id = class_course_ids.value(class_id);
+		if(q.value(1).toInt() != course_id)
+			changes << qMakePair(class_id, course_id);
+	}
+	qfDebug() << "classdefs to update:" << changes.count();
+	if(changes.isEmpty())
+		return;
+	q.prepare("UPDATE classdefs SET courseId=? WHERE classId=? AND stageId=?", qf::core::Exception::Throw);
+	for(const auto &change : changes) {
+		q.bindValue(0, change.second > 0? QVariant(change.second): QVariant(QVariant::Int));
+		q.bindValue(1, change.first);
+		q.bindValue(2, m_stageId);
+		q.exec(qf::core::Exception::Throw);
+	}
+}
+
+void CoursesImporter::dropCourses(const QList<int> &course_ids)
+{
+	qfs::Query q;
+	for(const QString &ids : idLists(course_ids)) {
+		/// course can be still assigned to class in other stage
+		q.exec("DELETE FROM coursecodes WHERE courseId IN (" + ids + ")"
+			   " AND courseId NOT IN (SELECT courseId FROM classdefs WHERE courseId IS NOT NULL)", qf::core::Exception::Throw);
+		q.exec("DELETE FROM courses WHERE id IN (" + ids + ")"
+			   " AND id NOT IN (SELECT courseId FROM classdefs WHERE courseId IS NOT NULL)", qf::core::Exception::Throw);
+		m_droppedCount += q.numRowsAffected();
+	}
+	q.exec("DELETE FROM codes WHERE id IN ("
+		"SELECT codes.id FROM codes LEFT JOIN coursecodes ON coursecodes.codeId=codes.id WHERE coursecodes.Id IS NULL"
+		")", qf::core::Exception::Throw);
+}
+
+QMap<QString, int> CoursesImporter::insertRows(const QString &table, const QStringList &fields, const QList<QVariantList> &rows, const QString &key_field)
+{
+	QMap<QString, int> ret;
+	if(rows.isEmpty())
+		return ret;
+	qfs::Connection conn = qfs::Connection::forName();
+	bool is_psql = conn.driverName().endsWith(QLatin1String("PSQL"), Qt::CaseInsensitive);
+	qfs::Query q(conn);
+	if(!key_field.isEmpty() && !is_psql) {
+		/// SQLite has no RETURNING, prepared statement executed per row in transaction is cheap there
+		QStringList placeholders;
+		for (int i = 0; i < fields.count(); ++i)
+			placeholders << QStringLiteral("?");
+		q.prepare("INSERT INTO " + table + " (" + fields.join(", ") + ") VALUES (" + placeholders.join(", ") + ")", qf::core::Exception::Throw);
+		int key_ix = fields.indexOf(key_field);
+		for(const QVariantList &row : rows) {
+			for (int i = 0; i < row.count(); ++i)
+				q.bindValue(i, row[i]);
+			q.exec(qf::core::Exception::Throw);
+			ret[row.value(key_ix).toString()] = q.lastInsertId().toInt();
+		}
+		return ret;
+	}
+	/// keep number of bound variables under SQLite limit 999
+	const int chunk_size = qMax(1, 900 / fields.count());
+	for (int i = 0; i < rows.count(); i += chunk_size) {
+		int n = qMin(chunk_size, rows.count() - i);
+		QStringList placeholders;
+		for (int j = 0; j < fields.count(); ++j)
+			placeholders << QStringLiteral("?");
+		const QString row_placeholders = '(' + placeholders.join(", ") + ')';
+		QStringList values;
+		for (int j = 0; j < n; ++j)
+			values << row_placeholders;
+		QString qs = "INSERT INTO " + table + " (" + fields.join(", ") + ") VALUES " + values.join(", ");
+		if(!key_field.isEmpty())
+			qs += " RETURNING id, " + key_field;
+		q.prepare(qs, qf::core::Exception::Throw);
+		int bind_ix = 0;
+		for (int j = i; j < i + n; ++j) {
+			for(const QVariant &v : rows[j])
+				q.bindValue(bind_ix++, v);
+		}
+		q.exec(qf::core::Exception::Throw);
+		while(q.next())
+			ret[q.value(1).toString()] = q.value(0).toInt();
+	}
+	return ret;
+}
+
+QStringList CoursesImporter::idLists(const QList<int> &ids)
+{
+	QStringList ret;
+	QStringList id_list;
+	for (int i = 0; i < ids.count(); ++i) {
+		id_list << QString::number(ids[i]);
+		if(id_list.count() == 500 || i == ids.count() - 1) {
+			ret << id_list.join(',');
+			id_list.clear();
+		}
+	}
+	return ret;
+}
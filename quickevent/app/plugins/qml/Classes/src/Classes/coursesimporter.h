@@ -0,0 +1,73 @@
+#ifndef CLASSES_COURSESIMPORTER_H
+#define CLASSES_COURSESIMPORTER_H
+
+#include <qf/core/exception.h>
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+
+struct CourseDef;
+
+namespace Classes {
+
+/// Set based import of stage courses.
+/// Existing courses, codes and classdefs of stage are loaded by few queries, import is diffed in memory
+/// and only changed rows are written, new rows are inserted by multi-row statements.
+/// Courses are matched by name, so re-import of the same data touches nothing.
+/// Import does not start transaction, caller is supposed to call it in one.
+class CoursesImporter
+{
+public:
+	CoursesImporter(int stage_id, bool is_relays);
+
+	void importCourses(const QList<CourseDef> &course_defs) throw(qf::core::Exception);
+
+	/// When set, classes of stage which are not assigned to any imported course get NULL course,
+	/// otherwise their course assignment is left untouched. Default is false.
+	bool isClearUnassignedClasses() const {return m_clearUnassignedClasses;}
+	void setClearUnassignedClasses(bool b) {m_clearUnassignedClasses = b;}
+
+	int insertedCount() const {return m_insertedCount;}
+	int updatedCount() const {return m_updatedCount;}
+	int unchangedCount() const {return m_unchangedCount;}
+	int droppedCount() const {return m_droppedCount;}
+private:
+	struct StoredCourse
+	{
+		int id = 0;
+		int length = 0;
+		int climb = 0;
+		QString note;
+		QList<int> codes;
+		bool used = false;
+	};
+	void loadStoredCourses();
+	/// code -> codes.id, only codes created for this stage or used by its courses are considered,
+	/// since codes rows carry stage specific flags
+	QMap<int, int> loadCodeIds();
+	/// class id -> course id, classes not in map are cleared only if isClearUnassignedClasses()
+	void assignClassdefs(const QMap<int, int> &class_course_ids);
+	void dropCourses(const QList<int> &course_ids);
+
+	/// insert rows by multi-row VALUES statements
+	/// @return key field value -> id of inserted row, empty if key_field is empty
+	static QMap<QString, int> insertRows(const QString &table, const QStringList &fields, const QList<QVariantList> &rows, const QString &key_field = QString());
+	static QStringList idLists(const QList<int> &ids);
+private:
+	int m_stageId;
+	bool m_isRelays;
+	bool m_clearUnassignedClasses = false;
+	QMap<QString, StoredCourse> m_storedCourses; //< course name -> stored course
+	QList<int> m_duplicateCourseIds;
+	int m_insertedCount = 0;
+	int m_updatedCount = 0;
+	int m_unchangedCount = 0;
+	int m_droppedCount = 0;
+};
+
+}
+
+#endif // CLASSES_COURSESIMPORTER_H
@@ -26,6 +26,7 @@
 
 #include <QDomDocument>
 #include <QComboBox>
+#include <QPushButton>
 #include <QStyledItemDelegate>
 
 namespace qfc = qf::core;
@@ -366,8 +367,16 @@ void ClassesWidget::importCourses(const QList<CourseDef> &course_defs)
 	auto *event_plugin = qobject_cast<Event::EventPlugin *>(fwk->plugin("Event"));
 	auto *classes_plugin = qobject_cast<Classes::ClassesPlugin *>(fwk->plugin("Classes"));
 	if(event_plugin && classes_plugin) {
-		QString msg = tr("Delete all courses definitions for stage %1?").arg(selectedStageId());
-		if(qfd::MessageBox::askYesNo(fwk, msg, false)) {
+		qfd::MessageBox mbx(fwk);
+		mbx.setIcon(QMessageBox::Question);
+		mbx.setText(tr("Import courses definitions for stage %1.").arg(selectedStageId()));
+		mbx.setInformativeText(tr("Update only changed courses or delete all courses definitions of stage and import them again?"));
+		QAbstractButton *bt_update = mbx.addButton(tr("Update changed"), QMessageBox::AcceptRole);
+		QAbstractButton *bt_replace = mbx.addButton(tr("Delete all"), QMessageBox::DestructiveRole);
+		mbx.addButton(QMessageBox::Cancel);
+		mbx.exec();
+		bool diff_mode = (mbx.clickedButton() == bt_update);
+		if(diff_mode || mbx.clickedButton() == bt_replace) {
 			QVariantList courses;
 			for(const auto &cd : course_defs)
 				courses << cd;
@@ -377,7 +386,7 @@ void ClassesWidget::importCourses(const QList<CourseDef> &course_defs)
 				qfInfo() << doc.toJson();
 			}
 			*/
-			classes_plugin->createCourses(selectedStageId(), courses);
+			classes_plugin->createCourses(selectedStageId(), courses, diff_mode);
 			reload();
 		}
 	}
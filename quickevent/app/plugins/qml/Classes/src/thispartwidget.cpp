@@ -8,11 +8,12 @@ ThisPartWidget::ThisPartWidget(QWidget *parent)
 {
 	setPersistentSettingsId("Classes");
 	setTitle(tr("Classes"));
+}
 
+void ThisPartWidget::lazyInit()
+{
 	ClassesWidget *w = new ClassesWidget();
 	centralFrame()->addWidget(w);
 	w->settleDownInPartWidget(this);
-
-	//QMetaObject::invokeMethod(this, "lazyInit", Qt::QueuedConnection);
 }
 
@@ -10,6 +10,8 @@ private:
 	typedef quickevent::PartWidget Super;
 public:
 	ThisPartWidget(QWidget *parent = nullptr);
+protected:
+	void lazyInit() Q_DECL_OVERRIDE;
 };
 
 #endif // THISPARTWIDGET_H
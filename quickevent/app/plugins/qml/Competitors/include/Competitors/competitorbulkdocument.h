@@ -0,0 +1 @@
+#include "../../src/Competitors/competitorbulkdocument.h"
@@ -3,7 +3,9 @@ message(including $$PWD)
 HEADERS += \
     $$PWD/competitorsplugin.h \
     $$PWD/competitordocument.h \
+    $$PWD/competitorbulkdocument.h \
 
 SOURCES += \
     $$PWD/competitorsplugin.cpp \
     $$PWD/competitordocument.cpp \
+    $$PWD/competitorbulkdocument.cpp \
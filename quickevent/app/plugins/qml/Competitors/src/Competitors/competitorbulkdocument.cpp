@@ -0,0 +1,136 @@
+#include "competitorbulkdocument.h"
+
+#include <Event/eventplugin.h>
+#include <Event/competitortotals.h>
+
+#include <qf/qmlwidgets/framework/mainwindow.h>
+#include <qf/qmlwidgets/framework/plugin.h>
+
+#include <qf/core/exception.h>
+#include <qf/core/sql/connection.h>
+#include <qf/core/sql/query.h>
+#include <qf/core/assert.h>
+
+using namespace Competitors;
+
+namespace {
+const auto SIID = QStringLiteral("siId");
+}
+
+static Event::EventPlugin* eventPlugin()
+{
+	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
+	qf::qmlwidgets::framework::Plugin *plugin = fwk->plugin("Event");
+	return qobject_cast<Event::EventPlugin *>(plugin);
+}
+
+CompetitorBulkDocument::CompetitorBulkDocument(const QString &connection_name)
+	: Super(QStringLiteral("competitors"), connection_name)
+{
+}
+
+void CompetitorBulkDocument::setSiid(int ix, const QVariant &siid, bool save_siid_to_runs)
+{
+	setValue(ix, SIID, siid);
+	if(save_siid_to_runs)
+		m_siidNotSavedToRuns.remove(ix);
+	else
+		m_siidNotSavedToRuns << ix;
+}
+
+QVariant CompetitorBulkDocument::siid(int ix) const
+{
+	return value(ix, SIID);
+}
+
+void CompetitorBulkDocument::save()
+{
+	qfLogFuncFrame();
+	m_changedCompetitorIds.clear();
+	Super::save();
+	if(!m_changedCompetitorIds.isEmpty()) {
+		/// one summarized event per save, long id lists would not fit into NOTIFY payload
+		QVariant payload;
+		if(m_changedCompetitorIds.count() <= MAX_EVENT_PAYLOAD_IDS) {
+			QVariantList ids;
+			for(int id : m_changedCompetitorIds)
+				ids << id;
+			payload = ids;
+		}
+		eventPlugin()->emitDbEvent(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED, payload);
+	}
+}
+
+void CompetitorBulkDocument::nullZeroSiids(const QList<int> &ixs)
+{
+	for(int ix : ixs) {
+		if(isDirty(ix, SIID) && siid(ix).toInt() == 0)
+			setValue(ix, SIID, QVariant());
+	}
+}
+
+void CompetitorBulkDocument::dropRecords(const QList<int> &ixs)
+{
+	qf::core::sql::Query q(connectionName());
+	for(const QString &ids : idLists(ixs))
+		q.exec("DELETE FROM runs WHERE competitorId IN (" + ids + ")", qf::core::Exception::Throw);
+	Super::dropRecords(ixs);
+	for(int ix : ixs)
+		m_changedCompetitorIds << dataId(ix).toInt();
+}
+
+void CompetitorBulkDocument::updateRecords(const QList<int> &ixs)
+{
+	nullZeroSiids(ixs);
+	Super::updateRecords(ixs);
+	QList<int> competitor_ids;
+	QList<QVariantList> siids;
+	for(int ix : ixs) {
+		if(isDirty(ix, QStringLiteral("classId")))
+			m_changedCompetitorIds << dataId(ix).toInt();
+		if(!isDirty(ix, SIID) || !isSaveSiidToRuns(ix))
+			continue;
+		competitor_ids << dataId(ix).toInt();
+		siids << QVariantList{siid(ix)};
+	}
+	updateRows(QStringLiteral("runs"), QStringLiteral("competitorId"), QStringList{SIID}, competitor_ids, siids);
+}
+
+void CompetitorBulkDocument::insertRecords(const QList<int> &ixs)
+{
+	nullZeroSiids(ixs);
+	Super::insertRecords(ixs);
+	auto *event_plugin = eventPlugin();
+	QF_ASSERT(event_plugin != nullptr, "invalid Event plugin type", return);
+	int stage_count = event_plugin->stageCount();
+	if(stage_count <= 0)
+		return;
+	/// runs of many competitors are inserted by one statement, chunked to fit SQLite 999 bound variables limit
+	const int chunk_size = qMax(1, 300 / stage_count);
+	qf::core::sql::Query q(connectionName());
+	for (int i = 0; i < ixs.count(); i += chunk_size) {
+		const int n = qMin(chunk_size, ixs.count() - i);
+		QStringList values;
+		for (int j = 0; j < n * stage_count; ++j)
+			values << QStringLiteral("(?, ?, ?)");
+		q.prepare("INSERT INTO runs (competitorId, stageId, siId) VALUES " + values.join(", "), qf::core::Exception::Throw);
+		int bind_ix = 0;
+		for (int j = i; j < i + n; ++j) {
+			int ix = ixs[j];
+			QVariant competitor_id = dataId(ix);
+			QVariant siid = isSaveSiidToRuns(ix)? this->siid(ix): QVariant(QVariant::Int);
+			for(int stage_id = 1; stage_id <= stage_count; stage_id++) {
+				q.bindValue(bind_ix++, competitor_id);
+				q.bindValue(bind_ix++, stage_id);
+				q.bindValue(bind_ix++, siid);
+			}
+		}
+		q.exec(qf::core::Exception::Throw);
+	}
+	QList<int> competitor_ids;
+	for(int ix : ixs)
+		competitor_ids << dataId(ix).toInt();
+	Event::CompetitorTotals totals(qf::core::sql::Connection::forName(connectionName()), stage_count);
+	totals.updateCompetitors(competitor_ids);
+	m_changedCompetitorIds += competitor_ids;
+}
@@ -0,0 +1,43 @@
+#ifndef COMPETITORS_COMPETITORBULKDOCUMENT_H
+#define COMPETITORS_COMPETITORBULKDOCUMENT_H
+
+#include "../competitorspluginglobal.h"
+
+#include <qf/core/model/sqlbulkdocument.h>
+
+#include <QSet>
+
+namespace Competitors {
+
+/// Bulk counterpart of CompetitorDocument used by imports.
+/// Runs of inserted, edited and dropped competitors are maintained by batched statements
+/// and DBEVENT_COMPETITOR_COUNTS_CHANGED is emitted at most once per save() with list of changed competitor ids
+/// as payload, payload is null when more than MAX_EVENT_PAYLOAD_IDS competitors are changed.
+class COMPETITORSPLUGIN_DECL_EXPORT CompetitorBulkDocument : public qf::core::model::SqlBulkDocument
+{
+private:
+	typedef qf::core::model::SqlBulkDocument Super;
+public:
+	static constexpr int MAX_EVENT_PAYLOAD_IDS = 500;
+public:
+	CompetitorBulkDocument(const QString &connection_name = QString());
+
+	void setSiid(int ix, const QVariant &siid, bool save_siid_to_runs);
+	QVariant siid(int ix) const;
+	bool isSaveSiidToRuns(int ix) const {return !m_siidNotSavedToRuns.contains(ix);}
+
+	void save() Q_DECL_OVERRIDE;
+protected:
+	void dropRecords(const QList<int> &ixs) Q_DECL_OVERRIDE;
+	void updateRecords(const QList<int> &ixs) Q_DECL_OVERRIDE;
+	void insertRecords(const QList<int> &ixs) Q_DECL_OVERRIDE;
+private:
+	void nullZeroSiids(const QList<int> &ixs);
+private:
+	QSet<int> m_siidNotSavedToRuns;
+	QList<int> m_changedCompetitorIds;
+};
+
+}
+
+#endif // COMPETITORS_COMPETITORBULKDOCUMENT_H
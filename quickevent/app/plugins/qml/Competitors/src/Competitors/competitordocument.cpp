@@ -1,6 +1,7 @@
 #include "competitordocument.h"
 
 #include <Event/eventplugin.h>
+#include <Event/competitortotals.h>
 
 #include <qf/qmlwidgets/framework/mainwindow.h>
 #include <qf/qmlwidgets/framework/plugin.h>
@@ -9,6 +10,7 @@
 #include <qf/core/sql/query.h>
 #include <qf/core/sql/transaction.h>
 #include <qf/core/assert.h>
+#include <qf/core/utils.h>
 
 using namespace Competitors;
 
@@ -54,18 +56,28 @@ bool CompetitorDocument::saveData()
 			QF_ASSERT(event_plugin != nullptr, "invalid Event plugin type", return false);
 
 			int stage_count = event_plugin->stageCount();
-			qf::core::sql::Query q(model()->connectionName());
-			q.prepare("INSERT INTO runs (competitorId, stageId, siId) VALUES (:competitorId, :stageId, :siId)");
 			m_lastInsertedRunsIds.clear();
-			for(int i=0; i<stage_count; i++) {
-				q.bindValue(":competitorId", competitor_id);
-				q.bindValue(":stageId", i + 1);
-				if(isSaveSiidToRuns())
-					q.bindValue(":siId", siid());
+			if(stage_count > 0) {
+				/// all stages runs are inserted by one statement
+				QStringList values;
+				for(int i=0; i<stage_count; i++)
+					values << QStringLiteral("(?, ?, ?)");
+				qf::core::sql::Query q(model()->connectionName());
+				q.prepare("INSERT INTO runs (competitorId, stageId, siId) VALUES " + values.join(", "), qf::core::Exception::Throw);
+				QVariant run_siid = isSaveSiidToRuns()? siid(): QVariant(QVariant::Int);
+				for(int i=0; i<stage_count; i++) {
+					q.bindValue(3 * i, competitor_id);
+					q.bindValue(3 * i + 1, i + 1);
+					q.bindValue(3 * i + 2, run_siid);
+				}
 				q.exec(qf::core::Exception::Throw);
-				m_lastInsertedRunsIds << q.lastInsertId().toInt();
+				q.exec("SELECT id FROM runs WHERE competitorId=" QF_IARG(competitor_id) " ORDER BY stageId", qf::core::Exception::Throw);
+				while(q.next())
+					m_lastInsertedRunsIds << q.value(0).toInt();
+				Event::CompetitorTotals totals(qf::core::sql::Connection::forName(model()->connectionName()), stage_count);
+				totals.updateCompetitors(QList<int>() << competitor_id);
 			}
-			eventPlugin()->emitDbEvent(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED);
+			eventPlugin()->emitDbEvent(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED, QVariantList{competitor_id});
 		}
 		else if(old_mode == DataDocument::ModeEdit) {
 			if(siid_dirty) {
@@ -80,7 +92,7 @@ bool CompetitorDocument::saveData()
 				}
 			}
 			if(class_dirty)
-				eventPlugin()->emitDbEvent(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED);
+				eventPlugin()->emitDbEvent(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED, QVariantList{dataId()});
 		}
 	}
 	return ret;
@@ -100,7 +112,7 @@ bool CompetitorDocument::dropData()
 	}
 	if(ret) {
 		ret = Super::dropData();
-		eventPlugin()->emitDbEvent(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED);
+		eventPlugin()->emitDbEvent(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED, QVariantList{id});
 	}
 	return ret;
 }
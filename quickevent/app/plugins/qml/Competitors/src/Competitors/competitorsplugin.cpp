@@ -120,6 +120,7 @@ void CompetitorsPlugin::reloadRegistrationsModel()
 		registrationsModel()->clearRows();
 	// clear registration table to be regenerated when registrationsTable() will be called
 	m_registrationsTable = qf::core::utils::Table();
+	m_registrationsSearchIndex.clear();
 }
 
 qf::core::model::SqlTableModel* CompetitorsPlugin::registrationsModel()
@@ -147,18 +148,25 @@ const qf::core::utils::Table &CompetitorsPlugin::registrationsTable()
 	qf::core::model::SqlTableModel *m = registrationsModel();
 	if(m_registrationsTable.isNull() && !m->table().isNull()) {
 		m_registrationsTable = m->table();
-		auto c_nsk = QStringLiteral("competitorNameAscii7");
-		m_registrationsTable.appendColumn(c_nsk, QVariant::String);
-		int ix_nsk = m_registrationsTable.fields().fieldIndex(c_nsk);
-		int ix_cname = m_registrationsTable.fields().fieldIndex(QStringLiteral("competitorName"));
+		m_registrationsSearchIndex.clear();
+		const qf::core::utils::Table::FieldList &fields = m_registrationsTable.fields();
+		int ix_cname = fields.fieldIndex(QStringLiteral("competitorName"));
+		int ix_registration = fields.fieldIndex(QStringLiteral("registration"));
+		int ix_siid = fields.fieldIndex(QStringLiteral("siid"));
 		for (int i = 0; i < m_registrationsTable.rowCount(); ++i) {
-			qf::core::utils::TableRow &row_ref = m_registrationsTable.rowRef(i);
-			QString nsk = row_ref.value(ix_cname).toString();
-			nsk = QString::fromLatin1(qf::core::Collator::toAscii7(QLocale::Czech, nsk, true));
-			row_ref.setValue(ix_nsk, nsk);
+			qf::core::utils::TableRow row = m_registrationsTable.row(i);
+			m_registrationsSearchIndex.addItem(row.value(ix_cname).toString() + ' '
+											   + row.value(ix_registration).toString()
+											   + " SI:" + row.value(ix_siid).toString());
 		}
 	}
 	return m_registrationsTable;
 }
 
+const qf::core::utils::SearchIndex &CompetitorsPlugin::registrationsSearchIndex()
+{
+	registrationsTable();
+	return m_registrationsSearchIndex;
+}
+
 }
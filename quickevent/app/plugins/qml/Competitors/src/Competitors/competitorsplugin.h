@@ -7,6 +7,7 @@
 
 #include <qf/core/utils.h>
 #include <qf/core/utils/table.h>
+#include <qf/core/utils/searchindex.h>
 
 namespace qf {
 
@@ -50,6 +51,8 @@ public:
 	Q_SLOT void reloadRegistrationsModel();
 	qf::core::model::SqlTableModel* registrationsModel();
 	const qf::core::utils::Table& registrationsTable();
+	/// search index of registrationsTable() rows, item id is row number
+	const qf::core::utils::SearchIndex& registrationsSearchIndex();
 private:
 	Q_SLOT void onInstalled();
 	void onRegistrationsDockVisibleChanged(bool on = true);
@@ -59,6 +62,7 @@ private:
 	qf::qmlwidgets::framework::DockWidget *m_registrationsDockWidget = nullptr;
 	qf::core::model::SqlTableModel *m_registrationsModel = nullptr;
 	qf::core::utils::Table m_registrationsTable;
+	qf::core::utils::SearchIndex m_registrationsSearchIndex;
 };
 
 }
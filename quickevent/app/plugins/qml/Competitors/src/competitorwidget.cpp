@@ -6,6 +6,7 @@
 #include "registrationswidget.h"
 
 #include "Event/eventplugin.h"
+#include "Event/competitortotals.h"
 
 #include <quickevent/og/itemdelegate.h>
 #include <quickevent/og/sqltablemodel.h>
@@ -16,6 +17,7 @@
 #include <qf/qmlwidgets/dialogs/messagebox.h>
 #include <qf/qmlwidgets/framework/mainwindow.h>
 
+#include <qf/core/sql/connection.h>
 #include <qf/core/sql/dbenum.h>
 #include <qf/core/sql/transaction.h>
 #include <qf/core/assert.h>
@@ -223,8 +225,16 @@ bool CompetitorWidget::saveRunsTable()
 	if(is_running_set)
 		throw BadDataInputException(tr("Canont set not running flag for competitor with valid finish time."));
 	bool ret = m_runsModel->postAll(true);
-	if(ret)
+	if(ret) {
+		/// run flags edited here are part of n-stage totals, saveData() runs this in its transaction
+		Competitors::CompetitorDocument *doc = qobject_cast<Competitors::CompetitorDocument*>(dataController()->document());
+		int competitor_id = doc->value(QStringLiteral("competitors.id")).toInt();
+		if(competitor_id > 0) {
+			Event::CompetitorTotals totals(qf::core::sql::Connection::forName(m_runsModel->connectionName()), eventPlugin()->stageCount());
+			totals.updateCompetitors(QList<int>{competitor_id});
+		}
 		eventPlugin()->emitDbEvent(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED);
+	}
 	return ret;
 }
 /*
@@ -5,6 +5,7 @@
 #include <qf/qmlwidgets/framework/mainwindow.h>
 
 #include <qf/core/model/sqltablemodel.h>
+#include <qf/core/utils/searchindex.h>
 #include <qf/core/log.h>
 #include <qf/core/assert.h>
 
@@ -21,10 +22,13 @@ static Competitors::CompetitorsPlugin* competitorsPlugin()
 	return plugin;
 }
 
+/// Contains only registrations matching the current filter text, completer shows them unfiltered.
 class FindRegistrationsModel : public QAbstractTableModel
 {
 private:
 	typedef QAbstractTableModel Super;
+public:
+	static constexpr int MaxMatchCount = 50;
 public:
 	FindRegistrationsModel(QObject *parent);
 
@@ -32,14 +36,27 @@ public:
 	int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
 	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
 	const qf::core::utils::Table& registrationsTable() const;
+	void setFilterText(const QString &text);
+	/// @return registrationsTable() row number of model row
+	int tableRow(int row) const {return m_matches.value(row, -1);}
 private:
 	mutable qf::core::utils::Table m_registrationsTable;
+	qf::core::utils::SearchIndex m_searchIndex;
+	QVector<int> m_matches;
 };
 
 FindRegistrationsModel::FindRegistrationsModel(QObject *parent)
 	: Super(parent)
 {
 	m_registrationsTable = competitorsPlugin()->registrationsTable();
+	m_searchIndex = competitorsPlugin()->registrationsSearchIndex();
+}
+
+void FindRegistrationsModel::setFilterText(const QString &text)
+{
+	beginResetModel();
+	m_matches = m_searchIndex.search(text, MaxMatchCount);
+	endResetModel();
 }
 
 const qf::core::utils::Table &FindRegistrationsModel::registrationsTable() const
@@ -50,33 +67,25 @@ const qf::core::utils::Table &FindRegistrationsModel::registrationsTable() const
 int FindRegistrationsModel::rowCount(const QModelIndex &parent) const
 {
 	Q_UNUSED(parent)
-	const qf::core::utils::Table &table = registrationsTable();
-	return table.rowCount();
+	return m_matches.count();
 }
 
 QVariant FindRegistrationsModel::data(const QModelIndex &index, int role) const
 {
 	const qf::core::utils::Table &table = registrationsTable();
-	int row_no = index.row();
+	int row_no = tableRow(index.row());
 	if(row_no >= 0 && row_no < table.rowCount()) {
 		qf::core::utils::TableRow table_row = table.row(row_no);
 		const qf::core::utils::Table::FieldList &fields = table.fields();
 		static auto col_name = fields.fieldIndex(QStringLiteral("competitorName"));
-		static auto col_searchkey = fields.fieldIndex(QStringLiteral("competitorNameAscii7"));
 		static int col_registration = fields.fieldIndex(QStringLiteral("registration"));
 		static auto col_siid = fields.fieldIndex(QStringLiteral("siid"));
 		static auto SI = QStringLiteral("SI:");
-		if(role == Qt::DisplayRole || role == Qt::EditRole) {
+		if(role == Qt::DisplayRole || role == Qt::EditRole || role == FindRegistrationEdit::CompletionRole) {
 			return table_row.value(col_name).toString() + ' '
 					+ table_row.value(col_registration).toString() + ' '
 					+ SI + table_row.value(col_siid).toString();
 		}
-		else if(role == FindRegistrationEdit::CompletionRole) {
-			return table_row.value(col_searchkey).toString() + ' '
-					+ table_row.value(col_registration).toString() + ' '
-					+ SI + table_row.value(col_siid).toString() + ' '
-					+ table_row.value(col_name).toString();
-		}
 	}
 	return QVariant();
 }
@@ -88,8 +97,15 @@ FindRegistrationEdit::FindRegistrationEdit(QWidget *parent)
 	QCompleter *cmpl = new QCompleter(m_findRegistrationsModel, this);
 	cmpl->setCompletionRole(CompletionRole);
 	cmpl->setCaseSensitivity(Qt::CaseInsensitive);
-	cmpl->setFilterMode(Qt::MatchContains);
+	/// model is filtered by search index, completer just shows it
+	cmpl->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
 	setCompleter(cmpl);
+	connect(this, &FindRegistrationEdit::textEdited, this, &FindRegistrationEdit::onTextEdited);
+}
+
+void FindRegistrationEdit::onTextEdited(const QString &text)
+{
+	m_findRegistrationsModel->setFilterText(text);
 }
 
 void FindRegistrationEdit::focusInEvent(QFocusEvent *event)
@@ -110,7 +126,7 @@ void FindRegistrationEdit::onCompleterActivated(const QModelIndex &index)
 	QF_ASSERT(proxy_model != nullptr, "Bad proxy model!", return);
 	QModelIndex ix = proxy_model->mapToSource(index);
 	const qf::core::utils::Table &table = m_findRegistrationsModel->registrationsTable();
-	int row_no = ix.row();
+	int row_no = m_findRegistrationsModel->tableRow(ix.row());
 	if(row_no >= 0 && row_no < table.rowCount()) {
 		qf::core::utils::TableRow table_row = table.row(row_no);
 		emit registrationSelected(table_row.valuesMap(false));
@@ -20,6 +20,7 @@ protected:
 	void focusInEvent(QFocusEvent * event) Q_DECL_OVERRIDE;
 private:
 	Q_SLOT void onCompleterActivated(const QModelIndex &index);
+	Q_SLOT void onTextEdited(const QString &text);
 private:
 	FindRegistrationsModel *m_findRegistrationsModel = nullptr;
 };
@@ -0,0 +1 @@
+#include "../../src/Event/competitortotals.h"
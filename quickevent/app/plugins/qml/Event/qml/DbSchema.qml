@@ -239,6 +239,42 @@ Schema {
 				Index {fields: ['stageId', 'siId']; unique: false }
 			]
 		},
+		Table { name: 'competitorTotals'
+			fields: [
+				Field { name: 'id'; type: Serial { primaryKey: true } },
+				Field { name: 'competitorId'; type: Int {} },
+				Field { name: 'stageCount'; type: Int {}
+					notNull: true
+					comment: "Totals after first stageCount stages"
+				},
+				Field { name: 'stagesCompleted'; type: Int {}
+					defaultValue: 0;
+					notNull: true
+				},
+				Field { name: 'timeMs'; type: Int {}
+					defaultValue: 0;
+					notNull: true
+					comment: 'sum of times of completed stages in miliseconds'
+				},
+				Field { name: 'status'; type: Int {}
+					defaultValue: 0;
+					notNull: true
+					comment: '0 - OK, 1 - not competing, 2 - not finished, 3 - disqualified, the worst status of counted stages'
+				}
+			]
+			indexes: [
+				Index {
+					fields: ['competitorId'];
+					references: ForeignKeyReference {
+						table: 'competitors';
+						fields: ['id'];
+						onUpdate: 'RESTRICT';
+						onDelete: 'CASCADE';
+					}
+				},
+				Index {fields: ['stageCount', 'status', 'timeMs']; unique: false }
+			]
+		},
 		Table { name: 'relays'
 			fields: [
 				Field { name: 'id'; type: Serial { primaryKey: true } },
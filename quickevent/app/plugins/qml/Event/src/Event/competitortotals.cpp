@@ -0,0 +1,203 @@
+#include "competitortotals.h"
+
+#include <qf/core/log.h>
+#include <qf/core/utils.h>
+#include <qf/core/exception.h>
+#include <qf/core/sql/query.h>
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+#include <algorithm>
+
+namespace qfs = qf::core::sql;
+
+namespace Event {
+
+namespace {
+/// rows are written as literal numbers, chunks keep statements reasonably long
+const int INSERT_CHUNK_ROWS = 500;
+const int ID_LIST_CHUNK = 500;
+}
+
+bool CompetitorTotals::Total::operator==(const CompetitorTotals::Total &o) const
+{
+	return competitorId == o.competitorId
+			&& stageCount == o.stageCount
+			&& stagesCompleted == o.stagesCompleted
+			&& timeMs == o.timeMs
+			&& status == o.status;
+}
+
+CompetitorTotals::CompetitorTotals(const qf::core::sql::Connection &conn, int stage_count)
+	: m_connection(conn)
+	, m_stageCount(stage_count)
+{
+}
+
+QString CompetitorTotals::intList(const QList<int> &ids, int from, int count)
+{
+	QStringList sl;
+	for (int i = from; i < from + count && i < ids.count(); ++i)
+		sl << QString::number(ids[i]);
+	return sl.join(',');
+}
+
+QList<CompetitorTotals::Total> CompetitorTotals::computeTotals(const QString &competitors_condition)
+{
+	qfLogFuncFrame() << competitors_condition;
+	QList<Total> ret;
+	if(m_stageCount <= 0)
+		return ret;
+	QString qs = "SELECT competitors.id, runs.stageId, runs.timeMs, runs.finishTimeMs, runs.isRunning, runs.notCompeting, runs.disqualified"
+				 " FROM competitors"
+				 " LEFT JOIN runs ON runs.competitorId=competitors.id AND runs.stageId>=1 AND runs.stageId<=" QF_IARG(m_stageCount);
+	if(!competitors_condition.isEmpty())
+		qs += " WHERE " + competitors_condition;
+	qs += " ORDER BY competitors.id, runs.stageId";
+	qfs::Query q(m_connection);
+	q.exec(qs, qf::core::Exception::Throw);
+	int current_id = 0;
+	QVector<int> stage_status;
+	QVector<int> stage_times;
+	auto flush_competitor = [&]() {
+		if(current_id == 0)
+			return;
+		Total t;
+		t.competitorId = current_id;
+		for (int i = 0; i < m_stageCount; ++i) {
+			t.stageCount = i + 1;
+			t.status = std::max(t.status, stage_status[i]);
+			if(stage_status[i] == StatusOk) {
+				t.stagesCompleted++;
+				t.timeMs += stage_times[i];
+			}
+			ret << t;
+		}
+	};
+	while(q.next()) {
+		int competitor_id = q.value(0).toInt();
+		if(competitor_id != current_id) {
+			flush_competitor();
+			current_id = competitor_id;
+			/// stage without run counts as not finished
+			stage_status.fill(StatusNotFinished, m_stageCount);
+			stage_times.fill(0, m_stageCount);
+		}
+		int stage_id = q.value(1).toInt();
+		if(stage_id < 1 || stage_id > m_stageCount)
+			continue;
+		int status = StatusOk;
+		if(q.value(6).toBool())
+			status = StatusDisqualified;
+		else if(!q.value(4).toBool() || q.value(3).toInt() <= 0)
+			status = StatusNotFinished;
+		else if(q.value(5).toBool())
+			status = StatusNotCompeting;
+		stage_status[stage_id - 1] = status;
+		stage_times[stage_id - 1] = q.value(2).toInt();
+	}
+	flush_competitor();
+	return ret;
+}
+
+void CompetitorTotals::insertTotals(const QList<CompetitorTotals::Total> &totals)
+{
+	qfs::Query q(m_connection);
+	for (int i = 0; i < totals.count(); i += INSERT_CHUNK_ROWS) {
+		QStringList values;
+		for (int j = i; j < i + INSERT_CHUNK_ROWS && j < totals.count(); ++j) {
+			const Total &t = totals[j];
+			values << '(' + QString::number(t.competitorId)
+					  + ',' + QString::number(t.stageCount)
+					  + ',' + QString::number(t.stagesCompleted)
+					  + ',' + QString::number(t.timeMs)
+					  + ',' + QString::number(t.status) + ')';
+		}
+		q.exec("INSERT INTO competitorTotals (competitorId, stageCount, stagesCompleted, timeMs, status) VALUES " + values.join(','), qf::core::Exception::Throw);
+	}
+}
+
+void CompetitorTotals::updateCompetitors(const QList<int> &competitor_ids)
+{
+	qfLogFuncFrame() << competitor_ids;
+	qfs::Query q(m_connection);
+	for (int i = 0; i < competitor_ids.count(); i += ID_LIST_CHUNK) {
+		QString ids = intList(competitor_ids, i, ID_LIST_CHUNK);
+		q.exec("DELETE FROM competitorTotals WHERE competitorId IN (" + ids + ")", qf::core::Exception::Throw);
+		insertTotals(computeTotals("competitors.id IN (" + ids + ")"));
+	}
+}
+
+void CompetitorTotals::updateRuns(const QList<int> &run_ids)
+{
+	qfLogFuncFrame() << run_ids;
+	QList<int> competitor_ids;
+	qfs::Query q(m_connection);
+	for (int i = 0; i < run_ids.count(); i += ID_LIST_CHUNK) {
+		q.exec("SELECT DISTINCT competitorId FROM runs WHERE id IN (" + intList(run_ids, i, ID_LIST_CHUNK) + ")", qf::core::Exception::Throw);
+		while(q.next())
+			competitor_ids << q.value(0).toInt();
+	}
+	updateCompetitors(competitor_ids);
+}
+
+QList<int> CompetitorTotals::check()
+{
+	qfLogFuncFrame();
+	QHash<qint64, Total> stored;
+	{
+		qfs::Query q(m_connection);
+		q.exec("SELECT competitorId, stageCount, stagesCompleted, timeMs, status FROM competitorTotals", qf::core::Exception::Throw);
+		while(q.next()) {
+			Total t;
+			t.competitorId = q.value(0).toInt();
+			t.stageCount = q.value(1).toInt();
+			t.stagesCompleted = q.value(2).toInt();
+			t.timeMs = q.value(3).toInt();
+			t.status = q.value(4).toInt();
+			stored[((qint64)t.competitorId << 32) | (quint32)t.stageCount] = t;
+		}
+	}
+	QSet<int> ret;
+	for(const Total &t : computeTotals(QString())) {
+		auto it = stored.find(((qint64)t.competitorId << 32) | (quint32)t.stageCount);
+		if(it == stored.end()) {
+			ret << t.competitorId;
+			continue;
+		}
+		if(!(it.value() == t))
+			ret << t.competitorId;
+		stored.erase(it);
+	}
+	/// rows of stage counts event does not have anymore
+	for(const Total &t : stored)
+		ret << t.competitorId;
+	QList<int> ids = ret.toList();
+	std::sort(ids.begin(), ids.end());
+	qfInfo() << "competitor totals check, inconsistent competitors:" << ids.count();
+	return ids;
+}
+
+void CompetitorTotals::rebuild()
+{
+	qfLogFuncFrame();
+	qfs::Query q(m_connection);
+	q.exec("DELETE FROM competitorTotals", qf::core::Exception::Throw);
+	insertTotals(computeTotals(QString()));
+}
+
+bool CompetitorTotals::needsRebuild()
+{
+	qfs::Query q(m_connection);
+	q.exec("SELECT"
+		   " EXISTS(SELECT 1 FROM competitors)"
+		   ", EXISTS(SELECT 1 FROM competitorTotals)", qf::core::Exception::Throw);
+	if(q.next())
+		return q.value(0).toBool() && !q.value(1).toBool();
+	return false;
+}
+
+}
@@ -0,0 +1,58 @@
+#ifndef EVENT_COMPETITORTOTALS_H
+#define EVENT_COMPETITORTOTALS_H
+
+#include "../eventpluginglobal.h"
+
+#include <qf/core/sql/connection.h>
+
+#include <QList>
+#include <QString>
+
+namespace Event {
+
+/// Competitor totals after first N stages stored in competitorTotals table.
+/// Row is kept for every competitor and stage count 1..stage_count, so overall results
+/// after N stages are read by one indexed query instead of summing runs of all stages.
+/// Update functions do not start transaction, caller is supposed to write runs and totals in one.
+/// Does not touch plugins, so it can be used in QueryExecutor worker thread.
+class EVENTPLUGIN_DECL_EXPORT CompetitorTotals
+{
+public:
+	/// aggregated status is the worst status of counted stages
+	enum Status {StatusOk = 0, StatusNotCompeting, StatusNotFinished, StatusDisqualified};
+public:
+	CompetitorTotals(const qf::core::sql::Connection &conn, int stage_count);
+
+	/// recompute totals of competitors from their runs
+	void updateCompetitors(const QList<int> &competitor_ids);
+	/// recompute totals of competitors owning runs
+	void updateRuns(const QList<int> &run_ids);
+	/// @return ids of competitors which stored totals differ from their runs
+	QList<int> check();
+	/// drop and recompute totals of all competitors
+	void rebuild();
+	/// @return true if there are competitors but no totals are stored, like in event imported from older version
+	bool needsRebuild();
+private:
+	struct Total
+	{
+		int competitorId = 0;
+		int stageCount = 0;
+		int stagesCompleted = 0;
+		int timeMs = 0;
+		int status = StatusOk;
+
+		bool operator==(const Total &o) const;
+	};
+	/// totals for all stage counts of competitors matching SQL condition, ordered by competitor and stage count
+	QList<Total> computeTotals(const QString &competitors_condition);
+	void insertTotals(const QList<Total> &totals);
+	static QString intList(const QList<int> &ids, int from, int count);
+private:
+	qf::core::sql::Connection m_connection;
+	int m_stageCount;
+};
+
+}
+
+#endif // EVENT_COMPETITORTOTALS_H
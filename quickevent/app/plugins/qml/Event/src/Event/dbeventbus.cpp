@@ -0,0 +1,169 @@
+#include "dbeventbus.h"
+
+#include <qf/core/log.h>
+#include <qf/core/exception.h>
+
+#include <QJsonDocument>
+#include <QTimer>
+
+namespace Event {
+
+namespace {
+/// deliver is called from timer, one failing subscriber must not stop delivery to others
+void callHandler(const DbEventBus::Handler &handler, const QString &domain, const QVariantList &data_list)
+{
+	try {
+		handler(data_list);
+	}
+	catch(const qf::core::Exception &e) {
+		qfError() << "DB event" << domain << "handler error:" << e.message();
+	}
+}
+}
+
+QString DbEvent::toPayload() const
+{
+	QVariantMap m;
+	m[QStringLiteral("eventName")] = eventName;
+	m[QStringLiteral("domain")] = domain;
+	m[QStringLiteral("connectionId")] = connectionId;
+	m[QStringLiteral("data")] = data;
+	QJsonDocument jsd = QJsonDocument::fromVariant(m);
+	return QString::fromUtf8(jsd.toJson(QJsonDocument::Compact));
+}
+
+bool DbEvent::fromPayload(const QString &payload, DbEvent *event)
+{
+	QJsonParseError error;
+	QJsonDocument jsd = QJsonDocument::fromJson(payload.toUtf8(), &error);
+	if(error.error != QJsonParseError::NoError) {
+		qfError() << "JSON parse error:" << error.errorString();
+		return false;
+	}
+	QVariantMap m = jsd.toVariant().toMap();
+	event->eventName = m.value(QStringLiteral("eventName")).toString();
+	event->domain = m.value(QStringLiteral("domain")).toString();
+	event->connectionId = m.value(QStringLiteral("connectionId")).toInt();
+	event->data = m.value(QStringLiteral("data"));
+	return true;
+}
+
+DbEventBus::DbEventBus(QObject *parent)
+	: Super(parent)
+{
+}
+
+void DbEventBus::setMergeInterval(const QString &domain, int msec)
+{
+	Domain &d = m_domains[domain];
+	d.mergeInterval = msec;
+	if(d.timer)
+		d.timer->setInterval(msec);
+}
+
+void DbEventBus::setKeyFunction(const QString &domain, KeyFunction key_function)
+{
+	m_domains[domain].keyFunction = key_function;
+}
+
+void DbEventBus::subscribe(const QString &domain, QObject *context, Handler handler)
+{
+	subscribe(domain, QVariant(), context, handler);
+}
+
+void DbEventBus::subscribe(const QString &domain, const QVariant &key, QObject *context, Handler handler)
+{
+	Subscription s;
+	s.key = key;
+	s.context = context;
+	s.handler = handler;
+	m_domains[domain].subscriptions << s;
+}
+
+void DbEventBus::unsubscribe(const QString &domain, QObject *context)
+{
+	auto it = m_domains.find(domain);
+	if(it == m_domains.end())
+		return;
+	QList<Subscription> &subs = it.value().subscriptions;
+	for (int i = subs.count() - 1; i >= 0; --i) {
+		if(subs[i].context.isNull() || subs[i].context == context)
+			subs.removeAt(i);
+	}
+}
+
+void DbEventBus::post(const QString &domain, const QVariant &data)
+{
+	auto it = m_domains.find(domain);
+	if(it == m_domains.end())
+		return;
+	Domain &d = it.value();
+	if(d.subscriptions.isEmpty())
+		return;
+	d.pending << data;
+	if(!d.timer) {
+		d.timer = new QTimer(this);
+		d.timer->setSingleShot(true);
+		d.timer->setInterval(d.mergeInterval);
+		connect(d.timer, &QTimer::timeout, [this, domain]() {
+			deliver(domain);
+		});
+	}
+	if(!d.timer->isActive())
+		d.timer->start();
+}
+
+void DbEventBus::flush()
+{
+	for(const QString &domain : m_domains.keys())
+		deliver(domain);
+}
+
+void DbEventBus::deliver(const QString &domain)
+{
+	auto it = m_domains.find(domain);
+	if(it == m_domains.end())
+		return;
+	Domain &d = it.value();
+	if(d.timer)
+		d.timer->stop();
+	if(d.pending.isEmpty())
+		return;
+	QVariantList data_list = d.pending;
+	d.pending.clear();
+	QList<Subscription> subscriptions = d.subscriptions;
+	KeyFunction key_function = d.keyFunction;
+	QVariantList keys;
+	bool has_dead = false;
+	for(const Subscription &s : subscriptions) {
+		if(s.context.isNull()) {
+			has_dead = true;
+			continue;
+		}
+		if(!s.key.isValid()) {
+			callHandler(s.handler, domain, data_list);
+			continue;
+		}
+		if(keys.isEmpty()) {
+			for(const QVariant &data : data_list)
+				keys << (key_function? key_function(data): data);
+		}
+		QVariantList key_data_list;
+		for (int i = 0; i < data_list.count(); ++i) {
+			if(keys[i] == s.key)
+				key_data_list << data_list[i];
+		}
+		if(!key_data_list.isEmpty())
+			callHandler(s.handler, domain, key_data_list);
+	}
+	if(has_dead) {
+		/// handler could add new subscriptions, find domain again
+		QList<Subscription> &subs = m_domains[domain].subscriptions;
+		for (int i = subs.count() - 1; i >= 0; --i) {
+			if(subs[i].context.isNull())
+				subs.removeAt(i);
+		}
+	}
+}
+
+}
@@ -0,0 +1,79 @@
+#ifndef EVENT_DBEVENTBUS_H
+#define EVENT_DBEVENTBUS_H
+
+#include "../eventpluginglobal.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QVariant>
+
+#include <functional>
+
+class QTimer;
+
+namespace Event {
+
+struct EVENTPLUGIN_DECL_EXPORT DbEvent
+{
+	QString eventName;
+	QString domain;
+	int connectionId = 0;
+	QVariant data;
+
+	/// NOTIFY payload, JSON object understood by all client versions
+	QString toPayload() const;
+	static bool fromPayload(const QString &payload, DbEvent *event);
+};
+
+/// Delivers db events to subscribers of event domain, events of other domains are not seen by them.
+/// Events of domain are collected for its merge interval and delivered in one batch
+/// with data of all merged events, so receivers refresh once for a burst of events.
+/// Delivery is always asynchronous, events posted in one event loop pass are merged at least.
+class EVENTPLUGIN_DECL_EXPORT DbEventBus : public QObject
+{
+	Q_OBJECT
+private:
+	typedef QObject Super;
+public:
+	typedef std::function<void (const QVariantList &data_list)> Handler;
+	typedef std::function<QVariant (const QVariant &data)> KeyFunction;
+public:
+	DbEventBus(QObject *parent = nullptr);
+
+	/// events of domain posted within msec are merged, default is 0
+	void setMergeInterval(const QString &domain, int msec);
+	/// key of event data matched by keyed subscriptions, event data itself is the key by default
+	void setKeyFunction(const QString &domain, KeyFunction key_function);
+	/// handler is called with data of merged domain events, subscription ends when context is destroyed
+	void subscribe(const QString &domain, QObject *context, Handler handler);
+	/// handler is called only with data of merged domain events having key equal to key
+	void subscribe(const QString &domain, const QVariant &key, QObject *context, Handler handler);
+	void unsubscribe(const QString &domain, QObject *context);
+	void post(const QString &domain, const QVariant &data);
+	/// deliver all pending events now
+	void flush();
+private:
+	struct Subscription
+	{
+		QVariant key;
+		QPointer<QObject> context;
+		Handler handler;
+	};
+	struct Domain
+	{
+		int mergeInterval = 0;
+		KeyFunction keyFunction;
+		QList<Subscription> subscriptions;
+		QVariantList pending;
+		QTimer *timer = nullptr;
+	};
+	void deliver(const QString &domain);
+private:
+	QHash<QString, Domain> m_domains;
+};
+
+}
+
+#endif // EVENT_DBEVENTBUS_H
@@ -1,4 +1,6 @@
 #include "eventplugin.h"
+#include "dbeventbus.h"
+#include "competitortotals.h"
 #include "../connectdbdialogwidget.h"
 #include "../connectionsettings.h"
 #include "../eventdialogwidget.h"
@@ -24,6 +26,8 @@
 #include <qf/core/sql/querybuilder.h>
 #include <qf/core/sql/connection.h>
 #include <qf/core/sql/transaction.h>
+#include <qf/core/sql/preparedquerycache.h>
+#include <qf/core/sql/queryexecutor.h>
 #include <qf/core/utils/fileutils.h>
 
 #include <QInputDialog>
@@ -39,6 +43,12 @@
 #include <QPushButton>
 #include <QToolButton>
 #include <QDirIterator>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QSet>
+#include <QTimer>
 
 namespace qfw = qf::qmlwidgets;
 namespace qff = qf::qmlwidgets::framework;
@@ -47,43 +57,6 @@ namespace qfs = qf::core::sql;
 
 namespace Event {
 
-class DbEventPayload : public QVariantMap
-{
-private:
-	typedef QVariantMap Super;
-
-	QF_VARIANTMAP_FIELD(QString, e, setE, ventName)
-	QF_VARIANTMAP_FIELD(QString, d, setD, omain)
-	QF_VARIANTMAP_FIELD(int, c, setc, onnectionId)
-	QF_VARIANTMAP_FIELD(QVariant, d, setD, ata)
-public:
-	DbEventPayload(const QVariantMap &data = QVariantMap()) : QVariantMap(data) {}
-
-	static DbEventPayload fromJson(const QByteArray &json);
-
-	QByteArray toJson() const;
-};
-
-DbEventPayload DbEventPayload::fromJson(const QByteArray &json)
-{
-	QJsonParseError error;
-	QJsonDocument jsd = QJsonDocument::fromJson(json, &error);
-	if(error.error == QJsonParseError::NoError) {
-		QVariantMap m = jsd.toVariant().toMap();
-		return DbEventPayload(m);
-	}
-	else {
-		qfError() << "JSON parse error:" << error.errorString();
-	}
-	return DbEventPayload();
-}
-
-QByteArray DbEventPayload::toJson() const
-{
-	QJsonDocument jsd = QJsonDocument::fromVariant(*this);
-	return jsd.toJson(QJsonDocument::Compact);
-}
-
 static auto QBE_EXT = QStringLiteral(".qbe");
 
 const char* EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED = "competitorCountsChanged";
@@ -122,6 +95,20 @@ EventPlugin::EventPlugin(QObject *parent)
 	connect(this, &EventPlugin::eventNameChanged, [this](const QString &event_name) {
 		setEventOpen(!event_name.isEmpty());
 	});
+	m_dbEventBus = new DbEventBus(this);
+	setupDbEventBus(m_dbEventBus);
+}
+
+void EventPlugin::setupDbEventBus(DbEventBus *bus)
+{
+	/// bursts of card reads and punches from radio controls are delivered to receivers in batches
+	bus->setMergeInterval(DBEVENT_CARD_READ, 100);
+	bus->setMergeInterval(DBEVENT_PUNCH_RECEIVED, 100);
+	bus->setMergeInterval(DBEVENT_COMPETITOR_COUNTS_CHANGED, 200);
+	/// punch receivers subscribe by code
+	bus->setKeyFunction(DBEVENT_PUNCH_RECEIVED, [](const QVariant &data) {
+		return QVariant(data.toMap().value(QStringLiteral("code")).toInt());
+	});
 }
 
 void EventPlugin::initEventConfig()
@@ -174,9 +161,10 @@ int EventPlugin::stageIdForRun(int run_id)
 	qfs::QueryBuilder qb;
 	qb.select2("runs", "stageId")
 			.from("runs")
-			.where("runs.id=" QF_IARG(run_id));
+			.where("runs.id=:runId")
+			.bindValue(":runId", run_id);
 	qfs::Query q;
-	q.exec(qb.toString(), qf::core::Exception::Throw);
+	q.exec(qb, qf::core::Exception::Throw);
 	if(q.next())
 		ret = q.value(0).toInt();
 	else
@@ -273,9 +261,6 @@ void EventPlugin::onInstalled()
 	m_actEditEvent = new qfw::Action(tr("E&dit event"));
 	m_actEditEvent->setEnabled(false);
 	connect(m_actEditEvent, SIGNAL(triggered()), this, SLOT(editEvent()));
-	connect(this, &EventPlugin::eventNameChanged, [this](const QString &event_name) {
-		this->m_actEditEvent->setEnabled(!event_name.isEmpty());
-	});
 
 	m_actExportEvent = new qfw::Action(tr("E&xport event"));
 	m_actExportEvent->setEnabled(false);
@@ -285,6 +270,14 @@ void EventPlugin::onInstalled()
 	m_actImportEvent->setEnabled(false);
 	connect(m_actImportEvent, &QAction::triggered, this, &EventPlugin::importEvent_qbe);
 
+	m_actCheckCompetitorTotals = new qfw::Action(tr("Check competitor &totals"));
+	m_actCheckCompetitorTotals->setEnabled(false);
+	connect(m_actCheckCompetitorTotals, &QAction::triggered, this, &EventPlugin::checkCompetitorTotals);
+	connect(this, &EventPlugin::eventNameChanged, [this](const QString &event_name) {
+		this->m_actEditEvent->setEnabled(!event_name.isEmpty());
+		this->m_actCheckCompetitorTotals->setEnabled(!event_name.isEmpty());
+	});
+
 	connect(this, SIGNAL(eventNameChanged(QString)), fwk->statusBar(), SLOT(setEventName(QString)));
 	connect(this, SIGNAL(currentStageIdChanged(int)), fwk->statusBar(), SLOT(setStageNo(int)));
 	connect(fwk, &qff::MainWindow::pluginsLoaded, this, &EventPlugin::connectToSqlServer);
@@ -301,6 +294,24 @@ void EventPlugin::onInstalled()
 	m_actEvent->addActionInto(m_actEditEvent);
 	m_actEvent->addActionInto(m_actExportEvent);
 	m_actEvent->addActionInto(m_actImportEvent);
+	m_actEvent->addSeparatorInto();
+	m_actEvent->addActionInto(m_actCheckCompetitorTotals);
+
+	{
+		qfw::Action *a = new qfw::Action(tr("SQL statement cache statistics"));
+		connect(a, &QAction::triggered, [fwk]() {
+			QString report = qfs::PreparedQueryCache::statisticsReport();
+			if(report.isEmpty())
+				report = tr("No prepared statement executed yet.");
+			qfd::MessageBox::showInfo(fwk, report);
+		});
+		fwk->menuBar()->actionForPath("help")->addActionInto(a);
+	}
+	{
+		qfw::Action *a = new qfw::Action(tr("Replay DB event log"));
+		connect(a, &QAction::triggered, this, &EventPlugin::replayDbEventLog);
+		fwk->menuBar()->actionForPath("help")->addActionInto(a);
+	}
 
 	qfw::ToolBar *tb = fwk->toolBar("Event", true);
 	tb->setObjectName("EventToolbar");
@@ -385,16 +396,16 @@ void EventPlugin::emitDbEvent(const QString &domain, const QVariant &data, bool
 								  Q_ARG(QString, domain),
 								  Q_ARG(int, connection_id),
 								  Q_ARG(QVariant, data));
+		m_dbEventBus->post(domain, data);
 	}
 	if(connectionType() == ConnectionType::SingleFile)
 		return;
-	DbEventPayload dbpl;
-	dbpl.setEventName(eventName());
-	dbpl.setDomain(domain);
-	dbpl.setData(data);
-	dbpl.setconnectionId(connection_id);
-	QByteArray json_ba = dbpl.toJson();
-	QString payload_str = QString::fromUtf8(json_ba);
+	DbEvent db_event;
+	db_event.eventName = eventName();
+	db_event.domain = domain;
+	db_event.data = data;
+	db_event.connectionId = connection_id;
+	QString payload_str = db_event.toPayload();
 	if(payload_str.length() > 4000) {
 		int len = payload_str.toUtf8().length();
 		if(len > 8000) {
@@ -438,7 +449,7 @@ DbSchema EventPlugin::dbSchema()
 
 int EventPlugin::minDbVersion()
 {
-	return 10200;
+	return 10201;
 }
 
 void EventPlugin::onDbEvent(const QString &name, QSqlDriver::NotificationSource source, const QVariant &payload)
@@ -446,21 +457,19 @@ void EventPlugin::onDbEvent(const QString &name, QSqlDriver::NotificationSource
 	qfLogFuncFrame() << "name:" << name << "source:" << source << "payload:" << payload;
 	if(name == QLatin1String(DBEVENT_NOTIFY_NAME)) {
 		if(source == QSqlDriver::OtherSource) {
-			DbEventPayload dbpl = DbEventPayload::fromJson(payload.toString().toUtf8());
-			QString domain = dbpl.domain();
-			if(domain.isEmpty()) {
+			DbEvent db_event;
+			if(!DbEvent::fromPayload(payload.toString(), &db_event) || db_event.domain.isEmpty()) {
 				qfWarning() << "DbNotify with invalid domain, payload:" << payload.toString();
 				return;
 			}
-			QString event_name = dbpl.eventName();
-			if(event_name.isEmpty()) {
-				qfWarning() << "DbNotify with invalid event name, payload:" << event_name << payload.toString();
+			if(db_event.eventName.isEmpty()) {
+				qfWarning() << "DbNotify with invalid event name, payload:" << payload.toString();
 				return;
 			}
-			if(event_name == eventName()) {
-				QVariant data = dbpl.data();
-				qfDebug() << "emitting domain:" << domain << "data:" << data;
-				emit dbEventNotify(domain, dbpl.connectionId(), data);
+			if(db_event.eventName == eventName()) {
+				qfDebug() << "emitting domain:" << db_event.domain << "data:" << db_event.data;
+				emit dbEventNotify(db_event.domain, db_event.connectionId, db_event.data);
+				m_dbEventBus->post(db_event.domain, db_event.data);
 			}
 		}
 		else {
@@ -498,6 +507,19 @@ void EventPlugin::onEventOpened()
 	m_cbxStage->setCurrentIndex(-1);
 	m_cbxStage->blockSignals(false);
 	loadCurrentStageId();
+	{
+		/// event imported from older data version has no competitor totals yet
+		CompetitorTotals totals(qfs::Connection::forName(), stage_cnt);
+		try {
+			if(totals.needsRebuild()) {
+				qfInfo() << "Competitor totals are missing, rebuilding them.";
+				rebuildCompetitorTotals();
+			}
+		}
+		catch (const qf::core::Exception &e) {
+			qfError() << "Check competitor totals error:" << e.message();
+		}
+	}
 	//emit this->currentStageIdChanged(currentStageId());
 }
 
@@ -770,8 +792,163 @@ void EventPlugin::editEvent()
 	if(!dlg.exec())
 		return;
 
+	int old_stage_count = stageCount();
 	eventConfig()->setValue("event", event_w->saveParams());
 	eventConfig()->save("event");
+	/// totals are stored for every stage count
+	if(stageCount() != old_stage_count)
+		rebuildCompetitorTotals();
+}
+
+void EventPlugin::checkCompetitorTotals()
+{
+	qfLogFuncFrame();
+	qff::MainWindow *fwk = qff::MainWindow::frameWork();
+	QList<int> competitor_ids;
+	try {
+		CompetitorTotals totals(qfs::Connection::forName(), stageCount());
+		competitor_ids = totals.check();
+	}
+	catch (const qf::core::Exception &e) {
+		qfd::MessageBox::showException(fwk, e);
+		return;
+	}
+	if(competitor_ids.isEmpty()) {
+		qfd::MessageBox::showInfo(fwk, tr("Competitor totals are consistent with runs."));
+		return;
+	}
+	if(!qfd::MessageBox::askYesNo(fwk, tr("Totals of %1 competitor(s) are not consistent with runs. Rebuild all competitor totals?").arg(competitor_ids.count()), true))
+		return;
+	if(rebuildCompetitorTotals())
+		qfd::MessageBox::showInfo(fwk, tr("Competitor totals rebuilt."));
+}
+
+bool EventPlugin::rebuildCompetitorTotals()
+{
+	qfLogFuncFrame();
+	try {
+		qfs::Connection conn = qfs::Connection::forName();
+		qfs::Transaction transaction(conn);
+		CompetitorTotals totals(conn, stageCount());
+		totals.rebuild();
+		transaction.commit();
+		return true;
+	}
+	catch (const qf::core::Exception &e) {
+		qfd::MessageBox::showException(qff::MainWindow::frameWork(), e);
+	}
+	return false;
+}
+
+void EventPlugin::replayDbEventLog()
+{
+	qfLogFuncFrame();
+	qff::MainWindow *fwk = qff::MainWindow::frameWork();
+	QString fn = qfd::FileDialog::getOpenFileName(fwk, tr("Replay DB event log"), QString(), tr("DB event log (*.log *.txt *.json);;All files (*)"));
+	if(fn.isEmpty())
+		return;
+	QFile f(fn);
+	if(!f.open(QFile::ReadOnly)) {
+		qfd::MessageBox::showError(fwk, tr("Cannot open file '%1' for reading.").arg(fn));
+		return;
+	}
+	QList<DbEvent> events;
+	int invalid_count = 0;
+	while(!f.atEnd()) {
+		QString line = QString::fromUtf8(f.readLine()).trimmed();
+		if(line.isEmpty())
+			continue;
+		DbEvent db_event;
+		if(!DbEvent::fromPayload(line, &db_event) || db_event.domain.isEmpty()) {
+			invalid_count++;
+			continue;
+		}
+		events << db_event;
+	}
+	bool ok;
+	int post_interval = QInputDialog::getInt(fwk, tr("Replay DB event log"), tr("Post interval [msec], 0 posts events as fast as possible:"), 10, 0, 10000, 1, &ok);
+	if(!ok)
+		return;
+
+	struct DomainStat
+	{
+		int eventCount = 0;
+		int handlerCalls = 0;
+		int keyedHandlerCalls = 0;
+		int minBatch = 0;
+		int maxBatch = 0;
+		int batchSum = 0;
+	};
+	QMap<QString, DomainStat> stats;
+	QObject context;
+	DbEventBus bus;
+	setupDbEventBus(&bus);
+	auto count_batch = [&stats](const QString &domain, const QVariantList &data_list, bool keyed) {
+		DomainStat &st = stats[domain];
+		int n = data_list.count();
+		if(keyed) {
+			st.keyedHandlerCalls++;
+			return;
+		}
+		st.handlerCalls++;
+		st.batchSum += n;
+		st.maxBatch = qMax(st.maxBatch, n);
+		st.minBatch = (st.handlerCalls == 1)? n: qMin(st.minBatch, n);
+	};
+	QSet<int> punch_codes;
+	for(const DbEvent &db_event : events) {
+		if(!stats.contains(db_event.domain)) {
+			const QString domain = db_event.domain;
+			bus.subscribe(domain, &context, [count_batch, domain](const QVariantList &data_list) {
+				count_batch(domain, data_list, false);
+			});
+		}
+		stats[db_event.domain].eventCount++;
+		if(db_event.domain == QLatin1String(DBEVENT_PUNCH_RECEIVED)) {
+			/// one keyed subscriber per code like code class results widgets do
+			int code = db_event.data.toMap().value(QStringLiteral("code")).toInt();
+			if(!punch_codes.contains(code)) {
+				punch_codes << code;
+				const QString domain = db_event.domain;
+				bus.subscribe(domain, code, &context, [count_batch, domain](const QVariantList &data_list) {
+					count_batch(domain, data_list, true);
+				});
+			}
+		}
+	}
+
+	QElapsedTimer elapsed;
+	elapsed.start();
+	for(const DbEvent &db_event : events) {
+		bus.post(db_event.domain, db_event.data);
+		if(post_interval > 0) {
+			QEventLoop loop;
+			QTimer::singleShot(post_interval, &loop, SLOT(quit()));
+			loop.exec();
+		}
+		else {
+			QCoreApplication::processEvents();
+		}
+	}
+	bus.flush();
+	qint64 msec = elapsed.elapsed();
+
+	QStringList report;
+	report << tr("Replayed %1 events in %2 msec, %3 invalid lines skipped.").arg(events.count()).arg(msec).arg(invalid_count);
+	QMapIterator<QString, DomainStat> it(stats);
+	while(it.hasNext()) {
+		it.next();
+		const DomainStat &st = it.value();
+		double avg = st.handlerCalls? (double)st.batchSum / st.handlerCalls: 0;
+		QString line = tr("%1: events: %2, handler calls: %3, batch size min: %4 avg: %5 max: %6")
+				.arg(it.key()).arg(st.eventCount).arg(st.handlerCalls)
+				.arg(st.minBatch).arg(avg, 0, 'f', 1).arg(st.maxBatch);
+		if(st.keyedHandlerCalls > 0)
+			line += tr(", keyed handler calls: %1 for %2 keys").arg(st.keyedHandlerCalls).arg(punch_codes.count());
+		report << line;
+	}
+	qfInfo() << report.join('\n');
+	qfd::MessageBox::showInfo(fwk, report.join('\n'));
 }
 
 bool EventPlugin::closeEvent()
@@ -880,6 +1057,8 @@ bool EventPlugin::openEvent(const QString &_event_name)
 			qfd::MessageBox::showError(fwk, tr("Event was created in more recent QuickEvent version (%1) and the application might not work as expected. Download latest QuickEvent is strongly recommended.")
 									   .arg(qf::core::Utils::intToVersionString(evc->dbVersion())));
 		}
+		/// one catalog sweep at event open, table models do not query catalog on reload then
+		qfs::Connection::forName().warmCatalogCache();
 		connection_settings.setEventName(event_name);
 		setEventName(event_name);
 		emit eventOpened(eventName());
@@ -989,63 +1168,84 @@ void EventPlugin::exportEvent()
 		return;
 	if(!ex_fn.endsWith(ext, Qt::CaseInsensitive))
 		ex_fn += ext;
-	QString err_str;
-	QString export_connection_name = QStringLiteral("qe_export_connection");
-	do {
-		if(QFile::exists(ex_fn)) {
-			if(!QFile::remove(ex_fn)) {
-				err_str = tr("Cannot delete existing file %1").arg(ex_fn);
-				break;
-			}
-		}
-		qfs::Connection ex_conn(QSqlDatabase::addDatabase("QSQLITE", export_connection_name));
-		ex_conn.setDatabaseName(ex_fn);
-		qfInfo() << "Opening export database file" << ex_fn;
-		if(!ex_conn.open()) {
-			qfd::MessageBox::showError(fwk, tr("Open Database Error: %1").arg(ex_conn.errorString()));
+	if(QFile::exists(ex_fn)) {
+		if(!QFile::remove(ex_fn)) {
+			qfd::MessageBox::showError(fwk, tr("Cannot delete existing file %1").arg(ex_fn));
 			return;
 		}
-		qfs::Transaction transaction(ex_conn);
-
-		DbSchema db_schema = dbSchema();
-		auto tables = db_schema.tables();
-		int step_cnt = tables.count() + 1;
-		int step_no = 0;
-		fwk->showProgress(tr("Creating database"), ++step_no, step_cnt);
-		{
-			DbSchema::CreateDbSqlScriptOptions create_options;
-			create_options.setDriverName(ex_conn.driverName());
-			QStringList create_script = db_schema.createDbSqlScript(create_options);
-			qfs::Query ex_q(ex_conn);
-			if(!run_sql_script(ex_q, create_script)) {
-				err_str = tr("Create Database Error: %1").arg(ex_q.lastError().text());
+	}
+	/// schema is QML object, it must be read in GUI thread
+	DbSchema db_schema = dbSchema();
+	QStringList create_script;
+	{
+		DbSchema::CreateDbSqlScriptOptions create_options;
+		create_options.setDriverName(QStringLiteral("QSQLITE"));
+		create_script = db_schema.createDbSqlScript(create_options);
+	}
+	QList<QPair<QString, QSqlRecord>> tables;
+	for(QObject *table : db_schema.tables())
+		tables << qMakePair(table->property("name").toString(), db_schema.sqlRecord(table));
+	QString msg_creating = tr("Creating database");
+	QString msg_copying = tr("Copying table %1");
+	QString msg_create_error = tr("Create Database Error: %1");
+	QString msg_open_error = tr("Open Database Error: %1");
+	/// tables are copied in worker thread, so export of big event does not block the SI reader
+	auto task = [=](qfs::Connection &conn) -> QVariant {
+		QString err_str;
+		QString export_connection_name = QStringLiteral("qe_export_connection");
+		do {
+			qfs::Connection ex_conn(QSqlDatabase::addDatabase("QSQLITE", export_connection_name));
+			ex_conn.setDatabaseName(ex_fn);
+			qfInfo() << "Opening export database file" << ex_fn;
+			if(!ex_conn.open()) {
+				err_str = msg_open_error.arg(ex_conn.errorString());
 				break;
 			}
-		}
-		qfs::Connection conn = qfs::Connection::forName();
-		for(QObject *table : tables) {
-			QString table_name = table->property("name").toString();
-			qfDebug() << "Copying table" << table_name;
-			fwk->showProgress(tr("Copying table %1").arg(table_name), ++step_no, step_cnt);
-			QSqlRecord rec = db_schema.sqlRecord(table);
-			err_str = copy_sql_table(table_name, rec, conn, ex_conn);
+			qfs::Transaction transaction(ex_conn);
+
+			int step_cnt = tables.count() + 1;
+			int step_no = 0;
+			QMetaObject::invokeMethod(fwk, "showProgress", Qt::QueuedConnection
+									  , Q_ARG(QString, msg_creating)
+									  , Q_ARG(int, ++step_no)
+									  , Q_ARG(int, step_cnt));
+			{
+				qfs::Query ex_q(ex_conn);
+				if(!run_sql_script(ex_q, create_script)) {
+					err_str = msg_create_error.arg(ex_q.lastError().text());
+					break;
+				}
+			}
+			for(const auto &table : tables) {
+				const QString &table_name = table.first;
+				qfDebug() << "Copying table" << table_name;
+				QMetaObject::invokeMethod(fwk, "showProgress", Qt::QueuedConnection
+										  , Q_ARG(QString, msg_copying.arg(table_name))
+										  , Q_ARG(int, ++step_no)
+										  , Q_ARG(int, step_cnt));
+				err_str = copy_sql_table(table_name, table.second, conn, ex_conn);
+				if(!err_str.isEmpty())
+					break;
+			}
 			if(!err_str.isEmpty())
 				break;
+			transaction.commit();
+		} while(false);
+		{
+			QSqlDatabase c = QSqlDatabase::database(export_connection_name, false);
+			if(c.isOpen())
+				c.close();
 		}
-		if(!err_str.isEmpty())
-			break;
-		transaction.commit();
-	} while(false);
-	{
-		QSqlDatabase c = QSqlDatabase::database(export_connection_name, false);
-		if(c.isOpen())
-			c.close();
-	}
-	QSqlDatabase::removeDatabase(export_connection_name);
-	fwk->hideProgress();
-	if(!err_str.isEmpty()) {
-		qfd::MessageBox::showError(fwk, err_str);
-	}
+		QSqlDatabase::removeDatabase(export_connection_name);
+		return err_str;
+	};
+	qfs::QueryExecutor::instance()->execute(task, [fwk](const QVariant &result, const QString &error) {
+		fwk->hideProgress();
+		QString err_str = error.isEmpty()? result.toString(): error;
+		if(!err_str.isEmpty()) {
+			qfd::MessageBox::showError(fwk, err_str);
+		}
+	});
 }
 
 void EventPlugin::importEvent_qbe()
@@ -30,6 +30,8 @@ class DbSchema;
 
 namespace Event {
 
+class DbEventBus;
+
 class EVENTPLUGIN_DECL_EXPORT EventPlugin : public qf::qmlwidgets::framework::Plugin
 {
 	Q_OBJECT
@@ -82,6 +84,13 @@ public:
 	Q_SLOT bool openEvent(const QString &event_name = QString());
 	Q_SLOT void exportEvent();
 	Q_SLOT void importEvent_qbe();
+	/// compare stored competitor totals with runs and rebuild them on request
+	Q_SLOT void checkCompetitorTotals();
+	/// rebuild all competitor totals in one transaction, @return false on SQL error
+	bool rebuildCompetitorTotals();
+	/// replay file of NOTIFY payloads, one per line, through bus configured like the event one
+	/// and report handler calls and batch sizes, plugin subscribers are not called
+	Q_SLOT void replayDbEventLog();
 
 	Q_SIGNAL void reloadDataRequest();
 
@@ -92,6 +101,8 @@ public:
 
 	Q_INVOKABLE void emitDbEvent(const QString &domain, const QVariant &data = QVariant(), bool loopback = true);
 	Q_SIGNAL void dbEventNotify(const QString &domain, int connection_id, const QVariant &payload);
+	/// local and remote db events merged per domain
+	DbEventBus* dbEventBus() {return m_dbEventBus;}
 
 	Q_INVOKABLE QString sqlDriverName();
 
@@ -104,6 +115,7 @@ public:
 	//Q_SIGNAL void editStartListRequest(int stage_id, int class_id, int competitor_id);
 private:
 	void setSqlServerConnected(bool ok);
+	static void setupDbEventBus(DbEventBus *bus);
 
 	ConnectionType connectionType() const;
 	QStringList existingSqlEventNames() const;
@@ -128,12 +140,14 @@ private:
 	qf::qmlwidgets::Action *m_actEditEvent = nullptr;
 	qf::qmlwidgets::Action *m_actExportEvent = nullptr;
 	qf::qmlwidgets::Action *m_actImportEvent = nullptr;
+	qf::qmlwidgets::Action *m_actCheckCompetitorTotals = nullptr;
 	qf::qmlwidgets::Action *m_actEditStage = nullptr;
 	Event::EventConfig *m_eventConfig = nullptr;
 	bool m_sqlServerConnected = false;
 	QComboBox *m_cbxStage = nullptr;
 	QMap<int, StageData> m_stageCache;
 	QMap<int, QString> m_classNameCache;
+	DbEventBus *m_dbEventBus = nullptr;
 };
 
 }
@@ -6,6 +6,8 @@ HEADERS += \
     $$PWD/connectionsettings.h \
     $$PWD/eventdialogwidget.h \
     $$PWD/Event/eventplugin.h \
+    $$PWD/Event/dbeventbus.h \
+    $$PWD/Event/competitortotals.h \
     $$PWD/Event/eventconfig.h \
     $$PWD/Event/stage.h \
     $$PWD/Event/stagedocument.h \
@@ -18,6 +20,8 @@ SOURCES += \
     $$PWD/connectionsettings.cpp \
     $$PWD/eventdialogwidget.cpp \
     $$PWD/Event/eventplugin.cpp \
+    $$PWD/Event/dbeventbus.cpp \
+    $$PWD/Event/competitortotals.cpp \
     $$PWD/Event/eventconfig.cpp \
     $$PWD/Event/stage.cpp \
     $$PWD/Event/stagedocument.cpp \
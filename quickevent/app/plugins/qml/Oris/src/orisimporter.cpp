@@ -5,7 +5,7 @@
 #include <Classes/classesplugin.h>
 #include <Classes/classdocument.h>
 #include <Competitors/competitorsplugin.h>
-#include <Competitors/competitordocument.h>
+#include <Competitors/competitorbulkdocument.h>
 
 #include <qf/qmlwidgets/framework/mainwindow.h>
 #include <qf/qmlwidgets/dialogs/dialog.h>
@@ -19,6 +19,7 @@
 #include <qf/core/network/networkreply.h>
 #include <qf/core/log.h>
 #include <qf/core/sql/query.h>
+#include <qf/core/sql/queryexecutor.h>
 #include <qf/core/sql/transaction.h>
 #include <qf/core/utils/fileutils.h>
 #include <qf/core/utils/htmlutils.h>
@@ -32,8 +33,11 @@
 #include <QJsonObject>
 #include <QNetworkReply>
 #include <QPushButton>
+#include <QSharedPointer>
 #include <QTime>
+#include <QTimer>
 #include <QUrl>
+#include <QVector>
 
 static Event::EventPlugin* eventPlugin()
 {
@@ -439,11 +443,12 @@ void OrisImporter::importEventOrisEntries(int event_id)
 			while(q.next()) {
 				classes_map[q.value(0).toInt()] = q.value(1).toString();
 			}
-			QMap<int, int> imported_competitors; // importId->id
-			q.exec("SELECT id, importId FROM competitors WHERE importId>0 ORDER BY importId", qf::core::Exception::Throw);
-			while(q.next()) {
-				imported_competitors[q.value(1).toInt()] = q.value(0).toInt();
-			}
+			/// all imported competitors are loaded and diffed in memory, changes are saved by batched statements
+			Competitors::CompetitorBulkDocument doc;
+			doc.loadWhere("importId>0");
+			QMap<int, int> imported_competitors; // importId->doc record index
+			for (int ix = 0; ix < doc.recordCount(); ++ix)
+				imported_competitors[doc.value(ix, QStringLiteral("importId")).toInt()] = ix;
 			QJsonDocument jsd2 = load_offline_json(json_fn);
 			if(jsd2.isNull())
 				jsd2 = jsd;
@@ -453,22 +458,15 @@ void OrisImporter::importEventOrisEntries(int event_id)
 			for(auto it = data.constBegin(); it != data.constEnd(); ++it) {
 				items_count++;
 			}
-			QList<Competitors::CompetitorDocument*> doc_lst;
-			doc_lst.reserve(items_count);
 			QSet<int> used_idsi;
 			for(auto it = data.constBegin(); it != data.constEnd(); ++it) {
 				QJsonObject competitor_o = it.value().toObject();
-				Competitors::CompetitorDocument *doc = new Competitors::CompetitorDocument();
-				doc_lst << doc;
 				int import_id = competitor_o.value(QStringLiteral("ID")).toString().toInt();
-				int competitor_id = imported_competitors.value(import_id);
-				if(competitor_id > 0) {
-					doc->load(competitor_id);
+				int ix = imported_competitors.value(import_id, -1);
+				if(ix >= 0)
 					imported_competitors.remove(import_id);
-				}
-				else {
-					doc->loadForInsert();
-				}
+				else
+					ix = doc.appendRecord();
 				QString siid_str = competitor_o.value(QStringLiteral("SI")).toString();
 				bool ok;
 				int siid = siid_str.toInt(&ok);
@@ -491,32 +489,30 @@ void OrisImporter::importEventOrisEntries(int event_id)
 					}
 				}
 				QString reg_no = competitor_o.value(QStringLiteral("RegNo")).toString();
-				fwk->showProgress("Importing: " + reg_no + ' ' + last_name + ' ' + first_name, items_processed, items_count);
+				if(items_processed % 100 == 0)
+					fwk->showProgress("Importing: " + reg_no + ' ' + last_name + ' ' + first_name, items_processed, items_count);
 				int class_id = competitor_o.value(QStringLiteral("ClassID")).toString().toInt();
 				if(!classes_map.contains(class_id)) {
 					qfWarning() << "class id:" << class_id << "not found in the class definitions";
 					class_id = 0;
 				}
-				doc->setValue("classId", (class_id == 0)? QVariant(QVariant::Int): QVariant(class_id));
+				doc.setValue(ix, "classId", (class_id == 0)? QVariant(QVariant::Int): QVariant(class_id));
 				if(siid > 0) {
 					bool is_unique = !used_idsi.contains(siid);
 					if(is_unique)
 						used_idsi << siid;
-					doc->setSiid(siid, false);
+					doc.setSiid(ix, siid, false);
 				}
-				doc->setValue("firstName", first_name);
-				doc->setValue("lastName", last_name);
-				doc->setValue("registration", reg_no);
-				doc->setValue("licence", competitor_o.value(QStringLiteral("Licence")).toString());
-				doc->setValue("note", note);
-				doc->setValue("importId", import_id);
+				doc.setValue(ix, "firstName", first_name);
+				doc.setValue(ix, "lastName", last_name);
+				doc.setValue(ix, "registration", reg_no);
+				doc.setValue(ix, "licence", competitor_o.value(QStringLiteral("Licence")).toString());
+				doc.setValue(ix, "note", note);
+				doc.setValue(ix, "importId", import_id);
 				items_processed++;
 			}
-			for(int id : imported_competitors.values()) {
-				Competitors::CompetitorDocument *doc = new Competitors::CompetitorDocument();
-				doc_lst << doc;
-				doc->load(id, doc->ModeDelete);
-			}
+			for(int ix : imported_competitors.values())
+				doc.setMode(ix, qf::core::model::DataDocument::ModeDelete);
 			static const QStringList fields = QStringList()
 											  << QStringLiteral("classId")
 											  << QStringLiteral("className")
@@ -530,44 +526,44 @@ void OrisImporter::importEventOrisEntries(int event_id)
 			QVariantList new_entries_rows;
 			QVariantList edited_entries_rows;
 			QVariantList deleted_entries_rows;
-			auto field_string = [classes_map](Competitors::CompetitorDocument *doc, const QString fldn) {
+			auto field_string = [classes_map, &doc](int ix, const QString fldn) {
 				QString s;
 				if(fldn == QLatin1String("className"))
-					s = classes_map.value(doc->value(QStringLiteral("classId")).toInt());
+					s = classes_map.value(doc.value(ix, QStringLiteral("classId")).toInt());
 				else
-					s = doc->value(fldn).toString();
+					s = doc.value(ix, fldn).toString();
 				return s;
 			};
-			for(Competitors::CompetitorDocument *doc : doc_lst) {
+			for (int ix = 0; ix < doc.recordCount(); ++ix) {
 				QVariantList tr = QVariantList() << QStringLiteral("tr");
-				if(doc->mode() == doc->ModeInsert) {
+				if(doc.mode(ix) == qf::core::model::DataDocument::ModeInsert) {
 					for(QString fldn : fields) {
-						auto td = QVariantList() << QStringLiteral("td") << field_string(doc, fldn);
+						auto td = QVariantList() << QStringLiteral("td") << field_string(ix, fldn);
 						tr.insert(tr.length(), td);
 					}
 					new_entries_rows.insert(new_entries_rows.length(), tr);
 				}
-				else if(doc->mode() == doc->ModeEdit) {
-					if(doc->isDirty()) {
+				else if(doc.mode(ix) == qf::core::model::DataDocument::ModeEdit) {
+					if(doc.isDirty(ix)) {
 						for(QString fldn : fields) {
 							static QVariantMap green_attrs;
 							if(green_attrs.isEmpty())
 								green_attrs["bgcolor"] = QStringLiteral("khaki");
 							auto td = QVariantList() << QStringLiteral("td");
-							if(fldn != QLatin1String("className") && doc->isDirty(fldn))
+							if(fldn != QLatin1String("className") && doc.isDirty(ix, fldn))
 								td << green_attrs;
-							td << field_string(doc, fldn);
+							td << field_string(ix, fldn);
 							tr.insert(tr.length(), td);
 						}
 						edited_entries_rows.insert(edited_entries_rows.length(), tr);
 					}
 				}
-				else if(doc->mode() == doc->ModeDelete) {
+				else if(doc.mode(ix) == qf::core::model::DataDocument::ModeDelete) {
 					for(QString fldn : fields) {
-						auto td = QVariantList() << QStringLiteral("td") << field_string(doc, fldn);
+						auto td = QVariantList() << QStringLiteral("td") << field_string(ix, fldn);
 						tr.insert(tr.length(), td);
 					}
-					deleted_entries_rows.insert(new_entries_rows.length(), tr);
+					deleted_entries_rows.insert(deleted_entries_rows.length(), tr);
 				}
 			}
 			QVariantList html_body = QVariantList() << QStringLiteral("body");
@@ -598,30 +594,24 @@ void OrisImporter::importEventOrisEntries(int event_id)
 			w->setHtmlText(html);
 			if(dlg.exec()) {
 				qf::core::sql::Transaction transaction;
-				QMap<int, int> cid_sid_changes; // competitorId->siId
-				const auto SIID = QStringLiteral("siId");
-				for(Competitors::CompetitorDocument *doc : doc_lst) {
-					if(doc->mode() == doc->ModeInsert) {
-						doc->save();
-						int siid = doc->value(SIID).toInt();
-						cid_sid_changes[doc->dataId().toInt()] = siid;
-					}
-					else if(doc->mode() == doc->ModeEdit) {
-						if(doc->isDirty()) {
-							int siid = doc->value(SIID).toInt();
-							cid_sid_changes[doc->dataId().toInt()] = siid;
-							doc->save();
-						}
-					}
-					else if(doc->mode() == doc->ModeDelete) {
-						if(!no_drops)
-							doc->drop();
-					}
+				QList<int> changed_ixs;
+				for (int ix = 0; ix < doc.recordCount(); ++ix) {
+					if(doc.mode(ix) == qf::core::model::DataDocument::ModeInsert)
+						changed_ixs << ix;
+					else if(doc.mode(ix) == qf::core::model::DataDocument::ModeEdit && doc.isDirty(ix))
+						changed_ixs << ix;
+					else if(doc.mode(ix) == qf::core::model::DataDocument::ModeDelete && no_drops)
+						doc.setMode(ix, qf::core::model::DataDocument::ModeView);
 				}
+				doc.save();
+				QMap<int, int> cid_sid_changes; // competitorId->siId
+				for(int ix : changed_ixs)
+					cid_sid_changes[doc.dataId(ix).toInt()] = doc.siid(ix).toInt();
 				cid_sid_changes.remove(0);
 				int stage_cnt = eventPlugin()->stageCount();
 				for (int stage_id = 1; stage_id <= stage_cnt; ++stage_id) {
 					QMap<int, int> sid_cid_map; // siId->competitorId
+					QHash<int, int> cid_sid_map; // competitorId->siId
 					q.exec("SELECT competitorId, siId FROM runs WHERE siId IS NOT NULL AND stageId=" QF_IARG(stage_id), qf::core::Exception::Throw);
 					// take all SI->competitor_id assignments for this stage
 					while(q.next()) {
@@ -629,6 +619,7 @@ void OrisImporter::importEventOrisEntries(int event_id)
 						int sid = q.value(1).toInt();
 						if(sid > 0)
 							sid_cid_map[sid] = cid;
+						cid_sid_map[cid] = sid;
 					}
 					{
 						// reply siid_changes changes in si_map
@@ -665,6 +656,9 @@ void OrisImporter::importEventOrisEntries(int event_id)
 							it.next();
 							int competitor_id = it.key();
 							int si_id = it.value();
+							// skip runs having this SI already
+							if(cid_sid_map.value(competitor_id) == si_id)
+								continue;
 							qfDebug() << "stage:" << stage_id << "saving SI:" << si_id << "for competitor id:" << competitor_id;
 							q.bindValue(QStringLiteral(":competitorId"), competitor_id);
 							q.bindValue(QStringLiteral(":siId"), (si_id > 0)? si_id: QVariant(QVariant::Int));
@@ -674,7 +668,6 @@ void OrisImporter::importEventOrisEntries(int event_id)
 				}
 				transaction.commit();
 			}
-			qDeleteAll(doc_lst);
 			emit eventPlugin()->reloadDataRequest();
 		}
 		catch (qf::core::Exception &e) {
@@ -683,6 +676,131 @@ void OrisImporter::importEventOrisEntries(int event_id)
 	});
 }
 
+namespace {
+
+/// rows of one import written by the same INSERT statement, values are bound by name
+struct ImportRows
+{
+	QString title;
+	QString table;
+	QStringList fields;
+	QString deleteSql;
+	QVector<QVariantMap> rows; //< values keyed by ':' + field name
+	int rowsWritten = 0;
+	std::function<void (const QString &error)> done;
+
+	QString insertSql(const QString &table_name) const
+	{
+		QStringList placeholders;
+		for(const QString &f : fields)
+			placeholders << ':' + f;
+		return "INSERT INTO " + table_name + " (" + fields.join(", ") + ") VALUES (" + placeholders.join(", ") + ")";
+	}
+	QString tempTable() const {return QStringLiteral("import_") + table;}
+};
+
+/// SQLite has one write lock for the whole database, GUI thread card readout writes
+/// would fail with "database is locked" during long import transaction.
+/// Rows are written to TEMP table, which does not lock main database, in GUI thread
+/// in short transactions with event loop served between them. Old rows are replaced
+/// by imported ones in one short transaction at the end, so the import stays atomic.
+const int SQLITE_IMPORT_BATCH_ROWS = 200;
+
+void insert_import_row(qf::core::sql::Query &q, const QVariantMap &row)
+{
+	for(auto it = row.constBegin(); it != row.constEnd(); ++it)
+		q.bindValue(it.key(), it.value());
+	q.exec(qf::core::Exception::Throw);
+}
+
+void drop_import_temp_table(const QSharedPointer<ImportRows> &job)
+{
+	qf::core::sql::Query q;
+	if(!q.exec("DROP TABLE IF EXISTS temp." + job->tempTable()))
+		qfWarning() << "Cannot drop import table:" << job->tempTable();
+}
+
+void write_import_batch(QSharedPointer<ImportRows> job)
+{
+	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
+	try {
+		qf::core::sql::Transaction transaction;
+		qf::core::sql::Query q(transaction.connection());
+		if(job->rowsWritten == 0) {
+			q.exec("DROP TABLE IF EXISTS temp." + job->tempTable(), qf::core::Exception::Throw);
+			q.exec("CREATE TEMP TABLE " + job->tempTable() + " AS SELECT " + job->fields.join(", ")
+				   + " FROM " + job->table + " WHERE 0", qf::core::Exception::Throw);
+		}
+		q.prepare(job->insertSql("temp." + job->tempTable()), qf::core::Exception::Throw);
+		int n = qMin(job->rows.count(), job->rowsWritten + SQLITE_IMPORT_BATCH_ROWS);
+		for(; job->rowsWritten < n; job->rowsWritten++)
+			insert_import_row(q, job->rows[job->rowsWritten]);
+		if(job->rowsWritten == job->rows.count()) {
+			/// the only statements locking main database
+			q.exec(job->deleteSql, qf::core::Exception::Throw);
+			q.exec("INSERT INTO " + job->table + " (" + job->fields.join(", ") + ") SELECT " + job->fields.join(", ")
+				   + " FROM temp." + job->tempTable(), qf::core::Exception::Throw);
+		}
+		transaction.commit();
+	}
+	catch (const qf::core::Exception &e) {
+		drop_import_temp_table(job);
+		job->done(e.message());
+		return;
+	}
+	catch (const std::exception &e) {
+		drop_import_temp_table(job);
+		job->done(QString::fromUtf8(e.what()));
+		return;
+	}
+	if(job->rowsWritten < job->rows.count()) {
+		fwk->showProgress(job->title, job->rowsWritten, job->rows.count());
+		QTimer::singleShot(0, [job]() {
+			write_import_batch(job);
+		});
+	}
+	else {
+		drop_import_temp_table(job);
+		job->done(QString());
+	}
+}
+
+/// delete old rows and insert new ones, \a done is called in GUI thread
+void write_import_rows(QSharedPointer<ImportRows> job)
+{
+	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
+	fwk->showProgress(job->title, 0, job->rows.count());
+	if(qf::core::sql::Connection::forName().driverName().endsWith(QLatin1String("SQLITE"), Qt::CaseInsensitive)) {
+		write_import_batch(job);
+		return;
+	}
+	/// server database, import in one transaction in worker thread
+	auto task = [fwk, job](qf::core::sql::Connection &conn) -> QVariant {
+		qf::core::sql::Transaction transaction(conn);
+		qf::core::sql::Query q(conn);
+		q.exec(job->deleteSql, qf::core::Exception::Throw);
+		q.prepare(job->insertSql(job->table), qf::core::Exception::Throw);
+		int cnt = job->rows.count();
+		for(int i=0; i<cnt; i++) {
+			if(i % 100 == 0) {
+				QMetaObject::invokeMethod(fwk, "showProgress", Qt::QueuedConnection
+										  , Q_ARG(QString, job->title)
+										  , Q_ARG(int, i)
+										  , Q_ARG(int, cnt));
+			}
+			insert_import_row(q, job->rows[i]);
+		}
+		transaction.commit();
+		return cnt;
+	};
+	qf::core::sql::QueryExecutor::instance()->execute(task, [job](const QVariant &result, const QString &error) {
+		Q_UNUSED(result)
+		job->done(error);
+	});
+}
+
+}
+
 void OrisImporter::importRegistrations()
 {
 	int sport_id = eventPlugin()->eventConfig()->sportId();
@@ -692,57 +810,38 @@ void OrisImporter::importRegistrations()
 		saveJsonBackup("Registrations", jsd);
 		qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
 		QJsonObject data = jsd.object().value(QStringLiteral("Data")).toObject();;
-		// import clubs
-		int items_processed = 0;
-		int items_count = 0;
+		QSharedPointer<ImportRows> job(new ImportRows());
+		job->title = tr("Importing registrations");
+		job->table = QStringLiteral("registrations");
+		job->fields = QStringList{"firstName", "lastName", "registration", "licence", "clubAbbr", "siId", "importId"};
+		job->deleteSql = QStringLiteral("DELETE FROM registrations");
+		job->rows.reserve(data.count());
 		for(auto it = data.constBegin(); it != data.constEnd(); ++it) {
-			items_count++;
+			QJsonObject obj = it.value().toObject();
+			QString reg = obj.value(QStringLiteral("RegNo")).toString();
+			QVariantMap row;
+			row[QStringLiteral(":firstName")] = obj.value(QStringLiteral("FirstName")).toString();
+			row[QStringLiteral(":lastName")] = obj.value(QStringLiteral("LastName")).toString();
+			row[QStringLiteral(":registration")] = reg.isEmpty()? QVariant(QVariant::String): reg;
+			row[QStringLiteral(":clubAbbr")] = reg.isEmpty()? QVariant(QVariant::String): reg.mid(0, 3);
+			row[QStringLiteral(":licence")] = obj.value(QStringLiteral("Lic")).toString();
+			row[QStringLiteral(":siId")] = obj.value(QStringLiteral("SI")).toString().toInt();
+			row[QStringLiteral(":importId")] = obj.value(QStringLiteral("UserID")).toString().toInt();
+			job->rows << row;
 		}
-		fwk->showProgress(tr("Importing registrations"), 1, items_count);
-		try {
-			qf::core::sql::Transaction transaction;
-			qf::core::sql::Query q;
-			q.exec("DELETE FROM registrations", qf::core::Exception::Throw);
-			q.prepare("INSERT INTO registrations (firstName, lastName, registration, licence, clubAbbr, siId, importId) VALUES (:firstName, :lastName, :registration, :licence, :clubAbbr, :siId, :importId)", qf::core::Exception::Throw);
-			for(auto it = data.constBegin(); it != data.constEnd(); ++it) {
-				QJsonObject obj = it.value().toObject();
-				//qfInfo() << obj.value("LastName") << obj.value("SI") << obj.value("UserID");
- 				QString reg = obj.value(QStringLiteral("RegNo")).toString();
-				if(items_processed % 100 == 0) {
-					//Log.info(items_count, obj.RegNo);
-					fwk->showProgress(reg, items_processed, items_count);
-				}
-
-				q.bindValue(":firstName", obj.value(QStringLiteral("FirstName")).toString());
-				q.bindValue(":lastName", obj.value(QStringLiteral("LastName")).toString());
-				//var name_search_key = File.toAscii7(obj.LastName + " " + obj.FirstName, true);
-				//q.bindValue(":nameSearchKey", name_search_key);
-				if(!reg.isEmpty()) {
-					q.bindValue(":registration", reg);
-					q.bindValue(":clubAbbr", reg.mid(0, 3));
-				}
-				q.bindValue(":licence", obj.value(QStringLiteral("Lic")).toString());
-				q.bindValue(":siId", obj.value(QStringLiteral("SI")).toString().toInt());
-				q.bindValue(":importId", obj.value(QStringLiteral("UserID")).toString().toInt());
-
-				//q.bindValue(":abbr", obj.Abbr);
-				//q.bindValue(":name", obj.Name);
-				//q.bindValue(":importId", obj.ID);
-				q.exec(qf::core::Exception::Throw);
-
-				items_processed++;
-			}
-			transaction.commit();
+		job->done = [fwk](const QString &error) {
 			fwk->hideProgress();
+			if(!error.isEmpty()) {
+				qf::qmlwidgets::dialogs::MessageBox::showError(fwk, error);
+				return;
+			}
 			QMetaObject::invokeMethod(fwk->plugin("Event"), "emitDbEvent", Qt::QueuedConnection
 									  , Q_ARG(QString, Event::EventPlugin::DBEVENT_REGISTRATIONS_IMPORTED)
 									  , Q_ARG(QVariant, QVariant())
 									  , Q_ARG(bool, true)
 									  );
-		}
-		catch (qf::core::Exception &e) {
-			qf::qmlwidgets::dialogs::MessageBox::showException(fwk, e);
-		}
+		};
+		write_import_rows(job);
 	});
 }
 
@@ -753,38 +852,25 @@ void OrisImporter::importClubs()
 		saveJsonBackup("Clubs", jsd);
 		qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
 		QJsonObject data = jsd.object().value(QStringLiteral("Data")).toObject();;
-		// import clubs
-		int items_processed = 0;
-		int items_count = 0;
+		QSharedPointer<ImportRows> job(new ImportRows());
+		job->title = tr("Importing clubs");
+		job->table = QStringLiteral("clubs");
+		job->fields = QStringList{"name", "abbr", "importId"};
+		job->deleteSql = QStringLiteral("DELETE FROM clubs WHERE importId IS NOT NULL");
+		job->rows.reserve(data.count());
 		for(auto it = data.constBegin(); it != data.constEnd(); ++it) {
-			items_count++;
+			QJsonObject obj = it.value().toObject();
+			QVariantMap row;
+			row[QStringLiteral(":abbr")] = obj.value(QStringLiteral("Abbr")).toString();
+			row[QStringLiteral(":name")] = obj.value(QStringLiteral("Name")).toString();
+			row[QStringLiteral(":importId")] = obj.value(QStringLiteral("ID")).toString().toInt();
+			job->rows << row;
 		}
-		fwk->showProgress(tr("Importing clubs"), 1, items_count);
-		try {
-			qf::core::sql::Transaction transaction;
-			qf::core::sql::Query q;
-			q.exec("DELETE FROM clubs WHERE importId IS NOT NULL", qf::core::Exception::Throw);
-			q.prepare("INSERT INTO clubs (name, abbr, importId) VALUES (:name, :abbr, :importId)", qf::core::Exception::Throw);
-			for(auto it = data.constBegin(); it != data.constEnd(); ++it) {
-				QJsonObject obj = it.value().toObject();
-				//Log.debug(JSON.stringify(obj, null, 2));
-				QString abbr = obj.value(QStringLiteral("Abbr")).toString();
-				QString name = obj.value(QStringLiteral("Name")).toString();
-				fwk->showProgress(abbr + ' ' + name, items_processed, items_count);
-				q.bindValue(":abbr", abbr);
-				q.bindValue(":name", name);
-				q.bindValue(":importId", obj.value(QStringLiteral("ID")).toString().toInt());
-				q.exec(qf::core::Exception::Throw);
-
-				items_processed++;
-			}
-			transaction.commit();
+		job->done = [fwk](const QString &error) {
 			fwk->hideProgress();
-		}
-		catch (qf::core::Exception &e) {
-			qf::qmlwidgets::dialogs::MessageBox::showException(fwk, e);
-		}
+			if(!error.isEmpty())
+				qf::qmlwidgets::dialogs::MessageBox::showError(fwk, error);
+		};
+		write_import_rows(job);
 	});
 }
-
-
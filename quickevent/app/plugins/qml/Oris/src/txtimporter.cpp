@@ -1,7 +1,7 @@
 #include "txtimporter.h"
 
 #include <Event/eventplugin.h>
-#include <Competitors/competitordocument.h>
+#include <Competitors/competitorbulkdocument.h>
 
 #include <qf/qmlwidgets/framework/mainwindow.h>
 #include <qf/qmlwidgets/dialogs/filedialog.h>
@@ -11,7 +11,7 @@
 #include <qf/core/exception.h>
 #include <qf/core/sql/query.h>
 #include <qf/core/sql/transaction.h>
-#include <qf/core/utils/csvreader.h>
+#include <qf/core/utils/csvparser.h>
 
 #include <QTextStream>
 
@@ -118,27 +118,21 @@ void TxtImporter::importCompetitorsCSV()
 	if(fn.isEmpty())
 		return;
 	try {
-		QFile f(fn);
-		if(!f.open(QFile::ReadOnly))
+		qf::core::utils::CSVParser parser(',');
+		parser.setLineComment('#');
+		if(!parser.openFile(fn))
 			QF_EXCEPTION(tr("Cannot open file '%1' for reading.").arg(fn));
 		QList<QVariantList> csv_rows;
-		QTextStream ts(&f);
-		ts.setCodec("utf-8");
-		qf::core::utils::CSVReader reader(&ts);
-		reader.setSeparator(',');
-		reader.setLineComment('#');
 		/// skip header
-		if (!ts.atEnd())
-			reader.readCSVLine();
-		while (!ts.atEnd()) {
-			QStringList sl = reader.readCSVLineSplitted();
-			QString reg = sl.value(ColRegistration).trimmed();
-			QString class_name = sl.value(ColClassName).trimmed();
-			int si = sl.value(ColSiId).trimmed().toInt();
-			QString first_name = sl.value(ColFirstName).trimmed();
-			QString last_name = sl.value(ColLastName).trimmed();
-			QString lic = sl.value(ColLicence).trimmed();
-			QString note = sl.value(ColNote).trimmed();
+		parser.readRecord();
+		while (parser.readRecord()) {
+			QString reg = parser.fieldString(ColRegistration);
+			QString class_name = parser.fieldString(ColClassName);
+			int si = parser.fieldInt(ColSiId);
+			QString first_name = parser.fieldString(ColFirstName);
+			QString last_name = parser.fieldString(ColLastName);
+			QString lic = parser.fieldString(ColLicence);
+			QString note = parser.fieldString(ColNote);
 			csv_rows << (QVariantList() << reg << class_name << si << last_name << first_name << lic << note);
 		}
 		qf::core::sql::Transaction transaction;
@@ -159,13 +153,9 @@ void TxtImporter::importRankingCsv()
 	if(fn.isEmpty())
 		return;
 	try {
-		QFile f(fn);
-		if(!f.open(QFile::ReadOnly))
+		qf::core::utils::CSVParser parser(';');
+		if(!parser.openFile(fn))
 			QF_EXCEPTION(tr("Cannot open file '%1' for reading.").arg(fn));
-		QTextStream ts(&f);
-		qf::core::utils::CSVReader reader(&ts);
-		reader.setSeparator(';');
-		//reader.setLineComment('#');
 		enum {ColPos = 0, ColLastName, ColFirstName, ColRegistration, ColPoints, ColCoef};
 
 		qf::core::sql::Transaction transaction;
@@ -173,16 +163,15 @@ void TxtImporter::importRankingCsv()
 		q.prepare("UPDATE competitors SET ranking=:ranking WHERE registration=:registration", qf::core::Exception::Throw);
 
 		int n = 0;
-		while (!ts.atEnd()) {
-			QStringList line = reader.readCSVLineSplitted();
-			if(line.count() <= 1)
-				QF_EXCEPTION(tr("Fields separation error, invalid CSV format, Error reading CSV line: [%1]").arg(line.join(';').mid(0, 100)));
+		while (parser.readRecord()) {
+			if(parser.fieldCount() <= 1)
+				QF_EXCEPTION(tr("Fields separation error, invalid CSV format, Error reading CSV line: [%1]").arg(parser.recordStrings().join(';').mid(0, 100)));
 			if(n++ == 0) // skip column names
 				continue;
-			QString registration = line.value(ColRegistration);
-			int pos = line.value(ColPos).toInt();
+			QString registration = parser.fieldString(ColRegistration);
+			int pos = parser.fieldInt(ColPos);
 			if(pos == 0 || registration.isEmpty()) {
-				QF_EXCEPTION(tr("Error reading CSV line: [%1]").arg(line.join(';')));
+				QF_EXCEPTION(tr("Error reading CSV line: [%1]").arg(parser.recordStrings().join(';')));
 			}
 			qfDebug() << registration << "->" << pos;
 			q.bindValue(":ranking", pos);
@@ -206,9 +195,9 @@ void TxtImporter::importParsedCsv(const QList<QVariantList> &csv)
 		classes_map[q.value(1).toString()] = q.value(0).toInt();
 	}
 	QSet<int> used_idsi;
+	Competitors::CompetitorBulkDocument doc;
 	for(const QVariantList &row : csv) {
-		Competitors::CompetitorDocument doc;
-		doc.loadForInsert();
+		int ix = doc.appendRecord();
 		int siid = row.value(ColSiId).toInt();
 		//qfInfo() << "SI:" << siid, competitor_obj.ClassDesc, ' ', competitor_obj.LastName, ' ', competitor_obj.FirstName, "classId:", parseInt(competitor_obj.ClassID));
 		QString note = row.value(ColNote).toString();
@@ -228,19 +217,19 @@ void TxtImporter::importParsedCsv(const QList<QVariantList> &csv)
 			QF_EXCEPTION(tr("Undefined class name: '%1'").arg(class_name));
 		//fwk->showProgress("Importing: " + reg_no + ' ' + last_name + ' ' + first_name, items_processed, items_count);
 		//	qfWarning() << tr("%1 %2 %3 SI: %4 is duplicit!").arg(reg_no).arg(last_name).arg(first_name).arg(siid);
-		doc.setValue("classId", class_id);
+		doc.setValue(ix, "classId", class_id);
 		if(siid > 0) {
 			bool is_unique = !used_idsi.contains(siid);
 			if(is_unique)
 				used_idsi << siid;
-			doc.setSiid(siid, is_unique);
+			doc.setSiid(ix, siid, is_unique);
 		}
-		doc.setValue("firstName", first_name);
-		doc.setValue("lastName", last_name);
-		doc.setValue("registration", reg);
-		doc.setValue("licence", row.value(ColLicence).toString());
-		doc.setValue("note", note);
-		doc.save();
+		doc.setValue(ix, "firstName", first_name);
+		doc.setValue(ix, "lastName", last_name);
+		doc.setValue(ix, "registration", reg);
+		doc.setValue(ix, "licence", row.value(ColLicence).toString());
+		doc.setValue(ix, "note", note);
 	}
+	doc.save();
 
 }
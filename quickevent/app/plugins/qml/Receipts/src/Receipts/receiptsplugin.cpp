@@ -3,6 +3,8 @@
 #include "../receiptsprinter.h"
 
 #include <Event/eventplugin.h>
+#include <Runs/runsplugin.h>
+#include <Runs/standingsservice.h>
 #include <CardReader/cardreaderplugin.h>
 #include <CardReader/checkedcard.h>
 #include <CardReader/readcard.h>
@@ -50,18 +52,17 @@ void ReceiptsPlugin::onInstalled()
 
 CardReader::CardReaderPlugin *ReceiptsPlugin::cardReaderPlugin()
 {
-	qff::MainWindow *fwk = qff::MainWindow::frameWork();
-	auto ret = qobject_cast<CardReader::CardReaderPlugin *>(fwk->plugin("CardReader"));
-	QF_ASSERT(ret != nullptr, "Bad plugin", return 0);
-	return ret;
+	return qff::MainWindow::cachedPlugin<CardReader::CardReaderPlugin>();
+}
+
+Runs::RunsPlugin *ReceiptsPlugin::runsPlugin()
+{
+	return qff::MainWindow::cachedPlugin<Runs::RunsPlugin>();
 }
 
 Event::EventPlugin *ReceiptsPlugin::eventPlugin()
 {
-	qff::MainWindow *fwk = qff::MainWindow::frameWork();
-	auto ret = qobject_cast<Event::EventPlugin *>(fwk->plugin("Event"));
-	QF_ASSERT(ret != nullptr, "Bad plugin", return 0);
-	return ret;
+	return qff::MainWindow::cachedPlugin<Event::EventPlugin>();
 }
 
 QString ReceiptsPlugin::currentReceiptPath()
@@ -100,7 +101,16 @@ void ReceiptsPlugin::setReceiptsPrinterOptions(const ReceiptsPrinterOptions &opt
 	QString s = QString::fromUtf8(ba);
 	settings.setValue(printer_options_key, s);
 
-	QF_SAFE_DELETE(m_receiptsPrinter);
+	if(m_receiptsPrinter && m_receiptsPrinter->queuedJobCount() > 0) {
+		/// receipts waiting in queue are printed with new options
+		ReceiptsPrinter *old_printer = m_receiptsPrinter;
+		m_receiptsPrinter = new ReceiptsPrinter(opts, this);
+		m_receiptsPrinter->takeQueuedJobs(old_printer);
+		delete old_printer;
+	}
+	else {
+		QF_SAFE_DELETE(m_receiptsPrinter);
+	}
 }
 
 ReceiptsPrinter *ReceiptsPlugin::receiptsPrinter()
@@ -211,55 +221,12 @@ QVariantMap ReceiptsPlugin::receiptTablesData(int card_id)
 		model.reload();
 		if(model.rowCount() == 1) {
 			int class_id = model.value(0, "competitors.classId").toInt();
-			{
-				// find best laps for competitors class
-				qf::core::sql::QueryBuilder qb_minlaps;
-				qb_minlaps.select("runlaps.position, MIN(runlaps.lapTimeMs) AS minLapTimeMs")
-						.from("competitors")
-						.joinRestricted("competitors.id", "runs.competitorId", "runs.stageId=" QF_IARG(current_stage_id) " AND competitors.classId=" QF_IARG(class_id), "JOIN")
-						.joinRestricted("runs.id", "runlaps.runId", "runlaps.position > 0 AND runlaps.lapTimeMs > 0", "JOIN")
-						.groupBy("runlaps.position")
-						.orderBy("runlaps.position");
-				QString qs = qb_minlaps.toString();
-				//qfInfo() << qs;
-				qf::core::sql::Query q;
-				q.exec(qs);
-				while(q.next()) {
-					int position = q.value("position").toInt();
-					if(position == 0) {
-						qfWarning() << "position == 0 in best runlaps";
-						continue;
-					}
-					int lap = q.value("minLapTimeMs").toInt();
-					if(lap == 0) {
-						qfWarning() << "minLapTimeMs == 0 in best runlaps";
-						continue;
-					}
-					best_laps[position] = lap;
-					//qfInfo() << "bestlaps[" << position << "] =" << lap;
-				}
-			}
+			Runs::StandingsService *standings = runsPlugin()->standingsService();
+			standings->updateRun(run_id);
+			best_laps = standings->bestLaps(current_stage_id, class_id);
 			if(checked_card.isOk()) {
-				// find current standings
-				qf::core::sql::QueryBuilder qb;
-				qb.select2("runs", "timeMs")
-						.select("runs.disqualified OR NOT runs.isRunning OR runs.isRunning IS NULL OR runs.misPunch AS dis")
-						.from("competitors")
-						.joinRestricted("competitors.id", "runs.competitorId", "runs.stageId=" QF_IARG(current_stage_id) " AND competitors.classId=" QF_IARG(class_id))
-						.where("runs.finishTimeMs > 0")
-						.orderBy("misPunch, disqualified, isRunning, runs.timeMs");
-				//qfInfo() << qb.toString();
-				qf::core::sql::Query q;
-				q.exec(qb.toString(), qf::core::Exception::Throw);
-				while (q.next()) {
-					bool dis = q.value("dis").toBool();
-					int time = q.value("timeMs").toInt();
-					if(!dis) {
-						if(time <= checked_card.timeMs())
-							current_standings++;
-					}
-					competitors_finished++;
-				}
+				current_standings = standings->standingsForTime(current_stage_id, class_id, checked_card.timeMs());
+				competitors_finished = standings->finishedCount(current_stage_id, class_id);
 			}
 		}
 		qfu::TreeTable tt = model.toTreeTable();
@@ -379,8 +346,7 @@ bool ReceiptsPlugin::printReceipt(int card_id)
 {
 	QF_TIME_SCOPE("ReceiptsPlugin::printReceipt()");
 	try {
-		printReceipt(card_id, currentReceiptPath());
-		return true;
+		return printReceipt(card_id, currentReceiptPath());
 	}
 	catch(const qf::core::Exception &e) {
 		qfError() << e.toString();
@@ -394,8 +360,7 @@ bool ReceiptsPlugin::printCard(int card_id)
 	QF_TIME_SCOPE("ReceiptsPlugin::printCard()");
 	try {
 		QVariantMap dt = readCardTablesData(card_id);
-		receiptsPrinter()->printReceipt(manifest()->homeDir() + "/reports/sicard.qml", dt);
-		return true;
+		return receiptsPrinter()->printReceipt(manifest()->homeDir() + "/reports/sicard.qml", dt);
 	}
 	catch(const qf::core::Exception &e) {
 		qfError() << e.toString();
@@ -420,11 +385,11 @@ void ReceiptsPlugin::previewReceipt(int card_id, const QString &receipt_path)
 	dlg.exec();
 }
 
-void ReceiptsPlugin::printReceipt(int card_id, const QString &receipt_path)
+bool ReceiptsPlugin::printReceipt(int card_id, const QString &receipt_path)
 {
 	qfLogFuncFrame() << "card id:" << card_id;
 	QVariantMap dt = receiptTablesData(card_id);
-	receiptsPrinter()->printReceipt(receipt_path, dt);
+	return receiptsPrinter()->printReceipt(receipt_path, dt);
 }
 
 }
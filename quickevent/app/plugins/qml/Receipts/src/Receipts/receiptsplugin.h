@@ -16,6 +16,9 @@ class CardReaderPlugin;
 namespace Event {
 class EventPlugin;
 }
+namespace Runs {
+class RunsPlugin;
+}
 
 class ReceiptsPrinterOptions;
 class ReceiptsPrinter;
@@ -49,11 +52,12 @@ private:
 	void onInstalled();
 	CardReader::CardReaderPlugin* cardReaderPlugin();
 	Event::EventPlugin* eventPlugin();
+	Runs::RunsPlugin* runsPlugin();
 
 	ReceiptsPrinterOptions receiptsPrinterOptions();
 
 	void previewReceipt(int card_id, const QString &receipt_path);
-	void printReceipt(int card_id, const QString &receipt_path);
+	bool printReceipt(int card_id, const QString &receipt_path);
 	QList<QByteArray> createPrinterData(const QDomElement &body, const ReceiptsPrinterOptions &printer_options);
 
 	class DirectPrintContext;
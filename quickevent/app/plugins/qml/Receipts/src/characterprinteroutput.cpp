@@ -0,0 +1,99 @@
+#include "characterprinteroutput.h"
+
+#include <qf/core/log.h>
+#include <qf/core/utils/fileutils.h>
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTcpSocket>
+#include <QThread>
+
+CharacterPrinterOutput::CharacterPrinterOutput(const ReceiptsPrinterOptions &opts, QObject *parent)
+	: QObject(parent)
+	, m_printerOptions(opts)
+{
+}
+
+void CharacterPrinterOutput::writeData(int job_id, const QList<QByteArray> &data_lines)
+{
+	QElapsedTimer elapsed;
+	elapsed.start();
+	const ReceiptsPrinterOptions &printer_opts = m_printerOptions;
+	switch(printer_opts.characterPrinterType()) {
+		case ReceiptsPrinterOptions::CharacterPrinteType::Directory: {
+			if(!printer_opts.characterPrinterDirectory().isEmpty()) {
+				QString fn = printer_opts.characterPrinterDirectory();
+				qf::core::utils::FileUtils::ensurePath(fn);
+				QCryptographicHash ch(QCryptographicHash::Sha1);
+				for(QByteArray ba : data_lines)
+					ch.addData(ba);
+				fn += '/' + QString::fromLatin1(ch.result().toHex().mid(0, 8)) + ".txt";
+				saveFile(fn, data_lines);
+			}
+			break;
+		}
+		case ReceiptsPrinterOptions::CharacterPrinteType::LPT: {
+			if (!printer_opts.characterPrinterDevice().isEmpty()) {
+				saveFile(printer_opts.characterPrinterDevice(), data_lines);
+			}
+			break;
+		}
+		case ReceiptsPrinterOptions::CharacterPrinteType::Network: {
+			if (!printer_opts.characterPrinterAddress().isEmpty()) {
+				sendToNetwork(data_lines);
+			}
+			break;
+		}
+	}
+	emit dataWritten(job_id, (int)elapsed.elapsed());
+}
+
+void CharacterPrinterOutput::quitThread()
+{
+	thread()->quit();
+}
+
+void CharacterPrinterOutput::saveFile(const QString &file_name, const QList<QByteArray> &data_lines)
+{
+	QFile f(file_name);
+	if(f.open(QFile::WriteOnly)) {
+		for(QByteArray ba : data_lines) {
+			f.write(ba);
+			f.write("\n");
+		}
+	}
+	else {
+		qfError() << "Cannot open file" << f.fileName() << "for writing!";
+	}
+}
+
+void CharacterPrinterOutput::sendToNetwork(const QList<QByteArray> &data_lines)
+{
+	const ReceiptsPrinterOptions &printer_opts = m_printerOptions;
+	QTcpSocket socket;
+	QString host = printer_opts.characterPrinterAddress().section(':', 0, 0);
+	int port = printer_opts.characterPrinterAddress().section(':', 1, 1).toInt();
+	if(port == 0)
+		port = 9100;
+	socket.connectToHost(
+			host,
+			port,
+			QIODevice::WriteOnly);
+	if (socket.waitForConnected(1000)) {
+		for(const QByteArray& line : data_lines) {
+			socket.write(line);
+			socket.write("\n");
+		}
+		socket.disconnectFromHost();
+		if (!socket.waitForDisconnected(1000)) { // waiting till all data are sent
+			qfError() << "Error while closing the connection to printer: "
+					<< socket.error();
+		}
+	}
+	else {
+		qfError() << "Cannot open tcp connection to address "
+				<< host << " on port " << port
+				<< " reason: " << socket.error();
+	}
+}
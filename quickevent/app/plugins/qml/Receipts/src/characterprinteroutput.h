@@ -0,0 +1,29 @@
+#ifndef CHARACTERPRINTEROUTPUT_H
+#define CHARACTERPRINTEROUTPUT_H
+
+#include "receiptsprinteroptions.h"
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+
+/// Sends already rendered character printer data (ESC/POS lines) to printer.
+/// Lives in ReceiptsPrinter output thread, so blocking device and network I/O
+/// does not freeze GUI. Jobs are written in order they were queued.
+class CharacterPrinterOutput : public QObject
+{
+	Q_OBJECT
+public:
+	explicit CharacterPrinterOutput(const ReceiptsPrinterOptions &opts, QObject *parent = nullptr);
+
+	Q_SLOT void writeData(int job_id, const QList<QByteArray> &data_lines);
+	Q_SIGNAL void dataWritten(int job_id, int elapsed_msec);
+	Q_SLOT void quitThread();
+private:
+	void saveFile(const QString &file_name, const QList<QByteArray> &data_lines);
+	void sendToNetwork(const QList<QByteArray> &data_lines);
+private:
+	ReceiptsPrinterOptions m_printerOptions;
+};
+
+#endif // CHARACTERPRINTEROUTPUT_H
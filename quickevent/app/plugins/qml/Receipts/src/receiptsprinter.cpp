@@ -1,21 +1,22 @@
 #include "receiptsprinter.h"
+#include "characterprinteroutput.h"
 #include "Receipts/receiptsplugin.h"
 
 #include <qf/core/collator.h>
+#include <qf/core/exception.h>
 
 #include <qf/qmlwidgets/framework/mainwindow.h>
 #include <qf/qmlwidgets/reports/processor/reportpainter.h>
 #include <qf/qmlwidgets/reports/processor/reportprocessor.h>
 
-#include <QCryptographicHash>
 #include <QDomDocument>
 #include <QPrinter>
 #include <QPrinterInfo>
-#include <QTcpSocket>
 #include <QTextCodec>
+#include <QThread>
+#include <QTimer>
 
 //#define QF_TIMESCOPE_ENABLED
-#include <qf/core/utils/fileutils.h>
 #include <qf/core/utils/timescope.h>
 
 namespace qfu = qf::core::utils;
@@ -25,6 +26,20 @@ ReceiptsPrinter::ReceiptsPrinter(const ReceiptsPrinterOptions &opts, QObject *pa
 	: QObject(parent)
 	, m_printerOptions(opts)
 {
+	qRegisterMetaType<QList<QByteArray>>("QList<QByteArray>");
+}
+
+ReceiptsPrinter::~ReceiptsPrinter()
+{
+	if(!m_jobs.isEmpty())
+		qfWarning() << m_jobs.count() << "receipts in print queue discarded.";
+	QF_SAFE_DELETE(m_reportProcessor);
+	QF_SAFE_DELETE(m_graphicsPrinter);
+	if(m_outputThread) {
+		/// quit is queued after pending data, so all of them are written before thread finishes
+		QMetaObject::invokeMethod(m_characterPrinterOutput, "quitThread", Qt::QueuedConnection);
+		m_outputThread->wait();
+	}
 }
 /*
 static Receipts::ReceiptsPlugin *receiptsPlugin()
@@ -35,19 +50,110 @@ static Receipts::ReceiptsPlugin *receiptsPlugin()
 	return ret;
 }
 */
-void ReceiptsPrinter::printReceipt(const QString &report_file_name, const QVariantMap &report_data)
+const int ReceiptsPrinter::MAX_QUEUED_JOBS = 64;
+
+bool ReceiptsPrinter::printReceipt(const QString &report_file_name, const QVariantMap &report_data)
 {
 	qfLogFuncFrame();
 	if(report_file_name.isEmpty()) {
 		qfError() << "Empty receipt path.";
+		return false;
+	}
+	if(m_jobs.count() >= MAX_QUEUED_JOBS) {
+		qfError() << "Receipts print queue is full," << m_jobs.count() << "jobs waiting, print request refused.";
+		return false;
+	}
+	Job job;
+	job.id = ++m_lastJobId;
+	job.reportFileName = report_file_name;
+	job.reportData = report_data;
+	job.queuedTimer.start();
+	m_jobs.enqueue(job);
+	scheduleProcessJobs();
+	return true;
+}
+
+void ReceiptsPrinter::takeQueuedJobs(ReceiptsPrinter *other)
+{
+	if(!other || other == this || other->m_jobs.isEmpty())
 		return;
+	qfInfo() << other->m_jobs.count() << "receipts moved to new print queue.";
+	while(!other->m_jobs.isEmpty()) {
+		Job job = other->m_jobs.dequeue();
+		job.id = ++m_lastJobId;
+		m_jobs.enqueue(job);
 	}
-	QF_TIME_SCOPE("ReceiptsPrinter::printReceipt()");
-	const ReceiptsPrinterOptions &printer_opts = m_printerOptions;
-	QPrinter *printer = nullptr;
+	scheduleProcessJobs();
+}
+
+void ReceiptsPrinter::scheduleProcessJobs()
+{
+	if(!m_processJobsScheduled) {
+		m_processJobsScheduled = true;
+		/// let GUI process pending events between receipts
+		QTimer::singleShot(0, this, &ReceiptsPrinter::processNextJob);
+	}
+}
+
+void ReceiptsPrinter::processNextJob()
+{
+	m_processJobsScheduled = false;
+	if(m_jobs.isEmpty())
+		return;
+	Job job = m_jobs.dequeue();
+	int wait_msec = (int)job.queuedTimer.elapsed();
+	QElapsedTimer print_timer;
+	print_timer.start();
+	try {
+		printJob(job);
+	}
+	catch(const qf::core::Exception &e) {
+		qfError() << "Receipt job:" << job.id << "print error:" << e.toString();
+	}
+	qfInfo() << "Receipt job:" << job.id << "waited:" << wait_msec << "msec, rendered in:" << print_timer.elapsed() << "msec, jobs queued:" << m_jobs.count();
+	if(!m_jobs.isEmpty())
+		scheduleProcessJobs();
+}
+
+void ReceiptsPrinter::onCharacterDataWritten(int job_id, int elapsed_msec)
+{
+	qfInfo() << "Receipt job:" << job_id << "sent to printer in:" << elapsed_msec << "msec";
+}
+
+qf::qmlwidgets::reports::ReportProcessor *ReceiptsPrinter::reportProcessor(const QString &report_file_name)
+{
+	if(m_reportProcessor && m_reportProcessorFileName == report_file_name) {
+		QF_TIME_SCOPE("reset report processor");
+		m_reportProcessor->reset();
+		return m_reportProcessor;
+	}
+	QF_SAFE_DELETE(m_reportProcessor);
+	m_reportProcessorFileName = QString();
 	QPaintDevice *paint_device = nullptr;
-	if(printer_opts.printerType() == (int)ReceiptsPrinterOptions::PrinterType::GraphicPrinter) {
+	if(m_printerOptions.printerType() == (int)ReceiptsPrinterOptions::PrinterType::GraphicPrinter)
+		paint_device = graphicsPrinter();
+	else
+		paint_device = qff::MainWindow::frameWork();
+	if(!paint_device)
+		return nullptr;
+	auto *rp = new qf::qmlwidgets::reports::ReportProcessor(paint_device, this);
+	{
+		QF_TIME_SCOPE("compile report");
+		if(!rp->setReport(report_file_name)) {
+			delete rp;
+			return nullptr;
+		}
+	}
+	m_reportProcessor = rp;
+	m_reportProcessorFileName = report_file_name;
+	return m_reportProcessor;
+}
+
+QPrinter *ReceiptsPrinter::graphicsPrinter()
+{
+	if(!m_graphicsPrinter) {
 		QF_TIME_SCOPE("init graphics printer");
+		const ReceiptsPrinterOptions &printer_opts = m_printerOptions;
 		QPrinterInfo pi = QPrinterInfo::printerInfo(printer_opts.graphicsPrinterName());
 		if(pi.isNull()) {
 			for(auto s : QPrinterInfo::availablePrinterNames()) {
@@ -57,47 +163,63 @@ void ReceiptsPrinter::printReceipt(const QString &report_file_name, const QVaria
 		}
 		if(pi.isNull()) {
 			qfWarning() << "Default printer not set";
-			return;
+			return nullptr;
 		}
 		qfInfo() << "printing on:" << pi.printerName();
-		printer = new QPrinter(pi);
-		paint_device = printer;
+		m_graphicsPrinter = new QPrinter(pi);
 	}
-	else {
+	return m_graphicsPrinter;
+}
+
+CharacterPrinterOutput *ReceiptsPrinter::characterPrinterOutput()
+{
+	if(!m_characterPrinterOutput) {
+		const ReceiptsPrinterOptions &printer_opts = m_printerOptions;
 		qfInfo() << "printing on:" << printer_opts.characterPrinterModel() << "at:"
 				 << ((printer_opts.characterPrinterType() == ReceiptsPrinterOptions::CharacterPrinteType::Directory)?
 						 printer_opts.characterPrinterDirectory() :
 						 printer_opts.characterPrinterDevice());
-		qff::MainWindow *fwk = qff::MainWindow::frameWork();
-		paint_device = fwk;
+		m_outputThread = new QThread(this);
+		m_characterPrinterOutput = new CharacterPrinterOutput(printer_opts);
+		m_characterPrinterOutput->moveToThread(m_outputThread);
+		connect(m_outputThread, &QThread::finished, m_characterPrinterOutput, &QObject::deleteLater);
+		connect(m_characterPrinterOutput, &CharacterPrinterOutput::dataWritten, this, &ReceiptsPrinter::onCharacterDataWritten, Qt::QueuedConnection);
+		m_outputThread->start();
 	}
-	qf::qmlwidgets::reports::ReportProcessor rp(paint_device);
+	return m_characterPrinterOutput;
+}
+
+void ReceiptsPrinter::printJob(const ReceiptsPrinter::Job &job)
+{
+	qfLogFuncFrame() << "job:" << job.id;
+	QF_TIME_SCOPE("ReceiptsPrinter::printJob()");
+	const ReceiptsPrinterOptions &printer_opts = m_printerOptions;
+	qf::qmlwidgets::reports::ReportProcessor *rp = reportProcessor(job.reportFileName);
+	if(!rp)
+		return;
 	{
-		QF_TIME_SCOPE("setting report and data");
-		if(!rp.setReport(report_file_name))
-			return;
-		for(auto key : report_data.keys()) {
-			rp.setTableData(key, report_data.value(key));
+		QF_TIME_SCOPE("setting report data");
+		for(auto key : job.reportData.keys()) {
+			rp->setTableData(key, job.reportData.value(key));
 		}
 	}
 	if(printer_opts.printerType() == ReceiptsPrinterOptions::PrinterType::GraphicPrinter) {
 		QF_TIME_SCOPE("process graphics");
 		{
 			QF_TIME_SCOPE("process report");
-			rp.process();
+			rp->process();
 		}
 		qf::qmlwidgets::reports::ReportItemMetaPaintReport *doc;
 		{
 			QF_TIME_SCOPE("getting processor output");
-			doc = rp.processorOutput();
+			doc = rp->processorOutput();
 		}
-		qf::qmlwidgets::reports::ReportItemMetaPaint *it = doc->child(0);
+		qf::qmlwidgets::reports::ReportItemMetaPaint *it = doc? doc->child(0): nullptr;
 		if(it) {
 			QF_TIME_SCOPE("draw meta-paint");
-			qf::qmlwidgets::reports::ReportPainter painter(paint_device);
+			qf::qmlwidgets::reports::ReportPainter painter(rp->paintDevice());
 			painter.drawMetaPaint(it);
 		}
-		QF_SAFE_DELETE(printer);
 	}
 	else if(printer_opts.printerType() == ReceiptsPrinterOptions::PrinterType::CharacterPrinter) {
 		QDomDocument doc;
@@ -105,71 +227,12 @@ void ReceiptsPrinter::printReceipt(const QString &report_file_name, const QVaria
 		QDomElement el_body = doc.documentElement().firstChildElement("body");
 		qf::qmlwidgets::reports::ReportProcessor::HtmlExportOptions opts;
 		opts.setConvertBandsToTables(false);
-		rp.processHtml(el_body, opts);
+		rp->processHtml(el_body, opts);
 		//qfInfo() << doc.toString();
 		QList<QByteArray> data_lines = createPrinterData(el_body, printer_opts);
-		auto save_file = [data_lines](const QString &fn) {
-			QFile f(fn);
-			if(f.open(QFile::WriteOnly)) {
-				for(QByteArray ba : data_lines) {
-					f.write(ba);
-					f.write("\n");
-				}
-			}
-			else {
-				qfError() << "Cannot open file" << f.fileName() << "for writing!";
-			}
-		};
-		switch(printer_opts.characterPrinterType()) {
-			case ReceiptsPrinterOptions::CharacterPrinteType::Directory: {
-				if(!printer_opts.characterPrinterDirectory().isEmpty()) {
-					QString fn = printer_opts.characterPrinterDirectory();
-					qf::core::utils::FileUtils::ensurePath(fn);
-					QCryptographicHash ch(QCryptographicHash::Sha1);
-					for(QByteArray ba : data_lines)
-						ch.addData(ba);
-					fn += '/' + QString::fromLatin1(ch.result().toHex().mid(0, 8)) + ".txt";
-					save_file(fn);
-				}
-				break;
-			}
-			case ReceiptsPrinterOptions::CharacterPrinteType::LPT: {
-				if (!printer_opts.characterPrinterDevice().isEmpty()) {
-					save_file(printer_opts.characterPrinterDevice());
-				}
-				break;
-			}
-			case ReceiptsPrinterOptions::CharacterPrinteType::Network: {
-				if (!printer_opts.characterPrinterAddress().isEmpty()) {
-					QTcpSocket socket;
-					QString host = printer_opts.characterPrinterAddress().section(':', 0, 0);
-					int port = printer_opts.characterPrinterAddress().section(':', 1, 1).toInt();
-					if(port == 0)
-					    port = 9100;
-					socket.connectToHost(
-							host,
-							port,
-							QIODevice::WriteOnly);
-					if (socket.waitForConnected(1000)) {
-						for(const QByteArray& line : data_lines) {
-							socket.write(line);
-							socket.write("\n");
-						}
-						socket.disconnectFromHost();
-						if (!socket.waitForDisconnected(1000)) { // waiting till all data are sent
-							qfError() << "Error while closing the connection to printer: "
-									<< socket.error();
-						}
-					}
-					else {
-						qfError() << "Cannot open tcp connection to address "
-								<< host << " on port " << port
-								<< " reason: " << socket.error();
-					}
-				}
-				break;
-			}
-		}
+		QMetaObject::invokeMethod(characterPrinterOutput(), "writeData", Qt::QueuedConnection
+								  , Q_ARG(int, job.id)
+								  , Q_ARG(QList<QByteArray>, data_lines));
 	}
 }
 
@@ -4,24 +4,64 @@
 #include "receiptsprinteroptions.h"
 
 #include <QObject>
+#include <QQueue>
+#include <QElapsedTimer>
 
 class QDomElement;
+class QPrinter;
+class QThread;
 class DirectPrintContext;
+class CharacterPrinterOutput;
+
+namespace qf { namespace qmlwidgets { namespace reports { class ReportProcessor; }}}
 
 class ReceiptsPrinter : public QObject
 {
 	Q_OBJECT
 public:
 	explicit ReceiptsPrinter(const ReceiptsPrinterOptions &opts,  QObject *parent = 0);
+	~ReceiptsPrinter() Q_DECL_OVERRIDE;
+
+	/// maximum number of receipts waiting for print, new jobs are refused when queue is full
+	static const int MAX_QUEUED_JOBS;
 
 	const ReceiptsPrinterOptions& printerOptions() const {return m_printerOptions;}
 
-	void printReceipt(const QString &report_file_name, const QVariantMap &report_data);
+	/// Enqueue receipt, it is printed asynchronously in the order of calls.
+	/// Returns false if the print queue is full.
+	bool printReceipt(const QString &report_file_name, const QVariantMap &report_data);
+	int queuedJobCount() const {return m_jobs.count();}
+	/// Move jobs waiting in other printer's queue to the end of this queue.
+	void takeQueuedJobs(ReceiptsPrinter *other);
 private:
+	struct Job
+	{
+		int id = 0;
+		QString reportFileName;
+		QVariantMap reportData;
+		QElapsedTimer queuedTimer;
+	};
+	void scheduleProcessJobs();
+	void processNextJob();
+	void printJob(const Job &job);
+	void onCharacterDataWritten(int job_id, int elapsed_msec);
+	qf::qmlwidgets::reports::ReportProcessor* reportProcessor(const QString &report_file_name);
+	QPrinter* graphicsPrinter();
+	CharacterPrinterOutput* characterPrinterOutput();
+
 	QList<QByteArray> createPrinterData(const QDomElement &body, const ReceiptsPrinterOptions &printer_options);
 	void createPrinterData_helper(const QDomElement &el, DirectPrintContext *print_context, const QString &text_encoding);
 private:
 	ReceiptsPrinterOptions m_printerOptions;
+	QQueue<Job> m_jobs;
+	int m_lastJobId = 0;
+	bool m_processJobsScheduled = false;
+	/// report processor is kept between jobs, so the QML report is compiled only once
+	qf::qmlwidgets::reports::ReportProcessor *m_reportProcessor = nullptr;
+	QString m_reportProcessorFileName;
+	QPrinter *m_graphicsPrinter = nullptr;
+	QThread *m_outputThread = nullptr;
+	CharacterPrinterOutput *m_characterPrinterOutput = nullptr;
 };
 
 #endif // RECEIPTSPRINTER_H
@@ -7,6 +7,7 @@
 #include "Receipts/receiptsplugin.h"
 
 #include <Event/eventplugin.h>
+#include <Event/dbeventbus.h>
 #include <CardReader/cardreaderplugin.h>
 
 #include <quickevent/og/timems.h>
@@ -112,7 +113,10 @@ void ReceiptsWidget::settleDownInPartWidget(ReceiptsPartWidget *part_widget)
 	connect(part_widget, SIGNAL(resetPartRequest()), this, SLOT(reset()));
 	connect(part_widget, SIGNAL(reloadPartRequest()), this, SLOT(reset()));
 
-	connect(eventPlugin(), &Event::EventPlugin::dbEventNotify, this, &ReceiptsWidget::onDbEventNotify, Qt::QueuedConnection);
+	/// new cards are loaded once per batch of merged card reads
+	eventPlugin()->dbEventBus()->subscribe(Event::EventPlugin::DBEVENT_CARD_READ, this, [this](const QVariantList &) {
+		onCardRead();
+	});
 }
 
 void ReceiptsWidget::reset()
@@ -152,27 +156,12 @@ void ReceiptsWidget::reload()
 
 Receipts::ReceiptsPlugin *ReceiptsWidget::receiptsPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto plugin = qobject_cast<Receipts::ReceiptsPlugin *>(fwk->plugin("Receipts"));
-	QF_ASSERT(plugin != nullptr, "Bad plugin", return nullptr);
-	return plugin;
+	return qff::MainWindow::cachedPlugin<Receipts::ReceiptsPlugin>();
 }
 
 Event::EventPlugin *ReceiptsWidget::eventPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto plugin = qobject_cast<Event::EventPlugin *>(fwk->plugin("Event"));
-	QF_ASSERT(plugin != nullptr, "Bad plugin", return nullptr);
-	return plugin;
-}
-
-void ReceiptsWidget::onDbEventNotify(const QString &domain, int connection_id, const QVariant &data)
-{
-	Q_UNUSED(connection_id)
-	Q_UNUSED(data)
-	if(domain == QLatin1String(Event::EventPlugin::DBEVENT_CARD_READ)) {
-		onCardRead();
-	}
+	return qff::MainWindow::cachedPlugin<Event::EventPlugin>();
 }
 
 void ReceiptsWidget::createActions()
@@ -57,7 +57,6 @@ private:
 	void onCardRead();
 	void printNewCards();
 	void loadNewCards();
-	Q_SLOT void onDbEventNotify(const QString &domain, int connection_id, const QVariant &data);
 
 	bool printReceipt(int card_id);
 
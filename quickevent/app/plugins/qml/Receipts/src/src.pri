@@ -6,7 +6,8 @@ HEADERS += \
     $$PWD/Receipts/receiptsplugin.h \
     $$PWD/receiptsprinteroptions.h \
     $$PWD/receiptsprinteroptionsdialog.h \
-    $$PWD/receiptsprinter.h
+    $$PWD/receiptsprinter.h \
+    $$PWD/characterprinteroutput.h
 
 SOURCES += \
 	$$PWD/plugin.cpp \
@@ -15,7 +16,8 @@ SOURCES += \
     $$PWD/Receipts/receiptsplugin.cpp \
     $$PWD/receiptsprinteroptions.cpp \
     $$PWD/receiptsprinteroptionsdialog.cpp \
-    $$PWD/receiptsprinter.cpp
+    $$PWD/receiptsprinter.cpp \
+    $$PWD/characterprinteroutput.cpp
 
 FORMS += \
     $$PWD/receiptswidget.ui \
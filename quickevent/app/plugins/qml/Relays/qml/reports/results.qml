@@ -122,7 +122,7 @@ Report {
 						fill: Brush {color: Color {def: "khaki"} }
 						Cell {
 							width: "%"
-							textFn: detail.dataFn("className");
+							text: "{{className}}"
 							textStyle: myStyle.textStyleBold
 						}
 						//Cell {
@@ -186,11 +186,11 @@ Report {
 									function dataFn(field_name) {return function() {return rowData(field_name);}}
 									Cell {
 										width: "%"
-										textFn: lapsDetail.dataFn("competitorName");
+										text: "{{competitorName}}"
 									}
 									Para {
 										width: 16
-										textFn: lapsDetail.dataFn("registration");
+										text: "{{registration}}"
 									}
 									Para {
 										width: 13
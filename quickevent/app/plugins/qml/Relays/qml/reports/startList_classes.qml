@@ -78,7 +78,7 @@ Report {
 						fill: Brush {color: Color {def: "khaki"} }
 						Cell {
 							width: "%"
-							textFn: detail.dataFn("classes.name");
+							text: "{{classes.name}}"
 							textStyle: myStyle.textStyleBold
 						}
 						//Cell {
@@ -108,11 +108,7 @@ Report {
 								textStyle: myStyle.textStyleBold
 								Cell {
 									width: "%"
-									textFn: function() {
-										return relayDetail.dataFn("relays.number")()
-												+ ' ' + relayDetail.dataFn("relayName")()
-												+ ' ' + relayDetail.dataFn("clubs.name")();
-									}
+									text: "{{relays.number}} {{relayName}} {{clubs.name}}"
 								}
 							}
 							Band {
@@ -131,20 +127,20 @@ Report {
 									Cell {
 										width: 15
 										halign: Frame.AlignRight
-										textFn: lapsDetail.dataFn("leg");
+										text: "{{leg}}"
 									}
 									Cell {
 										width: "%"
-										textFn: lapsDetail.dataFn("competitorName");
+										text: "{{competitorName}}"
 									}
 									Para {
 										width: 18
-										textFn: lapsDetail.dataFn("registration");
+										text: "{{registration}}"
 									}
 									Cell {
 										width: 18
 										halign: Frame.AlignRight
-										textFn: lapsDetail.dataFn("runs.siId");
+										text: "{{runs.siId}}"
 									}
 								}
 							}
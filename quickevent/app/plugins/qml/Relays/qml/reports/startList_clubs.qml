@@ -78,11 +78,11 @@ Report {
 						fill: Brush {color: Color {def: "khaki"} }
 						textStyle: myStyle.textStyleBold
 						Cell {
-							textFn: detail.dataFn("club");
+							text: "{{club}}"
 						}
 						Cell {
 							width: "%"
-							textFn: detail.dataFn("name");
+							text: "{{name}}"
 						}
 					}
 					Band {
@@ -103,11 +103,7 @@ Report {
 								textStyle: myStyle.textStyleBold
 								Cell {
 									width: "%"
-									textFn: function() {
-										return relayDetail.dataFn("relays.number")()
-												+ ' ' + relayDetail.dataFn("classes.name")()
-												+ ' ' + relayDetail.dataFn("relayName")();
-									}
+									text: "{{relays.number}} {{classes.name}} {{relayName}}"
 								}
 							}
 							Band {
@@ -126,20 +122,20 @@ Report {
 									Cell {
 										width: 15
 										halign: Frame.AlignRight
-										textFn: lapsDetail.dataFn("leg");
+										text: "{{leg}}"
 									}
 									Cell {
 										width: "%"
-										textFn: lapsDetail.dataFn("competitorName");
+										text: "{{competitorName}}"
 									}
 									Para {
 										width: 18
-										textFn: lapsDetail.dataFn("registration");
+										text: "{{registration}}"
 									}
 									Cell {
 										width: 18
 										halign: Frame.AlignRight
-										textFn: lapsDetail.dataFn("runs.siId");
+										text: "{{runs.siId}}"
 									}
 								}
 							}
@@ -2,8 +2,10 @@ message(including $$PWD)
 
 HEADERS += \
     $$PWD/relaydocument.h \
-    $$PWD/relaysplugin.h
+    $$PWD/relaysplugin.h \
+    $$PWD/relayresults.h
 
 SOURCES += \
     $$PWD/relaydocument.cpp \
-    $$PWD/relaysplugin.cpp
+    $$PWD/relaysplugin.cpp \
+    $$PWD/relayresults.cpp
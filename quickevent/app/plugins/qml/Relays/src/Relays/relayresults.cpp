@@ -0,0 +1,339 @@
+#include "relayresults.h"
+
+#include <Event/eventplugin.h>
+
+#include <qf/core/log.h>
+#include <qf/core/exception.h>
+#include <qf/core/sql/query.h>
+#include <qf/core/sql/querybuilder.h>
+#include <quickevent/og/timems.h>
+
+#include <QStringList>
+
+#include <algorithm>
+
+namespace qfs = qf::core::sql;
+namespace qfu = qf::core::utils;
+namespace qog = quickevent::og;
+
+namespace Relays {
+
+namespace {
+
+void select_leg_fields(qfs::QueryBuilder &qb)
+{
+	qb.select2("relays", "id, classId, club, name")
+			.select2("clubs", "name")
+			.select2("runs", "id, leg, timeMs, finishTimeMs, disqualified, isRunning, notCompeting")
+			.select2("competitors", "registration")
+			.select("COALESCE(competitors.lastName, '') || ' ' || COALESCE(competitors.firstName, '') AS competitorName");
+}
+
+}
+
+int RelayResults::Relay::time(int leg_cnt) const
+{
+	int ret = 0;
+	for (int i = 0; i < qMin(legs.count(), leg_cnt); ++i) {
+		const Leg &leg = legs[i];
+		if(leg.disq)
+			return qog::TimeMs::DISQ_TIME_MSEC;
+		if(leg.time == 0)
+			return qog::TimeMs::NOT_FINISH_TIME_MSEC;
+		ret += leg.time;
+	}
+	return ret;
+}
+
+RelayResults::RelayResults(QObject *parent)
+	: Super(parent)
+{
+}
+
+void RelayResults::loadClasses(const QList<int> &class_ids)
+{
+	QStringList ids;
+	for(int class_id : class_ids) {
+		if(!m_classResults.contains(class_id))
+			ids << QString::number(class_id);
+	}
+	if(ids.isEmpty())
+		return;
+	qfLogFuncFrame() << "classes:" << ids;
+	for(const QString &id : ids)
+		m_classResults.insert(id.toInt(), ClassResults());
+	qfs::Query q;
+	{
+		qfs::QueryBuilder qb;
+		qb.select2("classdefs", "classId, relayLegCount")
+				.from("classdefs")
+				.where("classdefs.classId IN (" + ids.join(',') + ")");
+		q.execThrow(qb.toString());
+		while(q.next()) {
+			ClassResults &cr = m_classResults[q.value("classdefs.classId").toInt()];
+			if(cr.legCount == 0)
+				cr.legCount = q.value("classdefs.relayLegCount").toInt();
+		}
+	}
+	{
+		qfs::QueryBuilder qb;
+		select_leg_fields(qb);
+		qb.from("relays")
+				.join("relays.club", "clubs.abbr")
+				.joinRestricted("relays.id", "runs.relayId", "runs.leg>0")
+				.join("runs.competitorId", "competitors.id")
+				.where("relays.classId IN (" + ids.join(',') + ")")
+				.orderBy("relays.classId, relays.id, runs.leg");
+		q.execThrow(qb.toString());
+		while(q.next()) {
+			int class_id = q.value("relays.classId").toInt();
+			ClassResults &cr = m_classResults[class_id];
+			int relay_id = q.value("relays.id").toInt();
+			if(!cr.relayIndexes.contains(relay_id)) {
+				Relay r;
+				r.relayId = relay_id;
+				r.name = (q.value("relays.club").toString()
+						+ ' ' + q.value("relays.name").toString()
+						+ ' ' + q.value("clubs.name").toString()).trimmed();
+				r.legs.resize(cr.legCount);
+				cr.relayIndexes[relay_id] = cr.relays.count();
+				cr.relays << r;
+			}
+			int legno = q.value("runs.leg").toInt();
+			if(q.value("runs.id").toInt() == 0 || legno > cr.legCount)
+				continue;
+			setLeg(cr, class_id, relay_id, legno, legFromQuery(q));
+		}
+	}
+	for(const QString &id : ids) {
+		ClassResults &cr = m_classResults[id.toInt()];
+		for (int legno = 1; legno <= cr.legCount; ++legno)
+			computeLegPositions(cr, legno);
+		computeStandings(cr, 1);
+	}
+}
+
+qfu::TreeTable RelayResults::classResults(int class_id, int leg_count, int places, bool exclude_not_finish)
+{
+	loadClasses(QList<int>() << class_id);
+	const ClassResults &cr = m_classResults[class_id];
+	if(cr.legCount == 0) {
+		qfError() << "Leg count not defined for class id:" << class_id;
+		return qfu::TreeTable();
+	}
+	if(leg_count > cr.legCount)
+		leg_count = cr.legCount;
+
+	/// sort relays
+	QVector<QPair<int, const Relay*>> relays;
+	relays.reserve(cr.relays.count());
+	for(const Relay &relay : cr.relays) {
+		int time = relay.time(leg_count);
+		if(exclude_not_finish && time == qog::TimeMs::NOT_FINISH_TIME_MSEC)
+			continue;
+		relays << QPair<int, const Relay*>(time, &relay);
+	}
+	std::stable_sort(relays.begin(), relays.end(), [](const QPair<int, const Relay*> &a, const QPair<int, const Relay*> &b) {
+		return a.first < b.first;
+	});
+
+	int time0 = 0;
+	qfu::TreeTable tt;
+	tt.appendColumn("pos", QVariant::Int);
+	tt.appendColumn("name", QVariant::String);
+	tt.appendColumn("time", QVariant::Int);
+	tt.appendColumn("loss", QVariant::Int);
+	for (int i = 0; i < qMin(relays.count(), places); ++i) {
+		qfu::TreeTableRow rr = tt.appendRow();
+		const Relay &relay = *relays[i].second;
+		int time = relays[i].first;
+		if(i == 0)
+			time0 = time;
+		int prev_time = (i > 0)? relays[i-1].first: 0;
+		rr.setValue("pos", (time <= qog::TimeMs::MAX_REAL_TIME_MSEC && time > prev_time)? i+1: 0);
+		rr.setValue("name", relay.name);
+		rr.setValue("time", time);
+		rr.setValue("loss", (time <= qog::TimeMs::MAX_REAL_TIME_MSEC)?time - time0: 0);
+		qfu::TreeTable tt2;
+		for (int j = 0; j < leg_count; ++j) {
+			const Leg &leg = relay.legs[j];
+			qfu::TreeTableRow rr2 = tt2.appendRow();
+			rr2.setValue("competitorName", leg.name);
+			rr2.setValue("registration", leg.reg);
+			rr2.setValue("time",
+						 leg.disq? qog::TimeMs::DISQ_TIME_MSEC
+								: (leg.time == 0)? qog::TimeMs::NOT_FINISH_TIME_MSEC
+												: leg.time);
+			rr2.setValue("pos", leg.pos);
+			rr2.setValue("stime", leg.stime);
+			rr2.setValue("spos", leg.spos);
+		}
+		rr.appendTable(tt2);
+	}
+	return tt;
+}
+
+void RelayResults::updateRun(int run_id)
+{
+	qfLogFuncFrame() << "run id:" << run_id;
+	qfs::QueryBuilder qb;
+	select_leg_fields(qb);
+	qb.from("runs")
+			.join("runs.relayId", "relays.id", qfs::QueryBuilder::INNER_JOIN)
+			.join("relays.club", "clubs.abbr")
+			.join("runs.competitorId", "competitors.id")
+			.where("runs.id=" QF_IARG(run_id));
+	qfs::Query q;
+	q.execThrow(qb.toString());
+	int prev_class_id = m_runClassIds.value(run_id);
+	if(!q.next()) {
+		/// run is not a relay leg anymore
+		if(prev_class_id > 0)
+			removeClass(prev_class_id);
+		return;
+	}
+	int class_id = q.value("relays.classId").toInt();
+	if(prev_class_id > 0 && prev_class_id != class_id)
+		removeClass(prev_class_id);
+	auto it = m_classResults.find(class_id);
+	if(it == m_classResults.end())
+		return;
+	ClassResults &cr = it.value();
+	int relay_id = q.value("relays.id").toInt();
+	int legno = q.value("runs.leg").toInt();
+	if(!cr.relayIndexes.contains(relay_id) || legno < 1 || legno > cr.legCount) {
+		/// relay added or leg moved out of class legs, let class to be reloaded on next request
+		removeClass(class_id);
+		return;
+	}
+	int prev_legno = setLeg(cr, class_id, relay_id, legno, legFromQuery(q));
+	computeLegPositions(cr, legno);
+	if(prev_legno > 0 && prev_legno != legno)
+		computeLegPositions(cr, prev_legno);
+	computeStandings(cr, (prev_legno > 0)? qMin(legno, prev_legno): legno);
+}
+
+void RelayResults::clear()
+{
+	qfLogFuncFrame();
+	m_classResults.clear();
+	m_runClassIds.clear();
+}
+
+void RelayResults::onCardsRead(const QVariantList &card_ids)
+{
+	if(m_classResults.isEmpty())
+		return;
+	QStringList ids;
+	for(const QVariant &v : card_ids)
+		ids << QString::number(v.toInt());
+	qfs::Query q;
+	q.exec("SELECT runId FROM cards WHERE id IN (" + ids.join(',') + ")", qf::core::Exception::Throw);
+	while(q.next())
+		updateRun(q.value(0).toInt());
+}
+
+RelayResults::Leg RelayResults::legFromQuery(const qfs::Query &q)
+{
+	Leg leg;
+	leg.runId = q.value("runs.id").toInt();
+	leg.name = q.value("competitorName").toString();
+	leg.reg = q.value("competitors.registration").toString();
+	if(q.value("runs.isRunning").toBool()
+			&& !q.value("runs.notCompeting").toBool()
+			&& q.value("runs.finishTimeMs").toInt() > 0) {
+		leg.notfinish = false;
+		leg.disq = q.value("runs.disqualified").toBool();
+		leg.time = q.value("runs.timeMs").toInt();
+	}
+	return leg;
+}
+
+int RelayResults::setLeg(RelayResults::ClassResults &cr, int class_id, int relay_id, int legno, const RelayResults::Leg &leg)
+{
+	int prev_legno = 0;
+	auto prev_it = cr.runRelayIds.constFind(leg.runId);
+	if(prev_it != cr.runRelayIds.constEnd()) {
+		Relay &prev_relay = cr.relays[cr.relayIndexes.value(prev_it.value())];
+		for (int i = 0; i < prev_relay.legs.count(); ++i) {
+			if(prev_relay.legs[i].runId == leg.runId) {
+				prev_relay.legs[i] = Leg();
+				prev_legno = i + 1;
+				break;
+			}
+		}
+	}
+	cr.relays[cr.relayIndexes.value(relay_id)].legs[legno - 1] = leg;
+	cr.runRelayIds[leg.runId] = relay_id;
+	m_runClassIds[leg.runId] = class_id;
+	return prev_legno;
+}
+
+void RelayResults::removeClass(int class_id)
+{
+	qfLogFuncFrame() << "class id:" << class_id;
+	auto it = m_classResults.find(class_id);
+	if(it == m_classResults.end())
+		return;
+	for(auto run_it = it.value().runRelayIds.constBegin(); run_it != it.value().runRelayIds.constEnd(); ++run_it)
+		m_runClassIds.remove(run_it.key());
+	m_classResults.erase(it);
+}
+
+void RelayResults::computeLegPositions(RelayResults::ClassResults &cr, int legno)
+{
+	struct LegTime
+	{
+		bool disq;
+		int time;
+		int runId;
+		Leg *leg;
+	};
+	QVector<LegTime> leg_times;
+	leg_times.reserve(cr.relays.count());
+	for (int i = 0; i < cr.relays.count(); ++i) {
+		Leg &leg = cr.relays[i].legs[legno - 1];
+		leg.pos = 0;
+		if(!leg.notfinish)
+			leg_times << LegTime{leg.disq, leg.time, leg.runId, &leg};
+	}
+	std::sort(leg_times.begin(), leg_times.end(), [](const LegTime &a, const LegTime &b) {
+		if(a.disq != b.disq)
+			return b.disq;
+		if(a.time != b.time)
+			return a.time < b.time;
+		return a.runId < b.runId;
+	});
+	int run_pos = 1;
+	for(const LegTime &lt : leg_times) {
+		lt.leg->pos = lt.disq? 0: run_pos;
+		run_pos++;
+	}
+}
+
+void RelayResults::computeStandings(RelayResults::ClassResults &cr, int from_legno)
+{
+	for (int legno = from_legno; legno <= cr.legCount; ++legno) {
+		QVector<QPair<int, int>> relay_stime;
+		for (int i = 0; i < cr.relays.count(); ++i) {
+			Relay &relay = cr.relays[i];
+			Leg &leg = relay.legs[legno - 1];
+			leg.stime = 0;
+			leg.spos = 0;
+			if(!leg.notfinish && !leg.disq) {
+				if(legno == 1)
+					leg.stime = leg.time;
+				else if(relay.legs[legno-2].stime > 0)
+					leg.stime = leg.time + relay.legs[legno-2].stime;
+			}
+			if(leg.stime > 0)
+				relay_stime << QPair<int, int>(leg.stime, i);
+		}
+		std::sort(relay_stime.begin(), relay_stime.end());
+		int pos = 0;
+		for(const QPair<int, int> &p : relay_stime)
+			cr.relays[p.second].legs[legno - 1].spos = ++pos;
+	}
+}
+
+}
@@ -0,0 +1,80 @@
+#ifndef RELAYS_RELAYRESULTS_H
+#define RELAYS_RELAYRESULTS_H
+
+#include "../relayspluginglobal.h"
+
+#include <qf/core/utils/treetable.h>
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QVariantList>
+
+namespace qf { namespace core { namespace sql { class Query; }}}
+
+namespace Relays {
+
+/// Per class relay standings indexed by relay and run id.
+/// Classes are loaded lazily by single query, legs positions and overall standings are computed in memory.
+/// When card is read, only affected run is reloaded and its leg with following legs standings are recomputed.
+class RELAYSPLUGIN_DECL_EXPORT RelayResults : public QObject
+{
+	Q_OBJECT
+private:
+	typedef QObject Super;
+public:
+	RelayResults(QObject *parent = nullptr);
+
+	/// load all not loaded classes from class_ids by one query
+	void loadClasses(const QList<int> &class_ids);
+	qf::core::utils::TreeTable classResults(int class_id, int leg_count, int places, bool exclude_not_finish);
+
+	/// reload single run from SQL, does nothing if run's class is not loaded yet
+	Q_SLOT void updateRun(int run_id);
+	Q_SLOT void clear();
+
+	/// update runs of read cards, card ids are merged DBEVENT_CARD_READ payloads
+	void onCardsRead(const QVariantList &card_ids);
+private:
+	struct Leg
+	{
+		int runId = 0;
+		QString name, reg;
+		int time = 0;
+		int pos = 0;
+		int stime = 0;
+		int spos = 0;
+		bool disq = false;
+		bool notfinish = true;
+	};
+	struct Relay
+	{
+		int relayId = 0;
+		QString name;
+		QVector<Leg> legs;
+
+		int time(int leg_cnt) const;
+	};
+	struct ClassResults
+	{
+		int legCount = 0;
+		QVector<Relay> relays;
+		QHash<int, int> relayIndexes; //< relayId -> index to relays
+		QHash<int, int> runRelayIds; //< runId -> relayId
+	};
+
+	static Leg legFromQuery(const qf::core::sql::Query &q);
+	/// @return leg number run was assigned to before, 0 if none
+	int setLeg(ClassResults &cr, int class_id, int relay_id, int legno, const Leg &leg);
+	void removeClass(int class_id);
+	static void computeLegPositions(ClassResults &cr, int legno);
+	static void computeStandings(ClassResults &cr, int from_legno);
+private:
+	QHash<int, ClassResults> m_classResults;
+	QHash<int, int> m_runClassIds;
+};
+
+}
+
+#endif // RELAYS_RELAYRESULTS_H
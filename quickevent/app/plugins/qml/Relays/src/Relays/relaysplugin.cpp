@@ -1,9 +1,11 @@
 #include "relaysplugin.h"
 #include "../thispartwidget.h"
 #include "relaydocument.h"
+#include "relayresults.h"
 #include "../relaywidget.h"
 
 #include <Event/eventplugin.h>
+#include <Event/dbeventbus.h>
 
 #include <qf/qmlwidgets/framework/mainwindow.h>
 #include <qf/qmlwidgets/framework/dockwidget.h>
@@ -15,7 +17,6 @@
 #include <qf/core/model/sqltablemodel.h>
 #include <qf/core/log.h>
 #include <qf/core/assert.h>
-#include <quickevent/og/timems.h>
 
 #include <QQmlEngine>
 
@@ -24,7 +25,6 @@ namespace qff = qf::qmlwidgets::framework;
 namespace qfd = qf::qmlwidgets::dialogs;
 namespace qfm = qf::core::model;
 namespace qfs = qf::core::sql;
-namespace qog = quickevent::og;
 
 namespace Relays {
 
@@ -39,6 +39,7 @@ static Event::EventPlugin* eventPlugin()
 RelaysPlugin::RelaysPlugin(QObject *parent)
 	: Super(parent)
 {
+	m_relayResults = new RelayResults(this);
 	connect(this, &RelaysPlugin::installed, this, &RelaysPlugin::onInstalled, Qt::QueuedConnection);
 }
 
@@ -67,7 +68,10 @@ int RelaysPlugin::editRelay(int id, int mode)
 	dlg.setDefaultButton(QDialogButtonBox::Save);
 	dlg.setCentralWidget(w);
 	w->load(id, (qfm::DataDocument::RecordEditMode)mode);
-	return dlg.exec();
+	int ret = dlg.exec();
+	/// legs might be reassigned
+	m_relayResults->clear();
+	return ret;
 }
 
 void RelaysPlugin::onInstalled()
@@ -77,6 +81,24 @@ void RelaysPlugin::onInstalled()
 	fwk->addPartWidget(m_partWidget, manifest()->featureId());
 
 	connect(eventPlugin(), &Event::EventPlugin::dbEventNotify, this, &RelaysPlugin::onDbEventNotify);
+	connect(this, &RelaysPlugin::competitorEdited, m_relayResults, &RelayResults::clear);
+	connect(eventPlugin(), &Event::EventPlugin::eventOpened, m_relayResults, &RelayResults::clear);
+	connect(eventPlugin(), &Event::EventPlugin::reloadDataRequest, m_relayResults, &RelayResults::clear);
+	{
+		Event::DbEventBus *bus = eventPlugin()->dbEventBus();
+		bus->subscribe(Event::EventPlugin::DBEVENT_CARD_READ, m_relayResults, [this](const QVariantList &card_ids) {
+			m_relayResults->onCardsRead(card_ids);
+		});
+		bus->subscribe(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED, m_relayResults, [this](const QVariantList &) {
+			m_relayResults->clear();
+		});
+	}
+	/// Relays does not link Runs plugin, legs edited in runs table are connected by signal name
+	connect(fwk, &qff::MainWindow::pluginsLoaded, this, [this, fwk]() {
+		QObject *runs_plugin = fwk->plugin("Runs");
+		if(runs_plugin)
+			connect(runs_plugin, SIGNAL(runEdited(int)), m_relayResults, SLOT(updateRun(int)));
+	});
 
 	emit nativeInstalled();
 }
@@ -88,78 +110,6 @@ void RelaysPlugin::onDbEventNotify(const QString &domain, int connection_id, con
 	emit dbEventNotify(domain, connection_id, data);
 }
 
-namespace {
-
-struct Leg
-{
-	int runId = 0;
-	QString name, reg;
-	int time = 0;
-	int pos = 0;
-	int stime = 0;
-	int spos = 0;
-	bool disq = false;
-	bool notfinish = true;
-};
-
-struct Relay
-{
-	int relayId = 0;
-	QString name;
-	int loss = 0;
-	QVector<Leg> legs;
-
-	int time(int leg_cnt) const
-	{
-		int ret = 0;
-		for (int i = 0; i < qMin(legs.count(), leg_cnt); ++i) {
-			const Leg &leg = legs[i];
-			if(leg.disq)
-				return qog::TimeMs::DISQ_TIME_MSEC;
-			if(leg.time == 0)
-				return qog::TimeMs::NOT_FINISH_TIME_MSEC;
-			ret += leg.time;
-		}
-		return ret;
-	}
-#if 0
-	bool isDisq(int leg_cnt) const
-	{
-		for (int i = 0; i < qMin(legs.count(), leg_cnt); ++i) {
-			const Leg &leg = legs[i];
-			if(leg.disq)
-				return true;
-		}
-		return false;
-		/*
-		leg_cnt = qMin(legs.count(), leg_cnt);
-		if(leg_cnt == 0)
-			return false;
-		return legs[leg_cnt-1].stime == 0;
-		*/
-	}
-	bool notFinish(int leg_cnt) const
-	{
-		for (int i = 0; i < qMin(legs.count(), leg_cnt); ++i) {
-			const Leg &leg = legs[i];
-			if(leg.time == 0 && !leg.disq)
-				return true;
-		}
-		return false;
-	}
-	bool isOk(int leg_cnt) const
-	{
-		for (int i = 0; i < qMin(legs.count(), leg_cnt); ++i) {
-			const Leg &leg = legs[i];
-			if(leg.time == 0 || leg.disq)
-				return false;
-		}
-		return true;
-	}
-#endif
-};
-}
-
 qf::core::utils::TreeTable RelaysPlugin::nlegsResultsTable(int leg_count, int places, bool exclude_not_finish)
 {
 	qf::core::utils::TreeTable tt;
@@ -172,10 +122,17 @@ qf::core::utils::TreeTable RelaysPlugin::nlegsResultsTable(int leg_count, int pl
 			.orderBy("classes.name");
 	qfs::Query q;
 	q.execThrow(qb.toString());
-	while(q.next()) {
+	QList<QPair<int, QString>> classes;
+	while(q.next())
+		classes << QPair<int, QString>(q.value("classes.id").toInt(), q.value("classes.name").toString());
+	QList<int> class_ids;
+	for(const QPair<int, QString> &c : classes)
+		class_ids << c.first;
+	m_relayResults->loadClasses(class_ids);
+	for(const QPair<int, QString> &c : classes) {
 		qf::core::utils::TreeTableRow rr = tt.appendRow();
-		rr.setValue("className", q.value("classes.name"));
-		qf::core::utils::TreeTable tt2 = nlegsResultsTable(q.value("classes.id").toInt(), leg_count, places, exclude_not_finish);
+		rr.setValue("className", c.second);
+		qf::core::utils::TreeTable tt2 = nlegsResultsTable(c.first, leg_count, places, exclude_not_finish);
 		rr.appendTable(tt2);
 	}
 	return tt;
@@ -183,200 +140,7 @@ qf::core::utils::TreeTable RelaysPlugin::nlegsResultsTable(int leg_count, int pl
 
 qf::core::utils::TreeTable RelaysPlugin::nlegsResultsTable(int class_id, int leg_count, int places, bool exclude_not_finish)
 {
-	int max_leg = 0;
-	qfs::Query q;
-	{
-		qfs::QueryBuilder qb;
-		qb.select("relayLegCount")
-			.from("classdefs")
-			.where("classId=" QF_IARG(class_id));
-		q.execThrow(qb.toString());
-		if(q.next())
-			max_leg = q.value(0).toInt();
-	}
-	if(max_leg == 0) {
-		qfError() << "Leg count not defined for class id:" << class_id;
-		return qf::core::utils::TreeTable();
-	}
-	if(leg_count > max_leg)
-		leg_count = max_leg;
-
-	QList<Relay> relays;
-	//QStringList relay_ids;
-	{
-		qfs::QueryBuilder qb;
-		qb.select2("relays", "id, club, name")
-				.select2("clubs", "name")
-				.from("relays")
-				.join("relays.club", "clubs.abbr")
-				.where("relays.classId=" QF_IARG(class_id));
-		q.execThrow(qb.toString());
-		while(q.next()) {
-			Relay r;
-			r.relayId = q.value("relays.id").toInt();
-			r.name = (q.value("relays.club").toString()
-					+ ' ' + q.value("relays.name").toString()
-					+ ' ' + q.value("clubs.name").toString()).trimmed();
-			for (int i = 0; i < leg_count; ++i)
-				r.legs << Leg();
-			relays << r;
-			//relay_ids << QString::number(r.relayId);
-		}
-	}
-	{
-		qfs::QueryBuilder qb;
-		qb.select2("competitors", "id, registration")
-				.select2("runs", "id, relayId, leg")
-				.select("COALESCE(competitors.lastName, '') || ' ' || COALESCE(competitors.firstName, '') AS competitorName")
-				.from("runs")
-				.join("runs.competitorId", "competitors.id")
-				.joinRestricted("runs.relayId", "relays.id", "relays.classId=" QF_IARG(class_id), qfs::QueryBuilder::INNER_JOIN)
-				//.where("runs.relayId IN (" + relay_ids.join(',') + ")")
-				.where("runs.leg>0 AND runs.leg<=" + QString::number(leg_count))
-				.orderBy("runs.relayId, runs.leg");
-		q.execThrow(qb.toString());
-		while(q.next()) {
-			int relay_id = q.value("runs.relayId").toInt();
-			for (int i = 0; i < relays.count(); ++i) {
-				if(relays[i].relayId == relay_id) {
-					Relay &relay = relays[i];
-					int legno = q.value("runs.leg").toInt();
-					Leg &leg = relay.legs[legno - 1];
-					leg.name = q.value("competitorName").toString();
-					leg.runId = q.value("runs.id").toInt();
-					leg.reg = q.value("competitors.registration").toString();
-					break;
-				}
-			}
-		}
-	}
-	for (int legno = 1; legno <= leg_count; ++legno) {
-		qfs::QueryBuilder qb;
-		qb.select2("runs", "id, relayId, timeMs, disqualified")
-				.from("runs")
-				.joinRestricted("runs.relayId", "relays.id",
-								"relays.classId=" QF_IARG(class_id)
-								" AND runs.leg=" QF_IARG(legno)
-								" AND runs.isRunning"
-								" AND NOT runs.notCompeting"
-								" AND runs.finishTimeMs>0"
-								, qfs::QueryBuilder::INNER_JOIN)
-				.orderBy("runs.disqualified, runs.timeMs");
-		q.execThrow(qb.toString());
-		int run_pos = 1;
-		while(q.next()) {
-			int relay_id = q.value("runs.relayId").toInt();
-			for (int i = 0; i < relays.count(); ++i) {
-				if(relays[i].relayId == relay_id) {
-					int run_id = q.value("runs.id").toInt();
-					Relay &relay = relays[i];
-					Leg &leg = relay.legs[legno - 1];
-					if(leg.runId != run_id) {
-						qfError() << "internal error, leg:" << legno << "runId check:" << leg.runId << "should equal" << run_id;
-					}
-					else {
-						leg.notfinish = false;
-						leg.disq = q.value("runs.disqualified").toBool();
-						leg.time = q.value("timeMs").toInt();
-						leg.pos = leg.disq? 0: run_pos;
-						run_pos++;
-					}
-					break;
-				}
-			}
-		}
-	}
-	/// compute overal legs positions
-	for (int legno = 1; legno <= leg_count; ++legno) {
-		QList<QPair<int, int>> relay_stime;
-		for (int i = 0; i < relays.count(); ++i) {
-			Relay &relay = relays[i];
-			Leg &leg = relay.legs[legno - 1];
-			if(!leg.notfinish && !leg.disq) {
-				if(legno == 1)
-					leg.stime = leg.time;
-				else if(relay.legs[legno-2].stime > 0)
-					leg.stime = leg.time + relay.legs[legno-2].stime;
-			}
-			if(leg.stime > 0)
-				relay_stime << QPair<int, int>(relay.relayId, leg.stime);
-		}
-		std::sort(relay_stime.begin(), relay_stime.end(), [](const QPair<int, int> &a, const QPair<int, int> &b) {return a.second < b.second;});
-		int pos = 0;
-		for(const QPair<int, int> &p : relay_stime) {
-			int relay_id = p.first;
-			for (int i = 0; i < relays.count(); ++i) {
-				if(relays[i].relayId == relay_id) {
-					Relay &relay = relays[i];
-					Leg &leg = relay.legs[legno - 1];
-					leg.spos = ++pos;
-					break;
-				}
-			}
-		}
-	}
-	if(exclude_not_finish) {
-		/*
-		relays.erase(std::remove_if(relays.begin(),
-									  relays.end(),
-									  [](const Relay &r){return r.time(leg_count) == TIME_NOT_FINISH;}),
-					   relays.end());
-		*/
-		QMutableListIterator<Relay> i(relays);
-		while (i.hasNext()) {
-			const Relay &r = i.next();
-			if(r.time(leg_count) == qog::TimeMs::NOT_FINISH_TIME_MSEC)
-				i.remove();
-		}
-	}
-	/// sort relays
-	std::sort(relays.begin(), relays.end(), [leg_count](const Relay &a, const Relay &b) {
-		return a.time(leg_count) < b.time(leg_count);
-	});
-
-	int time0 = 0;
-	qf::core::utils::TreeTable tt;
-	tt.appendColumn("pos", QVariant::Int);
-	tt.appendColumn("name", QVariant::String);
-	tt.appendColumn("time", QVariant::Int);
-	tt.appendColumn("loss", QVariant::Int);
-	for (int i = 0; i < qMin(relays.count(), places); ++i) {
-		qf::core::utils::TreeTableRow rr = tt.appendRow();
-		Relay &relay = relays[i];
-		int time = relay.time(leg_count);
-		if(i == 0)
-			time0 = time;
-		int prev_time = (i > 0)? relays[i-1].time(leg_count): 0;
-		rr.setValue("pos", (time <= qog::TimeMs::MAX_REAL_TIME_MSEC && time > prev_time)? i+1: 0);
-		rr.setValue("name", relay.name);
-		rr.setValue("time", time);
-		rr.setValue("loss", (time <= qog::TimeMs::MAX_REAL_TIME_MSEC)?time - time0: 0);
-		qf::core::utils::TreeTable tt2;
-		tt.appendColumn("name", QVariant::String);
-		tt.appendColumn("reg", QVariant::String);
-		tt.appendColumn("time", QVariant::Int);
-		tt.appendColumn("pos", QVariant::Int);
-		tt.appendColumn("stime", QVariant::Int);
-		tt.appendColumn("spos", QVariant::Int);
-		//tt.appendColumn("disq", QVariant::Bool);
-		for (int j = 0; j < relay.legs.count(); ++j) {
-			Leg &leg = relay.legs[j];
-			qf::core::utils::TreeTableRow rr2 = tt2.appendRow();
-			rr2.setValue("competitorName", leg.name);
-			rr2.setValue("registration", leg.reg);
-			rr2.setValue("time",
-						 leg.disq? qog::TimeMs::DISQ_TIME_MSEC
-								: (leg.time == 0)? qog::TimeMs::NOT_FINISH_TIME_MSEC
-												: leg.time);
-			rr2.setValue("pos", leg.pos);
-			rr2.setValue("stime", leg.stime);
-			rr2.setValue("spos", leg.spos);
-			//rr2.setValue("disq", leg.disq);
-		}
-		rr.appendTable(tt2);
-	}
-	//qfInfo() << tt.toString();
-	return tt;
+	return m_relayResults->classResults(class_id, leg_count, places, exclude_not_finish);
 }
 
 }
@@ -22,6 +22,8 @@ class DockWidget;
 
 namespace Relays {
 
+class RelayResults;
+
 class RELAYSPLUGIN_DECL_EXPORT RelaysPlugin : public qf::qmlwidgets::framework::Plugin
 {
 	Q_OBJECT
@@ -42,6 +44,8 @@ public:
 
 	Q_SIGNAL void nativeInstalled();
 
+	RelayResults* relayResults() {return m_relayResults;}
+
 	qf::core::utils::TreeTable nlegsResultsTable(int leg_count, int places, bool exclude_not_finish);
 	qf::core::utils::TreeTable nlegsResultsTable(int class_id, int leg_count, int places, bool exclude_not_finish);
 private:
@@ -49,6 +53,7 @@ private:
 	void onDbEventNotify(const QString &domain, int connection_id, const QVariant &data);
 private:
 	qf::qmlwidgets::framework::PartWidget *m_partWidget = nullptr;
+	RelayResults *m_relayResults = nullptr;
 };
 
 }
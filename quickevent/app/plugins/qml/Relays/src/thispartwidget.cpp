@@ -10,11 +10,12 @@ ThisPartWidget::ThisPartWidget(QWidget *parent)
 {
 	setPersistentSettingsId("Relays");
 	setTitle(tr("&Relays"));
+}
 
+void ThisPartWidget::lazyInit()
+{
 	RelaysWidget *w = new RelaysWidget();
 	centralFrame()->addWidget(w);
 	w->settleDownInPartWidget(this);
-
-	//QMetaObject::invokeMethod(this, "lazyInit", Qt::QueuedConnection);
 }
 
@@ -12,6 +12,7 @@ public:
 	ThisPartWidget(QWidget *parent = nullptr);
 protected:
 	//void reload() Q_DECL_OVERRIDE;
+	void lazyInit() Q_DECL_OVERRIDE;
 };
 
 #endif // THISPARTWIDGET_H
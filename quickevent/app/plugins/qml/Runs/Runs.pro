@@ -19,6 +19,8 @@ LIBS += \
     -lEventplugin \
     -lCompetitorsplugin \
 
+win32: LIBS += -lpsapi
+
 include (src/src.pri)
 
 RESOURCES += \
@@ -0,0 +1 @@
+#include "../../src/Runs/resultssnapshot.h"
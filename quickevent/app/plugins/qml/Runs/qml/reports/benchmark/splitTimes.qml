@@ -0,0 +1,138 @@
+import qf.qmlreports 1.0
+import shared.QuickEvent.reports 1.0
+
+// used by Help / Benchmark split times report, every cell is read by compiled {{field}} binding
+Report {
+	id: root
+	objectName: "root"
+
+	styleSheet: StyleSheet {
+		objectName: "landscapeStyleSheet"
+		basedOn: ReportStyleCommon { id: myStyle }
+	}
+	textStyle: myStyle.textStyleDefault
+
+	width: 297
+	height: 210
+	hinset: 10
+	vinset: 5
+	Frame {
+		width: "%"
+		height: "%"
+		Band {
+			id: band
+			objectName: "band"
+			width: "%"
+			Detail {
+				id: detail
+				objectName: "detail"
+				width: "%"
+				layout: Frame.LayoutHorizontal
+				Cell {
+					width: 40
+					text: "{{competitorName}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split1}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split2}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split3}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split4}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split5}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split6}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split7}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split8}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split9}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split10}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split11}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split12}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split13}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split14}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split15}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split16}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split17}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split18}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split19}}"
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					text: "{{split20}}"
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,139 @@
+import qf.qmlreports 1.0
+import shared.QuickEvent.reports 1.0
+
+// used by Help / Benchmark split times report, the same cells as splitTimes.qml are read through textFn
+Report {
+	id: root
+	objectName: "root"
+
+	styleSheet: StyleSheet {
+		objectName: "landscapeStyleSheet"
+		basedOn: ReportStyleCommon { id: myStyle }
+	}
+	textStyle: myStyle.textStyleDefault
+
+	width: 297
+	height: 210
+	hinset: 10
+	vinset: 5
+	Frame {
+		width: "%"
+		height: "%"
+		Band {
+			id: band
+			objectName: "band"
+			width: "%"
+			Detail {
+				id: detail
+				objectName: "detail"
+				width: "%"
+				layout: Frame.LayoutHorizontal
+				function dataFn(field_name) {return function() {return rowData(field_name);}}
+				Cell {
+					width: 40
+					textFn: detail.dataFn("competitorName")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split1")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split2")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split3")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split4")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split5")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split6")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split7")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split8")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split9")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split10")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split11")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split12")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split13")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split14")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split15")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split16")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split17")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split18")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split19")
+				}
+				Cell {
+					width: 11
+					halign: Frame.AlignRight
+					textFn: detail.dataFn("split20")
+				}
+			}
+		}
+	}
+}
@@ -120,7 +120,7 @@ Report {
 						fill: Brush {color: Color {def: "khaki"} }
 						Cell {
 							width: "%"
-							textFn: detail.dataFn("classes.name");
+							text: "{{classes.name}}"
 							textStyle: myStyle.textStyleBold
 						}
 						Cell {
@@ -161,11 +161,11 @@ Report {
 							}
 							Cell {
 								width: "%"
-								textFn: runnersDetail.dataFn("competitorName");
+								text: "{{competitorName}}"
 							}
 							Cell {
 								width: hdrRegistration.width
-								textFn: runnersDetail.dataFn("registration");
+								text: "{{registration}}"
 							}
 							Component.onCompleted: {
 								//console.warn("=============", root.stageCount)
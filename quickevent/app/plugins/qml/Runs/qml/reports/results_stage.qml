@@ -75,7 +75,7 @@ Report {
 						fill: Brush {color: Color {def: "khaki"} }
 						Cell {
 							width: "%"
-							textFn: detail.dataFn("classes.name");
+							text: "{{classes.name}}"
 							textStyle: myStyle.textStyleBold
 						}
 						Cell {
@@ -107,11 +107,11 @@ Report {
 							}
 							Cell {
 								width: "%"
-								textFn: runnersDetail.dataFn("competitorName");
+								text: "{{competitorName}}"
 							}
 							Para {
 								width: 18
-								textFn: runnersDetail.dataFn("registration");
+								text: "{{registration}}"
 							}
 							Cell {
 								width: 15
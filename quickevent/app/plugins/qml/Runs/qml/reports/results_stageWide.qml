@@ -68,7 +68,7 @@ Report {
 						fill: Brush {color: Color {def: "khaki"} }
 						Cell {
 							width: "%"
-							textFn: detail.dataFn("classes.name");
+							text: "{{classes.name}}"
 							textStyle: myStyle.textStyleBold
 						}
 						Cell {
@@ -100,15 +100,15 @@ Report {
 							}
 							Cell {
 								width: "%"
-								textFn: runnersDetail.dataFn("competitorName");
+								text: "{{competitorName}}"
 							}
 							Cell {
 								width: "%"
-								textFn: runnersDetail.dataFn("clubs.name");
+								text: "{{clubs.name}}"
 							}
 							Para {
 								width: 18
-								textFn: runnersDetail.dataFn("registration");
+								text: "{{registration}}"
 							}
 							Cell {
 								width: 15
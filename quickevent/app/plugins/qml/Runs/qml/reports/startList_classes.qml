@@ -76,7 +76,7 @@ Report {
 						fill: Brush {color: Color {def: "khaki"} }
 						Cell {
 							width: "%"
-							textFn: detail.dataFn("classes.name");
+							text: "{{classes.name}}"
 							textStyle: myStyle.textStyleBold
 						}
 						Cell {
@@ -108,20 +108,20 @@ Report {
 								visible: root.isPrintStartNumbers
 								width: 8
 								halign: Frame.AlignRight
-								textFn: runnersDetail.dataFn("startNumber");
+								text: "{{startNumber}}"
 							}
 							Cell {
 								width: "%"
-								textFn: runnersDetail.dataFn("competitorName");
+								text: "{{competitorName}}"
 							}
 							Para {
 								width: 18
-								textFn: runnersDetail.dataFn("registration");
+								text: "{{registration}}"
 							}
 							Cell {
 								width: 18
 								halign: Frame.AlignRight
-								textFn: runnersDetail.dataFn("runs.siId");
+								text: "{{runs.siId}}"
 							}
 						}
 					}
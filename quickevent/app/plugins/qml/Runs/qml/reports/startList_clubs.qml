@@ -84,11 +84,11 @@ Report {
 						fill: Brush {color: Color {def: "khaki"} }
 						Cell {
 							width: "%"
-							textFn: detail.dataFn("clubAbbr");
+							text: "{{clubAbbr}}"
 							textStyle: myStyle.textStyleBold
 						}
 						Cell {
-							textFn: detail.dataFn("name");
+							text: "{{name}}"
 						}
 					}
 					//expandChildFrames: true
@@ -111,21 +111,21 @@ Report {
 							}
 							Para {
 								width: 12
-								textFn: runnersDetail.dataFn("classes.name");
+								text: "{{classes.name}}"
 							}
 							Para {
 								visible: root.isPrintStartNumbers
 								width: 8
 								halign: Frame.AlignRight
-								textFn: runnersDetail.dataFn("startNumber");
+								text: "{{startNumber}}"
 							}
 							Para {
 								width: "%"
-								textFn: runnersDetail.dataFn("competitorName");
+								text: "{{competitorName}}"
 							}
 							Para {
 								width: 18
-								textFn: runnersDetail.dataFn("registration");
+								text: "{{registration}}"
 							}
 							Para {
 								width: 4
@@ -137,7 +137,7 @@ Report {
 							Para {
 								width: 18
 								halign: Frame.AlignRight
-								textFn: runnersDetail.dataFn("runs.siId");
+								text: "{{runs.siId}}"
 							}
 						}
 					}
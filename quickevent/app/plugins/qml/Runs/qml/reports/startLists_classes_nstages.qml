@@ -89,7 +89,7 @@ Report {
 						fill: Brush {color: Color {def: "khaki"} }
 						Cell {
 							width: "%"
-							textFn: detail.dataFn("classes.name");
+							text: "{{classes.name}}"
 							textStyle: myStyle.textStyleBold
 						}
 						Cell {
@@ -129,16 +129,16 @@ Report {
 							function dataFn(field_name) {return function() {return rowData(field_name);}}
 							Cell {
 								width: "%"
-								textFn: runnersDetail.dataFn("competitorName");
+								text: "{{competitorName}}"
 							}
 							Cell {
 								width: hdrRegistration.width
-								textFn: runnersDetail.dataFn("registration");
+								text: "{{registration}}"
 							}
 							Cell {
 								width: hdrSI.width
 								halign: Frame.AlignRight
-								textFn: runnersDetail.dataFn("competitors.siId");
+								text: "{{competitors.siId}}"
 							}
 							Component.onCompleted: {
 								//console.warn("=============", root.stageCount)
@@ -88,12 +88,12 @@ Report {
 						layout: Frame.LayoutHorizontal
 						fill: Brush {color: Color {def: "khaki"} }
 						Cell {
-							textFn: detail.dataFn("clubAbbr");
+							text: "{{clubAbbr}}"
 							textStyle: myStyle.textStyleBold
 						}
 						Cell {
 							width: "%"
-							textFn: detail.dataFn("name");
+							text: "{{name}}"
 							textStyle: myStyle.textStyleBold
 						}
 						Component.onCompleted: {
@@ -120,20 +120,20 @@ Report {
 							function dataFn(field_name) {return function() {return rowData(field_name);}}
 							Cell {
 								width: 20
-								textFn: runnersDetail.dataFn("classes.name");
+								text: "{{classes.name}}"
 							}
 							Cell {
 								width: "%"
-								textFn: runnersDetail.dataFn("competitorName");
+								text: "{{competitorName}}"
 							}
 							Cell {
 								width: 25
-								textFn: runnersDetail.dataFn("registration");
+								text: "{{registration}}"
 							}
 							Cell {
 								width: 18
 								halign: Frame.AlignRight
-								textFn: runnersDetail.dataFn("competitors.siId");
+								text: "{{competitors.siId}}"
 							}
 							Component.onCompleted: {
 								//console.warn("=============", root.stageCount)
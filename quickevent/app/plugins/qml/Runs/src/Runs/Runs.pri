@@ -4,13 +4,23 @@ HEADERS += \
     $$PWD/runsplugin.h \
     $$PWD/findrunneredit.h \
     $$PWD/findrunnerwidget.h \
-    $$PWD/nstagesreportoptionsdialog.h
+    $$PWD/nstagesreportoptionsdialog.h \
+    $$PWD/standingsservice.h \
+    $$PWD/resultsbuilder.h \
+    $$PWD/resultssnapshot.h \
+    $$PWD/eventstatistics.h \
+    $$PWD/reportbenchmark.h
 
 SOURCES += \
     $$PWD/runsplugin.cpp \
     $$PWD/findrunneredit.cpp \
     $$PWD/findrunnerwidget.cpp \
-    $$PWD/nstagesreportoptionsdialog.cpp
+    $$PWD/nstagesreportoptionsdialog.cpp \
+    $$PWD/standingsservice.cpp \
+    $$PWD/resultsbuilder.cpp \
+    $$PWD/resultssnapshot.cpp \
+    $$PWD/eventstatistics.cpp \
+    $$PWD/reportbenchmark.cpp
 
 FORMS += \
     $$PWD/findrunnerwidget.ui \
@@ -0,0 +1,355 @@
+#include "eventstatistics.h"
+
+#include <qf/core/log.h>
+#include <qf/core/exception.h>
+#include <qf/core/sql/query.h>
+#include <qf/core/sql/querybuilder.h>
+
+#include <QStringList>
+#include <QTimer>
+
+namespace qfs = qf::core::sql;
+
+namespace Runs {
+
+namespace {
+
+/// changes made without db event are fixed by reconciliation
+const int RECONCILE_INTERVAL_MSEC = 5 * 60 * 1000;
+
+/// column indexes of EventStatistics::runsQuery(), in stage query they follow class columns
+enum RunsQueryColumn {
+	col_runs_id = 0,
+	col_runs_competitorId,
+	col_competitors_classId,
+	col_runs_isRunning,
+	col_runs_startTimeMs,
+	col_runs_finishTimeMs,
+	col_runs_timeMs,
+	col_runs_disqualified,
+};
+
+/// column indexes of stage query
+enum StageQueryColumn {
+	col_classes_id = 0,
+	col_classes_name,
+	col_classdefs_id,
+	col_classdefs_mapCount,
+	col_classdefs_resultsCount,
+	col_classdefs_resultsPrintTS,
+	col_run_columns,
+};
+
+QString int_list(const QList<int> &ids)
+{
+	QStringList sl;
+	for(int id : ids)
+		sl << QString::number(id);
+	return sl.join(',');
+}
+
+void add_count(QMap<int, int> &map, int key, int count)
+{
+	auto it = map.find(key);
+	if(it == map.end()) {
+		if(count > 0)
+			map.insert(key, count);
+		return;
+	}
+	it.value() += count;
+	if(it.value() <= 0)
+		map.erase(it);
+}
+
+}
+
+//=================================================
+//             EventStatistics::ClassCounters
+//=================================================
+int EventStatistics::ClassCounters::startFirstMs() const
+{
+	return m_startTimes.isEmpty()? 0: m_startTimes.firstKey();
+}
+
+int EventStatistics::ClassCounters::startLastMs() const
+{
+	return m_startTimes.isEmpty()? 0: m_startTimes.lastKey();
+}
+
+int EventStatistics::ClassCounters::resultTimeMs(int n) const
+{
+	int ret = 0;
+	for(auto it = m_resultTimes.constBegin(); it != m_resultTimes.constEnd() && n > 0; ++it) {
+		ret = it.key();
+		n -= it.value();
+	}
+	return ret;
+}
+
+bool EventStatistics::ClassCounters::operator==(const EventStatistics::ClassCounters &o) const
+{
+	return m_classId == o.m_classId
+			&& m_className == o.m_className
+			&& m_classdefsId == o.m_classdefsId
+			&& m_mapCount == o.m_mapCount
+			&& m_resultsCount == o.m_resultsCount
+			&& m_resultsPrintTS == o.m_resultsPrintTS
+			&& m_runnersCount == o.m_runnersCount
+			&& m_runnersFinished == o.m_runnersFinished
+			&& m_startTimes == o.m_startTimes
+			&& m_resultTimes == o.m_resultTimes;
+}
+
+//=================================================
+//             EventStatistics
+//=================================================
+EventStatistics::EventStatistics(QObject *parent)
+	: Super(parent)
+{
+	m_reconcileTimer = new QTimer(this);
+	m_reconcileTimer->setInterval(RECONCILE_INTERVAL_MSEC);
+	connect(m_reconcileTimer, &QTimer::timeout, this, &EventStatistics::reconcile);
+}
+
+QString EventStatistics::runsQuery(const QString &where_condition)
+{
+	qfs::QueryBuilder qb;
+	qb.select2("runs", "id, competitorId")
+			.select2("competitors", "classId")
+			.select2("runs", "isRunning, startTimeMs, finishTimeMs, timeMs, disqualified")
+			.from("runs")
+			.join("runs.competitorId", "competitors.id", "JOIN")
+			.where(where_condition);
+	return qb.toString();
+}
+
+EventStatistics::Run EventStatistics::runFromQuery(const qf::core::sql::Query &q, int col_offset)
+{
+	Run r;
+	r.competitorId = q.value(col_offset + col_runs_competitorId).toInt();
+	r.classId = q.value(col_offset + col_competitors_classId).toInt();
+	r.isRunning = q.value(col_offset + col_runs_isRunning).toBool();
+	QVariant start_time = q.value(col_offset + col_runs_startTimeMs);
+	r.hasStartTime = !start_time.isNull();
+	r.startTimeMs = start_time.toInt();
+	bool disqualified = q.value(col_offset + col_runs_disqualified).toBool();
+	r.finished = q.value(col_offset + col_runs_finishTimeMs).toInt() > 0 || disqualified;
+	int time_ms = q.value(col_offset + col_runs_timeMs).toInt();
+	if(time_ms > 0 && !disqualified)
+		r.resultTimeMs = time_ms;
+	return r;
+}
+
+void EventStatistics::applyRun(const EventStatistics::Run &run, int count)
+{
+	if(!run.isRunning)
+		return;
+	auto it = m_classes.find(run.classId);
+	if(it == m_classes.end())
+		return;
+	ClassCounters &cc = it.value();
+	cc.m_runnersCount += count;
+	if(run.finished)
+		cc.m_runnersFinished += count;
+	if(run.hasStartTime)
+		add_count(cc.m_startTimes, run.startTimeMs, count);
+	if(run.resultTimeMs > 0)
+		add_count(cc.m_resultTimes, run.resultTimeMs, count);
+}
+
+void EventStatistics::load(int stage_id)
+{
+	qfLogFuncFrame() << "stage:" << stage_id;
+	m_stageId = 0;
+	m_classIds.clear();
+	m_classes.clear();
+	m_runs.clear();
+	if(stage_id <= 0)
+		return;
+	qfs::QueryBuilder qb;
+	qb.select2("classes", "id, name")
+			.select2("classdefs", "id, mapCount, resultsCount, resultsPrintTS")
+			.select2("runs", "id, competitorId")
+			.select2("competitors", "classId")
+			.select2("runs", "isRunning, startTimeMs, finishTimeMs, timeMs, disqualified")
+			.from("classes")
+			.joinRestricted("classes.id", "classdefs.classId", "classdefs.stageId=" QF_IARG(stage_id))
+			.join("classes.id", "competitors.classId")
+			.joinRestricted("competitors.id", "runs.competitorId", "runs.stageId=" QF_IARG(stage_id))
+			.orderBy("classes.name, classes.id");
+	qfs::Query q;
+	q.exec(qb.toString(), qf::core::Exception::Throw);
+	while(q.next()) {
+		int class_id = q.value(col_classes_id).toInt();
+		if(!m_classes.contains(class_id)) {
+			ClassCounters &cc = m_classes[class_id];
+			cc.m_classId = class_id;
+			cc.m_className = q.value(col_classes_name).toString();
+			cc.m_classdefsId = q.value(col_classdefs_id).toInt();
+			cc.m_mapCount = q.value(col_classdefs_mapCount).toInt();
+			cc.m_resultsCount = q.value(col_classdefs_resultsCount).toInt();
+			cc.m_resultsPrintTS = q.value(col_classdefs_resultsPrintTS).toDateTime();
+			m_classIds << class_id;
+		}
+		int run_id = q.value(col_run_columns + col_runs_id).toInt();
+		if(run_id == 0)
+			continue;
+		Run r = runFromQuery(q, col_run_columns);
+		m_runs[run_id] = r;
+		applyRun(r, 1);
+	}
+	m_stageId = stage_id;
+	m_reconcileTimer->start();
+}
+
+void EventStatistics::loadStage(int stage_id)
+{
+	load(stage_id);
+	emit reloaded();
+}
+
+void EventStatistics::clear()
+{
+	qfLogFuncFrame();
+	m_reconcileTimer->stop();
+	m_stageId = 0;
+	m_classIds.clear();
+	m_classes.clear();
+	m_runs.clear();
+	emit reloaded();
+}
+
+void EventStatistics::reconcile()
+{
+	qfLogFuncFrame();
+	if(m_stageId == 0) {
+		m_reconcileTimer->stop();
+		return;
+	}
+	QList<int> old_class_ids = m_classIds;
+	QHash<int, ClassCounters> old_classes = m_classes;
+	try {
+		load(m_stageId);
+	}
+	catch (const qf::core::Exception &e) {
+		qfError() << "Event statistics reconciliation error:" << e.message();
+		clear();
+		return;
+	}
+	if(m_classIds != old_class_ids) {
+		emit reloaded();
+		return;
+	}
+	int fixed_cnt = 0;
+	for(int class_id : m_classIds) {
+		if(m_classes.value(class_id) != old_classes.value(class_id)) {
+			fixed_cnt++;
+			emit classChanged(class_id);
+		}
+	}
+	if(fixed_cnt > 0)
+		qfInfo() << "Event statistics reconciliation, classes changed without db event:" << fixed_cnt;
+}
+
+void EventStatistics::setResultsPrinted(int class_id, int results_count, const QDateTime &ts)
+{
+	auto it = m_classes.find(class_id);
+	if(it == m_classes.end())
+		return;
+	it.value().m_resultsCount = results_count;
+	it.value().m_resultsPrintTS = ts;
+	emit classChanged(class_id);
+}
+
+void EventStatistics::removeRun(int run_id, QSet<int> *changed_class_ids)
+{
+	auto it = m_runs.find(run_id);
+	if(it == m_runs.end())
+		return;
+	applyRun(it.value(), -1);
+	*changed_class_ids << it.value().classId;
+	m_runs.erase(it);
+}
+
+void EventStatistics::updateRuns(const QString &where_condition)
+{
+	qfLogFuncFrame() << where_condition;
+	if(m_stageId == 0)
+		return;
+	QSet<int> changed_class_ids;
+	bool unknown_class = false;
+	qfs::Query q;
+	q.exec(runsQuery("(" + where_condition + ") AND runs.stageId=" QF_IARG(m_stageId)), qf::core::Exception::Throw);
+	while(q.next()) {
+		int run_id = q.value(col_runs_id).toInt();
+		removeRun(run_id, &changed_class_ids);
+		Run r = runFromQuery(q, 0);
+		if(!m_classes.contains(r.classId)) {
+			unknown_class = true;
+			continue;
+		}
+		m_runs[run_id] = r;
+		applyRun(r, 1);
+		changed_class_ids << r.classId;
+	}
+	if(unknown_class) {
+		/// class created after stage was loaded
+		loadStage(m_stageId);
+		return;
+	}
+	for(int class_id : changed_class_ids)
+		emit classChanged(class_id);
+}
+
+void EventStatistics::updateRun(int run_id)
+{
+	updateRuns("runs.id=" QF_IARG(run_id));
+}
+
+void EventStatistics::onCardsRead(const QVariantList &card_ids)
+{
+	if(m_stageId == 0)
+		return;
+	QList<int> ids;
+	for(const QVariant &v : card_ids)
+		ids << v.toInt();
+	updateRuns("runs.id IN (SELECT runId FROM cards WHERE id IN (" + int_list(ids) + "))");
+}
+
+void EventStatistics::onCompetitorsChanged(const QVariantList &data_list)
+{
+	if(m_stageId == 0)
+		return;
+	QList<int> competitor_ids;
+	for(const QVariant &data : data_list) {
+		if(data.isNull()) {
+			/// unknown set of changed competitors
+			loadStage(m_stageId);
+			return;
+		}
+		if(data.type() == QVariant::List) {
+			for(const QVariant &v : data.toList())
+				competitor_ids << v.toInt();
+		}
+		else {
+			competitor_ids << data.toInt();
+		}
+	}
+	if(competitor_ids.isEmpty())
+		return;
+	/// deleted competitors and runs are not returned by query, remove them all first
+	QSet<int> id_set = competitor_ids.toSet();
+	QList<int> run_ids;
+	for(auto it = m_runs.constBegin(); it != m_runs.constEnd(); ++it) {
+		if(id_set.contains(it.value().competitorId))
+			run_ids << it.key();
+	}
+	QSet<int> changed_class_ids;
+	for(int run_id : run_ids)
+		removeRun(run_id, &changed_class_ids);
+	for(int class_id : changed_class_ids)
+		emit classChanged(class_id);
+	updateRuns("runs.competitorId IN (" + int_list(competitor_ids) + ")");
+}
+
+}
@@ -0,0 +1,125 @@
+#ifndef RUNS_EVENTSTATISTICS_H
+#define RUNS_EVENTSTATISTICS_H
+
+#include "../runspluginglobal.h"
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QVariantList>
+
+class QTimer;
+
+namespace qf { namespace core { namespace sql { class Query; }}}
+
+namespace Runs {
+
+/// Per class counters of one stage shown in event statistics.
+/// Stage is loaded by one query, then counters are updated per run from db events
+/// and from runs table edits. Periodic reconciliation reloads the stage to catch changes
+/// made without db event, like start times draw.
+class RUNSPLUGIN_DECL_EXPORT EventStatistics : public QObject
+{
+	Q_OBJECT
+private:
+	typedef QObject Super;
+public:
+	class RUNSPLUGIN_DECL_EXPORT ClassCounters
+	{
+		friend class EventStatistics;
+	public:
+		int classId() const {return m_classId;}
+		const QString& className() const {return m_className;}
+		/// 0 if class has no classdefs for stage
+		int classdefsId() const {return m_classdefsId;}
+		int mapCount() const {return m_mapCount;}
+		/// runners finished when results were printed last time
+		int resultsCount() const {return m_resultsCount;}
+		const QDateTime& resultsPrintTS() const {return m_resultsPrintTS;}
+
+		int runnersCount() const {return m_runnersCount;}
+		/// runners with finish time or disqualified
+		int runnersFinished() const {return m_runnersFinished;}
+		bool hasStartTimes() const {return !m_startTimes.isEmpty();}
+		int startFirstMs() const;
+		int startLastMs() const;
+		bool hasResultTimes() const {return !m_resultTimes.isEmpty();}
+		/// time of n-th runner in results, time of last one if there are less than n runners in results
+		int resultTimeMs(int n) const;
+
+		bool operator==(const ClassCounters &o) const;
+		bool operator!=(const ClassCounters &o) const {return !(*this == o);}
+	private:
+		int m_classId = 0;
+		QString m_className;
+		int m_classdefsId = 0;
+		int m_mapCount = 0;
+		int m_resultsCount = 0;
+		QDateTime m_resultsPrintTS;
+		int m_runnersCount = 0;
+		int m_runnersFinished = 0;
+		QMap<int, int> m_startTimes; //< start time -> runners count
+		QMap<int, int> m_resultTimes; //< time -> runners count, not disqualified runs with time only
+	};
+public:
+	EventStatistics(QObject *parent = nullptr);
+
+	/// 0 if no stage is loaded
+	int stageId() const {return m_stageId;}
+	/// load counters of all classes of stage by one query
+	void loadStage(int stage_id);
+	/// class ids in class name order
+	const QList<int>& classIds() const {return m_classIds;}
+	ClassCounters classCounters(int class_id) const {return m_classes.value(class_id);}
+	/// store results printout made by user
+	void setResultsPrinted(int class_id, int results_count, const QDateTime &ts);
+
+	/// reload single run from SQL, does nothing if stage is not loaded
+	void updateRun(int run_id);
+	Q_SLOT void clear();
+
+	/// update runs of read cards, card ids are merged DBEVENT_CARD_READ payloads
+	void onCardsRead(const QVariantList &card_ids);
+	/// data are merged DBEVENT_COMPETITOR_COUNTS_CHANGED payloads, null payload reloads the stage
+	void onCompetitorsChanged(const QVariantList &data_list);
+
+	/// counters of class changed
+	Q_SIGNAL void classChanged(int class_id);
+	/// stage loaded or cleared, all counters changed
+	Q_SIGNAL void reloaded();
+private:
+	struct Run
+	{
+		int classId = 0;
+		int competitorId = 0;
+		bool isRunning = false;
+		bool finished = false;
+		bool hasStartTime = false;
+		int startTimeMs = 0;
+		int resultTimeMs = 0; //< 0 if run is not in results
+	};
+	static QString runsQuery(const QString &where_condition);
+	static Run runFromQuery(const qf::core::sql::Query &q, int col_offset);
+	/// fill counters without notification
+	void load(int stage_id);
+	/// add (count = 1) or remove (count = -1) run from class counters
+	void applyRun(const Run &run, int count);
+	/// reload runs matching SQL condition, runs removed from stage must be removed by caller
+	void updateRuns(const QString &where_condition);
+	void removeRun(int run_id, QSet<int> *changed_class_ids);
+	Q_SLOT void reconcile();
+private:
+	int m_stageId = 0;
+	QList<int> m_classIds;
+	QHash<int, ClassCounters> m_classes;
+	QHash<int, Run> m_runs;
+	QTimer *m_reconcileTimer;
+};
+
+}
+
+#endif // RUNS_EVENTSTATISTICS_H
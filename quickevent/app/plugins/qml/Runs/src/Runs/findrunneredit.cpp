@@ -5,6 +5,7 @@
 #include <qf/qmlwidgets/framework/mainwindow.h>
 
 #include <qf/core/utils/table.h>
+#include <qf/core/utils/searchindex.h>
 #include <qf/core/model/sqltablemodel.h>
 #include <qf/core/log.h>
 #include <qf/core/assert.h>
@@ -22,10 +23,13 @@ static Competitors::CompetitorsPlugin* competitorsPlugin()
 }
 */
 
+/// Contains only runners matching the current filter text, completer shows them unfiltered.
 class FindRunnersModel : public QAbstractTableModel
 {
 private:
 	typedef QAbstractTableModel Super;
+public:
+	static constexpr int MaxMatchCount = 50;
 public:
 	FindRunnersModel(QObject *parent);
 
@@ -33,9 +37,14 @@ public:
 	int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
 	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
 	const qf::core::utils::Table& runnersTable() const {return m_runnersTable;}
-	void setRunnersTable(const qf::core::utils::Table &t);
+	void setRunnersTable(const qf::core::utils::Table &t, const qf::core::utils::SearchIndex &search_index);
+	void setFilterText(const QString &text);
+	/// @return runnersTable() row number of model row
+	int tableRow(int row) const {return m_matches.value(row, -1);}
 private:
 	qf::core::utils::Table m_runnersTable;
+	qf::core::utils::SearchIndex m_searchIndex;
+	QVector<int> m_matches;
 };
 
 FindRunnersModel::FindRunnersModel(QObject *parent)
@@ -43,44 +52,46 @@ FindRunnersModel::FindRunnersModel(QObject *parent)
 {
 }
 
-void FindRunnersModel::setRunnersTable(const qf::core::utils::Table &t)
+void FindRunnersModel::setRunnersTable(const qf::core::utils::Table &t, const qf::core::utils::SearchIndex &search_index)
 {
+	beginResetModel();
 	m_runnersTable = t;
+	m_searchIndex = search_index;
+	m_matches.clear();
+	endResetModel();
+}
+
+void FindRunnersModel::setFilterText(const QString &text)
+{
+	beginResetModel();
+	m_matches = m_searchIndex.search(text, MaxMatchCount);
+	endResetModel();
 }
 
 int FindRunnersModel::rowCount(const QModelIndex &parent) const
 {
 	Q_UNUSED(parent)
-	const qf::core::utils::Table &table = runnersTable();
-	return table.rowCount();
+	return m_matches.count();
 }
 
 QVariant FindRunnersModel::data(const QModelIndex &index, int role) const
 {
 	const qf::core::utils::Table &table = runnersTable();
-	int row_no = index.row();
+	int row_no = tableRow(index.row());
 	if(row_no >= 0 && row_no < table.rowCount()) {
 		qf::core::utils::TableRow table_row = table.row(row_no);
 		const qf::core::utils::Table::FieldList &fields = table.fields();
 		static auto col_class_name = fields.fieldIndex(QStringLiteral("classes.name"));
 		static auto col_name = fields.fieldIndex(QStringLiteral("competitorName"));
-		static auto col_searchkey = fields.fieldIndex(QStringLiteral("competitorNameAscii7"));
 		static int col_registration = fields.fieldIndex(QStringLiteral("registration"));
 		static auto col_siid = fields.fieldIndex(QStringLiteral("siid"));
 		static auto SI = QStringLiteral("SI:");
-		if(role == Qt::DisplayRole) {
+		if(role == Qt::DisplayRole || role == Qt::EditRole) {
 			return table_row.value(col_class_name).toString() + ' '
 					+ table_row.value(col_name).toString() + ' '
 					+ table_row.value(col_registration).toString() + ' '
 					+ SI + table_row.value(col_siid).toString();
 		}
-		else if(role == Qt::EditRole) {
-			return table_row.value(col_class_name).toString() + ' '
-					+ table_row.value(col_searchkey).toString() + ' '
-					+ table_row.value(col_registration).toString() + ' '
-					+ SI + table_row.value(col_siid).toString() + ' '
-					+ table_row.value(col_name).toString();
-		}
 	}
 	return QVariant();
 }
@@ -90,20 +101,28 @@ FindRunnerEdit::FindRunnerEdit(QWidget *parent)
 {	
 }
 
-void FindRunnerEdit::setTable(const qf::core::utils::Table &t)
+void FindRunnerEdit::setTable(const qf::core::utils::Table &t, const qf::core::utils::SearchIndex &search_index)
 {
 	//QF_SAFE_DELETE(m_findRunnersModel);
 	QF_SAFE_DELETE(m_completer);
 	m_completer = new QCompleter(this);
 	m_completer->setCaseSensitivity(Qt::CaseInsensitive);
-	m_completer->setFilterMode(Qt::MatchContains);
+	/// model is filtered by search index, completer just shows it
+	m_completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
 	m_findRunnersModel = new FindRunnersModel(m_completer);
-	m_findRunnersModel->setRunnersTable(t);
+	m_findRunnersModel->setRunnersTable(t, search_index);
 	m_completer->setModel(m_findRunnersModel);
 	connect(m_completer, SIGNAL(activated(QModelIndex)), this, SLOT(onCompleterActivated(QModelIndex)));
+	connect(this, &FindRunnerEdit::textEdited, this, &FindRunnerEdit::onTextEdited, Qt::UniqueConnection);
 	setCompleter(m_completer);
 }
 
+void FindRunnerEdit::onTextEdited(const QString &text)
+{
+	if(m_findRunnersModel)
+		m_findRunnersModel->setFilterText(text);
+}
+
 void FindRunnerEdit::onCompleterActivated(const QModelIndex &index)
 {
 	qfLogFuncFrame() << index << index.data();
@@ -111,7 +130,7 @@ void FindRunnerEdit::onCompleterActivated(const QModelIndex &index)
 	QF_ASSERT(proxy_model != nullptr, "Bat proxy model!", return);
 	QModelIndex ix = proxy_model->mapToSource(index);
 	const qf::core::utils::Table &table = m_findRunnersModel->runnersTable();
-	int row_no = ix.row();
+	int row_no = m_findRunnersModel->tableRow(ix.row());
 	if(row_no >= 0 && row_no < table.rowCount()) {
 		qf::core::utils::TableRow table_row = table.row(row_no);
 		emit runnerSelected(table_row.valuesMap(false));
@@ -6,7 +6,7 @@
 class QCompleter;
 class FindRunnersModel;
 
-namespace qf { namespace core { namespace utils { class Table; }}}
+namespace qf { namespace core { namespace utils { class Table; class SearchIndex; }}}
 
 class FindRunnerEdit : public QLineEdit
 {
@@ -17,11 +17,12 @@ public:
 	FindRunnerEdit(QWidget *parent = nullptr);
 
 	//const qf::core::utils::Table& table() const {return m_table;}
-	void setTable(const qf::core::utils::Table &t);
+	void setTable(const qf::core::utils::Table &t, const qf::core::utils::SearchIndex &search_index);
 
 	Q_SIGNAL void runnerSelected(const QVariantMap &runner_values);
 private:
 	Q_SLOT void onCompleterActivated(const QModelIndex &index);
+	Q_SLOT void onTextEdited(const QString &text);
 private:
 	FindRunnersModel *m_findRunnersModel = nullptr;
 	QCompleter *m_completer = nullptr;
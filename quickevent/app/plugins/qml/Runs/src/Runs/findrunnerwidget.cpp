@@ -15,10 +15,7 @@ namespace Runs {
 
 static RunsPlugin *runsPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Runs::RunsPlugin *>(fwk->plugin("Runs"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad plugin");
-	return plugin;
+	return qf::qmlwidgets::framework::MainWindow::cachedPlugin<Runs::RunsPlugin>();
 }
 
 FindRunnerWidget::FindRunnerWidget(int stage_id, QWidget *parent)
@@ -28,7 +25,7 @@ FindRunnerWidget::FindRunnerWidget(int stage_id, QWidget *parent)
 {
 	ui->setupUi(this);
 	ui->edFindRunner->setFocus();
-	ui->edFindRunner->setTable(runsPlugin()->runnersTable(stage_id));
+	ui->edFindRunner->setTable(runsPlugin()->runnersTable(stage_id), runsPlugin()->runnersSearchIndex(stage_id));
 	connect(ui->edFindRunner, &FindRunnerEdit::runnerSelected, this, &FindRunnerWidget::runnerSelected);
 }
 
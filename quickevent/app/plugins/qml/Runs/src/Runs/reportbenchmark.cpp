@@ -0,0 +1,260 @@
+#include "reportbenchmark.h"
+
+#include <quickevent/reportoptionsdialog.h>
+
+#include <qf/qmlwidgets/framework/mainwindow.h>
+#include <qf/qmlwidgets/reports/processor/reportprocessor.h>
+
+#include <qf/core/log.h>
+#include <qf/core/utils/svalue.h>
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace qfu = qf::core::utils;
+
+namespace Runs {
+
+namespace {
+void set_rows(qfu::TreeTable &tt, const QList<QVariantList> &rows)
+{
+	/// rows must be stored as SValues, otherwise appendTable() on row would modify its copy
+	qfu::SValue srows;
+	for (int i = 0; i < rows.count(); ++i)
+		srows[i] = rows[i];
+	tt[qfu::TreeTable::KEY_ROWS] = srows.value();
+}
+
+#ifdef Q_OS_LINUX
+qint64 proc_status_kb(const QByteArray &key)
+{
+	QFile f(QStringLiteral("/proc/self/status"));
+	if(!f.open(QFile::ReadOnly))
+		return -1;
+	for(const QByteArray &line : f.readAll().split('\n')) {
+		if(line.startsWith(key))
+			return line.mid(key.length()).trimmed().split(' ').value(0).toLongLong();
+	}
+	return -1;
+}
+#endif
+}
+
+QString ReportBenchmark::resultsReport(const QString &report_dir, int row_count)
+{
+	const int runners_in_class = 50;
+	qfu::TreeTable tt = stageResultsTable(row_count, runners_in_class);
+	quickevent::ReportOptionsDialog::Options opts;
+	opts.setColumns(opts.columns());
+	opts.setHorizontalMargin(opts.horizontalMargin());
+	opts.setVerticalMargin(opts.verticalMargin());
+	QVariantMap props;
+	props[QStringLiteral("options")] = opts;
+
+	resetPeakMemory();
+	qint64 mem_before_kb = currentMemoryKb();
+	QElapsedTimer elapsed;
+	elapsed.start();
+	int page_count = 0;
+	qint64 compile_msec = 0;
+	{
+		qf::qmlwidgets::reports::ReportProcessor rp(qf::qmlwidgets::framework::MainWindow::frameWork());
+		if(!rp.setReport(report_dir + QStringLiteral("/results_stage.qml"), props))
+			return QStringLiteral("Cannot load report results_stage.qml");
+		rp.setTableData(QString(), tt);
+		compile_msec = elapsed.elapsed();
+		rp.process(qf::qmlwidgets::reports::ReportProcessor::AllPages);
+		page_count = rp.pageCount();
+	}
+	qint64 msec = elapsed.elapsed();
+	qint64 peak_kb = peakMemoryKb();
+
+	QStringList report;
+	report << QStringLiteral("Results report, %1 runners in %2 classes, %3 pages")
+			  .arg(row_count).arg((row_count + runners_in_class - 1) / runners_in_class).arg(page_count);
+	report << QStringLiteral("Processing time: %1 msec (report compilation %2 msec), %3 usec per row")
+			  .arg(msec).arg(compile_msec).arg(row_count? (msec - compile_msec) * 1000 / row_count: 0);
+	if(peak_kb < 0)
+		report << QStringLiteral("Peak memory is not available on this platform.");
+	else
+		report << QStringLiteral("Memory before: %1 kB, peak: %2 kB, peak increase: %3 kB")
+				  .arg(mem_before_kb).arg(peak_kb).arg(peak_kb - mem_before_kb);
+	return report.join('\n');
+}
+
+QString ReportBenchmark::splitTimesReport(const QString &report_dir, int row_count)
+{
+	const int split_count = 20;
+	qfu::TreeTable tt = splitTimesTable(row_count, split_count);
+	/// name cell and split cells
+	const qint64 cell_count = qint64(row_count) * (split_count + 1);
+	QStringList report;
+	report << QStringLiteral("Split times report, %1 rows, %2 cells").arg(row_count).arg(cell_count);
+	qint64 bound_usec = -1;
+	for(const QString &fn : {QStringLiteral("splitTimes.qml"), QStringLiteral("splitTimesJs.qml")}) {
+		int page_count = 0;
+		qint64 msec = processReport(report_dir + QStringLiteral("/benchmark/") + fn, tt, &page_count);
+		if(msec < 0) {
+			report << QStringLiteral("Cannot load report %1").arg(fn);
+			continue;
+		}
+		qint64 usec = msec * 1000;
+		report << QStringLiteral("%1: %2 msec, %3 pages, %4 nsec per cell")
+				  .arg(fn).arg(msec).arg(page_count).arg(cell_count? usec * 1000 / cell_count: 0);
+		if(bound_usec < 0)
+			bound_usec = usec;
+		else if(bound_usec > 0)
+			report << QStringLiteral("textFn cells are %1 times slower than bound cells").arg(double(usec) / bound_usec, 0, 'f', 2);
+	}
+	return report.join('\n');
+}
+
+qint64 ReportBenchmark::processReport(const QString &file_name, const qfu::TreeTable &data, int *page_count)
+{
+	qf::qmlwidgets::reports::ReportProcessor rp(qf::qmlwidgets::framework::MainWindow::frameWork());
+	if(!rp.setReport(file_name))
+		return -1;
+	rp.setTableData(QString(), data);
+	QElapsedTimer elapsed;
+	elapsed.start();
+	rp.process(qf::qmlwidgets::reports::ReportProcessor::AllPages);
+	qint64 msec = elapsed.elapsed();
+	if(page_count)
+		*page_count = rp.pageCount();
+	return msec;
+}
+
+qfu::TreeTable ReportBenchmark::splitTimesTable(int row_count, int split_count)
+{
+	qfu::TreeTable ret;
+	ret.appendColumn("competitorName", QVariant::String);
+	for (int i = 1; i <= split_count; ++i)
+		ret.appendColumn(QStringLiteral("split%1").arg(i), QVariant::String);
+	QList<QVariantList> rows;
+	for (int i = 0; i < row_count; ++i) {
+		QVariantList row;
+		row.reserve(split_count + 1);
+		row << QStringLiteral("Lastname%1 Firstname%2").arg(i).arg(i % 50);
+		int stp_sec = 0;
+		for (int j = 0; j < split_count; ++j) {
+			stp_sec += 120 + (i * 7 + j * 13) % 240;
+			row << QStringLiteral("%1:%2").arg(stp_sec / 60).arg(stp_sec % 60, 2, 10, QChar('0'));
+		}
+		rows << row;
+	}
+	set_rows(ret, rows);
+	return ret;
+}
+
+qfu::TreeTable ReportBenchmark::stageResultsTable(int row_count, int runners_in_class)
+{
+	qfu::TreeTable ret;
+	ret.appendColumn("classes.id", QVariant::Int);
+	ret.appendColumn("classes.name", QVariant::String);
+	ret.appendColumn("courses.length", QVariant::Int);
+	ret.appendColumn("courses.climb", QVariant::Int);
+	const int class_count = (row_count + runners_in_class - 1) / runners_in_class;
+	QList<QVariantList> class_rows;
+	for (int i = 0; i < class_count; ++i)
+		class_rows << QVariantList{i + 1, QStringLiteral("H%1").arg(i + 10), 5000 + 100 * i, 100 + i};
+	set_rows(ret, class_rows);
+	int run_id = 0;
+	for (int i = 0; i < class_count; ++i) {
+		/// the same columns as ResultsBuilder::classResultsTable() emits
+		qfu::TreeTable runners;
+		runners.appendColumn("competitors.registration", QVariant::String);
+		runners.appendColumn("competitors.lastName", QVariant::String);
+		runners.appendColumn("competitors.firstName", QVariant::String);
+		runners.appendColumn("competitorName", QVariant::String);
+		runners.appendColumn("runs.id", QVariant::Int);
+		runners.appendColumn("runs.competitorId", QVariant::Int);
+		runners.appendColumn("runs.stageId", QVariant::Int);
+		runners.appendColumn("runs.siId", QVariant::Int);
+		runners.appendColumn("runs.startTimeMs", QVariant::Int);
+		runners.appendColumn("runs.finishTimeMs", QVariant::Int);
+		runners.appendColumn("runs.timeMs", QVariant::Int);
+		runners.appendColumn("runs.notCompeting", QVariant::Bool);
+		runners.appendColumn("runs.disqualified", QVariant::Bool);
+		runners.appendColumn("runs.misPunch", QVariant::Bool);
+		runners.appendColumn("runs.badCheck", QVariant::Bool);
+		runners.appendColumn("clubs.name", QVariant::String);
+		runners.appendColumn("pos", QVariant::String);
+		runners.appendColumn("npos", QVariant::Int);
+		QList<QVariantList> rows;
+		const int n = qMin(runners_in_class, row_count - i * runners_in_class);
+		for (int j = 0; j < n; ++j) {
+			++run_id;
+			const int start_ms = j * 60 * 1000;
+			const int time_ms = (30 * 60 + j * 17) * 1000;
+			const bool disq = (j % 20) == 19;
+			const QString last_name = QStringLiteral("Lastname%1").arg(run_id);
+			const QString first_name = QStringLiteral("Firstname%1").arg(j);
+			rows << QVariantList{QStringLiteral("ABC%1").arg(run_id % 10000, 4, 10, QChar('0'))
+								 , last_name, first_name, last_name + ' ' + first_name
+								 , run_id, run_id, 1, 100000 + run_id
+								 , start_ms, start_ms + time_ms, time_ms
+								 , false, disq, disq, false
+								 , QStringLiteral("Club %1").arg(run_id % 97)
+								 , disq? QString(): QStringLiteral("%1.").arg(j + 1)
+								 , disq? 0: j + 1};
+		}
+		set_rows(runners, rows);
+		ret.row(i).appendTable(runners);
+	}
+	QVariantMap event;
+	event[QStringLiteral("name")] = QStringLiteral("Report benchmark");
+	event[QStringLiteral("place")] = QStringLiteral("Benchmark");
+	event[QStringLiteral("stageCount")] = 1;
+	event[QStringLiteral("date")] = QDate::currentDate();
+	ret.setValue("stageId", 1);
+	ret.setValue("event", event);
+	ret.setValue("stageStart", QDateTime::currentDateTime());
+	return ret;
+}
+
+void ReportBenchmark::resetPeakMemory()
+{
+#ifdef Q_OS_LINUX
+	/// writing 5 to clear_refs resets VmHWM to current RSS
+	QFile f(QStringLiteral("/proc/self/clear_refs"));
+	if(f.open(QFile::WriteOnly))
+		f.write("5");
+#endif
+}
+
+qint64 ReportBenchmark::peakMemoryKb()
+{
+#if defined Q_OS_LINUX
+	return proc_status_kb("VmHWM:");
+#elif defined Q_OS_WIN
+	PROCESS_MEMORY_COUNTERS pmc;
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return pmc.PeakWorkingSetSize / 1024;
+	return -1;
+#else
+	return -1;
+#endif
+}
+
+qint64 ReportBenchmark::currentMemoryKb()
+{
+#if defined Q_OS_LINUX
+	return proc_status_kb("VmRSS:");
+#elif defined Q_OS_WIN
+	PROCESS_MEMORY_COUNTERS pmc;
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return pmc.WorkingSetSize / 1024;
+	return -1;
+#else
+	return -1;
+#endif
+}
+
+}
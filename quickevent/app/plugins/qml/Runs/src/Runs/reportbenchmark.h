@@ -0,0 +1,37 @@
+#ifndef RUNS_REPORTBENCHMARK_H
+#define RUNS_REPORTBENCHMARK_H
+
+#include <qf/core/utils/treetable.h>
+
+#include <QString>
+
+namespace Runs {
+
+/// Report processing benchmarks on generated data, SQL is not touched.
+/// Reports are processed off screen, the same way as report view widget does before first page is shown.
+/// Peak memory is process wide, it is reset before processing where platform allows it (Linux).
+class ReportBenchmark
+{
+public:
+	/// process results_stage.qml from report_dir with row_count runners in classes of 50
+	/// @return report of processing time, page count and memory
+	static QString resultsReport(const QString &report_dir, int row_count);
+	/// process benchmark/splitTimes.qml, where cells are bound by {{field}} placeholders,
+	/// and benchmark/splitTimesJs.qml, where the same cells are read by textFn
+	/// @return report of per cell cost of both variants
+	static QString splitTimesReport(const QString &report_dir, int row_count);
+private:
+	static qf::core::utils::TreeTable stageResultsTable(int row_count, int runners_in_class);
+	static qf::core::utils::TreeTable splitTimesTable(int row_count, int split_count);
+	/// @return processing time without report compilation in msec, -1 if report cannot be loaded
+	static qint64 processReport(const QString &file_name, const qf::core::utils::TreeTable &data, int *page_count);
+	static void resetPeakMemory();
+	/// kB, -1 if not known on this platform
+	static qint64 peakMemoryKb();
+	/// kB, -1 if not known on this platform
+	static qint64 currentMemoryKb();
+};
+
+}
+
+#endif // RUNS_REPORTBENCHMARK_H
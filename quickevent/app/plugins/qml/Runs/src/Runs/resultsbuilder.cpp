@@ -0,0 +1,366 @@
+#include "resultsbuilder.h"
+#include "resultssnapshot.h"
+
+#include <Event/competitortotals.h>
+
+#include <quickevent/og/timems.h>
+
+#include <qf/core/log.h>
+#include <qf/core/assert.h>
+#include <qf/core/utils.h>
+#include <qf/core/exception.h>
+#include <qf/core/sql/query.h>
+#include <qf/core/sql/querybuilder.h>
+
+#include <QHash>
+#include <QSqlField>
+#include <QSqlRecord>
+#include <QVector>
+
+namespace qfs = qf::core::sql;
+namespace qfu = qf::core::utils;
+
+namespace Runs {
+
+namespace {
+
+const int UNREAL_TIME_MSEC = quickevent::og::TimeMs::UNREAL_TIME_MSEC;
+
+int field_index(const QSqlRecord &rec, const QString &field_name)
+{
+	for (int i = 0; i < rec.count(); ++i) {
+		if(qf::core::Utils::fieldNameEndsWith(rec.fieldName(i), field_name))
+			return i;
+	}
+	QF_EXCEPTION("Field " + field_name + " not found in results query.");
+	return -1;
+}
+
+/// runs.* is expanded using builder's connection, it must be the one which executes query
+QString query_string(const qfs::QueryBuilder &qb, const qfs::Connection &conn)
+{
+	qfs::QueryBuilder::BuildOptions opts;
+	opts.setConnectionName(conn.connectionName());
+	return qb.toString(opts);
+}
+
+QString int_list(const QList<int> &ids)
+{
+	QStringList sl;
+	for(int id : ids)
+		sl << QString::number(id);
+	return sl.join(',');
+}
+
+/// same columns and values as SqlTableModel::toTreeTable() would export
+class TreeTableWriter
+{
+public:
+	TreeTableWriter(const qfs::Connection &conn, const QSqlRecord &rec, const QVector<int> &field_indexes)
+		: m_record(rec)
+		, m_fieldIndexes(field_indexes)
+		, m_retypeNullValues(conn.driverName().endsWith(QLatin1String("SQLITE"), Qt::CaseInsensitive))
+	{
+	}
+
+	qfu::TreeTable createTable() const
+	{
+		qfu::TreeTable ret;
+		for(int ix : m_fieldIndexes)
+			ret.appendColumn(m_record.fieldName(ix), m_record.field(ix).type());
+		return ret;
+	}
+	QVariantList rowValues(const qfs::Query &q) const
+	{
+		QVariantList ret;
+		ret.reserve(m_fieldIndexes.count() + 2);
+		for(int ix : m_fieldIndexes) {
+			QVariant v = q.value(ix);
+			/// SQLite driver reports NULL values as QString()
+			if(m_retypeNullValues && v.isNull())
+				v = QVariant(m_record.field(ix).type());
+			ret << v;
+		}
+		return ret;
+	}
+private:
+	QSqlRecord m_record;
+	QVector<int> m_fieldIndexes;
+	bool m_retypeNullValues;
+};
+
+void set_rows(qfu::TreeTable &tt, const QList<QVariantList> &rows)
+{
+	/// rows must be stored as SValues like TableModel::toTreeTable() does, otherwise appendTable() on row would modify its copy
+	qfu::SValue srows;
+	for (int i = 0; i < rows.count(); ++i)
+		srows[i] = rows[i];
+	tt[qfu::TreeTable::KEY_ROWS] = srows.value();
+}
+
+QVector<int> all_field_indexes(const QSqlRecord &rec)
+{
+	QVector<int> ret;
+	for (int i = 0; i < rec.count(); ++i)
+		ret << i;
+	return ret;
+}
+
+struct NStagesEntry
+{
+	int competitorId = 0;
+	QVariant registration;
+	QString competitorName;
+	QVector<int> stageTimes;
+	QVector<QString> stagePositions;
+	int timeMs = UNREAL_TIME_MSEC;
+};
+
+}
+
+ResultsBuilder::ResultsBuilder(const qf::core::sql::Connection &conn)
+	: m_connection(conn)
+{
+}
+
+qfu::TreeTable ResultsBuilder::stageClasses(int stage_id, const QString &class_filter, QList<int> *class_ids)
+{
+	qfLogFuncFrame() << "stage:" << stage_id << "class filter:" << class_filter;
+	qfs::QueryBuilder qb;
+	qb.select2("classes", "id, name")
+		.select2("courses", "length, climb")
+		.from("classes")
+		.joinRestricted("classes.id", "classdefs.classId", "classdefs.stageId=" QF_IARG(stage_id))
+		.join("classdefs.courseId", "courses.id")
+		.orderBy("classes.name");
+	if(!class_filter.isEmpty()) {
+		qb.where(class_filter);
+	}
+	qfs::Query q(m_connection);
+	q.exec(query_string(qb, m_connection), qf::core::Exception::Throw);
+	QSqlRecord rec = q.record();
+	TreeTableWriter writer(m_connection, rec, all_field_indexes(rec));
+	qfu::TreeTable ret = writer.createTable();
+	int class_id_ix = field_index(rec, QStringLiteral("classes.id"));
+	QList<QVariantList> class_rows;
+	while(q.next()) {
+		if(class_ids)
+			*class_ids << q.value(class_id_ix).toInt();
+		class_rows << writer.rowValues(q);
+	}
+	set_rows(ret, class_rows);
+	return ret;
+}
+
+qfu::TreeTable ResultsBuilder::classResultsTable(const ClassResultsSnapshot &results, int max_competitors_in_class, bool exclude_disq)
+{
+	qfu::TreeTable ret;
+	ret.appendColumn("competitors.registration", QVariant::String);
+	ret.appendColumn("competitors.lastName", QVariant::String);
+	ret.appendColumn("competitors.firstName", QVariant::String);
+	ret.appendColumn("competitorName", QVariant::String);
+	ret.appendColumn("runs.id", QVariant::Int);
+	ret.appendColumn("runs.competitorId", QVariant::Int);
+	ret.appendColumn("runs.stageId", QVariant::Int);
+	ret.appendColumn("runs.siId", QVariant::Int);
+	ret.appendColumn("runs.startTimeMs", QVariant::Int);
+	ret.appendColumn("runs.finishTimeMs", QVariant::Int);
+	ret.appendColumn("runs.timeMs", QVariant::Int);
+	ret.appendColumn("runs.notCompeting", QVariant::Bool);
+	ret.appendColumn("runs.disqualified", QVariant::Bool);
+	ret.appendColumn("runs.misPunch", QVariant::Bool);
+	ret.appendColumn("runs.badCheck", QVariant::Bool);
+	ret.appendColumn("clubs.name", QVariant::String);
+	ret.appendColumn("pos", QVariant::String);
+	ret.appendColumn("npos", QVariant::Int);
+	QList<QVariantList> rows;
+	for (int i = 0; i < results.rowCount(); ++i) {
+		if(max_competitors_in_class > 0 && rows.count() >= max_competitors_in_class)
+			break;
+		if(exclude_disq && results.isDisqualified(i))
+			continue;
+		int pos = results.position(i);
+		QVariantList row;
+		row.reserve(18);
+		row << results.registration(i)
+			<< results.lastName(i)
+			<< results.firstName(i)
+			<< results.competitorName(i)
+			<< results.runId(i)
+			<< results.competitorId(i)
+			<< results.stageId()
+			<< results.siId(i)
+			<< results.startTimeMs(i)
+			<< results.finishTimeMs(i)
+			<< results.timeMs(i)
+			<< results.isNotCompeting(i)
+			<< results.isDisqualified(i)
+			<< results.isMisPunch(i)
+			<< results.isBadCheck(i)
+			<< results.club(i)
+			<< QVariant(pos > 0? QString::number(pos) + '.': QString())
+			<< pos;
+		rows << row;
+	}
+	set_rows(ret, rows);
+	return ret;
+}
+
+QMap<int, qfu::Table> ResultsBuilder::nstagesResults(int stages_count, const QList<int> &class_ids, int places, bool exclude_disq)
+{
+	qfLogFuncFrame() << "stages:" << stages_count << "classes:" << class_ids;
+	QMap<int, qfu::Table> ret;
+	if(class_ids.isEmpty())
+		return ret;
+	QHash<int, QVector<NStagesEntry>> class_entries;
+	/// competitor id -> index in class entries
+	QHash<int, int> competitor_entry_index;
+	{
+		/// competitors come in results order from stored totals,
+		/// competitor without totals row is listed as not finished, it is better than to drop him from results
+		qfs::QueryBuilder qb;
+		qb.select2("competitors", "id, registration, classId")
+				.select("COALESCE(competitors.lastName, '') || ' ' || COALESCE(competitors.firstName, '') AS competitorName")
+				.select2("competitorTotals", "timeMs, status")
+				.from("competitors")
+				.joinRestricted("competitors.id", "competitorTotals.competitorId", "competitorTotals.stageCount=" QF_IARG(stages_count))
+				.where("competitors.classId IN (" + int_list(class_ids) + ")")
+				.orderBy("competitors.classId"
+						 ", COALESCE(competitorTotals.status, " QF_IARG(Event::CompetitorTotals::StatusNotFinished) ")"
+						 ", competitorTotals.timeMs, competitors.id");
+		qfs::Query q(m_connection);
+		q.exec(query_string(qb, m_connection), qf::core::Exception::Throw);
+		QSqlRecord rec = q.record();
+		const int id_ix = field_index(rec, QStringLiteral("competitors.id"));
+		const int registration_ix = field_index(rec, QStringLiteral("competitors.registration"));
+		const int class_id_ix = field_index(rec, QStringLiteral("competitors.classId"));
+		const int name_ix = field_index(rec, QStringLiteral("competitorName"));
+		const int time_ms_ix = field_index(rec, QStringLiteral("competitorTotals.timeMs"));
+		const int status_ix = field_index(rec, QStringLiteral("competitorTotals.status"));
+		int missing_totals_cnt = 0;
+		while(q.next()) {
+			NStagesEntry entry;
+			entry.competitorId = q.value(id_ix).toInt();
+			entry.registration = q.value(registration_ix);
+			entry.competitorName = q.value(name_ix).toString();
+			entry.stageTimes.fill(UNREAL_TIME_MSEC, stages_count);
+			entry.stagePositions.resize(stages_count);
+			QVariant status = q.value(status_ix);
+			if(status.isNull())
+				missing_totals_cnt++;
+			else if(status.toInt() == Event::CompetitorTotals::StatusOk)
+				entry.timeMs = q.value(time_ms_ix).toInt();
+			QVector<NStagesEntry> &entries = class_entries[q.value(class_id_ix).toInt()];
+			competitor_entry_index[entry.competitorId] = entries.count();
+			entries << entry;
+		}
+		if(missing_totals_cnt > 0)
+			qfWarning() << "Competitors without totals after" << stages_count << "stages listed as not finished:" << missing_totals_cnt
+						<< "run Event / Check competitor totals to fix them.";
+	}
+	{
+		qfs::QueryBuilder qb;
+		qb.select2("runs", "competitorId, stageId, timeMs, notCompeting, disqualified")
+				.select2("competitors", "classId")
+				.from("competitors")
+				.joinRestricted("competitors.id", "runs.competitorId", "runs.stageId>=1 AND runs.stageId<=" QF_IARG(stages_count) " AND runs.isRunning AND runs.finishTimeMs>0", "JOIN")
+				.where("competitors.classId IN (" + int_list(class_ids) + ")")
+				.orderBy("competitors.classId, runs.stageId, runs.notCompeting, runs.disqualified, runs.timeMs");
+		qfs::Query q(m_connection);
+		q.exec(query_string(qb, m_connection), qf::core::Exception::Throw);
+		QSqlRecord rec = q.record();
+		const int competitor_id_ix = field_index(rec, QStringLiteral("runs.competitorId"));
+		const int stage_id_ix = field_index(rec, QStringLiteral("runs.stageId"));
+		const int time_ms_ix = field_index(rec, QStringLiteral("runs.timeMs"));
+		const int not_competing_ix = field_index(rec, QStringLiteral("runs.notCompeting"));
+		const int disqualified_ix = field_index(rec, QStringLiteral("runs.disqualified"));
+		const int class_id_ix = field_index(rec, QStringLiteral("competitors.classId"));
+		int current_class_id = -1;
+		int current_stage_id = -1;
+		int pos = 0;
+		while (q.next()) {
+			int class_id = q.value(class_id_ix).toInt();
+			int stage_id = q.value(stage_id_ix).toInt();
+			if(class_id != current_class_id || stage_id != current_stage_id) {
+				current_class_id = class_id;
+				current_stage_id = stage_id;
+				pos = 0;
+			}
+			++pos;
+			int entry_ix = competitor_entry_index.value(q.value(competitor_id_ix).toInt(), -1);
+			QF_ASSERT(entry_ix >= 0, "Bad row index!", continue);
+			NStagesEntry &entry = class_entries[class_id][entry_ix];
+			QString p = QString::number(pos);
+			if(q.value(not_competing_ix).toBool())
+				p = "N";
+			if(q.value(disqualified_ix).toBool())
+				p = "D";
+			entry.stagePositions[stage_id - 1] = p;
+			entry.stageTimes[stage_id - 1] = q.value(time_ms_ix).toInt();
+		}
+	}
+	qfu::Table::FieldList fields;
+	fields << qfu::Table::Field("competitors.id", QVariant::Int);
+	fields << qfu::Table::Field("competitors.registration", QVariant::String);
+	fields << qfu::Table::Field("competitorName", QVariant::String);
+	for (int stage_id = 1; stage_id <= stages_count; ++stage_id) {
+		fields << qfu::Table::Field(QString("timeMs%1").arg(stage_id), QVariant::Int);
+		fields << qfu::Table::Field(QString("pos%1").arg(stage_id), QVariant::String);
+	}
+	fields << qfu::Table::Field("timeMs", QVariant::Int);
+	fields << qfu::Table::Field("timeLossMs", QVariant::Int);
+	fields << qfu::Table::Field("pos", QVariant::String);
+	const int time_ms_col = 3 + 2 * stages_count;
+
+	for(int class_id : class_ids) {
+		const QVector<NStagesEntry> &entries = class_entries[class_id];
+		int row_count = entries.count();
+		if(places > 0 && row_count > places)
+			row_count = places;
+		if(exclude_disq) {
+			for (int j = 0; j < row_count; ++j) {
+				if(entries[j].timeMs >= UNREAL_TIME_MSEC) {
+					row_count = j;
+					break;
+				}
+			}
+		}
+		qfu::Table t(fields);
+		int time_ms1 = 0;
+		int prev_time_ms = -1;
+		int prev_pos = 0;
+		for (int j = 0; j < row_count; ++j) {
+			const NStagesEntry &entry = entries[j];
+			qfu::TableRow &row = t.appendRow();
+			row.setInsert(false);
+			row.setBareBoneValue(0, entry.competitorId);
+			row.setBareBoneValue(1, entry.registration);
+			row.setBareBoneValue(2, entry.competitorName);
+			for (int i = 0; i < stages_count; ++i) {
+				row.setBareBoneValue(3 + 2 * i, entry.stageTimes[i]);
+				row.setBareBoneValue(3 + 2 * i + 1, entry.stagePositions[i]);
+			}
+			QString p;
+			int loss_ms = UNREAL_TIME_MSEC;
+			if(entry.timeMs < UNREAL_TIME_MSEC) {
+				if(time_ms1 == 0)
+					time_ms1 = entry.timeMs;
+				loss_ms = entry.timeMs - time_ms1;
+				int pos = j + 1;
+				if(entry.timeMs == prev_time_ms)
+					pos = prev_pos;
+				else
+					prev_pos = pos;
+				p = QString::number(pos) + '.';
+			}
+			prev_time_ms = entry.timeMs;
+			row.setBareBoneValue(time_ms_col, entry.timeMs);
+			row.setBareBoneValue(time_ms_col + 1, loss_ms);
+			row.setBareBoneValue(time_ms_col + 2, p);
+		}
+		ret[class_id] = t;
+	}
+	return ret;
+}
+
+}
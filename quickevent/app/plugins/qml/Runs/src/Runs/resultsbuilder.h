@@ -0,0 +1,37 @@
+#ifndef RUNS_RESULTSBUILDER_H
+#define RUNS_RESULTSBUILDER_H
+
+#include <qf/core/sql/connection.h>
+#include <qf/core/utils/table.h>
+#include <qf/core/utils/treetable.h>
+
+#include <QList>
+#include <QMap>
+
+namespace Runs {
+
+class ClassResultsSnapshot;
+
+/// Builds results report tables, stage results are emitted from ResultsSnapshot columns.
+/// Positions, ties and time losses are computed on plain structs while rows are fetched,
+/// report tables are emitted directly without SqlTableModel in between.
+/// Does not touch plugins, so it can be used in QueryExecutor worker thread.
+class ResultsBuilder
+{
+public:
+	ResultsBuilder(const qf::core::sql::Connection &conn);
+
+	/// classes table of stage with course length and climb, results are appended by caller
+	/// @param class_filter SQL condition on classes table
+	qf::core::utils::TreeTable stageClasses(int stage_id, const QString &class_filter, QList<int> *class_ids);
+	/// results table of one class, columns are the same for every class, also for empty one
+	static qf::core::utils::TreeTable classResultsTable(const ClassResultsSnapshot &results, int max_competitors_in_class = 0, bool exclude_disq = false);
+	/// class id -> summary results of first stages_count stages, table is created for every class in class_ids
+	QMap<int, qf::core::utils::Table> nstagesResults(int stages_count, const QList<int> &class_ids, int places = -1, bool exclude_disq = true);
+private:
+	qf::core::sql::Connection m_connection;
+};
+
+}
+
+#endif // RUNS_RESULTSBUILDER_H
@@ -0,0 +1,369 @@
+#include "resultssnapshot.h"
+
+#include <qf/core/log.h>
+#include <qf/core/exception.h>
+#include <qf/core/sql/query.h>
+#include <qf/core/sql/querybuilder.h>
+
+#include <QStringList>
+
+namespace qfs = qf::core::sql;
+
+namespace Runs {
+
+namespace {
+
+/// column indexes of ResultsSnapshot::runsQuery()
+enum RunsQueryColumn {
+	col_runs_id = 0,
+	col_runs_competitorId,
+	col_runs_stageId,
+	col_runs_siId,
+	col_runs_startTimeMs,
+	col_runs_finishTimeMs,
+	col_runs_timeMs,
+	col_runs_isRunning,
+	col_runs_notCompeting,
+	col_runs_disqualified,
+	col_runs_misPunch,
+	col_runs_badCheck,
+	col_competitors_classId,
+	col_competitors_registration,
+	col_competitors_lastName,
+	col_competitors_firstName,
+	col_clubs_name,
+};
+
+QString int_list(const QList<int> &ids)
+{
+	QStringList sl;
+	for(int id : ids)
+		sl << QString::number(id);
+	return sl.join(',');
+}
+
+}
+
+//=================================================
+//             ClassResultsSnapshot
+//=================================================
+bool ClassResultsSnapshot::isBefore(int status1, int time_ms1, int status2, int time_ms2)
+{
+	int nc1 = status1 & NotCompeting;
+	int nc2 = status2 & NotCompeting;
+	if(nc1 != nc2)
+		return nc1 < nc2;
+	int disq1 = status1 & Disqualified;
+	int disq2 = status2 & Disqualified;
+	if(disq1 != disq2)
+		return disq1 < disq2;
+	return time_ms1 < time_ms2;
+}
+
+void ClassResultsSnapshot::appendRow(const ClassResultsSnapshot::Row &r)
+{
+	m_runIds << r.runId;
+	m_competitorIds << r.competitorId;
+	m_siIds << r.siId;
+	m_registrations << r.registration;
+	m_lastNames << r.lastName;
+	m_firstNames << r.firstName;
+	m_clubs << r.club;
+	m_startTimes << r.startTimeMs;
+	m_finishTimes << r.finishTimeMs;
+	m_times << r.timeMs;
+	m_status << (quint8)r.status;
+	m_positions << 0;
+}
+
+void ClassResultsSnapshot::insertRow(const ClassResultsSnapshot::Row &r)
+{
+	int lo = 0;
+	int hi = rowCount();
+	while(lo < hi) {
+		int mid = (lo + hi) / 2;
+		if(isBefore(r.status, r.timeMs, m_status[mid], m_times[mid]))
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	m_runIds.insert(lo, r.runId);
+	m_competitorIds.insert(lo, r.competitorId);
+	m_siIds.insert(lo, r.siId);
+	m_registrations.insert(lo, r.registration);
+	m_lastNames.insert(lo, r.lastName);
+	m_firstNames.insert(lo, r.firstName);
+	m_clubs.insert(lo, r.club);
+	m_startTimes.insert(lo, r.startTimeMs);
+	m_finishTimes.insert(lo, r.finishTimeMs);
+	m_times.insert(lo, r.timeMs);
+	m_status.insert(lo, (quint8)r.status);
+	m_positions.insert(lo, 0);
+}
+
+void ClassResultsSnapshot::removeRow(int row)
+{
+	m_runIds.remove(row);
+	m_competitorIds.remove(row);
+	m_siIds.remove(row);
+	m_registrations.remove(row);
+	m_lastNames.remove(row);
+	m_firstNames.remove(row);
+	m_clubs.remove(row);
+	m_startTimes.remove(row);
+	m_finishTimes.remove(row);
+	m_times.remove(row);
+	m_status.remove(row);
+	m_positions.remove(row);
+}
+
+void ClassResultsSnapshot::computePositions()
+{
+	int prev_time_ms = -1;
+	int prev_pos = 0;
+	for (int i = 0; i < rowCount(); ++i) {
+		int time_ms = m_times[i];
+		bool has_pos = !(m_status[i] & (Disqualified | NotCompeting));
+		int pos = 0;
+		if(has_pos) {
+			pos = i + 1;
+			if(time_ms == prev_time_ms)
+				pos = prev_pos;
+			else
+				prev_pos = pos;
+		}
+		m_positions[i] = pos;
+		prev_time_ms = time_ms;
+	}
+}
+
+//=================================================
+//             ResultsSnapshot
+//=================================================
+ResultsSnapshot::ResultsSnapshot(QObject *parent)
+	: Super(parent)
+{
+}
+
+QString ResultsSnapshot::runsQuery(const QString &where_condition, const QString &order_by)
+{
+	qfs::QueryBuilder qb;
+	qb.select2("runs", "id, competitorId, stageId, siId, startTimeMs, finishTimeMs, timeMs, isRunning, notCompeting, disqualified, misPunch, badCheck")
+			.select2("competitors", "classId, registration, lastName, firstName")
+			.select2("clubs", "name")
+			.from("runs")
+			.join("runs.competitorId", "competitors.id", "JOIN")
+			.join("LEFT JOIN clubs ON substr(competitors.registration, 1, 3) = clubs.abbr")
+			.where(where_condition);
+	if(!order_by.isEmpty())
+		qb.orderBy(order_by);
+	return qb.toString();
+}
+
+ClassResultsSnapshot::Row ResultsSnapshot::rowFromQuery(const qf::core::sql::Query &q)
+{
+	ClassResultsSnapshot::Row r;
+	r.runId = q.value(col_runs_id).toInt();
+	r.competitorId = q.value(col_runs_competitorId).toInt();
+	r.siId = q.value(col_runs_siId).toInt();
+	r.registration = q.value(col_competitors_registration).toString();
+	r.lastName = q.value(col_competitors_lastName).toString();
+	r.firstName = q.value(col_competitors_firstName).toString();
+	r.club = q.value(col_clubs_name).toString();
+	r.startTimeMs = q.value(col_runs_startTimeMs).toInt();
+	r.finishTimeMs = q.value(col_runs_finishTimeMs).toInt();
+	r.timeMs = q.value(col_runs_timeMs).toInt();
+	if(q.value(col_runs_notCompeting).toBool())
+		r.status |= ClassResultsSnapshot::NotCompeting;
+	if(q.value(col_runs_disqualified).toBool())
+		r.status |= ClassResultsSnapshot::Disqualified;
+	if(q.value(col_runs_misPunch).toBool())
+		r.status |= ClassResultsSnapshot::MisPunch;
+	if(q.value(col_runs_badCheck).toBool())
+		r.status |= ClassResultsSnapshot::BadCheck;
+	return r;
+}
+
+bool ResultsSnapshot::isResultRow(const qf::core::sql::Query &q)
+{
+	return q.value(col_runs_isRunning).toBool() && q.value(col_runs_finishTimeMs).toInt() > 0;
+}
+
+ResultsSnapshot::StageResults ResultsSnapshot::loadStage(const qf::core::sql::Connection &conn, int stage_id)
+{
+	qfLogFuncFrame() << "stage:" << stage_id;
+	StageResults ret;
+	qfs::Query q(conn);
+	q.exec(runsQuery("runs.stageId=" QF_IARG(stage_id) " AND runs.isRunning AND runs.finishTimeMs>0"
+					 , "competitors.classId, runs.notCompeting, runs.disqualified, runs.timeMs")
+		   , qf::core::Exception::Throw);
+	ClassResultsSnapshot *current = nullptr;
+	while(q.next()) {
+		int class_id = q.value(col_competitors_classId).toInt();
+		if(!current || current->m_classId != class_id) {
+			current = &ret[class_id];
+			current->m_stageId = stage_id;
+			current->m_classId = class_id;
+		}
+		current->appendRow(rowFromQuery(q));
+	}
+	for(auto it = ret.begin(); it != ret.end(); ++it)
+		it.value().computePositions();
+	return ret;
+}
+
+void ResultsSnapshot::startLoading(int stage_id)
+{
+	m_loadingStageIds[stage_id] = false;
+}
+
+void ResultsSnapshot::setStage(int stage_id, const ResultsSnapshot::StageResults &results)
+{
+	bool runs_changed = m_loadingStageIds.value(stage_id, true);
+	m_loadingStageIds.remove(stage_id);
+	if(runs_changed) {
+		qfDebug() << "runs changed during load of stage:" << stage_id << "results are not cached";
+		return;
+	}
+	for(auto it = results.constBegin(); it != results.constEnd(); ++it) {
+		qint64 key = classKey(stage_id, it.key());
+		ClassResultsSnapshot &cr = m_classResults[key];
+		cr = it.value();
+		cr.m_dataVersion = ++m_lastDataVersion;
+		for(int run_id : cr.m_runIds)
+			m_runClassKeys[run_id] = key;
+	}
+	m_loadedStageIds << stage_id;
+}
+
+ClassResultsSnapshot ResultsSnapshot::classResults(int stage_id, int class_id) const
+{
+	ClassResultsSnapshot ret = m_classResults.value(classKey(stage_id, class_id));
+	ret.m_stageId = stage_id;
+	ret.m_classId = class_id;
+	return ret;
+}
+
+void ResultsSnapshot::clear()
+{
+	qfLogFuncFrame();
+	m_classResults.clear();
+	m_runClassKeys.clear();
+	m_loadedStageIds.clear();
+	markLoadingStagesDirty();
+}
+
+void ResultsSnapshot::markLoadingStagesDirty()
+{
+	for(auto it = m_loadingStageIds.begin(); it != m_loadingStageIds.end(); ++it)
+		it.value() = true;
+}
+
+void ResultsSnapshot::updateRun(int run_id)
+{
+	updateRuns("runs.id=" QF_IARG(run_id));
+}
+
+void ResultsSnapshot::onCardsRead(const QVariantList &card_ids)
+{
+	if(m_loadedStageIds.isEmpty() && m_loadingStageIds.isEmpty())
+		return;
+	QList<int> ids;
+	for(const QVariant &v : card_ids)
+		ids << v.toInt();
+	updateRuns("runs.id IN (SELECT runId FROM cards WHERE id IN (" + int_list(ids) + "))");
+}
+
+void ResultsSnapshot::onCompetitorsChanged(const QVariantList &data_list)
+{
+	if(m_loadedStageIds.isEmpty() && m_loadingStageIds.isEmpty())
+		return;
+	QList<int> competitor_ids;
+	for(const QVariant &data : data_list) {
+		if(data.isNull()) {
+			/// unknown set of changed competitors
+			clear();
+			return;
+		}
+		if(data.type() == QVariant::List) {
+			for(const QVariant &v : data.toList())
+				competitor_ids << v.toInt();
+		}
+		else {
+			competitor_ids << data.toInt();
+		}
+	}
+	if(competitor_ids.isEmpty())
+		return;
+	/// deleted competitors and runs are not returned by query, remove them all first
+	QSet<int> id_set = competitor_ids.toSet();
+	QList<int> run_ids;
+	for(auto it = m_classResults.constBegin(); it != m_classResults.constEnd(); ++it) {
+		const ClassResultsSnapshot &cr = it.value();
+		for (int i = 0; i < cr.rowCount(); ++i) {
+			if(id_set.contains(cr.competitorId(i)))
+				run_ids << cr.runId(i);
+		}
+	}
+	QSet<qint64> changed_keys;
+	for(int run_id : run_ids) {
+		qint64 key = removeRun(run_id);
+		if(key)
+			changed_keys << key;
+	}
+	for(qint64 key : changed_keys) {
+		ClassResultsSnapshot &cr = m_classResults[key];
+		cr.computePositions();
+		cr.m_dataVersion = ++m_lastDataVersion;
+	}
+	updateRuns("runs.competitorId IN (" + int_list(competitor_ids) + ")");
+}
+
+qint64 ResultsSnapshot::removeRun(int run_id)
+{
+	qint64 key = m_runClassKeys.take(run_id);
+	if(key == 0)
+		return 0;
+	auto it = m_classResults.find(key);
+	if(it == m_classResults.end())
+		return 0;
+	int row = it.value().rowOfRun(run_id);
+	if(row >= 0)
+		it.value().removeRow(row);
+	return key;
+}
+
+void ResultsSnapshot::updateRuns(const QString &where_condition)
+{
+	qfLogFuncFrame() << where_condition;
+	markLoadingStagesDirty();
+	if(m_loadedStageIds.isEmpty())
+		return;
+	QSet<qint64> changed_keys;
+	qfs::Query q;
+	q.exec(runsQuery(where_condition), qf::core::Exception::Throw);
+	while(q.next()) {
+		ClassResultsSnapshot::Row r = rowFromQuery(q);
+		qint64 old_key = removeRun(r.runId);
+		if(old_key)
+			changed_keys << old_key;
+		int stage_id = q.value(col_runs_stageId).toInt();
+		if(!isResultRow(q) || !m_loadedStageIds.contains(stage_id))
+			continue;
+		int class_id = q.value(col_competitors_classId).toInt();
+		qint64 key = classKey(stage_id, class_id);
+		ClassResultsSnapshot &cr = m_classResults[key];
+		cr.m_stageId = stage_id;
+		cr.m_classId = class_id;
+		cr.insertRow(r);
+		m_runClassKeys[r.runId] = key;
+		changed_keys << key;
+	}
+	for(qint64 key : changed_keys) {
+		ClassResultsSnapshot &cr = m_classResults[key];
+		cr.computePositions();
+		cr.m_dataVersion = ++m_lastDataVersion;
+	}
+}
+
+}
@@ -0,0 +1,142 @@
+#ifndef RUNS_RESULTSSNAPSHOT_H
+#define RUNS_RESULTSSNAPSHOT_H
+
+#include "../runspluginglobal.h"
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+
+namespace qf { namespace core { namespace sql { class Connection; class Query; }}}
+
+namespace Runs {
+
+/// Results of one class in one stage stored by columns, rows are in results order.
+/// Columns are implicitly shared, so copy taken by consumer is read-only snapshot
+/// which is not affected by later updates of the cache.
+class RUNSPLUGIN_DECL_EXPORT ClassResultsSnapshot
+{
+	friend class ResultsSnapshot;
+public:
+	enum StatusFlag {NotCompeting = 1, Disqualified = 2, MisPunch = 4, BadCheck = 8};
+public:
+	int stageId() const {return m_stageId;}
+	int classId() const {return m_classId;}
+	/// changes with every update of class results, (stage, class, data version) identifies snapshot content
+	int dataVersion() const {return m_dataVersion;}
+
+	int rowCount() const {return m_runIds.count();}
+	int runId(int row) const {return m_runIds[row];}
+	int competitorId(int row) const {return m_competitorIds[row];}
+	int siId(int row) const {return m_siIds[row];}
+	const QString& registration(int row) const {return m_registrations[row];}
+	const QString& lastName(int row) const {return m_lastNames[row];}
+	const QString& firstName(int row) const {return m_firstNames[row];}
+	QString competitorName(int row) const {return m_lastNames[row] + ' ' + m_firstNames[row];}
+	const QString& club(int row) const {return m_clubs[row];}
+	int startTimeMs(int row) const {return m_startTimes[row];}
+	int finishTimeMs(int row) const {return m_finishTimes[row];}
+	int timeMs(int row) const {return m_times[row];}
+	int status(int row) const {return m_status[row];}
+	bool isNotCompeting(int row) const {return m_status[row] & NotCompeting;}
+	bool isDisqualified(int row) const {return m_status[row] & Disqualified;}
+	bool isMisPunch(int row) const {return m_status[row] & MisPunch;}
+	bool isBadCheck(int row) const {return m_status[row] & BadCheck;}
+	/// 0 for not competing and disqualified runs, runs with equal time share position
+	int position(int row) const {return m_positions[row];}
+	/// @return row of run or -1
+	int rowOfRun(int run_id) const {return m_runIds.indexOf(run_id);}
+private:
+	struct Row
+	{
+		int runId = 0;
+		int competitorId = 0;
+		int siId = 0;
+		QString registration, lastName, firstName, club;
+		int startTimeMs = 0;
+		int finishTimeMs = 0;
+		int timeMs = 0;
+		int status = 0;
+	};
+	/// order of results query: not competing and disqualified runs last, then by time
+	static bool isBefore(int status1, int time_ms1, int status2, int time_ms2);
+	void appendRow(const Row &r);
+	/// inserts row after all rows which are not behind it
+	void insertRow(const Row &r);
+	void removeRow(int row);
+	void computePositions();
+private:
+	int m_stageId = 0;
+	int m_classId = 0;
+	int m_dataVersion = 0;
+	QVector<int> m_runIds;
+	QVector<int> m_competitorIds;
+	QVector<int> m_siIds;
+	QVector<QString> m_registrations;
+	QVector<QString> m_lastNames;
+	QVector<QString> m_firstNames;
+	QVector<QString> m_clubs;
+	QVector<int> m_startTimes;
+	QVector<int> m_finishTimes;
+	QVector<int> m_times;
+	QVector<quint8> m_status;
+	QVector<int> m_positions;
+};
+
+/// Stage results cache shared by results printing, awards and exports.
+/// Stage is loaded by one query for all its classes and then kept up to date per run
+/// from db events, so consumers read the same snapshot instead of recomputing results.
+class RUNSPLUGIN_DECL_EXPORT ResultsSnapshot : public QObject
+{
+	Q_OBJECT
+private:
+	typedef QObject Super;
+public:
+	typedef QHash<int, ClassResultsSnapshot> StageResults; //< class id -> results
+public:
+	ResultsSnapshot(QObject *parent = nullptr);
+
+	bool isStageLoaded(int stage_id) const {return m_loadedStageIds.contains(stage_id);}
+	/// results of all classes of stage, runs in QueryExecutor worker thread, must not touch plugins
+	static StageResults loadStage(const qf::core::sql::Connection &conn, int stage_id);
+	/// call before loadStage() is started, runs changed till setStage() discard loaded results
+	void startLoading(int stage_id);
+	/// store results loaded by loadStage(), they are not cached if some runs changed meanwhile
+	void setStage(int stage_id, const StageResults &results);
+	void cancelLoading(int stage_id) {m_loadingStageIds.remove(stage_id);}
+	/// read-only copy of class results, empty if stage is not loaded or class has no results
+	ClassResultsSnapshot classResults(int stage_id, int class_id) const;
+
+	/// reload single run from SQL, does nothing if run's stage is not loaded
+	void updateRun(int run_id);
+	Q_SLOT void clear();
+
+	/// update runs of read cards, card ids are merged DBEVENT_CARD_READ payloads
+	void onCardsRead(const QVariantList &card_ids);
+	/// data are merged DBEVENT_COMPETITOR_COUNTS_CHANGED payloads, null payload clears the cache
+	void onCompetitorsChanged(const QVariantList &data_list);
+private:
+	static qint64 classKey(int stage_id, int class_id) {return (((qint64)stage_id) << 32) | (quint32)class_id;}
+	static QString runsQuery(const QString &where_condition, const QString &order_by = QString());
+	static ClassResultsSnapshot::Row rowFromQuery(const qf::core::sql::Query &q);
+	static bool isResultRow(const qf::core::sql::Query &q);
+
+	/// reload runs matching SQL condition, runs removed from results must be removed by caller
+	void updateRuns(const QString &where_condition);
+	/// @return key of class run was removed from or 0
+	qint64 removeRun(int run_id);
+	void markLoadingStagesDirty();
+private:
+	QHash<qint64, ClassResultsSnapshot> m_classResults;
+	QHash<int, qint64> m_runClassKeys;
+	QSet<int> m_loadedStageIds;
+	QHash<int, bool> m_loadingStageIds; //< stage id -> runs changed during load
+	int m_lastDataVersion = 0;
+};
+
+}
+
+#endif // RUNS_RESULTSSNAPSHOT_H
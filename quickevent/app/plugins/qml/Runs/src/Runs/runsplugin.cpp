@@ -1,5 +1,10 @@
 #include "runsplugin.h"
 #include "nstagesreportoptionsdialog.h"
+#include "standingsservice.h"
+#include "resultsbuilder.h"
+#include "resultssnapshot.h"
+#include "eventstatistics.h"
+#include "reportbenchmark.h"
 #include "../thispartwidget.h"
 #include "../runswidget.h"
 #include "../runstabledialogwidget.h"
@@ -7,6 +12,7 @@
 #include "../printawardsoptionsdialogwidget.h"
 
 #include <Event/eventplugin.h>
+#include <Event/dbeventbus.h>
 
 #include <quickevent/reportoptionsdialog.h>
 
@@ -20,6 +26,7 @@
 #include <qf/core/log.h>
 #include <qf/core/assert.h>
 #include <qf/core/sql/query.h>
+#include <qf/core/sql/queryexecutor.h>
 #include <qf/core/sql/querybuilder.h>
 #include <qf/core/utils/table.h>
 #include <qf/core/utils/treetable.h>
@@ -37,10 +44,7 @@ namespace Runs {
 
 static Event::EventPlugin* eventPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Event::EventPlugin*>(fwk->plugin("Event"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad event plugin!");
-	return plugin;
+	return qff::MainWindow::cachedPlugin<Event::EventPlugin>();
 }
 
 static qf::qmlwidgets::framework::Plugin* competitorsPlugin()
@@ -55,6 +59,9 @@ RunsPlugin::RunsPlugin(QObject *parent)
 	: Super(parent)
 {
 	connect(this, &RunsPlugin::installed, this, &RunsPlugin::onInstalled, Qt::QueuedConnection);
+	m_standingsService = new StandingsService(this);
+	m_resultsSnapshot = new ResultsSnapshot(this);
+	m_eventStatistics = new EventStatistics(this);
 }
 
 RunsPlugin::~RunsPlugin()
@@ -79,27 +86,44 @@ const qf::core::utils::Table &RunsPlugin::runnersTable(int stage_id)
 		m.reload();
 		m_runnersTableCache = m.table();
 
-		auto c_nsk = QStringLiteral("competitorNameAscii7");
-		m_runnersTableCache.appendColumn(c_nsk, QVariant::String);
-		int ix_nsk = m_runnersTableCache.fields().fieldIndex(c_nsk);
-		int ix_cname = m_runnersTableCache.fields().fieldIndex(QStringLiteral("competitorName"));
+		m_runnersSearchIndexCache.clear();
+		const qf::core::utils::Table::FieldList &fields = m_runnersTableCache.fields();
+		int ix_class_name = fields.fieldIndex(QStringLiteral("classes.name"));
+		int ix_cname = fields.fieldIndex(QStringLiteral("competitorName"));
+		int ix_registration = fields.fieldIndex(QStringLiteral("registration"));
+		int ix_siid = fields.fieldIndex(QStringLiteral("siid"));
 		for (int i = 0; i < m_runnersTableCache.rowCount(); ++i) {
-			qf::core::utils::TableRow &row_ref = m_runnersTableCache.rowRef(i);
-			QString nsk = row_ref.value(ix_cname).toString();
-			nsk = QString::fromLatin1(qf::core::Collator::toAscii7(QLocale::Czech, nsk, true));
-			row_ref.setValue(ix_nsk, nsk);
+			qf::core::utils::TableRow row = m_runnersTableCache.row(i);
+			m_runnersSearchIndexCache.addItem(row.value(ix_class_name).toString() + ' '
+											  + row.value(ix_cname).toString() + ' '
+											  + row.value(ix_registration).toString()
+											  + " SI:" + row.value(ix_siid).toString());
 		}
 		m_runnersTableCacheStageId = stage_id;
 	}
 	return m_runnersTableCache;
 }
 
+const qf::core::utils::SearchIndex &RunsPlugin::runnersSearchIndex(int stage_id)
+{
+	runnersTable(stage_id);
+	return m_runnersSearchIndexCache;
+}
+
 void RunsPlugin::clearRunnersTableCache()
 {
 	//qfInfo() << QF_FUNC_NAME;
 	m_runnersTableCacheStageId = 0;
 }
 
+void RunsPlugin::onStartTimesChanged()
+{
+	m_resultsSnapshot->clear();
+	int stage_id = m_eventStatistics->stageId();
+	if(stage_id > 0)
+		m_eventStatistics->loadStage(stage_id);
+}
+
 void RunsPlugin::onInstalled()
 {
 	qff::MainWindow *fwk = qff::MainWindow::frameWork();
@@ -110,6 +134,35 @@ void RunsPlugin::onInstalled()
 		this->setSelectedStageId(stage_id);
 	});
 	connect(competitorsPlugin(), SIGNAL(competitorEdited()), this, SLOT(clearRunnersTableCache()));
+	connect(competitorsPlugin(), SIGNAL(competitorEdited()), m_standingsService, SLOT(clear()));
+	connect(eventPlugin(), &Event::EventPlugin::eventOpened, m_standingsService, &StandingsService::clear);
+	connect(eventPlugin(), &Event::EventPlugin::reloadDataRequest, m_standingsService, &StandingsService::clear);
+	connect(competitorsPlugin(), SIGNAL(competitorEdited()), m_resultsSnapshot, SLOT(clear()));
+	connect(eventPlugin(), &Event::EventPlugin::eventOpened, m_resultsSnapshot, &ResultsSnapshot::clear);
+	connect(eventPlugin(), &Event::EventPlugin::reloadDataRequest, m_resultsSnapshot, &ResultsSnapshot::clear);
+	connect(eventPlugin(), &Event::EventPlugin::eventOpened, m_eventStatistics, &EventStatistics::clear);
+	connect(eventPlugin(), &Event::EventPlugin::reloadDataRequest, m_eventStatistics, &EventStatistics::clear);
+	{
+		Event::DbEventBus *bus = eventPlugin()->dbEventBus();
+		bus->subscribe(Event::EventPlugin::DBEVENT_CARD_READ, m_standingsService, [this](const QVariantList &card_ids) {
+			m_standingsService->onCardsRead(card_ids);
+		});
+		bus->subscribe(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED, m_standingsService, [this](const QVariantList &) {
+			m_standingsService->clear();
+		});
+		bus->subscribe(Event::EventPlugin::DBEVENT_CARD_READ, m_resultsSnapshot, [this](const QVariantList &card_ids) {
+			m_resultsSnapshot->onCardsRead(card_ids);
+		});
+		bus->subscribe(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED, m_resultsSnapshot, [this](const QVariantList &data_list) {
+			m_resultsSnapshot->onCompetitorsChanged(data_list);
+		});
+		bus->subscribe(Event::EventPlugin::DBEVENT_CARD_READ, m_eventStatistics, [this](const QVariantList &card_ids) {
+			m_eventStatistics->onCardsRead(card_ids);
+		});
+		bus->subscribe(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED, m_eventStatistics, [this](const QVariantList &data_list) {
+			m_eventStatistics->onCompetitorsChanged(data_list);
+		});
+	}
 
 	fwk->addPartWidget(m_partWidget, manifest()->featureId());
 
@@ -130,6 +183,32 @@ void RunsPlugin::onInstalled()
 		a->setShortcut(QKeySequence("ctrl+shift+E"));
 		fwk->menuBar()->actionForPath("view")->addActionInto(a);
 	}
+	{
+		qfw::Action *a = new qfw::Action(tr("Benchmark results report"));
+		connect(a, &QAction::triggered, [this, fwk]() {
+			bool ok;
+			int row_count = QInputDialog::getInt(fwk, tr("Benchmark results report"), tr("Number of runners:"), 3000, 1, 100000, 1000, &ok);
+			if(!ok)
+				return;
+			QString report = ReportBenchmark::resultsReport(manifest()->homeDir() + "/reports", row_count);
+			qfInfo() << report;
+			qf::qmlwidgets::dialogs::MessageBox::showInfo(fwk, report);
+		});
+		fwk->menuBar()->actionForPath("help")->addActionInto(a);
+	}
+	{
+		qfw::Action *a = new qfw::Action(tr("Benchmark split times report"));
+		connect(a, &QAction::triggered, [this, fwk]() {
+			bool ok;
+			int row_count = QInputDialog::getInt(fwk, tr("Benchmark split times report"), tr("Number of rows:"), 5000, 1, 100000, 1000, &ok);
+			if(!ok)
+				return;
+			QString report = ReportBenchmark::splitTimesReport(manifest()->homeDir() + "/reports", row_count);
+			qfInfo() << report;
+			qf::qmlwidgets::dialogs::MessageBox::showInfo(fwk, report);
+		});
+		fwk->menuBar()->actionForPath("help")->addActionInto(a);
+	}
 
 	emit nativeInstalled();
 }
@@ -283,101 +362,8 @@ int RunsPlugin::cardForRun(int run_id)
 
 qf::core::utils::Table RunsPlugin::nstagesResultsTable(int stages_count, int class_id, int places, bool exclude_disq)
 {
-	qfs::QueryBuilder qb;
-	qb.select2("competitors", "id, registration")
-			.select("COALESCE(competitors.lastName, '') || ' ' || COALESCE(competitors.firstName, '') AS competitorName")
-			.from("competitors")
-			.where("competitors.classId=" QF_IARG(class_id));
-	for (int stage_id = 1; stage_id <= stages_count; ++stage_id) {
-		//qb.select("0 AS runId" QF_IARG(stage_id));
-		qb.select(QF_IARG(UNREAL_TIME_MSEC) " AS timeMs" QF_IARG(stage_id));
-		qb.select("'' AS pos" QF_IARG(stage_id));
-	}
-	qb.select(QF_IARG(UNREAL_TIME_MSEC) " AS timeMs");
-	qb.select(QF_IARG(UNREAL_TIME_MSEC) " AS timeLossMs");
-	qb.select("'' AS pos");
-	qf::core::model::SqlTableModel mod;
-	mod.setQueryBuilder(qb, false);
-	mod.reload();
-	QMap<int, int> competitor_id_to_row;
-	for (int j = 0; j < mod.rowCount(); ++j) {
-		competitor_id_to_row[mod.value(j, "competitors.id").toInt()] = j;
-	}
-	for (int stage_id = 1; stage_id <= stages_count; ++stage_id) {
-		qfs::QueryBuilder qb;
-		qb.select2("runs", "competitorId, timeMs, notCompeting, disqualified")
-				.from("competitors")
-				.joinRestricted("competitors.id", "runs.competitorId", "runs.stageId=" QF_IARG(stage_id) " AND runs.isRunning AND runs.finishTimeMs>0", "JOIN")
-				.where("competitors.classId=" QF_IARG(class_id))
-				.orderBy("runs.notCompeting, runs.disqualified, runs.timeMs");
-		qfs::Query q;
-		q.exec(qb.toString());
-		int pos = 0;
-		while (q.next()) {
-			++pos;
-			int competitor_id = q.value("competitorId").toInt();
-			int row_ix = competitor_id_to_row.value(competitor_id, -1);
-			QF_ASSERT(row_ix >= 0, "Bad row index!", continue);
-			QString p = QString::number(pos);
-			if(q.value("notCompeting").toBool())
-				p = "N";
-			if(q.value("disqualified").toBool())
-				p = "D";
-			mod.setValue(row_ix, QString("pos%1").arg(stage_id), p);
-			mod.setValue(row_ix, QString("timeMs%1").arg(stage_id), q.value("timeMs"));
-		}
-	}
-	for (int j = 0; j < mod.rowCount(); ++j) {
-		int time_ms = 0;
-		for (int stage_id = 1; stage_id <= stages_count; ++stage_id) {
-			QString pos_str = mod.value(j, QString("pos%1").arg(stage_id)).toString();
-			int pos = pos_str.toInt();
-			int tms = mod.value(j, QString("timeMs%1").arg(stage_id)).toInt();
-			if(pos > 0 && tms < UNREAL_TIME_MSEC && time_ms < UNREAL_TIME_MSEC)
-				time_ms += tms;
-			else
-				time_ms = UNREAL_TIME_MSEC;
-		}
-		mod.setValue(j, "timeMs", time_ms);
-	}
-	qfu::Table t = mod.table();
-	t.sort("timeMs");
-	int pos = 0;
-	int time_ms1 = 0;
-	//const bool trim_disq = false;
-	int trim_at = -1;
-	for (int j = 0; j < t.rowCount(); ++j) {
-		++pos;
-		QString p = QString::number(pos) + '.';
-		int time_ms = t.row(j).value("timeMs").toInt();
-		int loss_ms = UNREAL_TIME_MSEC;
-		if(time_ms < UNREAL_TIME_MSEC) {
-			if(time_ms1 == 0)
-				time_ms1 = time_ms;
-			loss_ms = time_ms - time_ms1;
-		}
-		else {
-			if(exclude_disq) {
-				trim_at = j;
-				break;
-			}
-			p = "";
-		}
-		t.rowRef(j).setValue("pos", p);
-		t.rowRef(j).setValue("timeLossMs", loss_ms);
-	}
-	if(trim_at < 0) {
-		if(places > 0)
-			trim_at = places;
-	}
-	else {
-		if(places > 0 && trim_at > places)
-			trim_at = places;
-	}
-	if(trim_at >= 0)
-		while(t.rowCount() > trim_at)
-			t.removeRow(trim_at);
-	return t;
+	ResultsBuilder rb(qfs::Connection::forName());
+	return rb.nstagesResults(stages_count, QList<int>() << class_id, places, exclude_disq).value(class_id);
 }
 
 QVariant RunsPlugin::nstagesResultsTableData(int stages_count, int places, bool exclude_disq)
@@ -396,12 +382,16 @@ QVariant RunsPlugin::nstagesResultsTableData(int stages_count, int places, bool
 	}
 	mod.reload();
 	qf::core::utils::TreeTable tt = mod.toTreeTable();
+	QList<int> class_ids;
+	for(int i=0; i<tt.rowCount(); i++)
+		class_ids << tt.row(i).value("id").toInt();
+	/// all classes at once, one query per stage count instead of one per class and stage
+	ResultsBuilder rb(qfs::Connection::forName());
+	QMap<int, qf::core::utils::Table> results = rb.nstagesResults(stages_count, class_ids, places, exclude_disq);
 	for(int i=0; i<tt.rowCount(); i++) {
 		qf::core::utils::TreeTableRow tt_row = tt.row(i);
-		qfInfo() << "Processing class:" << tt_row.value("name").toString();
 		int class_id = tt_row.value("id").toInt();
-		qf::core::utils::Table t = nstagesResultsTable(stages_count, class_id, places, exclude_disq);
-		qf::core::utils::TreeTable tt2 = t.toTreeTable();
+		qf::core::utils::TreeTable tt2 = results.value(class_id).toTreeTable();
 		tt_row.appendTable(tt2);
 	}
 	return tt.toVariant();
@@ -415,87 +405,42 @@ QVariant RunsPlugin::currentStageResultsTableData(const QString &class_filter, i
 
 QVariant RunsPlugin::stageResultsTableData(int stage_id, const QString &class_filter, int max_competitors_in_class, bool exclude_disq)
 {
-	//var event_plugin = FrameWork.plugin("Event");
-	qf::core::model::SqlTableModel model;
-	{
-		qf::core::sql::QueryBuilder qb;
-		qb.select2("classes", "id, name")
-			.select2("courses", "length, climb")
-			.from("classes")
-			//.where("classes.name NOT IN ('D21B', 'H40B', 'H35C', 'H55B')")
-			.joinRestricted("classes.id", "classdefs.classId", "classdefs.stageId={{stage_id}}")
-			.join("classdefs.courseId", "courses.id")
-			.orderBy("classes.name");//.limit(1);
-		if(!class_filter.isEmpty()) {
-			qb.where(class_filter);
-		}
-		model.setQueryBuilder(qb, true);
+	QVariant event_info = eventPlugin()->eventConfig()->value("event");
+	QDateTime stage_start = eventPlugin()->stageStartDateTime(stage_id);
+	/// results printing, awards and exports share results snapshot, stage is loaded once for all classes
+	bool load_stage = !m_resultsSnapshot->isStageLoaded(stage_id);
+	if(load_stage)
+		m_resultsSnapshot->startLoading(stage_id);
+	qfu::TreeTable tt;
+	QList<int> class_ids;
+	ResultsSnapshot::StageResults stage_results;
+	/// classes and not cached results are loaded in worker thread, SI reader is served meanwhile
+	QString err;
+	qfs::QueryExecutor::instance()->executeAndWait([&](qfs::Connection &conn) -> QVariant {
+		ResultsBuilder rb(conn);
+		tt = rb.stageClasses(stage_id, class_filter, &class_ids);
+		if(load_stage)
+			stage_results = ResultsSnapshot::loadStage(conn, stage_id);
+		return QVariant();
+	}, &err);
+	if(!err.isEmpty()) {
+		if(load_stage)
+			m_resultsSnapshot->cancelLoading(stage_id);
+		qfError() << "Load stage results error:" << err;
+		return QVariant();
 	}
-	{
-		QVariantMap qm;
-		qm["stage_id"] = stage_id;
-		model.setQueryParameters(qm);
+	if(load_stage)
+		m_resultsSnapshot->setStage(stage_id, stage_results);
+	/// stage not cached because runs changed during load is printed from loaded results
+	bool use_snapshot = m_resultsSnapshot->isStageLoaded(stage_id);
+	for (int i = 0; i < class_ids.count(); ++i) {
+		int class_id = class_ids[i];
+		ClassResultsSnapshot results = use_snapshot? m_resultsSnapshot->classResults(stage_id, class_id): stage_results.value(class_id);
+		tt.row(i).appendTable(ResultsBuilder::classResultsTable(results, max_competitors_in_class, exclude_disq));
 	}
-	//console.info("currentStageTable query:", reportModel.effectiveQuery());
-	model.reload();
-	qf::core::utils::TreeTable tt = model.toTreeTable();
 	tt.setValue("stageId", stage_id);
-	tt.setValue("event", eventPlugin()->eventConfig()->value("event"));
-	tt.setValue("stageStart", eventPlugin()->stageStartDateTime(stage_id));
-
-	{
-		qf::core::sql::QueryBuilder qb;
-		qb.select2("competitors", "registration, lastName, firstName")
-			.select("COALESCE(competitors.lastName, '') || ' ' || COALESCE(competitors.firstName, '') AS competitorName")
-			.select2("runs", "*")
-			.select2("clubs", "name")
-			.from("competitors")
-			.join("LEFT JOIN clubs ON substr(competitors.registration, 1, 3) = clubs.abbr")
-			.joinRestricted("competitors.id"
-							, "runs.competitorId"
-							, QStringLiteral("runs.stageId={{stage_id}} AND runs.isRunning AND runs.finishTimeMs>0") + (exclude_disq? " AND NOT runs.disqualified": "")
-							, "JOIN")
-			.where("competitors.classId={{class_id}}")
-			.orderBy("runs.notCompeting, runs.disqualified, runs.timeMs");
-		if(max_competitors_in_class > 0)
-			qb.limit(max_competitors_in_class);
-		model.setQueryBuilder(qb, true);
-	}
-	for(int i=0; i<tt.rowCount(); i++) {
-		int class_id = tt.row(i).value("classes.id").toInt();
-		//console.debug("class id:", class_id);
-		QVariantMap qm;
-		qm["stage_id"] = stage_id;
-		qm["class_id"] = class_id;
-		model.setQueryParameters(qm);
-		model.reload();
-		qf::core::utils::TreeTable tt2 = model.toTreeTable();
-		tt2.appendColumn("pos", QVariant::String);
-		tt2.appendColumn("npos", QVariant::Int);
-		int prev_time_ms = 0;
-		int prev_pos = 0;
-		for(int j=0; j<tt2.rowCount(); j++) {
-			qf::core::utils::TreeTableRow row = tt2.row(j);
-			bool has_pos = !row.value(QStringLiteral("disqualified")).toBool() && !row.value(QStringLiteral("notCompeting")).toBool();
-			int time_ms = row.value(QStringLiteral("timeMs")).toInt();
-			if(has_pos) {
-				int pos = j+1;
-				if(time_ms == prev_time_ms)
-					pos = prev_pos;
-				else
-					prev_pos = pos;
-				row.setValue("pos", QString::number(pos) + '.');
-				row.setValue("npos", pos);
-			}
-			else {
-				row.setValue("pos", QString());
-				row.setValue("npos", 0);
-			}
-			prev_time_ms = time_ms;
-		}
-		tt.row(i).appendTable(tt2);
-	}
-	//console.debug(tt.toString());
+	tt.setValue("event", event_info);
+	tt.setValue("stageStart", stage_start);
 	return tt.toVariant();
 }
 
@@ -9,6 +9,7 @@
 
 #include <qf/core/utils.h>
 #include <qf/core/utils/table.h>
+#include <qf/core/utils/searchindex.h>
 
 namespace qf {
 	namespace core {
@@ -27,6 +28,10 @@ namespace qf {
 
 namespace Runs {
 
+class StandingsService;
+class ResultsSnapshot;
+class EventStatistics;
+
 class RUNSPLUGIN_DECL_EXPORT RunsPlugin : public qf::qmlwidgets::framework::Plugin
 {
 	Q_OBJECT
@@ -45,10 +50,20 @@ public:
 	qf::qmlwidgets::framework::PartWidget *partWidget() {return m_partWidget;}
 
 	Q_SIGNAL void nativeInstalled();
+	/// run was saved from runs table, plugins which do not link Runs can connect it by name
+	Q_SIGNAL void runEdited(int run_id);
 
 	const qf::core::utils::Table& runnersTable(int stage_id);
+	/// search index of runnersTable() rows, item id is row number
+	const qf::core::utils::SearchIndex& runnersSearchIndex(int stage_id);
 	Q_SLOT void clearRunnersTableCache();
 
+	StandingsService* standingsService() {return m_standingsService;}
+	ResultsSnapshot* resultsSnapshot() {return m_resultsSnapshot;}
+	EventStatistics* eventStatistics() {return m_eventStatistics;}
+	/// start times were written by plain SQL, drop cached results and recount loaded stage
+	void onStartTimesChanged();
+
 	Q_INVOKABLE int courseForRun(int run_id);
 	Q_INVOKABLE int cardForRun(int run_id);
 	Q_INVOKABLE QVariant currentStageResultsTableData(const QString &class_filter, int max_competitors_in_class = 0, bool exclude_disq = false);
@@ -71,8 +86,12 @@ private:
 private:
 	qf::qmlwidgets::framework::PartWidget *m_partWidget = nullptr;
 	qf::core::utils::Table m_runnersTableCache;
+	qf::core::utils::SearchIndex m_runnersSearchIndexCache;
 	int m_runnersTableCacheStageId = 0;
 	qf::qmlwidgets::framework::DockWidget *m_eventStatisticsDockWidget = nullptr;
+	StandingsService *m_standingsService = nullptr;
+	ResultsSnapshot *m_resultsSnapshot = nullptr;
+	EventStatistics *m_eventStatistics = nullptr;
 };
 
 }
@@ -0,0 +1,207 @@
+#include "standingsservice.h"
+
+#include <Event/eventplugin.h>
+
+#include <qf/core/log.h>
+#include <qf/core/exception.h>
+#include <qf/core/sql/query.h>
+#include <qf/core/sql/querybuilder.h>
+
+#include <QStringList>
+
+#include <algorithm>
+
+namespace qfs = qf::core::sql;
+
+namespace Runs {
+
+StandingsService::StandingsService(QObject *parent)
+	: Super(parent)
+{
+}
+
+int StandingsService::standingsForTime(int stage_id, int class_id, int time_ms)
+{
+	const ClassStandings &cs = classStandings(stage_id, class_id);
+	auto it = std::upper_bound(cs.okTimes.begin(), cs.okTimes.end(), time_ms);
+	return (int)(it - cs.okTimes.begin());
+}
+
+int StandingsService::finishedCount(int stage_id, int class_id)
+{
+	return classStandings(stage_id, class_id).finishedCount;
+}
+
+QMap<int, int> StandingsService::bestLaps(int stage_id, int class_id)
+{
+	QMap<int, int> ret;
+	const ClassStandings &cs = classStandings(stage_id, class_id);
+	for(const auto &kv : cs.laps) {
+		if(!kv.second.empty())
+			ret[kv.first] = *kv.second.begin();
+	}
+	return ret;
+}
+
+int StandingsService::bestLap(int stage_id, int class_id, int position)
+{
+	const ClassStandings &cs = classStandings(stage_id, class_id);
+	auto it = cs.laps.find(position);
+	if(it == cs.laps.end() || it->second.empty())
+		return 0;
+	return *it->second.begin();
+}
+
+bool StandingsService::containsRun(int stage_id, int class_id, int run_id)
+{
+	return classStandings(stage_id, class_id).runs.contains(run_id);
+}
+
+void StandingsService::clear()
+{
+	qfLogFuncFrame();
+	m_classStandings.clear();
+	m_runClassKeys.clear();
+}
+
+void StandingsService::onCardsRead(const QVariantList &card_ids)
+{
+	if(m_runClassKeys.isEmpty())
+		return;
+	QStringList ids;
+	for(const QVariant &v : card_ids)
+		ids << QString::number(v.toInt());
+	qfs::Query q;
+	q.exec("SELECT runId FROM cards WHERE id IN (" + ids.join(',') + ")", qf::core::Exception::Throw);
+	while(q.next())
+		updateRun(q.value(0).toInt());
+}
+
+void StandingsService::updateRun(int run_id)
+{
+	qfLogFuncFrame() << "run id:" << run_id;
+	auto key_it = m_runClassKeys.constFind(run_id);
+	if(key_it == m_runClassKeys.constEnd())
+		return;
+	ClassStandings &cs = m_classStandings[key_it.value()];
+	removeRun(cs, run_id);
+	RunEntry entry;
+	qfs::Query q;
+	q.exec("SELECT timeMs, finishTimeMs"
+		   ", disqualified OR NOT isRunning OR isRunning IS NULL OR misPunch AS dis"
+		   " FROM runs WHERE id=" QF_IARG(run_id), qf::core::Exception::Throw);
+	if(!q.next()) {
+		m_runClassKeys.remove(run_id);
+		return;
+	}
+	entry.timeMs = q.value(0).toInt();
+	entry.finished = q.value(1).toInt() > 0;
+	entry.ok = entry.finished && !q.value(2).toBool();
+	q.exec("SELECT position, lapTimeMs FROM runlaps WHERE runId=" QF_IARG(run_id)
+		   " AND position > 0 AND lapTimeMs > 0 ORDER BY position", qf::core::Exception::Throw);
+	while(q.next()) {
+		int position = q.value(0).toInt();
+		if(entry.laps.size() < position)
+			entry.laps.resize(position);
+		entry.laps[position - 1] = q.value(1).toInt();
+	}
+	addRun(cs, run_id, entry);
+}
+
+StandingsService::ClassStandings &StandingsService::classStandings(int stage_id, int class_id)
+{
+	qint64 key = classKey(stage_id, class_id);
+	auto it = m_classStandings.find(key);
+	if(it == m_classStandings.end()) {
+		it = m_classStandings.insert(key, ClassStandings());
+		loadClassStandings(it.value(), stage_id, class_id);
+		for(auto run_it = it.value().runs.constBegin(); run_it != it.value().runs.constEnd(); ++run_it)
+			m_runClassKeys[run_it.key()] = key;
+	}
+	return it.value();
+}
+
+void StandingsService::loadClassStandings(StandingsService::ClassStandings &cs, int stage_id, int class_id)
+{
+	qfLogFuncFrame() << "stage:" << stage_id << "class:" << class_id;
+	QHash<int, RunEntry> entries;
+	{
+		qfs::QueryBuilder qb;
+		qb.select2("runs", "id, timeMs, finishTimeMs")
+				.select("runs.disqualified OR NOT runs.isRunning OR runs.isRunning IS NULL OR runs.misPunch AS dis")
+				.from("competitors")
+				.joinRestricted("competitors.id", "runs.competitorId", "runs.stageId=" QF_IARG(stage_id), "JOIN")
+				.where("competitors.classId=" QF_IARG(class_id));
+		qfs::Query q;
+		q.exec(qb.toString(), qf::core::Exception::Throw);
+		while(q.next()) {
+			RunEntry &entry = entries[q.value("id").toInt()];
+			entry.timeMs = q.value("timeMs").toInt();
+			entry.finished = q.value("finishTimeMs").toInt() > 0;
+			entry.ok = entry.finished && !q.value("dis").toBool();
+		}
+	}
+	{
+		qfs::QueryBuilder qb;
+		qb.select2("runlaps", "runId, position, lapTimeMs")
+				.from("competitors")
+				.joinRestricted("competitors.id", "runs.competitorId", "runs.stageId=" QF_IARG(stage_id) " AND competitors.classId=" QF_IARG(class_id), "JOIN")
+				.joinRestricted("runs.id", "runlaps.runId", "runlaps.position > 0 AND runlaps.lapTimeMs > 0", "JOIN");
+		qfs::Query q;
+		q.exec(qb.toString(), qf::core::Exception::Throw);
+		while(q.next()) {
+			auto it = entries.find(q.value(0).toInt());
+			if(it == entries.end())
+				continue;
+			int position = q.value(1).toInt();
+			if(it.value().laps.size() < position)
+				it.value().laps.resize(position);
+			it.value().laps[position - 1] = q.value(2).toInt();
+		}
+	}
+	for(auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+		addRun(cs, it.key(), it.value());
+}
+
+void StandingsService::addRun(StandingsService::ClassStandings &cs, int run_id, const StandingsService::RunEntry &entry)
+{
+	cs.runs[run_id] = entry;
+	if(entry.finished)
+		cs.finishedCount++;
+	if(entry.ok)
+		cs.okTimes.insert(std::upper_bound(cs.okTimes.begin(), cs.okTimes.end(), entry.timeMs), entry.timeMs);
+	for (int i = 0; i < entry.laps.size(); ++i) {
+		int lap = entry.laps[i];
+		if(lap > 0)
+			cs.laps[i + 1].insert(lap);
+	}
+}
+
+void StandingsService::removeRun(StandingsService::ClassStandings &cs, int run_id)
+{
+	auto it = cs.runs.find(run_id);
+	if(it == cs.runs.end())
+		return;
+	const RunEntry &entry = it.value();
+	if(entry.finished)
+		cs.finishedCount--;
+	if(entry.ok) {
+		auto time_it = std::lower_bound(cs.okTimes.begin(), cs.okTimes.end(), entry.timeMs);
+		if(time_it != cs.okTimes.end() && *time_it == entry.timeMs)
+			cs.okTimes.erase(time_it);
+	}
+	for (int i = 0; i < entry.laps.size(); ++i) {
+		int lap = entry.laps[i];
+		if(lap <= 0)
+			continue;
+		auto laps_it = cs.laps.find(i + 1);
+		if(laps_it == cs.laps.end())
+			continue;
+		auto lap_it = laps_it->second.find(lap);
+		if(lap_it != laps_it->second.end())
+			laps_it->second.erase(lap_it);
+	}
+	cs.runs.erase(it);
+}
+
+}
@@ -0,0 +1,72 @@
+#ifndef RUNS_STANDINGSSERVICE_H
+#define RUNS_STANDINGSSERVICE_H
+
+#include "../runspluginglobal.h"
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include <QVariantList>
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace Runs {
+
+/// In-process index of stage/class standings.
+/// Class data are loaded lazily on first query and then kept up to date
+/// per run from card read db events, so queries do not touch SQL.
+class RUNSPLUGIN_DECL_EXPORT StandingsService : public QObject
+{
+	Q_OBJECT
+private:
+	typedef QObject Super;
+public:
+	StandingsService(QObject *parent = nullptr);
+
+	/// number of not disqualified finishers with time <= time_ms
+	int standingsForTime(int stage_id, int class_id, int time_ms);
+	/// number of runs with finish time, disqualified included
+	int finishedCount(int stage_id, int class_id);
+	/// position -> best lap time in class
+	QMap<int, int> bestLaps(int stage_id, int class_id);
+	int bestLap(int stage_id, int class_id, int position);
+	bool containsRun(int stage_id, int class_id, int run_id);
+
+	/// reload single run from SQL, does nothing if run's class is not loaded yet
+	void updateRun(int run_id);
+	Q_SLOT void clear();
+
+	/// update runs of read cards, card ids are merged DBEVENT_CARD_READ payloads
+	void onCardsRead(const QVariantList &card_ids);
+private:
+	struct RunEntry
+	{
+		int timeMs = 0;
+		bool finished = false;
+		bool ok = false;
+		QVector<int> laps; //< index is position - 1
+	};
+	struct ClassStandings
+	{
+		QHash<int, RunEntry> runs;
+		std::vector<int> okTimes; //< sorted
+		int finishedCount = 0;
+		std::map<int, std::multiset<int>> laps; //< position -> lap times
+	};
+	static qint64 classKey(int stage_id, int class_id) {return (((qint64)stage_id) << 32) | (quint32)class_id;}
+
+	ClassStandings& classStandings(int stage_id, int class_id);
+	void loadClassStandings(ClassStandings &cs, int stage_id, int class_id);
+	static void addRun(ClassStandings &cs, int run_id, const RunEntry &entry);
+	static void removeRun(ClassStandings &cs, int run_id);
+private:
+	QHash<qint64, ClassStandings> m_classStandings;
+	QHash<int, qint64> m_runClassKeys;
+};
+
+}
+
+#endif // RUNS_STANDINGSSERVICE_H
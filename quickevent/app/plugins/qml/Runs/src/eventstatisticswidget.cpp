@@ -4,6 +4,7 @@
 #include "eventstatisticsoptions.h"
 
 #include "Runs/runsplugin.h"
+#include "Runs/eventstatistics.h"
 
 #include <Event/eventplugin.h>
 
@@ -11,13 +12,13 @@
 #include <quickevent/og/timems.h>
 #include <quickevent/reportoptionsdialog.h>
 
-#include <qf/core/sql/querybuilder.h>
+#include <qf/core/exception.h>
+#include <qf/core/sql/query.h>
 #include <qf/qmlwidgets/framework/mainwindow.h>
 #include <qf/qmlwidgets/reports/widgets/reportviewwidget.h>
 
 #include <qf/core/assert.h>
 
-#include <QElapsedTimer>
 #include <QSettings>
 #include <QTimer>
 
@@ -26,18 +27,12 @@ namespace qfu = qf::core::utils;
 
 static Event::EventPlugin* eventPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Event::EventPlugin*>(fwk->plugin("Event"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad Event plugin!");
-	return plugin;
+	return qf::qmlwidgets::framework::MainWindow::cachedPlugin<Event::EventPlugin>();
 }
 
 static Runs::RunsPlugin* runsPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Runs::RunsPlugin *>(fwk->plugin("Runs"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad Runs plugin!");
-	return plugin;
+	return qf::qmlwidgets::framework::MainWindow::cachedPlugin<Runs::RunsPlugin>();
 }
 
 //============================================================
@@ -64,14 +59,44 @@ public:
 		col_COUNT
 	};
 public:
-	EventStatisticsModel(QObject *parent);
+	EventStatisticsModel(Runs::EventStatistics *statistics, QObject *parent);
 
 	QVariant data(const QModelIndex &index, int role) const Q_DECL_OVERRIDE;
 	QVariant value(int row_ix, int column_ix) const Q_DECL_OVERRIDE;
+
+	/// update counters of class row without model reset
+	void updateClass(int class_id);
+protected:
+	/// rows are filled from in-memory statistics, no query is executed
+	bool reloadTable(const QString &query_str) Q_DECL_OVERRIDE;
+private:
+	enum TableFields {
+		fld_classes_id,
+		fld_classes_name,
+		fld_classdefs_id,
+		fld_classdefs_mapCount,
+		fld_classdefs_resultsCount,
+		fld_classdefs_resultsPrintTS,
+		fld_runnersCount,
+		fld_runnersFinished,
+		fld_startFirstMs,
+		fld_startLastMs,
+		fld_time1Ms,
+		fld_time3Ms,
+		fld_freeMapCount,
+		fld_timeToCloseMs,
+		fld_runnersNotFinished,
+		fld_resultsNotPrinted,
+		fld_resultsNotPrintedSec,
+	};
+	static void setRowCounters(qfu::TableRow &row, const Runs::EventStatistics::ClassCounters &cc);
+private:
+	Runs::EventStatistics *m_statistics;
 };
 
-EventStatisticsModel::EventStatisticsModel(QObject *parent)
+EventStatisticsModel::EventStatisticsModel(Runs::EventStatistics *statistics, QObject *parent)
 	: Super(parent)
+	, m_statistics(statistics)
 {
 	clearColumns(col_COUNT);
 	setColumn(col_className, ColumnDefinition("classes.name", tr("Class")));
@@ -90,68 +115,69 @@ EventStatisticsModel::EventStatisticsModel(QObject *parent)
 			  .setToolTip(tr("Time since recent results printout."))
 			  .setCastType(qMetaTypeId<quickevent::og::TimeMs>())
 			  );
-	{
-		static const auto competiting_cond = QStringLiteral("runs.stageId={{stage_id}} AND runs.isRunning AND competitors.classId=classes.id");
-		qf::core::sql::QueryBuilder qb_runners_count;
-		qb_runners_count.select("COUNT(runs.id)")
-				.from("runs").joinRestricted("runs.competitorId", "competitors.id", competiting_cond, qf::core::sql::QueryBuilder::INNER_JOIN);
-		qf::core::sql::QueryBuilder qb_runners_finished;
-		qb_runners_finished.select("COUNT(runs.id)")
-				.from("runs").joinRestricted("runs.competitorId", "competitors.id", competiting_cond, qf::core::sql::QueryBuilder::INNER_JOIN)
-				.where("runs.finishTimeMs > 0 OR runs.disqualified");
-		qf::core::sql::QueryBuilder qb_runners_start_first;
-		qb_runners_start_first.select("MIN(runs.startTimeMs)")
-				.from("runs").joinRestricted("runs.competitorId", "competitors.id", competiting_cond, qf::core::sql::QueryBuilder::INNER_JOIN)
-				.where("runs.startTimeMs IS NOT NULL");
-		qf::core::sql::QueryBuilder qb_runners_start_last;
-		qb_runners_start_last.select("MAX(runs.startTimeMs)")
-				.from("runs").joinRestricted("runs.competitorId", "competitors.id", competiting_cond, qf::core::sql::QueryBuilder::INNER_JOIN)
-				.where("runs.startTimeMs IS NOT NULL");
-		static const auto in_results_cond = competiting_cond + QStringLiteral(" AND runs.timeMs>0 AND NOT runs.disqualified");
-		qf::core::sql::QueryBuilder qb_first_time;
-		{
-			qf::core::sql::QueryBuilder qb;
-			qb.select("runs.timeMs")
-				.from("runs").joinRestricted("runs.competitorId", "competitors.id", in_results_cond, qf::core::sql::QueryBuilder::INNER_JOIN)
-				.orderBy("runs.timeMs")
-				.limit(1)
-				.as("results1");
-			qb_first_time.select("MAX(timeMs)")
-					.from(qb.toString());
-		}
-		qf::core::sql::QueryBuilder qb_third_time;
-		{
-			qf::core::sql::QueryBuilder qb;
-			qb.select("runs.timeMs")
-				.from("runs").joinRestricted("runs.competitorId", "competitors.id", in_results_cond, qf::core::sql::QueryBuilder::INNER_JOIN)
-				.orderBy("runs.timeMs")
-				.limit(3)
-				.as("results3");
-			qb_third_time.select("MAX(timeMs)")//.select("COUNT(timeMs) AS count3")
-					.from(qb.toString());
-		}
+}
 
-		qf::core::sql::QueryBuilder qb;
-		qb.select2("classes", "*")
-				.select2("classdefs", "*")
-				.select("(" + qb_runners_count.toString() + ") AS runnersCount")
-				.select("(" + qb_runners_finished.toString() + ") AS runnersFinished")
-				.select("(" + qb_runners_start_first.toString() + ") AS startFirstMs")
-				.select("(" + qb_runners_start_last.toString() + ") AS startLastMs")
-				.select("(" + qb_first_time.toString() + ") AS time1Ms")
-				.select("(" + qb_third_time.toString() + ") AS time3Ms")
-				.select("0 AS timeToCloseMs")
-				.select("0 AS freeMapCount")
-				.select("0 AS runnersNotFinished")
-				.select("0 AS resultsNotPrinted")
-				.select("0 AS resultsNotPrintedSec")
-				.from("classes")
-				.joinRestricted("classes.id", "classdefs.classId", "classdefs.stageId={{stage_id}}")
-				//.join("classes.id", "competitors.classId")
-				//.joinRestricted("competitors.id", "runs.competitorId", "runs.stageId={{stage_id}}")
-				//.groupBy("classes.id")
-				.orderBy("classes.name");
-		setQueryBuilder(qb, false);
+bool EventStatisticsModel::reloadTable(const QString &query_str)
+{
+	Q_UNUSED(query_str)
+	qfu::Table::FieldList fields;
+	fields << qfu::Table::Field("classes.id", QVariant::Int);
+	fields << qfu::Table::Field("classes.name", QVariant::String);
+	fields << qfu::Table::Field("classdefs.id", QVariant::Int);
+	fields << qfu::Table::Field("classdefs.mapCount", QVariant::Int);
+	fields << qfu::Table::Field("classdefs.resultsCount", QVariant::Int);
+	fields << qfu::Table::Field("classdefs.resultsPrintTS", QVariant::DateTime);
+	fields << qfu::Table::Field("runnersCount", QVariant::Int);
+	fields << qfu::Table::Field("runnersFinished", QVariant::Int);
+	fields << qfu::Table::Field("startFirstMs", QVariant::Int);
+	fields << qfu::Table::Field("startLastMs", QVariant::Int);
+	fields << qfu::Table::Field("time1Ms", QVariant::Int);
+	fields << qfu::Table::Field("time3Ms", QVariant::Int);
+	fields << qfu::Table::Field("freeMapCount", QVariant::Int);
+	fields << qfu::Table::Field("timeToCloseMs", QVariant::Int);
+	fields << qfu::Table::Field("runnersNotFinished", QVariant::Int);
+	fields << qfu::Table::Field("resultsNotPrinted", QVariant::Int);
+	fields << qfu::Table::Field("resultsNotPrintedSec", QVariant::Int);
+	m_table = qfu::Table(fields);
+	for(int class_id : m_statistics->classIds()) {
+		qfu::TableRow &row = m_table.appendRow();
+		row.setInsert(false);
+		setRowCounters(row, m_statistics->classCounters(class_id));
+	}
+	return true;
+}
+
+void EventStatisticsModel::setRowCounters(qfu::TableRow &row, const Runs::EventStatistics::ClassCounters &cc)
+{
+	row.setBareBoneValue(fld_classes_id, cc.classId());
+	row.setBareBoneValue(fld_classes_name, cc.className());
+	row.setBareBoneValue(fld_classdefs_id, cc.classdefsId());
+	row.setBareBoneValue(fld_classdefs_mapCount, cc.mapCount());
+	row.setBareBoneValue(fld_classdefs_resultsCount, cc.resultsCount());
+	row.setBareBoneValue(fld_classdefs_resultsPrintTS, cc.resultsPrintTS());
+	row.setBareBoneValue(fld_runnersCount, cc.runnersCount());
+	row.setBareBoneValue(fld_runnersFinished, cc.runnersFinished());
+	row.setBareBoneValue(fld_startFirstMs, cc.hasStartTimes()? QVariant(cc.startFirstMs()): QVariant(QVariant::Int));
+	row.setBareBoneValue(fld_startLastMs, cc.hasStartTimes()? QVariant(cc.startLastMs()): QVariant(QVariant::Int));
+	row.setBareBoneValue(fld_time1Ms, cc.hasResultTimes()? QVariant(cc.resultTimeMs(1)): QVariant(QVariant::Int));
+	row.setBareBoneValue(fld_time3Ms, cc.hasResultTimes()? QVariant(cc.resultTimeMs(3)): QVariant(QVariant::Int));
+	row.setBareBoneValue(fld_freeMapCount, 0);
+	row.setBareBoneValue(fld_timeToCloseMs, 0);
+	row.setBareBoneValue(fld_runnersNotFinished, 0);
+	row.setBareBoneValue(fld_resultsNotPrinted, 0);
+	row.setBareBoneValue(fld_resultsNotPrintedSec, 0);
+}
+
+void EventStatisticsModel::updateClass(int class_id)
+{
+	/// there are tens of classes, rows can be sorted by view
+	for (int i = 0; i < rowCount(); ++i) {
+		qfu::TableRow &row = m_table.rowRef(i);
+		if(row.value(fld_classes_id).toInt() == class_id) {
+			setRowCounters(row, m_statistics->classCounters(class_id));
+			emit dataChanged(index(i, 0), index(i, columnCount() - 1));
+			return;
+		}
 	}
 }
 
@@ -176,12 +202,12 @@ QVariant EventStatisticsModel::value(int row_ix, int column_ix) const
 		return cnt;
 	}
 	else if(column_ix == col_resultsNotPrinted) {
-		int results_count = tableRow(row_ix).value(QStringLiteral("resultsCount")).toInt();
+		int results_count = tableRow(row_ix).value(fld_classdefs_resultsCount).toInt();
 		int cnt = value(row_ix, col_runnersFinished).toInt() - results_count;
 		return cnt;
 	}
 	else if(column_ix == col_resultsNotPrintedSec) {
-		QDateTime dt1 = tableRow(row_ix).value(QStringLiteral("resultsPrintTS")).toDateTime();
+		QDateTime dt1 = tableRow(row_ix).value(fld_classdefs_resultsPrintTS).toDateTime();
 		QDateTime dt2 = QDateTime::currentDateTime();
 		if(!dt1.isValid())
 			return QVariant{QVariant::Int};
@@ -279,6 +305,7 @@ void FooterModel::setMasterModel(qf::core::model::TableModel *masterModel)
 {
 	m_masterModel = masterModel;
 	connect(m_masterModel, &qf::core::model::SqlTableModel::reloaded, this, &FooterModel::reload);
+	connect(m_masterModel, &qf::core::model::SqlTableModel::dataChanged, this, &FooterModel::reload);
 }
 
 void FooterModel::reload()
@@ -397,7 +424,14 @@ EventStatisticsWidget::EventStatisticsWidget(QWidget *parent)
 			autoRefreshTimer()->stop();
 	});
 
-	connect(eventPlugin(), &Event::EventPlugin::dbEventNotify, this, &EventStatisticsWidget::onDbEventNotify, Qt::QueuedConnection);
+	{
+		Runs::EventStatistics *statistics = runsPlugin()->eventStatistics();
+		connect(statistics, &Runs::EventStatistics::classChanged, this, [this](int class_id) {
+			if(m_tableModel)
+				m_tableModel->updateClass(class_id);
+		});
+		connect(statistics, &Runs::EventStatistics::reloaded, this, &EventStatisticsWidget::reloadLater);
+	}
 	connect(eventPlugin(), &Event::EventPlugin::currentStageIdChanged, this, &EventStatisticsWidget::reload);
 }
 
@@ -428,8 +462,18 @@ void EventStatisticsWidget::reload()
 	if(stage_id == 0)
 		return;
 
+	Runs::EventStatistics *statistics = runsPlugin()->eventStatistics();
+	if(statistics->stageId() != stage_id) {
+		try {
+			statistics->loadStage(stage_id);
+		}
+		catch (const qf::core::Exception &e) {
+			qfError() << "Load event statistics error:" << e.message();
+			return;
+		}
+	}
 	if(!m_tableModel) {
-		m_tableModel = new EventStatisticsModel(this);
+		m_tableModel = new EventStatisticsModel(statistics, this);
 		m_tableFooterModel = new FooterModel(this);
 		m_tableFooterModel->setMasterModel(m_tableModel);
 
@@ -440,26 +484,10 @@ void EventStatisticsWidget::reload()
 		// when loadPersistentSettingsRecursively was called by framework
 		ui->tableView->loadPersistentSettings();
 	}
-	QVariantMap qm;
-	qm[QStringLiteral("stage_id")] = currentStageId();
-	m_tableModel->setQueryParameters(qm);
-	QElapsedTimer tm;
-	tm.start();
 	m_tableModel->reload();
-	qfDebug() << m_tableModel->effectiveQuery();
-	qfDebug() << "query execution time:" << tm.elapsed() << "msec";
 	QTimer::singleShot(10, m_tableFooterView, &FooterView::syncSectionSizes);
 }
 
-void EventStatisticsWidget::onDbEventNotify(const QString &domain, const QVariant &payload)
-{
-	Q_UNUSED(payload)
-	if(domain == QLatin1String(Event::EventPlugin::DBEVENT_CARD_READ)
-	   || domain == QLatin1String(Event::EventPlugin::DBEVENT_COMPETITOR_COUNTS_CHANGED)) {
-		reloadLater();
-	}
-}
-
 void EventStatisticsWidget::onVisibleChanged(bool is_visible)
 {
 	Q_UNUSED(is_visible)
@@ -496,6 +524,8 @@ QTimer *EventStatisticsWidget::autoRefreshTimer()
 void EventStatisticsWidget::on_btReload_clicked()
 {
 	qfLogFuncFrame();
+	/// load stage statistics from SQL again
+	runsPlugin()->eventStatistics()->clear();
 	reload();
 }
 
@@ -511,11 +541,13 @@ void EventStatisticsWidget::printResultsForRows(const QList<int> &rows)
 {
 	qfLogFuncFrame() << rows;
 	QStringList class_names;
+	QList<int> class_ids;
 	QList<int> classdefs_ids;
 	QList<int> runners_finished;
 	for(int i : rows) {
 		qf::core::utils::TableRow row = m_tableModel->tableRow(i);
 		class_names << row.value(QStringLiteral("classes.name")).toString();
+		class_ids << row.value(QStringLiteral("classes.id")).toInt();
 		classdefs_ids << row.value(QStringLiteral("classdefs.id")).toInt();
 		runners_finished << row.value(QStringLiteral("runnersFinished")).toInt();
 	}
@@ -550,14 +582,14 @@ void EventStatisticsWidget::printResultsForRows(const QList<int> &rows)
 								, props
 								);
 	if(report_printed) {
-		clearNewResults(classdefs_ids, runners_finished);
-		reload();
+		clearNewResults(class_ids, classdefs_ids, runners_finished);
 	}
 }
 
 void EventStatisticsWidget::on_btClearNewInSelectedRows_clicked()
 {
 	qfLogFuncFrame();
+	QList<int> class_ids;
 	QList<int> classdefs_ids;
 	QList<int> runners_finished;
 	QList<int> sel_rows = ui->tableView->selectedRowsIndexes();
@@ -567,25 +599,28 @@ void EventStatisticsWidget::on_btClearNewInSelectedRows_clicked()
 	for(int i : sel_rows) {
 		qf::core::utils::TableRow row = ui->tableView->tableRow(i);
 		//class_names << row.value(QStringLiteral("classes.name")).toString();
+		class_ids << row.value(QStringLiteral("classes.id")).toInt();
 		classdefs_ids << row.value(QStringLiteral("classdefs.id")).toInt();
 		runners_finished << row.value(QStringLiteral("runnersFinished")).toInt();
 	}
-	clearNewResults(classdefs_ids, runners_finished);
-	reload();
+	clearNewResults(class_ids, classdefs_ids, runners_finished);
 }
 
-void EventStatisticsWidget::clearNewResults(const QList<int> &classdefs_ids, const QList<int> &runners_finished)
+void EventStatisticsWidget::clearNewResults(const QList<int> &class_ids, const QList<int> &classdefs_ids, const QList<int> &runners_finished)
 {
 	qfLogFuncFrame();
 	QString qs = "UPDATE classdefs SET resultsCount=:resultsCount, resultsPrintTS=:resultsPrintTS WHERE id=:id";
 	qf::core::sql::Query q;
 	q.prepare(qs, qf::core::Exception::Throw);
+	QDateTime print_ts = QDateTime::currentDateTime();
+	Runs::EventStatistics *statistics = runsPlugin()->eventStatistics();
 	for (int i = 0; i < classdefs_ids.count(); ++i) {
 		qfDebug() << classdefs_ids[i] << runners_finished[i];
 		q.bindValue(":resultsCount", runners_finished[i]);
-		q.bindValue(":resultsPrintTS", QDateTime::currentDateTime());
+		q.bindValue(":resultsPrintTS", print_ts);
 		q.bindValue(":id", classdefs_ids[i]);
 		q.exec(qf::core::Exception::Throw);
+		statistics->setResultsPrinted(class_ids[i], runners_finished[i], print_ts);
 	}
 }
 
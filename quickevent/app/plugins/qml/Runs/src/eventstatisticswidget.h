@@ -22,7 +22,6 @@ public:
 
 	Q_SLOT void reloadLater();
 	void reload();
-	Q_SLOT void onDbEventNotify(const QString &domain, const QVariant &payload);
 	Q_SLOT void onVisibleChanged(bool is_visible);
 
 	Q_SLOT void loadPersistentSettings();
@@ -37,7 +36,7 @@ private:
 	int currentStageId();
 	QTimer* autoRefreshTimer();
 	//QTimer* printResultsTimer();
-	void clearNewResults(const QList<int> &classdefs_ids, const QList<int> &runners_finished);
+	void clearNewResults(const QList<int> &class_ids, const QList<int> &classdefs_ids, const QList<int> &runners_finished);
 
 	QVariantMap options();
 	void printResultsForRows(const QList<int> &rows);
@@ -10,10 +10,7 @@
 
 static Event::EventPlugin* eventPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Event::EventPlugin*>(fwk->plugin("Event"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad event plugin!");
-	return plugin;
+	return qf::qmlwidgets::framework::MainWindow::cachedPlugin<Event::EventPlugin>();
 }
 
 RunsTableDialogWidget::RunsTableDialogWidget(QWidget *parent) :
@@ -1,5 +1,11 @@
 #include "runstablemodel.h"
 #include "Runs/runsplugin.h"
+#include "Runs/standingsservice.h"
+#include "Runs/resultssnapshot.h"
+#include "Runs/eventstatistics.h"
+
+#include <Event/eventplugin.h>
+#include <Event/competitortotals.h>
 
 #include <quickevent/og/timems.h>
 #include <quickevent/si/siid.h>
@@ -11,12 +17,14 @@
 
 #include <QMimeData>
 
+static Event::EventPlugin* eventPlugin()
+{
+	return qf::qmlwidgets::framework::MainWindow::cachedPlugin<Event::EventPlugin>();
+}
+
 static Runs::RunsPlugin *runsPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Runs::RunsPlugin *>(fwk->plugin("Runs"));
-	QF_ASSERT(plugin != nullptr, "Runs plugin not installed!", return nullptr);
-	return plugin;
+	return qf::qmlwidgets::framework::MainWindow::cachedPlugin<Runs::RunsPlugin>();
 }
 
 RunsTableModel::RunsTableModel(QObject *parent)
@@ -265,10 +273,56 @@ void RunsTableModel::onDataChanged(const QModelIndex &top_left, const QModelInde
 }
 
 bool RunsTableModel::postRow(int row_no, bool throw_exc)
+{
+	int run_id = value(row_no, col_runs_id).toInt();
+	bool ret = postRow_helper(row_no, throw_exc);
+	if(ret) {
+		runsPlugin()->standingsService()->updateRun(run_id);
+		runsPlugin()->resultsSnapshot()->updateRun(run_id);
+		runsPlugin()->eventStatistics()->updateRun(run_id);
+		emit runsPlugin()->runEdited(run_id);
+	}
+	return ret;
+}
+
+bool RunsTableModel::postRunRow(int row_no, bool throw_exc)
+{
+	/// start time change reloads times from card
+	bool totals_dirty = isDirty(row_no, col_runs_isRunning)
+			|| isDirty(row_no, col_runs_startTimeMs)
+			|| isDirty(row_no, col_runs_timeMs)
+			|| isDirty(row_no, col_runs_finishTimeMs)
+			|| isDirty(row_no, col_runs_notCompeting)
+			|| isDirty(row_no, col_runs_disqualified);
+	if(!totals_dirty)
+		return Super::postRow(row_no, throw_exc);
+	int run_id = value(row_no, col_runs_id).toInt();
+	/// run and competitor totals are written in one transaction, edit fails if totals cannot be updated
+	qf::core::sql::Transaction transaction(sqlConnection());
+	if(!Super::postRow(row_no, throw_exc))
+		return false;
+	try {
+		Event::CompetitorTotals totals(sqlConnection(), eventPlugin()->stageCount());
+		totals.updateRuns(QList<int>() << run_id);
+		transaction.commit();
+	}
+	catch (const qf::core::Exception &e) {
+		transaction.rollback();
+		/// model row is already posted, show values which are really in database
+		reloadRow(row_no);
+		if(throw_exc)
+			throw;
+		qfError() << "Update competitor totals error, run edit rolled back:" << e.message();
+		return false;
+	}
+	return true;
+}
+
+bool RunsTableModel::postRow_helper(int row_no, bool throw_exc)
 {
 	bool is_single_user = sqlConnection().driverName().endsWith(QLatin1String("SQLITE"), Qt::CaseInsensitive);
 	if(is_single_user)
-		return Super::postRow(row_no, throw_exc);
+		return postRunRow(row_no, throw_exc);
 
 	if(isDirty(row_no, col_runs_startTimeMs)) {
 		int run_id = value(row_no, col_runs_id).toInt();
@@ -283,7 +337,7 @@ bool RunsTableModel::postRow(int row_no, bool throw_exc)
 			db_msec = q.value("startTimeMs").toInt();
 		}
 		if(orig_msec == db_msec) {
-			bool ret = Super::postRow(row_no, throw_exc);
+			bool ret = postRunRow(row_no, throw_exc);
 			//transaction.commit();
 			QVariant v = value(row_no, col_runs_finishTimeMs);
 			if(!v.isNull()) {
@@ -300,6 +354,6 @@ bool RunsTableModel::postRow(int row_no, bool throw_exc)
 			return false;
 		}
 	}
-	return Super::postRow(row_no, throw_exc);
+	return postRunRow(row_no, throw_exc);
 }
 
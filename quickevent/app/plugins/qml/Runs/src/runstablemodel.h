@@ -60,6 +60,9 @@ public:
 	Q_SIGNAL void badDataInput(const QString &message);
 private:
 	void onDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right, const QVector<int> &roles);
+	bool postRow_helper(int row_no, bool throw_exc);
+	/// post row and update competitor totals in one transaction
+	bool postRunRow(int row_no, bool throw_exc);
 };
 
 #endif // RUNSTABLEMODEL_H
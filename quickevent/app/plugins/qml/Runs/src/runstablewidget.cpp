@@ -31,27 +31,17 @@ namespace qfm = qf::core::model;
 
 static Event::EventPlugin* eventPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Event::EventPlugin*>(fwk->plugin("Event"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad event plugin!");
-	return plugin;
+	return qff::MainWindow::cachedPlugin<Event::EventPlugin>();
 }
 
 static Runs::RunsPlugin *runsPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Runs::RunsPlugin *>(fwk->plugin("Runs"));
-	QF_ASSERT(plugin != nullptr, "Runs plugin not installed!", return nullptr);
-	return plugin;
+	return qff::MainWindow::cachedPlugin<Runs::RunsPlugin>();
 }
 
 static Competitors::CompetitorsPlugin *competitorsPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Competitors::CompetitorsPlugin *>(fwk->plugin("Competitors"));
-	if(plugin == nullptr)
-		QF_EXCEPTION("Competitors plugin not installed!");
-	return plugin;
+	return qff::MainWindow::cachedPlugin<Competitors::CompetitorsPlugin>();
 }
 
 RunsTableWidget::RunsTableWidget(QWidget *parent) :
@@ -314,6 +304,7 @@ void RunsTableWidget::onCustomContextMenuRequest(const QPoint &pos)
 					q.exec(qf::core::Exception::Throw);
 				}
 				transaction.commit();
+				runsPlugin()->onStartTimesChanged();
 				runsModel()->reload();
 			}
 		}
@@ -335,6 +326,7 @@ void RunsTableWidget::onCustomContextMenuRequest(const QPoint &pos)
 				q.exec(qf::core::Exception::Throw);
 			}
 			transaction.commit();
+			runsPlugin()->onStartTimesChanged();
 			runsModel()->reload();
 		}
 		catch (const qf::core::Exception &e) {
@@ -42,18 +42,12 @@ namespace qfm = qf::core::model;
 
 static Event::EventPlugin *eventPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Event::EventPlugin *>(fwk->plugin("Event"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad plugin");
-	return plugin;
+	return qff::MainWindow::cachedPlugin<Event::EventPlugin>();
 }
 
 static Runs::RunsPlugin *runsPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Runs::RunsPlugin *>(fwk->plugin("Runs"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad plugin");
-	return plugin;
+	return qff::MainWindow::cachedPlugin<Runs::RunsPlugin>();
 }
 
 RunsWidget::RunsWidget(QWidget *parent) :
@@ -394,6 +388,7 @@ void RunsWidget::import_start_times_ob2000()
 					}
 				}
 				transaction.commit();
+				runsPlugin()->onStartTimesChanged();
 			}
 			catch (const qf::core::Exception &e) {
 				qf::qmlwidgets::dialogs::MessageBox::showException(this, e);
@@ -697,6 +692,7 @@ void RunsWidget::on_btDraw_clicked()
 			}
 		}
 		transaction.commit();
+		runsPlugin()->onStartTimesChanged();
 	}
 	catch (const qf::core::Exception &e) {
 		qf::qmlwidgets::dialogs::MessageBox::showException(this, e);
@@ -723,6 +719,7 @@ void RunsWidget::on_btDrawRemove_clicked()
 		int stage_id = selectedStageId();
 		saveLockedForDrawing(class_id, stage_id, false, 0);
 		transaction.commit();
+		runsPlugin()->onStartTimesChanged();
 		runs_model->reload();
 	}
 	catch (const qf::core::Exception &e) {
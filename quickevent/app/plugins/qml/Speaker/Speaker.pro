@@ -13,12 +13,14 @@ DEFINES += SPEAKERPLUGIN_BUILD_DLL
 INCLUDEPATH += \
     $$PWD/../../../../lib/include \
     $$PWD/../Event/include \
+    $$PWD/../Runs/include \
 
 LIBS += -lquickevent
 
 LIBS += \
     -L$$DESTDIR \
     -lEventplugin \
+    -lRunsplugin \
 
 include (src/src.pri)
 
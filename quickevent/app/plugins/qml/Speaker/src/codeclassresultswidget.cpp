@@ -2,6 +2,9 @@
 #include "ui_codeclassresultswidget.h"
 
 #include "Event/eventplugin.h"
+#include "Event/dbeventbus.h"
+#include "Runs/runsplugin.h"
+#include "Runs/standingsservice.h"
 
 #include <quickevent/og/sqltablemodel.h>
 #include <quickevent/og/timems.h>
@@ -27,10 +30,12 @@ namespace qfm = qf::core::model;
 
 static Event::EventPlugin* eventPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Event::EventPlugin*>(fwk->plugin("Event"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad Event plugin!");
-	return plugin;
+	return qff::MainWindow::cachedPlugin<Event::EventPlugin>();
+}
+
+static Runs::RunsPlugin* runsPlugin()
+{
+	return qff::MainWindow::cachedPlugin<Runs::RunsPlugin>();
 }
 
 CodeClassResultsWidget::CodeClassResultsWidget(QWidget *parent)
@@ -47,6 +52,8 @@ CodeClassResultsWidget::CodeClassResultsWidget(QWidget *parent)
 	m->addColumn("competitorName", tr("Competitor"));
 	m->addColumn("competitors.registration", tr("Reg"));//.setReadOnly(true);
 	m->addColumn("timeMs", tr("Time")).setCastType(qMetaTypeId<quickevent::og::TimeMs>());
+	/// punch rows are inserted by punches.id, competitors.id is not selected
+	m->setIncludeJoinedTablesIdsToReloadRowQuery(true);
 	ui->tblView->setTableModel(m);
 	m_tableModel = m;
 }
@@ -76,6 +83,7 @@ void CodeClassResultsWidget::reload()
 	int stage_id = eventPlugin()->currentStageId();
 	int class_id = this->ui->lstClass->currentData().toInt();
 	int code = (m_pinnedToCode == ALL_CODES)? ui->lstCode->currentData().toInt(): m_pinnedToCode;
+	subscribePunches(code);
 	if(class_id == 0 || code == 0) {
 		m_tableModel->clearRows();
 		return;
@@ -109,7 +117,7 @@ void CodeClassResultsWidget::reload()
 	}
 	*/
 	else {
-		qb.select2("punches", "runTimeMs AS timeMs")
+		qb.select2("punches", "id, runTimeMs AS timeMs")
 				.from("punches")
 				.joinRestricted("punches.runId", "runs.id",
 								"punches.stageId=" QF_IARG(stage_id)
@@ -124,12 +132,69 @@ void CodeClassResultsWidget::reload()
 	m_tableModel->reload();
 }
 
-void CodeClassResultsWidget::onPunchReceived(const quickevent::si::PunchRecord &punch)
+void CodeClassResultsWidget::subscribePunches(int code)
+{
+	if(code == m_subscribedCode)
+		return;
+	Event::DbEventBus *bus = eventPlugin()->dbEventBus();
+	bus->unsubscribe(Event::EventPlugin::DBEVENT_PUNCH_RECEIVED, this);
+	m_subscribedCode = code;
+	if(code > 0) {
+		bus->subscribe(Event::EventPlugin::DBEVENT_PUNCH_RECEIVED, code, this, [this](const QVariantList &punches) {
+			onPunchesReceived(punches);
+		});
+	}
+}
+
+void CodeClassResultsWidget::onPunchesReceived(const QVariantList &punches)
+{
+	const int code = m_subscribedCode;
+	if(code == RESULTS_PUNCH_CODE)
+		return;
+	int stage_id = eventPlugin()->currentStageId();
+	int class_id = this->ui->lstClass->currentData().toInt();
+	if(class_id == 0)
+		return;
+	Runs::StandingsService *standings = runsPlugin()->standingsService();
+	for(const QVariant &v : punches) {
+		quickevent::si::PunchRecord punch(v.toMap());
+		if(punch.code() != code || punch.siid() <= 0 || punch.marking() != quickevent::si::PunchRecord::MARKING_RACE)
+			continue;
+		if(punch.stageid() > 0 && punch.stageid() != stage_id)
+			continue;
+		/// punches without run or of runners from other classes are not listed
+		if(punch.runid() <= 0 || !standings->containsRun(stage_id, class_id, punch.runid()))
+			continue;
+		if(!insertPunchRow(punch.id())) {
+			reload();
+			return;
+		}
+	}
+}
+
+bool CodeClassResultsWidget::insertPunchRow(int punch_id)
 {
-	int code = this->ui->lstCode->currentData().toInt();
-	if(code > 0 && punch.code() == code) {
-		reload();
+	if(punch_id <= 0)
+		return false;
+	qf::core::sql::Query q;
+	if(!q.exec("SELECT runTimeMs FROM punches WHERE id=" QF_IARG(punch_id)) || !q.next() || q.value(0).isNull())
+		return false;
+	const int time_ms = q.value(0).toInt();
+	int lo = 0, hi = m_tableModel->rowCount();
+	while(lo < hi) {
+		int mid = (lo + hi) / 2;
+		if(m_tableModel->tableRow(mid).value(QStringLiteral("timeMs")).toInt() <= time_ms)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	m_tableModel->insertRows(lo, 1);
+	m_tableModel->tableRowRef(lo).setValue(QStringLiteral("punches.id"), punch_id);
+	if(m_tableModel->reloadRow(lo) != 1) {
+		qfWarning() << "Inserted punch id:" << punch_id << "cannot be reloaded";
+		return false;
 	}
+	return true;
 }
 
 void CodeClassResultsWidget::reset(int class_id, int code, int pin_to_code)
@@ -7,7 +7,6 @@ class QJsonObject;
 
 namespace quickevent {
 namespace og { class SqlTableModel; }
-namespace si { class PunchRecord; }
 }
 
 namespace Ui {
@@ -25,7 +24,6 @@ public:
 
 	void reloadDeferred();
 	void reload();
-	void onPunchReceived(const quickevent::si::PunchRecord &punch);
 
 	static constexpr int ALL_CODES = 0;
 	static constexpr int RESULTS_PUNCH_CODE = 1000;
@@ -35,11 +33,18 @@ public:
 	QJsonObject saveSetup();
 protected:
 	//void dropEvent(QDropEvent *event) Q_DECL_OVERRIDE;
+private:
+	/// subscribe DbEventBus punches of code only
+	void subscribePunches(int code);
+	void onPunchesReceived(const QVariantList &punches);
+	/// insert punch row at position of its run time, rows are sorted by time
+	bool insertPunchRow(int punch_id);
 private:
 	Ui::CodeClassResultsWidget *ui;
 	quickevent::og::SqlTableModel *m_tableModel = nullptr;
 	QTimer *m_reloadDeferredTimer = nullptr;
 	int m_pinnedToCode = ALL_CODES;
+	int m_subscribedCode = 0;
 };
 
 #endif // CODECLASSRESULTSWIDGET_H
@@ -7,6 +7,7 @@
 #include "Speaker/speakerplugin.h"
 
 #include "Event/eventplugin.h"
+#include "Event/dbeventbus.h"
 
 #include <quickevent/si/punchrecord.h>
 #include <quickevent/si/siid.h>
@@ -36,10 +37,7 @@ namespace qfm = qf::core::model;
 
 static Event::EventPlugin* eventPlugin()
 {
-	qf::qmlwidgets::framework::MainWindow *fwk = qf::qmlwidgets::framework::MainWindow::frameWork();
-	auto *plugin = qobject_cast<Event::EventPlugin*>(fwk->plugin("Event"));
-	QF_ASSERT_EX(plugin != nullptr, "Bad Event plugin!");
-	return plugin;
+	return qff::MainWindow::cachedPlugin<Event::EventPlugin>();
 }
 
 SpeakerWidget::SpeakerWidget(QWidget *parent) :
@@ -93,7 +91,9 @@ void SpeakerWidget::settleDownInPartWidget(ThisPartWidget *part_widget)
 	connect(part_widget, SIGNAL(resetPartRequest()), this, SLOT(reset()));
 	connect(part_widget, SIGNAL(reloadPartRequest()), this, SLOT(reload()));
 
-	connect(eventPlugin(), &Event::EventPlugin::dbEventNotify, this, &SpeakerWidget::onDbEventNotify, Qt::QueuedConnection);
+	eventPlugin()->dbEventBus()->subscribe(Event::EventPlugin::DBEVENT_PUNCH_RECEIVED, this, [this](const QVariantList &punches) {
+		onPunchesReceived(punches);
+	});
 	connect(eventPlugin(), &Event::EventPlugin::eventOpened, this, &SpeakerWidget::loadSettings, Qt::QueuedConnection);
 	/*
 	qfw::Action *a = part_widget->menuBar()->actionForPath("station", true);
@@ -121,19 +121,16 @@ void SpeakerWidget::settleDownInPartWidget(ThisPartWidget *part_widget)
 	*/
 }
 
-void SpeakerWidget::onDbEventNotify(const QString &domain, int connection_id, const QVariant &data)
+void SpeakerWidget::onPunchesReceived(const QVariantList &punches)
 {
-	Q_UNUSED(connection_id)
 	if(!isPartActive())
 		return;
-	qfLogFuncFrame() << "domain:" << domain << "payload:" << data;
-	if(domain == QLatin1String(Event::EventPlugin::DBEVENT_PUNCH_RECEIVED)) {
-		quickevent::si::PunchRecord punch(data.toMap());
+	qfLogFuncFrame() << "punches:" << punches.count();
+	for(const QVariant &v : punches) {
+		quickevent::si::PunchRecord punch(v.toMap());
 		int siid = punch.siid();
-		if(siid > 0 && punch.marking() == quickevent::si::PunchRecord::MARKING_RACE) {
+		if(siid > 0 && punch.marking() == quickevent::si::PunchRecord::MARKING_RACE)
 			updateTableView(punch.id());
-			emit punchReceived(punch);
-		}
 	}
 }
 
@@ -211,7 +208,6 @@ void SpeakerWidget::onCodeClassActivated(int class_id, int code)
 	w->reset(class_id, code);
 	//if(eventPlugin()->isEventOpen())
 	//	w->loadSetup(QJsonObject());
-	connect(this, &SpeakerWidget::punchReceived, w, &CodeClassResultsWidget::onPunchReceived);
 
 	QDockWidget *dw = new QDockWidget();
 	static int dock_widget_no = 0;
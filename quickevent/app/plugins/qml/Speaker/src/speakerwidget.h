@@ -14,7 +14,6 @@ class ForeignKeyComboBox;
 }
 
 namespace quickevent { namespace og { class SqlTableModel; }}
-namespace quickevent { namespace si { class PunchRecord; }}
 
 class ThisPartWidget;
 
@@ -29,13 +28,13 @@ public:
 
 	void settleDownInPartWidget(ThisPartWidget *part_widget);
 
-	void onDbEventNotify(const QString &domain, int connection_id, const QVariant &data);
-	Q_SIGNAL void punchReceived(const quickevent::si::PunchRecord &punch);
 private:
 	//Q_SLOT void lazyInit();
 	Q_SLOT void reset();
 	Q_SLOT void reload();
 
+	/// punch records merged by DbEventBus
+	void onPunchesReceived(const QVariantList &punches);
 	void updateTableView(int punch_id);
 
 	void loadSettings();
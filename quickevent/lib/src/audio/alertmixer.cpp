@@ -0,0 +1,96 @@
+#include "alertmixer.h"
+
+#include <qf/core/log.h>
+
+#include <QMutexLocker>
+
+#include <cstring>
+
+namespace quickevent {
+namespace audio {
+
+AlertMixer::AlertMixer(const QAudioFormat &format, QObject *parent)
+	: Super(parent)
+	, m_format(format)
+{
+	m_clock.start();
+}
+
+int AlertMixer::play(const QByteArray &pcm)
+{
+	if(pcm.isEmpty())
+		return 0;
+	QMutexLocker locker(&m_mutex);
+	if(m_voices.count() >= MaxVoices) {
+		qfWarning() << "Too many sounds playing, the oldest one is dropped.";
+		m_voices.removeFirst();
+	}
+	Voice v;
+	v.playId = ++m_lastPlayId;
+	v.pcm = pcm;
+	v.queuedNsec = m_clock.nsecsElapsed();
+	m_voices << v;
+	return v.playId;
+}
+
+int AlertMixer::activeCount() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_voices.count();
+}
+
+qint64 AlertMixer::latencyUsec(int play_id) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_latencies.value(play_id, -1);
+}
+
+qint64 AlertMixer::lastLatencyUsec() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_latencies.value(m_lastPlayId, -1);
+}
+
+qint64 AlertMixer::bytesAvailable() const
+{
+	/// stream is endless
+	return Super::bytesAvailable() + m_format.bytesForDuration(100 * 1000);
+}
+
+qint64 AlertMixer::readData(char *data, qint64 maxlen)
+{
+	const int frame_size = m_format.bytesPerFrame();
+	if(frame_size <= 0)
+		return -1;
+	maxlen -= maxlen % frame_size;
+	std::memset(data, 0, maxlen);
+	qint16 *out = reinterpret_cast<qint16*>(data);
+	const int out_samples = maxlen / sizeof(qint16);
+	QMutexLocker locker(&m_mutex);
+	for (int i = m_voices.count() - 1; i >= 0; --i) {
+		Voice &v = m_voices[i];
+		if(v.pos == 0) {
+			/// every voice of burst gets its own latency
+			m_latencies[v.playId] = (m_clock.nsecsElapsed() - v.queuedNsec) / 1000;
+			if(m_latencies.count() > MaxLatencies)
+				m_latencies.erase(m_latencies.begin());
+		}
+		const qint16 *in = reinterpret_cast<const qint16*>(v.pcm.constData() + v.pos);
+		const int n = qMin(out_samples, int((v.pcm.size() - v.pos) / sizeof(qint16)));
+		for (int j = 0; j < n; ++j)
+			out[j] = static_cast<qint16>(qBound(-32768, out[j] + in[j], 32767));
+		v.pos += n * sizeof(qint16);
+		if(v.pos >= v.pcm.size())
+			m_voices.removeAt(i);
+	}
+	return maxlen;
+}
+
+qint64 AlertMixer::writeData(const char *data, qint64 len)
+{
+	Q_UNUSED(data)
+	Q_UNUSED(len)
+	return -1;
+}
+
+}}
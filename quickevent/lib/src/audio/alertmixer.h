@@ -0,0 +1,68 @@
+#ifndef QUICKEVENT_AUDIO_ALERTMIXER_H
+#define QUICKEVENT_AUDIO_ALERTMIXER_H
+
+#include "../quickeventglobal.h"
+
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+
+namespace quickevent {
+namespace audio {
+
+/// Mixes preloaded 16 bit PCM sounds into one continuous stream pulled by QAudioOutput.
+/// Silence is returned when nothing is playing, so the output stream is never stopped
+/// and a new sound starts after output buffer latency only.
+/// Overlapping sounds are mixed, when MaxVoices sounds are playing, the oldest one is dropped.
+/// Any reader can pull the stream, which makes it usable without audio device too.
+class QUICKEVENT_DECL_EXPORT AlertMixer : public QIODevice
+{
+	Q_OBJECT
+private:
+	typedef QIODevice Super;
+public:
+	static constexpr int MaxVoices = 4;
+public:
+	/// format must be 16 bit signed int in host byte order
+	AlertMixer(const QAudioFormat &format, QObject *parent = nullptr);
+
+	const QAudioFormat& format() const {return m_format;}
+	/// pcm must be in mixer format, @return play id, 0 if nothing is played
+	int play(const QByteArray &pcm);
+	int activeCount() const;
+	/// usecs from play() call till its first samples were read from mixer,
+	/// -1 if not read yet, dropped before read or too old
+	qint64 latencyUsec(int play_id) const;
+	/// latency of last play() call
+	qint64 lastLatencyUsec() const;
+
+	bool isSequential() const Q_DECL_OVERRIDE {return true;}
+	qint64 bytesAvailable() const Q_DECL_OVERRIDE;
+protected:
+	qint64 readData(char *data, qint64 maxlen) Q_DECL_OVERRIDE;
+	qint64 writeData(const char *data, qint64 len) Q_DECL_OVERRIDE;
+private:
+	struct Voice
+	{
+		QByteArray pcm;
+		int playId = 0;
+		int pos = 0;
+		qint64 queuedNsec = 0;
+	};
+	/// latencies of this many last plays are kept
+	static const int MaxLatencies = 64;
+	QAudioFormat m_format;
+	mutable QMutex m_mutex;
+	QList<Voice> m_voices;
+	QElapsedTimer m_clock;
+	int m_lastPlayId = 0;
+	QMap<int, qint64> m_latencies; //< play id -> latency usec
+};
+
+}}
+
+#endif
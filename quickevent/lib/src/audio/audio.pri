@@ -1,10 +1,12 @@
 
 HEADERS += \
     $$PWD/player.h \
+    $$PWD/alertmixer.h \
     $$PWD/wavfile.h
 
 SOURCES += \
     $$PWD/player.cpp \
+    $$PWD/alertmixer.cpp \
     $$PWD/wavfile.cpp
 
 
@@ -1,4 +1,5 @@
 #include "player.h"
+#include "alertmixer.h"
 #include "wavfile.h"
 
 #include <qf/core/log.h>
@@ -8,7 +9,13 @@
 #include <QAudioDeviceInfo>
 #include <QAudioFormat>
 #include <QAudioOutput>
+#include <QElapsedTimer>
 #include <QString>
+#include <QStringList>
+#include <QSysInfo>
+#include <QThread>
+#include <QtEndian>
+#include <QtMath>
 
 namespace quickevent {
 namespace audio {
@@ -18,7 +25,7 @@ Player::Player(QObject *parent)
 {
 }
 
-void Player::playAlert(AlertKind kind)
+QString Player::alertFileName(AlertKind kind)
 {
 	QString fn;
 	switch(kind) {
@@ -28,52 +35,255 @@ void Player::playAlert(AlertKind kind)
 	case AlertKind::OperatorWakeUp: fn = QStringLiteral("operator-wakeup.wav"); break;
 	case AlertKind::OperatorNotify: fn = QStringLiteral("operator-notify.wav"); break;
 	}
-	if(!fn.isEmpty()) {
+	if(!fn.isEmpty())
 		fn = QCoreApplication::applicationDirPath() + "/quickevent-data/style/sound/" + fn;
+	return fn;
+}
+
+void Player::playAlert(AlertKind kind)
+{
+	QString fn = alertFileName(kind);
+	if(!fn.isEmpty())
 		playFile(fn);
-	}
 }
 
 void Player::playFile(const QString &file)
 {
-	if (m_audioOutput) {
-		m_audioOutput->stop();
-	}
+	if(!openOutput())
+		return;
+	const QByteArray &pcm = pcmData(file);
+	if(pcm.isEmpty())
+		return;
+	m_mixer->play(pcm);
+}
 
-	if(!m_wavFile)
-		m_wavFile = new WavFile(this);
-	if(!m_wavFile->open(file)) {
-		qfError() << "Cannot open audio file" << file;
+void Player::preload()
+{
+	if(!openOutput())
 		return;
+	for(AlertKind kind : {AlertKind::Error, AlertKind::Warning, AlertKind::Info, AlertKind::OperatorNotify, AlertKind::OperatorWakeUp})
+		pcmData(alertFileName(kind));
+}
+
+qint64 Player::lastPlayLatencyUsec() const
+{
+	if(!m_mixer || !m_audioOutput)
+		return -1;
+	qint64 usec = m_mixer->lastLatencyUsec();
+	if(usec < 0)
+		return usec;
+	/// add time the samples spend in output buffer
+	return usec + m_mixer->format().durationForBytes(m_audioOutput->bufferSize());
+}
+
+QString Player::nullSinkTest()
+{
+	QAudioFormat fmt = outputFormat();
+	AlertMixer mixer(fmt);
+	mixer.open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+	/// quarter of full scale, two tones never clip
+	auto tone = [&fmt](int freq, int msec) -> QByteArray {
+		const int frames = fmt.sampleRate() * msec / 1000;
+		const int channels = fmt.channelCount();
+		QByteArray ret(frames * channels * int(sizeof(qint16)), Qt::Uninitialized);
+		qint16 *out = reinterpret_cast<qint16*>(ret.data());
+		for (int i = 0; i < frames; ++i) {
+			qint16 sample = static_cast<qint16>(8000 * qSin(2 * M_PI * freq * i / fmt.sampleRate()));
+			for (int ch = 0; ch < channels; ++ch)
+				*out++ = sample;
+		}
+		return ret;
+	};
+	const QByteArray tone1 = tone(440, 200);
+	const QByteArray tone2 = tone(660, 200);
+	/// dummy sink pulls 10 msec period like audio output does
+	QByteArray period(fmt.bytesForDuration(10 * 1000), 0);
+	QStringList report;
+
+	mixer.play(tone1);
+	mixer.play(tone2);
+	qint64 len = mixer.read(period.data(), period.size());
+	const qint16 *out = reinterpret_cast<const qint16*>(period.constData());
+	const qint16 *in1 = reinterpret_cast<const qint16*>(tone1.constData());
+	const qint16 *in2 = reinterpret_cast<const qint16*>(tone2.constData());
+	int mismatch = -1;
+	for (int i = 0; i < int(len / sizeof(qint16)); ++i) {
+		if(out[i] != qBound(-32768, in1[i] + in2[i], 32767)) {
+			mismatch = i;
+			break;
+		}
 	}
+	if(mismatch < 0)
+		report << QStringLiteral("Overlap mixing: OK, %1 bytes of 2 voices mixed.").arg(len);
+	else
+		report << QStringLiteral("Overlap mixing: FAILED at sample %1.").arg(mismatch);
+	while(mixer.activeCount() > 0)
+		mixer.read(period.data(), period.size());
 
-	QF_SAFE_DELETE(m_audioOutput);
+	/// burst of alerts posted every 3 msec, more than MaxVoices to show dropping too
+	const int alert_count = 2 * AlertMixer::MaxVoices;
+	const qint64 alert_interval_usec = 3 * 1000;
+	const qint64 read_interval_usec = 10 * 1000;
+	QList<int> play_ids;
+	int max_active = 0;
+	qint64 next_alert_usec = 0;
+	qint64 next_read_usec = 0;
+	QElapsedTimer clock;
+	clock.start();
+	while(play_ids.count() < alert_count || mixer.activeCount() > 0) {
+		qint64 now_usec = clock.nsecsElapsed() / 1000;
+		if(play_ids.count() < alert_count && now_usec >= next_alert_usec) {
+			play_ids << mixer.play(tone1);
+			next_alert_usec += alert_interval_usec;
+		}
+		if(now_usec >= next_read_usec) {
+			max_active = qMax(max_active, mixer.activeCount());
+			mixer.read(period.data(), period.size());
+			next_read_usec += read_interval_usec;
+		}
+		QThread::usleep(200);
+	}
+	int measured = 0;
+	qint64 min_usec = 0, max_usec = 0, sum_usec = 0;
+	QStringList latencies;
+	for(int id : play_ids) {
+		qint64 usec = mixer.latencyUsec(id);
+		latencies << ((usec < 0)? QStringLiteral("dropped"): QString::number(usec));
+		if(usec < 0)
+			continue;
+		min_usec = measured? qMin(min_usec, usec): usec;
+		max_usec = qMax(max_usec, usec);
+		sum_usec += usec;
+		measured++;
+	}
+	report << QStringLiteral("Burst of %1 alerts every %2 msec, sink period %3 msec, max voices mixed: %4")
+			  .arg(alert_count).arg(alert_interval_usec / 1000).arg(read_interval_usec / 1000).arg(max_active);
+	report << QStringLiteral("Latency usec per alert: %1").arg(latencies.join(QStringLiteral(", ")));
+	if(measured > 0)
+		report << QStringLiteral("Latency usec min: %1 avg: %2 max: %3, last alert: %4")
+				  .arg(min_usec).arg(sum_usec / measured).arg(max_usec).arg(mixer.lastLatencyUsec());
+	return report.join('\n');
+}
+
+QAudioFormat Player::outputFormat()
+{
+	QAudioFormat fmt;
+	fmt.setCodec("audio/pcm");
+	fmt.setSampleRate(44100);
+	fmt.setChannelCount(2);
+	fmt.setSampleSize(16);
+	fmt.setSampleType(QAudioFormat::SignedInt);
+	fmt.setByteOrder(QSysInfo::ByteOrder == QSysInfo::LittleEndian? QAudioFormat::LittleEndian: QAudioFormat::BigEndian);
+	return fmt;
+}
 
+bool Player::openOutput()
+{
+	if(m_audioOutput)
+		return true;
+	if(m_outputFailed)
+		return false;
+	QAudioFormat fmt = outputFormat();
 	QAudioDeviceInfo info(QAudioDeviceInfo::defaultOutputDevice());
-	if (!info.isFormatSupported(m_wavFile->fileFormat())) {
-		qfWarning() << "Raw audio format not supported by backend, cannot play audio.";
-		return;
+	if (!info.isFormatSupported(fmt)) {
+		QAudioFormat nearest = info.nearestFormat(fmt);
+		if(nearest.sampleSize() != 16 || nearest.sampleType() != QAudioFormat::SignedInt || nearest.byteOrder() != fmt.byteOrder()) {
+			qfWarning() << "16 bit PCM audio format not supported by backend, cannot play audio.";
+			m_outputFailed = true;
+			return false;
+		}
+		fmt = nearest;
 	}
-
-	m_audioOutput = new QAudioOutput(m_wavFile->fileFormat(), this);
+	m_mixer = new AlertMixer(fmt, this);
+	/// buffered QIODevice would read ahead 16 kB and delay new alerts by it
+	m_mixer->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+	m_audioOutput = new QAudioOutput(info, fmt, this);
+	/// small buffer keeps alert latency low, mixer never runs out of data
+	m_audioOutput->setBufferSize(fmt.bytesForDuration(50 * 1000));
 	connect(m_audioOutput, &QAudioOutput::stateChanged, [this](QAudio::State new_state) {
 		qfDebug() << "Player state changed to" << new_state;
-		switch (new_state) {
-		case QAudio::IdleState:
-			// Finished playing (no more data)
-			this->m_audioOutput->stop();
-			if(this->m_wavFile)
-				this->m_wavFile->close();
-			break;
-
-		default:
-			// ... other cases as appropriate
-			break;
+		if(new_state == QAudio::StoppedState && this->m_audioOutput->error() != QAudio::NoError) {
+			qfWarning() << "Audio output stopped with error:" << this->m_audioOutput->error() << "restarting.";
+			this->m_audioOutput->start(this->m_mixer);
 		}
 	});
+	m_audioOutput->start(m_mixer);
+	return true;
+}
 
-	m_audioOutput->start(m_wavFile);
+const QByteArray &Player::pcmData(const QString &file)
+{
+	auto it = m_pcmCache.constFind(file);
+	if(it != m_pcmCache.constEnd())
+		return it.value();
+	QByteArray pcm;
+	WavFile wav_file;
+	if(!wav_file.open(file)) {
+		qfError() << "Cannot open audio file" << file;
+	}
+	else {
+		qint64 len = wav_file.dataLength();
+		if(len <= 0 || len > wav_file.size() - wav_file.headerLength())
+			len = wav_file.size() - wav_file.headerLength();
+		pcm = convertPcm(wav_file.read(len), wav_file.fileFormat(), m_mixer->format());
+		qfDebug() << "audio file" << file << "decoded to" << pcm.size() << "bytes";
+	}
+	/// failed files are cached too, so they are not opened again on every alert
+	return m_pcmCache.insert(file, pcm).value();
 }
 
-}}
+QByteArray Player::convertPcm(const QByteArray &data, const QAudioFormat &from, const QAudioFormat &to)
+{
+	const int in_channels = from.channelCount();
+	const int in_bytes = from.sampleSize() / 8;
+	if(in_channels < 1 || (in_bytes != 1 && in_bytes != 2) || from.sampleRate() <= 0) {
+		qfWarning() << "Unsupported audio file format, sample size:" << from.sampleSize() << "channels:" << in_channels;
+		return QByteArray();
+	}
+	const int in_frames = data.size() / (in_channels * in_bytes);
+	if(in_frames == 0)
+		return QByteArray();
+	const uchar *in = reinterpret_cast<const uchar*>(data.constData());
+	auto sample = [in, in_channels, in_bytes, &from](int frame, int channel) -> int {
+		const uchar *p = in + (frame * in_channels + channel) * in_bytes;
+		if(in_bytes == 1)
+			return (int(p[0]) - 128) << 8;
+		if(from.byteOrder() == QAudioFormat::LittleEndian)
+			return qFromLittleEndian<qint16>(p);
+		return qFromBigEndian<qint16>(p);
+	};
+	const int out_channels = to.channelCount();
+	const int out_frames = int(qint64(in_frames) * to.sampleRate() / from.sampleRate());
+	QByteArray ret(out_frames * out_channels * int(sizeof(qint16)), Qt::Uninitialized);
+	qint16 *out = reinterpret_cast<qint16*>(ret.data());
+	const double step = double(from.sampleRate()) / to.sampleRate();
+	for (int i = 0; i < out_frames; ++i) {
+		/// linear interpolation is good enough for alert sounds
+		const double src = i * step;
+		const int f0 = qMin(int(src), in_frames - 1);
+		const int f1 = qMin(f0 + 1, in_frames - 1);
+		const double frac = src - f0;
+		for (int ch = 0; ch < out_channels; ++ch) {
+			int s0, s1;
+			if(out_channels == 1 && in_channels > 1) {
+				/// down mix
+				s0 = s1 = 0;
+				for (int c = 0; c < in_channels; ++c) {
+					s0 += sample(f0, c);
+					s1 += sample(f1, c);
+				}
+				s0 /= in_channels;
+				s1 /= in_channels;
+			}
+			else {
+				const int in_ch = qMin(ch, in_channels - 1);
+				s0 = sample(f0, in_ch);
+				s1 = sample(f1, in_ch);
+			}
+			*out++ = static_cast<qint16>(s0 + (s1 - s0) * frac);
+		}
+	}
+	return ret;
+}
 
+}}
@@ -4,14 +4,19 @@
 #include "../quickeventglobal.h"
 
 #include <QObject>
+#include <QHash>
+#include <QByteArray>
 
 class QAudioOutput;
+class QAudioFormat;
 
 namespace quickevent {
 namespace audio {
 
-class WavFile;
+class AlertMixer;
 
+/// Alert sounds are decoded once to PCM buffers of output format,
+/// one output stream is kept open and overlapping alerts are mixed by AlertMixer.
 class QUICKEVENT_DECL_EXPORT Player : public QObject
 {
 	Q_OBJECT
@@ -23,9 +28,24 @@ public:
 
 	void playAlert(AlertKind kind);
 	void playFile(const QString& file);
+	/// open output stream and decode all alert sounds, called by first play if not called before
+	void preload();
+	/// usecs from last play request till its samples were pulled by audio output, -1 if not played yet
+	qint64 lastPlayLatencyUsec() const;
+	/// play burst of test tones into mixer pulled by timer paced dummy reader instead of audio device,
+	/// @return report of overlap mixing check and per alert latencies
+	static QString nullSinkTest();
+private:
+	static QString alertFileName(AlertKind kind);
+	static QAudioFormat outputFormat();
+	bool openOutput();
+	const QByteArray& pcmData(const QString &file);
+	static QByteArray convertPcm(const QByteArray &data, const QAudioFormat &from, const QAudioFormat &to);
 private:
 	QAudioOutput* m_audioOutput = nullptr;
-	WavFile *m_wavFile = nullptr;
+	AlertMixer *m_mixer = nullptr;
+	bool m_outputFailed = false;
+	QHash<QString, QByteArray> m_pcmCache; //< file name -> PCM data in mixer format
 };
 
 }}
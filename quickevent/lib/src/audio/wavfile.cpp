@@ -96,6 +96,7 @@ bool WavFile::readHeader()
 
 			if (read((char*)&dataHeader, sizeof(DATAHeader)) != sizeof(DATAHeader))
 				return false;
+			m_dataLength = qFromLittleEndian<quint32>(dataHeader.descriptor.size);
 
 			// Establish format
 			if (memcmp(&header.riff.descriptor.id, "RIFF", 4) == 0)
@@ -19,6 +19,8 @@ public:
 	bool open(const QString &fileName);
 	const QAudioFormat &fileFormat() const;
 	qint64 headerLength() const;
+	/// length of PCM data chunk
+	qint64 dataLength() const {return m_dataLength;}
 
 private:
 	bool readHeader();
@@ -26,6 +28,7 @@ private:
 private:
 	QAudioFormat m_fileFormat;
 	qint64 m_headerLength;
+	qint64 m_dataLength = 0;
 };
 
 }}